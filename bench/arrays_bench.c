@@ -0,0 +1,93 @@
+/*
+ * Microbenchmarks das funções de arrays: as instâncias por tipo
+ * (mathc_min_element_int, mathc_find_float, ...) contra as antigas, laços
+ * escalares que recebiam só int*. Para float a referência é o mesmo laço
+ * escalar sobre double. Usa o C gerado por `mathc bench/arrays.mf`.
+ *
+ *   make bench                       # 10^6 e 10^7 elementos
+ *   build/bench/arrays_bench 50000000
+ */
+#define MATHC_BENCH_C "arrays.c"
+#include "bench.h"
+
+/* Referências: os laços do runtime antigo */
+static int min_antigo(const int* arr, int len) {
+    if (len == 0) return 0;
+    int min_val = arr[0];
+    for (int i = 1; i < len; i++) if (arr[i] < min_val) min_val = arr[i];
+    return min_val;
+}
+
+static int find_antigo(const int* arr, int len, int val) {
+    for (int i = 0; i < len; i++) if (arr[i] == val) return i;
+    return -1;
+}
+
+static int count_antigo(const int* arr, int len, int val) {
+    int cnt = 0;
+    for (int i = 0; i < len; i++) if (arr[i] == val) cnt++;
+    return cnt;
+}
+
+static double min_escalar(const double* arr, int len) {
+    double min_val = arr[0];
+    for (int i = 1; i < len; i++) if (arr[i] < min_val) min_val = arr[i];
+    return min_val;
+}
+
+#define REPETICOES 5
+
+static volatile double sumidouro;
+
+/* Melhor de REPETICOES de uma expressão */
+#define MELHOR(t, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            sumidouro = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    int* xs = malloc(sizeof(int) * (size_t)n);
+    double* fs = malloc(sizeof(double) * (size_t)n);
+    if (!xs || !fs) { printf("n %d: memória insuficiente\n", n); free(xs); free(fs); return; }
+    unsigned semente = 5;
+    for (int i = 0; i < n; i++) {
+        semente = semente * 1103515245u + 12345u;
+        xs[i] = (int)(semente >> 8) % 1000000 + 1;
+        fs[i] = xs[i] * 0.5;
+    }
+    // find procura um valor que só aparece no fim
+    xs[n - 1] = -7;
+
+    double t_ma, t_mn, t_fa, t_fn, t_ca, t_cn, t_fma, t_fmn;
+    MELHOR(t_ma, min_antigo(xs, n));
+    MELHOR(t_mn, mathc_min_element_int(xs, n));
+    MELHOR(t_fa, find_antigo(xs, n, -7));
+    MELHOR(t_fn, mathc_find_int(xs, n, -7));
+    MELHOR(t_ca, count_antigo(xs, n, 500));
+    MELHOR(t_cn, mathc_count_int(xs, n, 500));
+    MELHOR(t_fma, min_escalar(fs, n));
+    MELHOR(t_fmn, mathc_min_element_float(fs, n));
+
+    int ok = min_antigo(xs, n) == mathc_min_element_int(xs, n) &&
+             find_antigo(xs, n, -7) == mathc_find_int(xs, n, -7) &&
+             count_antigo(xs, n, 500) == mathc_count_int(xs, n, 500) &&
+             min_escalar(fs, n) == mathc_min_element_float(fs, n);
+    printf("n %9d  min_element: %6.1fx  find: %6.1fx  count: %6.1fx | float min_element: %6.1fx  %s\n",
+           n, t_ma / t_mn, t_fa / t_fn, t_ca / t_cn, t_fma / t_fmn, ok ? "ok" : "ERRO");
+    free(xs); free(fs);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * Preâmbulo comum dos harnesses bench/<nome>_bench.c. Cada harness define
+ * MATHC_BENCH_C com o nome do C gerado por `mathc bench/<nome>.mf` (achado
+ * em build/bench pelo -I do Makefile) antes de incluir este arquivo; o main
+ * do programa vira mathc_program_main para o harness ter o próprio.
+ */
+#ifndef MATHC_BENCH_H
+#define MATHC_BENCH_H
+
+#ifndef MATHC_BENCH_C
+#error "defina MATHC_BENCH_C (ex.: \"primes.c\") antes de incluir bench.h"
+#endif
+
+#define main mathc_program_main
+#include MATHC_BENCH_C
+#undef main
+
+#include <time.h>
+
+/* Relógio monotônico em segundos */
+static double agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Microbenchmarks do runtime de bigint gerado, cada núcleo contra a versão
+ * direta que ele substitui:
+ *   mul           Karatsuba (acima de MATHC_KARATSUBA_MIN)  x  escolar O(n^2)
+ *   factorial     árvore de produtos                        x  r = r * i, um fator por vez
+ *   combinations  expoentes de Legendre + árvore            x  r = r * (n - k + i) / i
+ *   to_string     blocos de 9 dígitos (÷10^9)               x  um dígito por passada (÷10)
+ * Usa o C gerado por `mathc bench/bigint.mf`.
+ *
+ *   make bench
+ *   build/bench/bigint_bench 20000   # n de factorial/combinations
+ */
+#define MATHC_BENCH_C "bigint.c"
+#include "bench.h"
+
+#define REPETICOES 3
+
+/* Referências */
+static mathc_bigint* factorial_laco(int n) {
+    mathc_bigint* r = mathc_big_from_ll(1);
+    for (int i = 2; i <= n; i++) r = mathc_big_mul(r, mathc_big_from_ll(i));
+    return r;
+}
+
+static mathc_bigint* combinations_laco(int n, int k) {
+    mathc_bigint* r = mathc_big_from_ll(1);
+    for (int i = 1; i <= k; i++) r = mathc_big_div(mathc_big_mul(r, mathc_big_from_ll(n - k + i)), mathc_big_from_ll(i));
+    return r;
+}
+
+static char* to_string_digitos(const mathc_bigint* a) {
+    int n = a->len, nd = 0;
+    unsigned* t = malloc(sizeof(unsigned) * (size_t)n);
+    char* s = malloc((size_t)n * 10 + 2);
+    memcpy(t, a->d, sizeof(unsigned) * (size_t)n);
+    while (n > 0) {
+        s[nd++] = (char)('0' + mathc_mag_divmod_small(t, n, 10));
+        while (n > 0 && t[n - 1] == 0) n--;
+    }
+    for (int i = 0; i < nd / 2; i++) { char c = s[i]; s[i] = s[nd - 1 - i]; s[nd - 1 - i] = c; }
+    s[nd] = 0;
+    free(t);
+    return s;
+}
+
+/* Operandos pseudoaleatórios de n limbs */
+static unsigned semente = 7;
+static mathc_bigint* aleatorio(int n) {
+    mathc_bigint* x = mathc_big_alloc(n);
+    for (int i = 0; i < n; i++) { semente = semente * 1103515245u + 12345u; x->d[i] = semente ^ (semente << 16); }
+    x->d[n - 1] |= 1u;
+    x->len = n;
+    return mathc_big_norm(x, 1);
+}
+
+#define MELHOR(t, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            expr; \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void linha(const char* nome, long long n, const char* velho, double tv, const char* novo, double tn, int ok) {
+    printf("%-12s n %8lld  %-9s %9.5fs | %-9s %9.5fs %8.1fx  %s\n",
+           nome, n, velho, tv, novo, tn, tv / tn, ok ? "ok" : "ERRO");
+}
+
+static void medir_mul(int limbs) {
+    mathc_bigint* a = aleatorio(limbs);
+    mathc_bigint* b = aleatorio(limbs);
+    unsigned* r1 = malloc(sizeof(unsigned) * 2 * (size_t)limbs);
+    unsigned* r2 = malloc(sizeof(unsigned) * 2 * (size_t)limbs);
+    double tv, tn;
+    MELHOR(tv, mathc_mag_mul_basic(r1, a->d, limbs, b->d, limbs));
+    MELHOR(tn, mathc_mag_mul(r2, a->d, limbs, b->d, limbs));
+    linha("mul (limbs)", limbs, "escolar", tv, "karatsuba", tn, memcmp(r1, r2, sizeof(unsigned) * 2 * (size_t)limbs) == 0);
+    free(r1); free(r2);
+    mathc_big_release(a); mathc_big_release(b);
+}
+
+static void medir(int n) {
+    double tv, tn;
+    mathc_bigint *x = NULL, *y = NULL;
+
+    MELHOR(tv, (mathc_big_release(x), x = factorial_laco(n)));
+    MELHOR(tn, (mathc_big_release(y), y = mathc_big_factorial(n)));
+    linha("factorial", n, "laço", tv, "árvore", tn, mathc_big_cmp_b(x, y) == 0);
+
+    char *s1 = NULL, *s2 = NULL;
+    MELHOR(tv, (free(s1), s1 = to_string_digitos(y)));
+    MELHOR(tn, (free(s2), s2 = mathc_big_to_string_b(y)));
+    linha("to_string", (long long)strlen(s2), "÷10", tv, "÷10^9", tn, strcmp(s1, s2) == 0);
+    free(s1); free(s2);
+    mathc_big_release(x); mathc_big_release(y);
+    x = y = NULL;
+
+    MELHOR(tv, (mathc_big_release(x), x = combinations_laco(n, n / 2)));
+    MELHOR(tn, (mathc_big_release(y), y = mathc_big_combinations(n, n / 2)));
+    linha("combinations", n, "laço", tv, "legendre", tn, mathc_big_cmp_b(x, y) == 0);
+    mathc_big_release(x); mathc_big_release(y);
+}
+
+int main(int argc, char** argv) {
+    for (int limbs = 64; limbs <= 8192; limbs *= 4) medir_mul(limbs);
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(5000);
+    medir(20000);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Microbenchmarks da leitura de arquivos numéricos no runtime gerado, com um
+ * arquivo temporário de 8 colunas de floats (%.6f) separadas por vírgula:
+ *   fscanf("%lf") por valor  x  fgets + strtod por linha  x  read_array  x  read_matrix
+ * e a primeira passada (contagem de palavras) com a máscara SSE2 contra o
+ * laço byte a byte. MATHC_NUM_THREADS limita as threads das duas passadas.
+ * Usa o C gerado por `mathc bench/files.mf`.
+ *
+ *   make bench
+ *   build/bench/files_bench 10000000   # quantidade de valores
+ */
+#define MATHC_BENCH_C "files.c"
+#include "bench.h"
+
+#define ARQUIVO "/tmp/mathc_files_bench.csv"
+#define COLUNAS 8
+
+static void gravar(int n) {
+    FILE* f = fopen(ARQUIVO, "w");
+    if (!f) { perror(ARQUIVO); exit(1); }
+    unsigned long long x = 88172645463325252ULL;
+    for (int i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        double d = (double)(x >> 11) / 9007199254740992.0 * 2000.0 - 1000.0;
+        fprintf(f, "%.6f%c", d, i % COLUNAS == COLUNAS - 1 ? '\n' : ',');
+    }
+    fclose(f);
+}
+
+static double soma_fscanf(void) {
+    FILE* f = fopen(ARQUIVO, "r");
+    double s = 0, x;
+    while (fscanf(f, "%lf,", &x) == 1) s += x;
+    fclose(f);
+    return s;
+}
+
+static double soma_strtod(void) {
+    FILE* f = fopen(ARQUIVO, "r");
+    char linha[1024];
+    double s = 0;
+    while (fgets(linha, sizeof(linha), f)) {
+        char* p = linha;
+        for (;;) {
+            char* e;
+            double x = strtod(p, &e);
+            if (e == p) break;
+            s += x;
+            p = *e == ',' ? e + 1 : e;
+        }
+    }
+    fclose(f);
+    return s;
+}
+
+static double soma_read_array(void) {
+    int n = 0;
+    double* v = mathc_read_array_float(ARQUIVO, &n);
+    double s = 0;
+    for (int i = 0; i < n; i++) s += v[i];
+    free(v);
+    return s;
+}
+
+static double soma_read_matrix(void) {
+    mathc_matrix_float* m = mathc_read_matrix_float(ARQUIVO, 0);
+    double s = 0;
+    for (int i = 0; i < m->rows; i++)
+        for (int j = 0; j < m->cols; j++) s += m->data[(size_t)i * m->stride + j];
+    free(m);
+    return s;
+}
+
+static long long contar_escalar(const char* p, const char* end) {
+    long long n = 0;
+    int prev = 1;
+    for (; p < end; p++) {
+        int s = MATHC_SCAN_SEP(*p);
+        n += !s & prev;
+        prev = s;
+    }
+    return n;
+}
+
+#define REPETICOES 3
+
+/* Melhor de REPETICOES execuções de expr; o último resultado fica em res */
+#define MELHOR(t, res, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            res = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    gravar(n);
+    double tf, ts, ta, tm, sf, ss, sa, sm;
+    MELHOR(tf, sf, soma_fscanf());
+    MELHOR(ts, ss, soma_strtod());
+    MELHOR(ta, sa, soma_read_array());
+    MELHOR(tm, sm, soma_read_matrix());
+    printf("float n %10d  fscanf %8.4fs | strtod %8.4fs %5.1fx | read_array %8.4fs %5.1fx | read_matrix %8.4fs %5.1fx  %s\n",
+           n, tf, ts, tf / ts, ta, tf / ta, tm, tf / tm,
+           fabs(sf - ss) + fabs(ss - sa) + fabs(sa - sm) < 1e-6 * fabs(sf) + 1e-6 ? "ok" : "ERRO");
+
+    mathc_file_view f = mathc_file_open(ARQUIVO);
+    long long ce, cs;
+    double te, tsimd;
+    MELHOR(te, ce, contar_escalar(f.data, f.data + f.size));
+    MELHOR(tsimd, cs, mathc_scan_count(f.data, f.data + f.size));
+    printf("conta   %10d  byte a byte %8.4fs | SSE2 %8.4fs %5.1fx  %s\n", n, te, tsimd, te / tsimd, ce == cs && cs == n ? "ok" : "ERRO");
+    mathc_file_close(f);
+    remove(ARQUIVO);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
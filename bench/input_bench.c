@@ -0,0 +1,123 @@
+/*
+ * Microbenchmarks da leitura de stdin no runtime gerado contra scanf, com
+ * stdin apontado para um arquivo temporário:
+ *   int    scanf("%d") por valor                 x  input() por valor  x  input_array(n)
+ *   float  scanf("%lf") por valor                x  input() por valor  x  input_array(n)
+ * Os floats vêm em duas formas: curtos (%.3f, como dados medidos) e exatos
+ * (a menor forma que relê o double, 16 a 17 dígitos, como o println imprime).
+ * Usa o C gerado por `mathc bench/input.mf`.
+ *
+ *   make bench
+ *   build/bench/input_bench 10000000   # quantidade de valores
+ */
+#define MATHC_BENCH_C "input.c"
+#include "bench.h"
+
+#include <fcntl.h>
+
+/* Grava os valores em um arquivo temporário e o deixa como stdin */
+static void preparar_stdin(const char* caminho) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { perror(caminho); exit(1); }
+    dup2(fd, STDIN_FILENO);
+    close(fd);
+}
+
+/* Volta ao início do arquivo, tanto para o FILE* stdin quanto para o leitor do runtime */
+static void rebobinar(void) {
+    lseek(STDIN_FILENO, 0, SEEK_SET);
+    rewind(stdin);
+    mathc_in_pos = mathc_in_len = mathc_in_eof = 0;
+}
+
+static long long ints_scanf(int n) { long long s = 0; int x; for (int i = 0; i < n; i++) { if (scanf("%d", &x) == 1) s += x; } return s; }
+static long long ints_input(int n) { long long s = 0; for (int i = 0; i < n; i++) s += mathc_input_int(); return s; }
+static long long ints_array(int n) {
+    int len = 0; int* v = mathc_input_array_int(n, &len);
+    long long s = 0; for (int i = 0; i < len; i++) s += v[i];
+    free(v);
+    return s;
+}
+static double floats_scanf(int n) { double s = 0, x; for (int i = 0; i < n; i++) { if (scanf("%lf", &x) == 1) s += x; } return s; }
+static double floats_input(int n) { double s = 0; for (int i = 0; i < n; i++) s += mathc_input_float(); return s; }
+static double floats_array(int n) {
+    int len = 0; double* v = mathc_input_array_float(n, &len);
+    double s = 0; for (int i = 0; i < len; i++) s += v[i];
+    free(v);
+    return s;
+}
+
+#define REPETICOES 3
+
+/* Melhor de REPETICOES leituras do arquivo inteiro; o último resultado fica em res */
+#define MELHOR(t, res, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            rebobinar(); \
+            double t0_ = agora(); \
+            res = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void linha(const char* nome, int n, double ts, double ti, double ta, int ok) {
+    printf("%-11s n %10d  scanf %8.4fs | input %8.4fs %6.1fx | input_array %8.4fs %6.1fx  %s\n",
+           nome, n, ts, ti, ts / ti, ta, ts / ta, ok ? "ok" : "ERRO");
+}
+
+static void medir_arquivo(const char* nome, int n, int flutuante) {
+    double ts, ti, ta;
+    preparar_stdin("/tmp/mathc_input_bench.txt");
+    if (flutuante) {
+        double ss, si, sa;
+        MELHOR(ts, ss, floats_scanf(n));
+        MELHOR(ti, si, floats_input(n));
+        MELHOR(ta, sa, floats_array(n));
+        linha(nome, n, ts, ti, ta, ss == si && si == sa);
+    } else {
+        long long ss, si, sa;
+        MELHOR(ts, ss, ints_scanf(n));
+        MELHOR(ti, si, ints_input(n));
+        MELHOR(ta, sa, ints_array(n));
+        linha(nome, n, ts, ti, ta, ss == si && si == sa);
+    }
+}
+
+/* forma: 0 int, 1 float curto (%.3f), 2 float exato (menor forma) */
+static void gravar(int n, int forma) {
+    FILE* f = fopen("/tmp/mathc_input_bench.txt", "w");
+    if (!f) { perror("/tmp/mathc_input_bench.txt"); exit(1); }
+    unsigned long long x = 88172645463325252ULL;
+    char buf[40];
+    for (int i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        if (forma == 0) fprintf(f, "%d%c", (int)(x >> 33) - (1 << 30), i % 10 == 9 ? '\n' : ' ');
+        else {
+            double d = (double)(x >> 11) / 9007199254740992.0 * 2000.0 - 1000.0;
+            if (forma == 1) fprintf(f, "%.3f%c", d, i % 10 == 9 ? '\n' : ' ');
+            else { buf[mathc_fmt_double(buf, d)] = 0; fprintf(f, "%s%c", buf, i % 10 == 9 ? '\n' : ' '); }
+        }
+    }
+    fclose(f);
+}
+
+static void medir(int n) {
+    gravar(n, 0);
+    medir_arquivo("int", n, 0);
+    gravar(n, 1);
+    medir_arquivo("float %.3f", n, 1);
+    gravar(n, 2);
+    medir_arquivo("float exato", n, 1);
+    remove("/tmp/mathc_input_bench.txt");
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * Benchmark de A @ B: kernel do runtime (blocado, SIMD, threads) contra o
+ * laço triplo ingênuo. Usa o C gerado por `mathc bench/matmul.mf`.
+ *
+ *   make bench                     # tamanhos padrão
+ *   build/bench/matmul_bench 1024  # tamanho específico
+ *   MATHC_NUM_THREADS=1 build/bench/matmul_bench
+ */
+#define MATHC_BENCH_C "matmul.c"
+#include "bench.h"
+
+static mathc_matrix_float* aleatoria(int n, unsigned* semente) {
+    mathc_matrix_float* m = mathc_matrix_new_float(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            *semente = *semente * 1103515245u + 12345u;
+            m->data[i * m->stride + j] = (double)(*semente >> 16 & 0x7fff) / 32768.0 - 0.5;
+        }
+    return m;
+}
+
+/* Referência: i-j-k sem blocagem, como um usuário escreveria na linguagem */
+static void ingenuo(const mathc_matrix_float* a, const mathc_matrix_float* b, mathc_matrix_float* c) {
+    int n = a->rows;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            double s = 0;
+            for (int k = 0; k < n; k++) s += a->data[i * a->stride + k] * b->data[k * b->stride + j];
+            c->data[i * c->stride + j] = s;
+        }
+}
+
+static void medir(int n) {
+    unsigned semente = 42;
+    mathc_matrix_float* a = aleatoria(n, &semente);
+    mathc_matrix_float* b = aleatoria(n, &semente);
+    mathc_matrix_float* ref = mathc_matrix_new_float(n, n);
+    double gflop = 2.0 * n * n * (double)n * 1e-9;
+
+    double t0 = agora();
+    ingenuo(a, b, ref);
+    double t_ingenuo = agora() - t0;
+
+    t0 = agora();
+    mathc_matrix_float* c = mathc_matmul_float(a, b);
+    double t_kernel = agora() - t0;
+
+    double erro = 0;
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            double d = fabs(c->data[i * c->stride + j] - ref->data[i * ref->stride + j]);
+            if (d > erro) erro = d;
+        }
+
+    printf("n=%5d  ingênuo %8.3fs (%6.2f GFLOP/s)  kernel %8.4fs (%7.2f GFLOP/s)  %6.1fx  erro %.1e\n",
+           n, t_ingenuo, gflop / t_ingenuo, t_kernel, gflop / t_kernel, t_ingenuo / t_kernel, erro);
+
+    double* v = malloc(sizeof(double) * n);
+    for (int i = 0; i < n; i++) v[i] = 1.0 / (i + 1);
+    t0 = agora();
+    int len = 0;
+    double* y = mathc_gemv_float(a, v, n, &len);
+    double t_gemv = agora() - t0;
+    printf("         gemv %dx%d: %.5fs (%.2f GFLOP/s)\n", n, n, t_gemv, 2.0 * n * (double)n * 1e-9 / t_gemv);
+
+    free(y); free(v); free(a); free(b); free(c); free(ref);
+}
+
+int main(int argc, char** argv) {
+    printf("threads: %d, AVX2/FMA: %s\n", mathc_num_threads(), mathc_has_avx2() ? "sim" : "não");
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    int tamanhos[] = { 64, 256, 512, 1024 };
+    for (int i = 0; i < 4; i++) medir(tamanhos[i]);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Microbenchmarks das operações de matrizes do runtime contra as versões
+ * ingênuas: transposta blocada x laço duplo, determinante por LU x expansão
+ * por cofatores, e preenchimentos (zeros/ones/identity) x laço elemento a
+ * elemento. Usa o C gerado por `mathc bench/matrix_ops.mf`.
+ *
+ *   make bench                          # tamanhos padrão
+ *   build/bench/matrix_ops_bench 4096   # tamanho específico
+ */
+#define MATHC_BENCH_C "matrix_ops.c"
+#include "bench.h"
+
+static mathc_matrix_float* aleatoria(int rows, int cols, unsigned* semente) {
+    mathc_matrix_float* m = mathc_matrix_new_float(rows, cols);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++) {
+            *semente = *semente * 1103515245u + 12345u;
+            m->data[i * m->stride + j] = (double)(*semente >> 16 & 0x7fff) / 32768.0 - 0.5;
+        }
+    return m;
+}
+
+/* Referência: percorre a origem por linhas e escreve o destino por colunas */
+static mathc_matrix_float* transposta_ingenua(const mathc_matrix_float* a) {
+    mathc_matrix_float* b = mathc_matrix_new_float(a->cols, a->rows);
+    for (int i = 0; i < a->rows; i++)
+        for (int j = 0; j < a->cols; j++) b->data[j * b->stride + i] = a->data[i * a->stride + j];
+    return b;
+}
+
+/* Referência: expansão por cofatores na primeira linha, O(n!) */
+static double cofatores(const double* m, int n) {
+    if (n == 1) return m[0];
+    double* menor = malloc(sizeof(double) * (n - 1) * (n - 1));
+    double det = 0;
+    for (int c = 0; c < n; c++) {
+        for (int i = 1; i < n; i++)
+            for (int j = 0, k = 0; j < n; j++)
+                if (j != c) menor[(i - 1) * (n - 1) + k++] = m[i * n + j];
+        det += (c % 2 ? -1 : 1) * m[c] * cofatores(menor, n - 1);
+    }
+    free(menor);
+    return det;
+}
+
+static void medir_transposta(int n) {
+    unsigned semente = 7;
+    mathc_matrix_float* a = aleatoria(n, n + 3, &semente);
+
+    double t0 = agora();
+    mathc_matrix_float* ref = transposta_ingenua(a);
+    double t_ingenuo = agora() - t0;
+
+    t0 = agora();
+    mathc_matrix_float* b = mathc_transpose_float(a);
+    double t_kernel = agora() - t0;
+
+    int ok = 1;
+    for (int i = 0; i < b->rows && ok; i++)
+        for (int j = 0; j < b->cols; j++)
+            if (b->data[i * b->stride + j] != ref->data[i * ref->stride + j]) { ok = 0; break; }
+
+    double gb = 2.0 * sizeof(double) * n * (double)(n + 3) * 1e-9;
+    printf("transpose %5dx%-5d  ingênuo %8.4fs (%5.2f GB/s)  blocado %8.4fs (%5.2f GB/s)  %5.1fx  %s\n",
+           n, n + 3, t_ingenuo, gb / t_ingenuo, t_kernel, gb / t_kernel, t_ingenuo / t_kernel, ok ? "ok" : "ERRO");
+    free(a); free(ref); free(b);
+}
+
+static void medir_determinante(int n) {
+    unsigned semente = 11;
+    mathc_matrix_float* a = aleatoria(n, n, &semente);
+
+    double t0 = agora();
+    double det = mathc_determinant_float(a);
+    double t_lu = agora() - t0;
+    printf("determinant %4d  LU %9.5fs (%6.2f GFLOP/s)", n, t_lu, 2.0 / 3.0 * n * n * (double)n * 1e-9 / t_lu);
+
+    // Cofatores só são viáveis para n pequeno
+    if (n <= 10) {
+        double* denso = malloc(sizeof(double) * n * n);
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++) denso[i * n + j] = a->data[i * a->stride + j];
+        t0 = agora();
+        double ref = cofatores(denso, n);
+        double t_cof = agora() - t0;
+        printf("  cofatores %9.5fs  %9.1fx  det %.6g  erro %.1e", t_cof, t_cof / t_lu, det, fabs(ref - det));
+        free(denso);
+    }
+    printf("\n");
+    free(a);
+}
+
+#define REPETICOES 5
+
+/* Melhor de REPETICOES: a partir da segunda, o bloco liberado volta do malloc já mapeado */
+#define MELHOR(t, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            mathc_matrix_float* m_ = (expr); \
+            double dt_ = agora() - t0_; \
+            soma += mathc_trace_float(m_); \
+            free(m_); \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+/* Referência: identidade elemento a elemento, como um laço na linguagem */
+static mathc_matrix_float* identidade_ingenua(int n) {
+    mathc_matrix_float* m = mathc_matrix_raw_float(n, n);
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) m->data[i * m->stride + j] = i == j ? 1.0 : 0.0;
+    return m;
+}
+
+static void medir_preenchimentos(int n) {
+    double soma = 0, t_ingenuo, t_id, t_z, t_u;
+    MELHOR(t_ingenuo, identidade_ingenua(n));
+    MELHOR(t_id, mathc_identity_float(n));
+    MELHOR(t_z, mathc_zeros_float(n, -1));
+    MELHOR(t_u, mathc_ones_float(n, -1));
+
+    double gb = sizeof(double) * n * (double)n * 1e-9;
+    printf("fills %5d  laço %8.5fs  identity %8.5fs (%5.2f GB/s)  zeros %8.5fs (%5.2f GB/s)  ones %8.5fs (%5.2f GB/s)  [%g]\n",
+           n, t_ingenuo, t_id, gb / t_id, t_z, gb / t_z, t_u, gb / t_u, soma);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            int n = atoi(argv[i]);
+            medir_transposta(n);
+            medir_determinante(n);
+            medir_preenchimentos(n);
+        }
+        return 0;
+    }
+    int tamanhos[] = { 256, 1024, 2048, 4096 };
+    for (int i = 0; i < 4; i++) medir_transposta(tamanhos[i]);
+    int ordens[] = { 8, 10, 256, 1024 };
+    for (int i = 0; i < 4; i++) medir_determinante(ordens[i]);
+    for (int i = 0; i < 4; i++) medir_preenchimentos(tamanhos[i]);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Microbenchmarks de mod[p] (p = 10^9 + 7) no runtime gerado, contra o que
+ * se escreveria sem o tipo:
+ *   mul   cadeia x = x * y mod p: % com p em variável  x  mathc_mod_mul (p constante, Barrett)
+ *         e, como referência, Montgomery (R = 2^32)
+ *   pow   a ^ e com % e p em variável                  x  mathc_mod_pow
+ *   sum   s = (s + a[i]) % p                           x  soma em 64 bits e um só %
+ *   prod  r = r * a[i] % p                             x  8 acumuladores
+ * Usa o C gerado por `mathc bench/mod.mf`.
+ *
+ *   make bench
+ *   build/bench/mod_bench 100000000   # tamanho do array / da cadeia
+ */
+#define MATHC_BENCH_C "mod.c"
+#include "bench.h"
+
+#define P 1000000007u
+#define NINV 2226617417u  // -P^-1 mod 2^32
+#define R2 582344008u     // 2^64 mod P
+
+static volatile unsigned p_variavel = P;
+
+/* Referências */
+static unsigned mul_cadeia_var(unsigned x, unsigned y, int n) {
+    unsigned p = p_variavel;
+    for (int i = 0; i < n; i++) x = (unsigned)((unsigned long long)x * y % p);
+    return x;
+}
+
+static unsigned mul_cadeia_mod(unsigned x, unsigned y, int n) {
+    for (int i = 0; i < n; i++) x = mathc_mod1000000007_mul(x, y);
+    return x;
+}
+
+static inline unsigned montgomery_reduz(unsigned long long t) {
+    unsigned m = (unsigned)t * NINV;
+    unsigned u = (unsigned)((t + (unsigned long long)m * P) >> 32);
+    return u >= P ? u - P : u;
+}
+
+static unsigned mul_cadeia_montgomery(unsigned x, unsigned y, int n) {
+    x = montgomery_reduz((unsigned long long)x * R2);  // entrada: x·R mod p
+    y = montgomery_reduz((unsigned long long)y * R2);
+    for (int i = 0; i < n; i++) x = montgomery_reduz((unsigned long long)x * y);
+    return montgomery_reduz(x);                       // saída: x·R^-1 mod p
+}
+
+static unsigned pow_var(unsigned b, long long e) {
+    unsigned long long p = p_variavel, r = 1, x = b;
+    while (e) { if (e & 1) r = r * x % p; x = x * x % p; e >>= 1; }
+    return (unsigned)r;
+}
+
+static unsigned soma_resto(unsigned const* a, int n) {
+    unsigned s = 0;
+    for (int i = 0; i < n; i++) s = (s + a[i]) % P;
+    return s;
+}
+
+static unsigned prod_resto(unsigned const* a, int n) {
+    unsigned long long r = 1;
+    for (int i = 0; i < n; i++) r = r * a[i] % P;
+    return (unsigned)r;
+}
+
+#define REPETICOES 5
+
+static volatile unsigned sumidouro;
+
+/* Melhor de REPETICOES execuções de expr; o último resultado fica em res */
+#define MELHOR(t, res, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            res = (expr); \
+            double dt_ = agora() - t0_; \
+            sumidouro = res; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void linha(const char* nome, int n, const char* velho, const char* novo, double tv, double tn, unsigned av, unsigned an) {
+    printf("%-5s n %10d  %-11s %8.4fs | %-11s %8.4fs %7.1fx  %s\n",
+           nome, n, velho, tv, novo, tn, tv / tn, av == an ? "ok" : "ERRO");
+}
+
+static unsigned pow_lote(int q, int gerado) {
+    unsigned acc = 0;
+    for (int i = 0; i < q; i++) {
+        long long e = (long long)i * 2654435761u % (1u << 30);
+        acc += gerado ? mathc_mod1000000007_pow(5, e) : pow_var(5, e);
+    }
+    return acc;
+}
+
+static void medir(int n) {
+    double tv, tn;
+    unsigned av, an;
+
+    MELHOR(tv, av, mul_cadeia_var(3, 123456789, n));
+    MELHOR(tn, an, mul_cadeia_mod(3, 123456789, n));
+    linha("mul", n, "% variável", "mod[p]", tv, tn, av, an);
+    MELHOR(tv, av, mul_cadeia_montgomery(3, 123456789, n));
+    linha("mul", n, "Montgomery", "mod[p]", tv, tn, av, an);
+
+    // n / 100 expoentes de 30 bits sobre a mesma base
+    MELHOR(tv, av, pow_lote(n / 100, 0));
+    MELHOR(tn, an, pow_lote(n / 100, 1));
+    linha("pow", n / 100, "% variável", "mod[p]", tv, tn, av, an);
+
+    unsigned* a = malloc(sizeof(unsigned) * (size_t)n);
+    if (!a) { fprintf(stderr, "memória insuficiente\n"); exit(1); }
+    unsigned x = 1;
+    for (int i = 0; i < n; i++) {
+        x = x * 1103515245u + 12345u;
+        a[i] = x % P ? x % P : 1;
+    }
+    MELHOR(tv, av, soma_resto(a, n));
+    MELHOR(tn, an, mathc_mod1000000007_sum(a, n));
+    linha("sum", n, "% por item", "um %", tv, tn, av, an);
+    MELHOR(tv, av, prod_resto(a, n));
+    MELHOR(tn, an, mathc_mod1000000007_prod(a, n));
+    linha("prod", n, "1 acumul.", "8 acumul.", tv, tn, av, an);
+    free(a);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
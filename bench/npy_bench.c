@@ -0,0 +1,153 @@
+/*
+ * Microbenchmarks de load_npy/save_npy no runtime gerado, com um vetor de
+ * doubles em 8 colunas:
+ *   leitura: fread para um bloco novo  x  read_array do mesmo dado em texto
+ *            x  load_npy como vetor  x  load_npy como matriz (mapeamento)
+ *   escrita: fwrite do cabeçalho e dos dados  x  save_npy (um writev),
+ *            sempre num arquivo novo
+ * Cada leitura soma todos os valores, para que as páginas mapeadas sejam de
+ * fato lidas. Usa o C gerado por `mathc bench/npy.mf`.
+ *
+ *   make bench
+ *   build/bench/npy_bench 10000000   # quantidade de valores
+ */
+#define MATHC_BENCH_C "npy.c"
+#include "bench.h"
+
+#define ARQUIVO "/tmp/mathc_npy_bench.npy"
+#define TEXTO "/tmp/mathc_npy_bench.txt"
+#define COLUNAS 8
+
+static double* gerar(int n) {
+    double* v = malloc(sizeof(double) * (size_t)n);
+    unsigned long long x = 88172645463325252ULL;
+    for (int i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        v[i] = (double)(x >> 11) / 9007199254740992.0 * 2000.0 - 1000.0;
+    }
+    return v;
+}
+
+static void gravar_texto(const double* v, int n) {
+    FILE* f = fopen(TEXTO, "w");
+    if (!f) { perror(TEXTO); exit(1); }
+    for (int i = 0; i < n; i++) fprintf(f, "%.17g%c", v[i], i % COLUNAS == COLUNAS - 1 ? '\n' : ' ');
+    fclose(f);
+}
+
+static double somar(const double* v, size_t n) {
+    double s = 0;
+    for (size_t i = 0; i < n; i++) s += v[i];
+    return s;
+}
+
+/* Cabeçalho igual ao de save_npy, escrito com fwrite */
+static int escrever_fwrite(const double* v, int n) {
+    char head[256];
+    size_t hl = mathc_npy_header_text(head, "<f8", 2, n / COLUNAS, COLUNAS);
+    remove(ARQUIVO);
+    FILE* f = fopen(ARQUIVO, "wb");
+    if (!f) { perror(ARQUIVO); exit(1); }
+    fwrite(head, 1, hl, f);
+    fwrite(v, sizeof(double), (size_t)n, f);
+    fclose(f);
+    return 0;
+}
+
+static int escrever_save_npy(mathc_matrix_float* m) {
+    remove(ARQUIVO);
+    mathc_save_npy_matrix_float(ARQUIVO, m);
+    return 0;
+}
+
+static double ler_fread(void) {
+    FILE* f = fopen(ARQUIVO, "rb");
+    char head[10];
+    if (fread(head, 1, 10, f) != 10) exit(1);
+    size_t hl = (unsigned char)head[8] | (size_t)(unsigned char)head[9] << 8;
+    fseek(f, 0, SEEK_END);
+    size_t bytes = (size_t)ftell(f) - 10 - hl;
+    fseek(f, (long)(10 + hl), SEEK_SET);
+    double* v = malloc(bytes);
+    if (fread(v, 1, bytes, f) != bytes) exit(1);
+    fclose(f);
+    double s = somar(v, bytes / sizeof(double));
+    free(v);
+    return s;
+}
+
+static double ler_texto(void) {
+    int n = 0;
+    double* v = mathc_read_array_float(TEXTO, &n);
+    double s = somar(v, (size_t)n);
+    free(v);
+    return s;
+}
+
+static double ler_npy_vetor(void) {
+    int n = 0, cap = 0;
+    double* v = mathc_load_npy_array_float(ARQUIVO, &n, &cap);
+    double s = somar(v, (size_t)n);
+    mathc_npy_release(v);
+    return s;
+}
+
+static double ler_npy_matriz(void) {
+    mathc_matrix_float* m = mathc_load_npy_matrix_float(ARQUIVO);
+    double s = somar(m->data, (size_t)m->rows * m->cols);
+    mathc_npy_release_matrix_float(m);
+    return s;
+}
+
+#define REPETICOES 3
+
+/* Melhor de REPETICOES execuções de expr; o último resultado fica em res */
+#define MELHOR(t, res, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            res = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    n -= n % COLUNAS;
+    double* v = gerar(n);
+    mathc_matrix_float* m = mathc_matrix_raw_float(n / COLUNAS, COLUNAS);
+    memcpy(m->data, v, sizeof(double) * (size_t)n);
+    double esperado = somar(v, (size_t)n);
+
+    double tw, tn;
+    int ok;
+    MELHOR(tw, ok, escrever_fwrite(v, n));
+    MELHOR(tn, ok, escrever_save_npy(m));
+    printf("grava n %10d  fwrite %8.4fs | save_npy %8.4fs %5.1fx\n", n, tw, tn, tw / tn);
+    (void)ok;
+
+    gravar_texto(v, n);
+    double tf, tt, ta, tm, sf, st, sa, sm;
+    MELHOR(tf, sf, ler_fread());
+    MELHOR(tt, st, ler_texto());
+    MELHOR(ta, sa, ler_npy_vetor());
+    MELHOR(tm, sm, ler_npy_matriz());
+    printf("le    n %10d  fread %8.4fs | texto %8.4fs %5.1fx | load_npy vetor %8.4fs %5.1fx | matriz %8.4fs %5.1fx  %s\n",
+           n, tf, tt, tf / tt, ta, tf / ta, tm, tf / tm,
+           sf == esperado && st == esperado && sa == esperado && sm == esperado ? "ok" : "ERRO");
+
+    free(v);
+    free(m);
+    remove(ARQUIVO);
+    remove(TEXTO);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Microbenchmarks dos núcleos de teoria dos números do runtime gerado, cada
+ * um contra a versão direta que ele substitui:
+ *   gcd           binário de Stein (ctz)   x  Euclides com %
+ *   modpow        quadrados sucessivos     x  e multiplicações seguidas
+ *   modinv        Euclides estendido       x  Fermat (a^(p-2) mod p)
+ *   factorize     Pollard-rho (Brent)      x  divisão por tentativa até sqrt(n)
+ *   binomial_mod  tabela de n! e 1/n!      x  produto de k termos e um inverso por consulta
+ * Usa o C gerado por `mathc bench/number_theory.mf`.
+ *
+ *   make bench
+ *   build/bench/number_theory_bench 10000000   # número de consultas
+ */
+#define MATHC_BENCH_C "number_theory.c"
+#include "bench.h"
+
+#define P 1000000007
+
+/* Referências */
+static int gcd_euclides(int a, int b) {
+    if (a < 0) a = -a;
+    if (b < 0) b = -b;
+    while (b) { int t = a % b; a = b; b = t; }
+    return a;
+}
+
+static int modpow_linear(int b, int e, int m) {
+    unsigned long long r = 1 % m;
+    for (int i = 0; i < e; i++) r = r * (unsigned)b % (unsigned)m;
+    return (int)r;
+}
+
+static int modinv_fermat(int a, int p) { return (int)mathc_powmod_u64((unsigned)a, (unsigned)p - 2, (unsigned)p); }
+
+static int factorize_tentativa(int n, int* out) {
+    int len = 0;
+    for (int d = 2; (long long)d * d <= n; d += d == 2 ? 1 : 2)
+        while (n % d == 0) { out[len++] = d; n /= d; }
+    if (n > 1) out[len++] = n;
+    return len;
+}
+
+static int binomial_direto(int n, int k, int p) {
+    if (k < 0 || k > n) return 0;
+    if (k > n - k) k = n - k;
+    unsigned long long num = 1, den = 1;
+    for (int i = 0; i < k; i++) { num = num * (unsigned)(n - i) % p; den = den * (unsigned)(i + 1) % p; }
+    return (int)(num * mathc_powmod_u64(den, p - 2, p) % p);
+}
+
+/* Entradas pseudoaleatórias compartilhadas pelas duas versões */
+static unsigned semente;
+static inline int sorteia(void) { semente = semente * 1103515245u + 12345u; return (int)(semente >> 1); }
+
+#define REPETICOES 5
+
+static volatile long long sumidouro;
+
+/* Melhor de REPETICOES de um laço de q chamadas; acumula os resultados em acc */
+#define MELHOR(t, acc, q, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            semente = 3; acc = 0; \
+            double t0_ = agora(); \
+            for (int i_ = 0; i_ < (q); i_++) acc += (expr); \
+            double dt_ = agora() - t0_; \
+            sumidouro = acc; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void linha(const char* nome, const char* velho, const char* novo, int q, double tv, double tn, long long av, long long an) {
+    printf("%-12s %9d consultas: %-11s %8.4fs | %-11s %8.4fs %7.1fx  %s\n",
+           nome, q, velho, tv, novo, tn, tv / tn, av == an ? "ok" : "ERRO");
+}
+
+static void medir(int q) {
+    double tv, tn;
+    long long av, an;
+
+    MELHOR(tv, av, q, gcd_euclides(sorteia(), sorteia()));
+    MELHOR(tn, an, q, mathc_gcd(sorteia(), sorteia()));
+    linha("gcd", "Euclides", "Stein", q, tv, tn, av, an);
+
+    // Expoentes até 2000: o laço linear ainda termina em tempo razoável
+    MELHOR(tv, av, q / 100, modpow_linear(sorteia(), sorteia() % 2000, P));
+    MELHOR(tn, an, q / 100, mathc_modpow(sorteia(), sorteia() % 2000, P));
+    linha("modpow", "linear", "quadrados", q / 100, tv, tn, av, an);
+
+    MELHOR(tv, av, q, modinv_fermat(sorteia() % (P - 1) + 1, P));
+    MELHOR(tn, an, q, mathc_modinv(sorteia() % (P - 1) + 1, P));
+    linha("modinv", "Fermat", "Euclides", q, tv, tn, av, an);
+
+    int fs[32];
+    MELHOR(tv, av, q / 100, factorize_tentativa(sorteia() | 1, fs));
+    int len;
+    MELHOR(tn, an, q / 100, (free(mathc_factorize(sorteia() | 1, &len)), len));
+    linha("factorize", "tentativa", "rho", q / 100, tv, tn, av, an);
+
+    // n até 10^6, k qualquer: a tabela é montada uma vez na primeira consulta
+    MELHOR(tv, av, q / 100, binomial_direto(sorteia() % 1000000, sorteia() % 1000000, P));
+    MELHOR(tn, an, q / 100, mathc_binomial_mod(sorteia() % 1000000, sorteia() % 1000000, P));
+    linha("binomial_mod", "direto", "tabela", q / 100, tv, tn, av, an);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Microbenchmarks de isprime e primes_up_to: o crivo segmentado em bits e o
+ * Miller-Rabin determinístico do runtime gerado contra a antiga
+ * mathc_isprime, divisão por tentativa até sqrt(n). Mede a contagem de
+ * primos em [0, n) com isprime (o crivo cresce sob demanda), primes_up_to(n),
+ * e consultas espalhadas perto de 2^31, onde o crivo não alcança e cada
+ * consulta é um Miller-Rabin. Usa o C gerado por `mathc bench/primes.mf`.
+ *
+ *   make bench                      # 10^6 e 10^7
+ *   build/bench/primes_bench 100000000
+ */
+#define MATHC_BENCH_C "primes.c"
+#include "bench.h"
+
+/* Referência: o runtime antigo */
+static inline int isprime_antigo(int n) {
+    if (n < 2) return 0;
+    if (n == 2) return 1;
+    if (n % 2 == 0) return 0;
+    int limit = (int)sqrt(n);
+    for (int i = 3; i <= limit; i += 2)
+        if (n % i == 0) return 0;
+    return 1;
+}
+
+/* Descarta o cache para que cada repetição meça também a construção do crivo */
+static void zerar_crivo(void) {
+    free(mathc_sieve.words);
+    mathc_sieve.words = NULL;
+    mathc_sieve.built = 0;
+    mathc_sieve.misses = 0;
+}
+
+static int contar_antigo(int n) {
+    int c = 0;
+    for (int i = 0; i < n; i++) c += isprime_antigo(i);
+    return c;
+}
+
+static int contar_novo(int n) {
+    int c = 0;
+    for (int i = 0; i < n; i++) c += mathc_isprime(i);
+    return c;
+}
+
+static int contar_lista(int n) {
+    int len;
+    free(mathc_primes_up_to(n - 1, &len));
+    return len;
+}
+
+/* q consultas pseudoaleatórias em [2^31 - 2^24, 2^31) */
+static int altos_antigo(int q) {
+    unsigned s = 7; int c = 0;
+    for (int i = 0; i < q; i++) { s = s * 1103515245u + 12345u; c += isprime_antigo(2147483647 - (int)(s >> 8)); }
+    return c;
+}
+
+static int altos_novo(int q) {
+    unsigned s = 7; int c = 0;
+    for (int i = 0; i < q; i++) { s = s * 1103515245u + 12345u; c += mathc_isprime(2147483647 - (int)(s >> 8)); }
+    return c;
+}
+
+#define REPETICOES 5
+
+static volatile int sumidouro;
+
+/* Melhor de REPETICOES, com o crivo refeito do zero a cada vez */
+#define MELHOR(t, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            zerar_crivo(); \
+            double t0_ = agora(); \
+            sumidouro = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    double t_a, t_n, t_l;
+    int ca = contar_antigo(n), cn = contar_novo(n), cl = contar_lista(n);
+    MELHOR(t_a, contar_antigo(n));
+    MELHOR(t_n, contar_novo(n));
+    MELHOR(t_l, contar_lista(n));
+    printf("n %10d  pi(n) %8d  isprime: antiga %8.4fs  nova %8.4fs %6.1fx | primes_up_to %8.4fs %6.1fx  %s\n",
+           n, cn, t_a, t_n, t_a / t_n, t_l, t_a / t_l, ca == cn && cn == cl ? "ok" : "ERRO");
+}
+
+static void medir_altos(int q) {
+    double t_a, t_n;
+    int ca = altos_antigo(q), cn = altos_novo(q);
+    MELHOR(t_a, altos_antigo(q));
+    MELHOR(t_n, altos_novo(q));
+    printf("%d consultas perto de 2^31: antiga %8.4fs  Miller-Rabin %8.4fs %6.1fx  %s\n",
+           q, t_a, t_n, t_a / t_n, ca == cn ? "ok" : "ERRO");
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    medir_altos(100000);
+    return 0;
+}
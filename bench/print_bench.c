@@ -0,0 +1,102 @@
+/*
+ * Microbenchmarks da saída do runtime gerado contra printf, com stdout
+ * redirecionado para /dev/null durante a medição:
+ *   int    printf("%d\n")                  x  mathc_println_int (buffer + pares de dígitos)
+ *   float  printf("%g\n") / printf("%.17g\n")  x  mathc_println_float (menor forma exata)
+ *   str    printf("%s\n")                  x  mathc_println_string
+ * %g perde dígitos (0.1 + 0.2 sai "0.3"); %.17g é o que o printf precisa para
+ * reler o mesmo double, e é a comparação justa para float.
+ * Usa o C gerado por `mathc bench/print.mf`.
+ *
+ *   make bench
+ *   build/bench/print_bench 10000000   # quantidade de valores
+ */
+#define MATHC_BENCH_C "print.c"
+#include "bench.h"
+
+#include <fcntl.h>
+
+static int stdout_salvo = -1;
+
+/* Troca stdout por /dev/null (e volta); os dois buffers são esvaziados antes */
+static void silenciar(int sim) {
+    fflush(stdout);
+    mathc_out_flush();
+    if (sim) {
+        int nulo = open("/dev/null", O_WRONLY);
+        if (nulo < 0) { perror("/dev/null"); exit(1); }
+        stdout_salvo = dup(STDOUT_FILENO);
+        dup2(nulo, STDOUT_FILENO);
+        close(nulo);
+    } else {
+        dup2(stdout_salvo, STDOUT_FILENO);
+        close(stdout_salvo);
+    }
+}
+
+static void ints_printf(const int* a, int n) { for (int i = 0; i < n; i++) printf("%d\n", a[i]); }
+static void ints_mathc(const int* a, int n) { for (int i = 0; i < n; i++) mathc_println_int(a[i]); }
+static void floats_g(const double* a, int n) { for (int i = 0; i < n; i++) printf("%g\n", a[i]); }
+static void floats_17g(const double* a, int n) { for (int i = 0; i < n; i++) printf("%.17g\n", a[i]); }
+static void floats_mathc(const double* a, int n) { for (int i = 0; i < n; i++) mathc_println_float(a[i]); }
+static void strs_printf(int n) { for (int i = 0; i < n; i++) printf("%s\n", "resultado"); }
+static void strs_mathc(int n) { for (int i = 0; i < n; i++) mathc_println_string("resultado"); }
+
+#define REPETICOES 3
+
+/* Melhor de REPETICOES execuções de stmt, com a saída descartada */
+#define MELHOR(t, stmt) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            silenciar(1); \
+            double t0_ = agora(); \
+            stmt; \
+            fflush(stdout); \
+            mathc_out_flush(); \
+            double dt_ = agora() - t0_; \
+            silenciar(0); \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void linha(const char* nome, int n, const char* velho, const char* novo, double tv, double tn) {
+    printf("%-5s n %10d  %-12s %8.4fs | %-12s %8.4fs %7.1fx\n", nome, n, velho, tv, novo, tn, tv / tn);
+}
+
+static void medir(int n) {
+    double tv, tn;
+    int* a = malloc(sizeof(int) * (size_t)n);
+    double* f = malloc(sizeof(double) * (size_t)n);
+    if (!a || !f) { fprintf(stderr, "memória insuficiente\n"); exit(1); }
+    unsigned x = 12345;
+    for (int i = 0; i < n; i++) {
+        x = x * 1103515245u + 12345u;
+        a[i] = (int)x;
+        f[i] = (double)(x >> 8) / 1000.0 - 5000.0;
+    }
+
+    MELHOR(tv, ints_printf(a, n));
+    MELHOR(tn, ints_mathc(a, n));
+    linha("int", n, "printf %d", "println", tv, tn);
+    MELHOR(tv, floats_g(f, n));
+    MELHOR(tn, floats_mathc(f, n));
+    linha("float", n, "printf %g", "println", tv, tn);
+    MELHOR(tv, floats_17g(f, n));
+    linha("float", n, "printf %.17g", "println", tv, tn);
+    MELHOR(tv, strs_printf(n));
+    MELHOR(tn, strs_mathc(n));
+    linha("str", n, "printf %s", "println", tv, tn);
+    fflush(stdout);
+    free(a);
+    free(f);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(5000000);
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Microbenchmarks de sum, mean e variance: o runtime gerado (long long para
+ * int, Kahan com acumuladores SSE2 para float, Welford por blocos em uma
+ * passada) contra as antigas mathc_sum/mathc_variance, laços escalares que
+ * recebiam int* e calculavam a variância em duas passadas. Também mede o
+ * erro da soma de float contra a soma ingênua, com long double como
+ * referência. Usa o C gerado por `mathc bench/reductions.mf`.
+ *
+ *   make bench                              # 10^6 e 10^7 elementos
+ *   build/bench/reductions_bench 100000000  # 10^8 (800 MB em float)
+ */
+#define MATHC_BENCH_C "reductions.c"
+#include "bench.h"
+
+/* Referências: o runtime antigo (só int*), com os laços sequenciais de antes */
+static double sum_antigo(const int* arr, int len) {
+    double s = 0.0;
+    for (int i = 0; i < len; i++) s += arr[i];
+    return s;
+}
+
+static double variance_antiga(const int* arr, int len) {
+    if (len == 0) return 0.0;
+    double m = sum_antigo(arr, len) / len, var = 0.0;
+    for (int i = 0; i < len; i++) { double diff = arr[i] - m; var += diff * diff; }
+    return var / len;
+}
+
+/* As mesmas duas passadas sobre double, para comparar com float[] */
+static double sum_ingenua(const double* arr, int len) {
+    double s = 0.0;
+    for (int i = 0; i < len; i++) s += arr[i];
+    return s;
+}
+
+static double variance_ingenua(const double* arr, int len) {
+    double m = sum_ingenua(arr, len) / len, var = 0.0;
+    for (int i = 0; i < len; i++) { double diff = arr[i] - m; var += diff * diff; }
+    return var / len;
+}
+
+#define REPETICOES 5
+
+static volatile double sumidouro;
+
+/* Melhor de REPETICOES de uma expressão double */
+#define MELHOR(t, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            sumidouro = (expr); \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    int* xs = malloc(sizeof(int) * (size_t)n);
+    double* fs = malloc(sizeof(double) * (size_t)n);
+    if (!xs || !fs) { printf("n %d: memória insuficiente\n", n); free(xs); free(fs); return; }
+    unsigned semente = 11;
+    long double ref = 0.0L;
+    for (int i = 0; i < n; i++) {
+        semente = semente * 1103515245u + 12345u;
+        xs[i] = (int)(semente >> 16) % 1000;
+        fs[i] = 0.1 + (double)(semente >> 8) * 1e-9;
+        ref += fs[i];
+    }
+
+    double t_sa, t_sn, t_va, t_vn, t_fi, t_fk, t_fvi, t_fvn;
+    MELHOR(t_sa, sum_antigo(xs, n));
+    MELHOR(t_sn, mathc_sum_int(xs, n));
+    MELHOR(t_va, variance_antiga(xs, n));
+    MELHOR(t_vn, mathc_variance_int(xs, n));
+    MELHOR(t_fi, sum_ingenua(fs, n));
+    MELHOR(t_fk, mathc_sum_float(fs, n));
+    MELHOR(t_fvi, variance_ingenua(fs, n));
+    MELHOR(t_fvn, mathc_variance_float(fs, n));
+
+    double err_ing = fabs((double)(sum_ingenua(fs, n) - ref) / (double)ref);
+    double err_kahan = fabs((double)(mathc_sum_float(fs, n) - ref) / (double)ref);
+    int ok = sum_antigo(xs, n) == mathc_sum_int(xs, n) &&
+             fabs(variance_antiga(xs, n) - mathc_variance_int(xs, n)) <= 1e-9 * variance_antiga(xs, n);
+    printf("n %9d  int sum: antiga %8.5fs  nova %8.5fs %5.1fx | variance: antiga %8.5fs  nova %8.5fs %5.1fx  %s\n",
+           n, t_sa, t_sn, t_sa / t_sn, t_va, t_vn, t_va / t_vn, ok ? "ok" : "ERRO");
+    printf("            float sum: ingênua %8.5fs  Kahan %8.5fs (erro %.1e vs %.1e) | variance: duas passadas %8.5fs  Welford %8.5fs\n",
+           t_fi, t_fk, err_ing, err_kahan, t_fvi, t_fvn);
+    free(xs); free(fs);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) medir(atoi(argv[i]));
+        return 0;
+    }
+    medir(1000000);
+    medir(10000000);
+    return 0;
+}
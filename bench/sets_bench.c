@@ -0,0 +1,150 @@
+/*
+ * Microbenchmarks da álgebra de conjuntos: união, diferença, interseção e
+ * diferença simétrica por intercalação dos arrays ordenados contra as
+ * antigas set_union/set_difference, que procuravam cada elemento de um lado
+ * no outro por busca linear (O(n·m)). Também compara set[int; 0..N] (bitset,
+ * operações palavra a palavra) com a intercalação da tabela hash no mesmo
+ * domínio. Usa o C gerado por `mathc bench/sets.mf`.
+ *
+ *   make bench                      # tamanhos padrão (até 10^5)
+ *   build/bench/sets_bench 200000   # tamanho específico
+ */
+#define MATHC_BENCH_C "sets.c"
+#include "bench.h"
+
+/* Referências: o runtime antigo guardava o conjunto como um int* sem ordem */
+typedef struct { int* ptr; int len; } set_result_t;
+
+static set_result_t set_union(int* a, int a_len, int* b, int b_len) {
+    int* result = malloc(sizeof(int) * (a_len + b_len));
+    int result_len = 0;
+    for (int i = 0; i < a_len; i++) result[result_len++] = a[i];
+    for (int i = 0; i < b_len; i++) {
+        int found = 0;
+        for (int j = 0; j < a_len; j++)
+            if (b[i] == a[j]) { found = 1; break; }
+        if (!found) result[result_len++] = b[i];
+    }
+    set_result_t r = { result, result_len };
+    return r;
+}
+
+static set_result_t set_difference(int* a, int a_len, int* b, int b_len) {
+    int* result = malloc(sizeof(int) * a_len);
+    int result_len = 0;
+    for (int i = 0; i < a_len; i++) {
+        int found = 0;
+        for (int j = 0; j < b_len; j++)
+            if (a[i] == b[j]) { found = 1; break; }
+        if (!found) result[result_len++] = a[i];
+    }
+    set_result_t r = { result, result_len };
+    return r;
+}
+
+/* n elementos distintos em ordem aleatória: múltiplos de passo embaralhados */
+static mathc_set_int* aleatorio(int n, int passo, unsigned* semente, int** bruto) {
+    int* xs = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) xs[i] = i * passo;
+    for (int i = n - 1; i > 0; i--) {
+        *semente = *semente * 1103515245u + 12345u;
+        int j = (int)(*semente >> 8) % (i + 1), t = xs[i];
+        xs[i] = xs[j]; xs[j] = t;
+    }
+    *bruto = xs;
+    return mathc_set_from_int(xs, n);
+}
+
+#define REPETICOES 5
+
+/* Melhor de REPETICOES de uma operação que devolve um conjunto novo */
+#define MELHOR(t, n_, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            mathc_set_int* s_ = (expr); \
+            double dt_ = agora() - t0_; \
+            n_ = s_->len; \
+            mathc_set_free_int(s_); \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static void medir(int n) {
+    unsigned semente = 13;
+    int *xa, *xb;
+    // a = múltiplos de 2, b = múltiplos de 3: interseção com n/3 elementos
+    mathc_set_int* a = aleatorio(n, 2, &semente, &xa);
+    mathc_set_int* b = aleatorio(n, 3, &semente, &xb);
+
+    double t0 = agora();
+    set_result_t u = set_union(xa, n, xb, n);
+    double t_u_ant = agora() - t0;
+    t0 = agora();
+    set_result_t d = set_difference(xa, n, xb, n);
+    double t_d_ant = agora() - t0;
+
+    double t_u, t_d, t_i, t_s;
+    int len_u, len_d, len_i, len_s;
+    MELHOR(t_u, len_u, mathc_set_union_int(a, b));
+    MELHOR(t_d, len_d, mathc_set_difference_int(a, b));
+    MELHOR(t_i, len_i, mathc_set_intersection_int(a, b));
+    MELHOR(t_s, len_s, mathc_set_symmetric_diff_int(a, b));
+
+    int ok = len_u == u.len && len_d == d.len && len_i == n - d.len && len_s == len_u - len_i;
+    printf("n %7d  union: antiga %9.4fs  merge %8.5fs  %8.1fx | difference: antiga %9.4fs  merge %8.5fs  %8.1fx | "
+           "intersection %8.5fs  symmetric_diff %8.5fs  %s\n",
+           n, t_u_ant, t_u, t_u_ant / t_u, t_d_ant, t_d, t_d_ant / t_d, t_i, t_s, ok ? "ok" : "ERRO");
+    free(u.ptr); free(d.ptr); free(xa); free(xb);
+    mathc_set_free_int(a); mathc_set_free_int(b);
+}
+
+/* Melhor de REPETICOES de uma operação entre bitsets */
+#define MELHOR_BITS(t, n_, expr) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            double t0_ = agora(); \
+            mathc_set_bits* s_ = (expr); \
+            double dt_ = agora() - t0_; \
+            n_ = s_->len; \
+            mathc_set_free_bits(s_); \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+/* Domínio 0..n-1: a = múltiplos de 2, b = múltiplos de 3 nas duas representações */
+static void medir_bits(int n) {
+    mathc_set_int* a = mathc_set_new_int(n / 2 + 1);
+    mathc_set_int* b = mathc_set_new_int(n / 3 + 1);
+    mathc_set_bits* ba = mathc_set_new_bits(n);
+    mathc_set_bits* bb = mathc_set_new_bits(n);
+    for (int x = 0; x < n; x += 2) { mathc_set_add_int(a, x); mathc_set_add_bits(ba, x); }
+    for (int x = 0; x < n; x += 3) { mathc_set_add_int(b, x); mathc_set_add_bits(bb, x); }
+
+    double t_u, t_i, t_bu, t_bi;
+    int len_u, len_i, len_bu, len_bi;
+    MELHOR(t_u, len_u, mathc_set_union_int(a, b));
+    MELHOR(t_i, len_i, mathc_set_intersection_int(a, b));
+    MELHOR_BITS(t_bu, len_bu, mathc_set_union_bits(ba, bb));
+    MELHOR_BITS(t_bi, len_bi, mathc_set_intersection_bits(ba, bb));
+
+    int ok = len_u == len_bu && len_i == len_bi;
+    printf("domínio %7d  union: merge %8.5fs  bitset %8.6fs  %6.1fx | intersection: merge %8.5fs  bitset %8.6fs  %6.1fx  %s\n",
+           n, t_u, t_bu, t_u / t_bu, t_i, t_bi, t_i / t_bi, ok ? "ok" : "ERRO");
+    mathc_set_free_int(a); mathc_set_free_int(b);
+    mathc_set_free_bits(ba); mathc_set_free_bits(bb);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            medir(atoi(argv[i]));
+            medir_bits(atoi(argv[i]));
+        }
+        return 0;
+    }
+    int tamanhos[] = { 1000, 10000, 100000 };
+    for (int i = 0; i < 3; i++) medir(tamanhos[i]);
+    for (int i = 0; i < 3; i++) medir_bits(tamanhos[i]);
+    return 0;
+}
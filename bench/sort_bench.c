@@ -0,0 +1,118 @@
+/*
+ * Microbenchmarks de sort: o runtime gerado (introsort para vetores médios,
+ * radix sort LSD a partir de MATHC_RADIX_MIN elementos por byte de chave)
+ * contra a antiga mathc_sort, que trocava arr[i] e arr[j] para todo par fora
+ * de ordem (O(n²), medida só até 5·10^4 elementos), e contra o qsort da libc.
+ * A partir de MATHC_PAR_SORT_MIN elementos sort divide o trabalho entre
+ * threads; a coluna "seq" é a mesma ordenação numa thread só.
+ * Usa o C gerado por `mathc bench/sort.mf`.
+ *
+ *   make bench                        # tamanhos padrão (até 10^7)
+ *   build/bench/sort_bench 50000000   # tamanho específico
+ *   MATHC_NUM_THREADS=4 build/bench/sort_bench
+ */
+#define MATHC_BENCH_C "sort.c"
+#include "bench.h"
+
+/* Referência: a ordenação por trocas do runtime antigo */
+static void sort_antigo(int* arr, int len) {
+    for (int i = 0; i < len - 1; i++)
+        for (int j = i + 1; j < len; j++)
+            if (arr[j] < arr[i]) { int tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp; }
+}
+
+static int compara_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int compara_float(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+#define REPETICOES 5
+
+/* Melhor de REPETICOES: copia a entrada em trabalho e ordena */
+#define MELHOR(t, trabalho, entrada, n_, chamada) do { \
+        t = 1e30; \
+        for (int r_ = 0; r_ < REPETICOES; r_++) { \
+            memcpy(trabalho, entrada, sizeof(*(entrada)) * (size_t)(n_)); \
+            double t0_ = agora(); \
+            chamada; \
+            double dt_ = agora() - t0_; \
+            if (dt_ < t) t = dt_; \
+        } \
+    } while (0)
+
+static unsigned semente = 7;
+
+static unsigned proximo(void) {
+    semente = semente * 1103515245u + 12345u;
+    return semente >> 1;
+}
+
+static void medir(int n) {
+    int* entrada = malloc(sizeof(int) * n);
+    int* trabalho = malloc(sizeof(int) * n);
+    int* esperado = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) entrada[i] = (int)proximo() - (1 << 30);
+
+    double t_ant = 0.0, t_intro, t_seq, t_radix, t_qsort;
+    if (n <= 50000) {
+        memcpy(trabalho, entrada, sizeof(int) * n);
+        double t0 = agora();
+        sort_antigo(trabalho, n);
+        t_ant = agora() - t0;
+    }
+    MELHOR(t_qsort, esperado, entrada, n, qsort(esperado, n, sizeof(int), compara_int));
+    MELHOR(t_intro, trabalho, entrada, n, mathc_introsort_int(trabalho, n, 2 * 31));
+    int ok = memcmp(trabalho, esperado, sizeof(int) * n) == 0;
+    MELHOR(t_seq, trabalho, entrada, n, mathc_sort_seq_int(trabalho, n));
+    ok = ok && memcmp(trabalho, esperado, sizeof(int) * n) == 0;
+    MELHOR(t_radix, trabalho, entrada, n, mathc_sort_int(trabalho, n));
+    ok = ok && memcmp(trabalho, esperado, sizeof(int) * n) == 0;
+
+    if (t_ant > 0.0)
+        printf("int   n %8d  antiga %9.4fs | introsort %8.5fs  %8.1fx | sort %8.5fs  %8.1fx | qsort %8.5fs  %s\n",
+               n, t_ant, t_intro, t_ant / t_intro, t_radix, t_ant / t_radix, t_qsort, ok ? "ok" : "ERRO");
+    else
+        printf("int   n %8d  introsort %8.5fs | seq %8.5fs | sort %8.5fs  %5.1fx seq | qsort %8.5fs  %5.1fx  %s\n",
+               n, t_intro, t_seq, t_radix, t_seq / t_radix, t_qsort, t_qsort / t_radix, ok ? "ok" : "ERRO");
+    free(entrada); free(trabalho); free(esperado);
+}
+
+static void medir_float(int n) {
+    double* entrada = malloc(sizeof(double) * n);
+    double* trabalho = malloc(sizeof(double) * n);
+    double* esperado = malloc(sizeof(double) * n);
+    for (int i = 0; i < n; i++) entrada[i] = ((double)proximo() - 1e9) / 1e3;
+
+    double t_intro, t_seq, t_radix, t_qsort;
+    MELHOR(t_qsort, esperado, entrada, n, qsort(esperado, n, sizeof(double), compara_float));
+    MELHOR(t_intro, trabalho, entrada, n, mathc_introsort_float(trabalho, n, 2 * 31));
+    int ok = memcmp(trabalho, esperado, sizeof(double) * n) == 0;
+    MELHOR(t_seq, trabalho, entrada, n, mathc_sort_seq_float(trabalho, n));
+    ok = ok && memcmp(trabalho, esperado, sizeof(double) * n) == 0;
+    MELHOR(t_radix, trabalho, entrada, n, mathc_sort_float(trabalho, n));
+    ok = ok && memcmp(trabalho, esperado, sizeof(double) * n) == 0;
+
+    printf("float n %8d  introsort %8.5fs | seq %8.5fs | sort %8.5fs  %5.1fx seq | qsort %8.5fs  %5.1fx  %s\n",
+           n, t_intro, t_seq, t_radix, t_seq / t_radix, t_qsort, t_qsort / t_radix, ok ? "ok" : "ERRO");
+    free(entrada); free(trabalho); free(esperado);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            medir(atoi(argv[i]));
+            medir_float(atoi(argv[i]));
+        }
+        return 0;
+    }
+    printf("threads: %d\n", mathc_num_threads());
+    int tamanhos[] = { 1000, 10000, 50000, 1000000, 10000000 };
+    for (int i = 0; i < 5; i++) medir(tamanhos[i]);
+    for (int i = 0; i < 5; i++) medir_float(tamanhos[i]);
+    return 0;
+}
@@ -4,10 +4,14 @@
 # Define o diretório de output padrão se não estiver definido
 export MATHC_OUTPUT_DIR="${MATHC_OUTPUT_DIR:-build/tests}"
 
+# Opções extras repassadas ao compilador (ex.: MATHC_FLAGS=--emit=structured)
+MATHC_FLAGS="${MATHC_FLAGS:-}"
+
 echo "========================================"
 echo "COMPILADOR DE LINGUAGEM MATEMÁTICA"
 echo "Teste de Validação Final"
 echo "Diretório de output: $MATHC_OUTPUT_DIR"
+[ -n "$MATHC_FLAGS" ] && echo "Opções do compilador: $MATHC_FLAGS"
 echo "========================================"
 echo ""
 
@@ -54,13 +58,17 @@ for test_file in "${TEST_FILES[@]}"; do
     # Arquivo executável esperado
     expected_exe="$MATHC_OUTPUT_DIR/$base_name.out"
 
+    # Entrada padrão do programa: tests/data/<teste>.in, se existir
+    stdin_file="tests/data/$base_name.in"
+    [ -f "$stdin_file" ] || stdin_file=/dev/null
+
     # Usa arquivo temporário para capturar saída exata
     temp_out=$(mktemp)
-    if ./mathc "$test_file" >"$temp_out" 2>&1; then
+    if ./mathc $MATHC_FLAGS "$test_file" >"$temp_out" 2>&1; then
         # Compilador retornou 0 - verifica se executável foi gerado
         if [ -f "$expected_exe" ]; then
             # Executa o programa compilado
-            if "$expected_exe" >>"$temp_out" 2>&1; then
+            if "$expected_exe" <"$stdin_file" >>"$temp_out" 2>&1; then
                 # Programa executou com sucesso
                 echo "✅ PASSOU"
                 ((PASSED++))
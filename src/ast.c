@@ -26,7 +26,7 @@ ASTNode* create_int_literal(int value, int line) {
     node->type = NODE_INT_LITERAL;
     node->line = line;
     node->int_literal.value = value;
-    node->inferred_type = create_type_spec(TYPE_INT, NULL, NULL);
+    node->inferred_type = lattice_type(TYPE_INT);
     return node;
 }
 
@@ -38,6 +38,7 @@ ASTNode* create_float_literal(double value, int line) {
         }
     node->type = NODE_FLOAT_LITERAL;
     node->line = line;
+    node->inferred_type = lattice_type(TYPE_FLOAT);
     node->float_literal.value = value;
     return node;
 }
@@ -50,6 +51,7 @@ ASTNode* create_bool_literal(int value, int line) {
         }
     node->type = NODE_BOOL_LITERAL;
     node->line = line;
+    node->inferred_type = lattice_type(TYPE_BOOL);
     node->bool_literal.value = value;
     return node;
 }
@@ -62,10 +64,24 @@ ASTNode* create_complex_literal(char* value, int line) {
         }
     node->type = NODE_COMPLEX_LITERAL;
     node->line = line;
+    node->inferred_type = lattice_type(TYPE_COMPLEX);
     node->complex_literal.value = strdup(value);
     return node;
 }
 
+ASTNode* create_bigint_literal(char* digits, int line) {
+    ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
+    if (!node) {
+            fprintf(stderr, "ERRO FATAL: Falha ao alocar memória para nó BIGINT_LITERAL\n");
+            exit(EXIT_FAILURE);
+        }
+    node->type = NODE_BIGINT_LITERAL;
+    node->line = line;
+    node->inferred_type = lattice_type(TYPE_BIGINT);
+    node->bigint_literal.digits = strdup(digits);
+    return node;
+}
+
 ASTNode* create_string_literal(char* value, int line) {
     ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
     if (!node) {
@@ -75,7 +91,7 @@ ASTNode* create_string_literal(char* value, int line) {
     node->type = NODE_STRING_LITERAL;
     node->line = line;
     node->string_literal.value = strdup(value);
-    node->inferred_type = create_type_spec(TYPE_STRING, NULL, NULL);
+    node->inferred_type = lattice_type(TYPE_STRING);
     return node;
 }
 
@@ -87,6 +103,7 @@ ASTNode* create_char_literal(char value, int line) {
         }
     node->type = NODE_CHAR_LITERAL;
     node->line = line;
+    node->inferred_type = lattice_type(TYPE_CHAR);
     node->char_literal.value = value;
     return node;
 }
@@ -128,14 +145,7 @@ ASTNode* create_binary_op(OperatorType op, ASTNode* left, ASTNode* right, int li
     node->binary_op.left = left;
     node->binary_op.right = right;
 
-    if (left && left->inferred_type && right && right->inferred_type &&
-        left->inferred_type->base_type == TYPE_INT &&
-        right->inferred_type->base_type == TYPE_INT)
-    {
-        node->inferred_type = create_type_spec(TYPE_INT, NULL, NULL);
-    } else {
-        node->inferred_type = create_type_spec(TYPE_FLOAT, NULL, NULL);
-    }
+    node->inferred_type = infer_node_type(node);
 
     return node;
 }
@@ -150,6 +160,7 @@ ASTNode* create_unary_op(OperatorType op, ASTNode* operand, int line) {
     node->line = line;
     node->unary_op.op = op;
     node->unary_op.operand = operand;
+    node->inferred_type = infer_node_type(node);
     return node;
 }
 
@@ -167,6 +178,7 @@ ASTNode* create_call(ASTNode* function, NodeList* arguments, int line) {
     node->line = line;
     node->call.function = function;
     node->call.arguments = arguments;
+    node->inferred_type = infer_node_type(node);
     return node;
 }
 
@@ -180,6 +192,7 @@ ASTNode* create_array_access(ASTNode* array, ASTNode* index, int line) {
     node->line = line;
     node->array_access.array = array;
     node->array_access.index = index;
+    node->inferred_type = infer_node_type(node);
     return node;
 }
 
@@ -191,6 +204,7 @@ ASTNode* create_member_access(ASTNode* object, char* member, NodeList* args, int
         }
     node->type = NODE_MEMBER_ACCESS;
     node->line = line;
+    node->inferred_type = NULL;
     node->member_access.object = object;
     node->member_access.member = strdup(member);
     node->member_access.args = args;
@@ -209,6 +223,7 @@ ASTNode* create_array_literal(NodeList* elements, int line) {
         }
     node->type = NODE_ARRAY_LITERAL;
     node->line = line;
+    node->inferred_type = NULL;
     node->array_literal.elements = elements;
     return node;
 }
@@ -221,6 +236,7 @@ ASTNode* create_matrix_literal(NodeList* rows, int line) {
         }
     node->type = NODE_MATRIX_LITERAL;
     node->line = line;
+    node->inferred_type = NULL;
     node->matrix_literal.rows = rows;
     return node;
 }
@@ -233,6 +249,7 @@ ASTNode* create_set_literal(NodeList* elements, int line) {
         }
     node->type = NODE_SET_LITERAL;
     node->line = line;
+    node->inferred_type = NULL;
     node->set_literal.elements = elements;
     return node;
 }
@@ -249,6 +266,7 @@ ASTNode* create_declaration(TypeSpec* type, char* name, ASTNode* initializer, in
     }
     node->type = NODE_DECLARATION;
     node->line = line;
+    node->inferred_type = NULL;
     node->declaration.var_type = type;
     node->declaration.name = strdup(name);
     if (!node->declaration.name) {
@@ -269,6 +287,7 @@ ASTNode* create_assignment(ASTNode* target, OperatorType op, ASTNode* value, int
     }
     node->type = NODE_ASSIGNMENT;
     node->line = line;
+    node->inferred_type = NULL;
     node->assignment.target = target;
     node->assignment.op = op;
     node->assignment.value = value;
@@ -284,6 +303,7 @@ ASTNode* create_if_stmt(ASTNode* condition, NodeList* then_block,
     }
     node->type = NODE_IF_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->if_stmt.condition = condition;
     node->if_stmt.then_block = then_block;
     node->if_stmt.elif_parts = elif_parts;
@@ -299,6 +319,7 @@ ASTNode* create_while_stmt(ASTNode* condition, NodeList* body, int line) {
     }
     node->type = NODE_WHILE_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->while_stmt.condition = condition;
     node->while_stmt.body = body;
     return node;
@@ -313,6 +334,7 @@ ASTNode* create_for_stmt(char* iterator, char* index_var,
     }
     node->type = NODE_FOR_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->for_stmt.iterator = strdup(iterator);
     node->for_stmt.index_var = index_var ? strdup(index_var) : NULL;
     node->for_stmt.iterable = iterable;
@@ -328,6 +350,7 @@ ASTNode* create_return_stmt(ASTNode* value, int line) {
     }
     node->type = NODE_RETURN_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->return_stmt.value = value;
     return node;
 }
@@ -340,6 +363,7 @@ ASTNode* create_break_stmt(int line) {
     }
     node->type = NODE_BREAK_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     return node;
 }
 
@@ -351,6 +375,7 @@ ASTNode* create_continue_stmt(int line) {
     }
     node->type = NODE_CONTINUE_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     return node;
 }
 
@@ -362,6 +387,7 @@ ASTNode* create_expr_stmt(ASTNode* expression, int line) {
     }
     node->type = NODE_EXPR_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->expr_stmt.expression = expression;
     return node;
 }
@@ -375,6 +401,7 @@ ASTNode* create_try_stmt(NodeList* try_block, NodeList* catch_clauses,
     }
     node->type = NODE_TRY_STMT;
     node->line = line;
+    node->inferred_type = NULL;
     node->try_stmt.try_block = try_block;
     node->try_stmt.catch_clauses = catch_clauses;
     node->try_stmt.finally_block = finally_block;
@@ -390,6 +417,7 @@ ASTNode* create_catch_clause(TypeSpec* exception_type, char* var_name,
     }
     node->type = NODE_CATCH_CLAUSE;
     node->line = line;
+    node->inferred_type = NULL;
     node->catch_clause.exception_type = exception_type;
     node->catch_clause.var_name = strdup(var_name);
     node->catch_clause.body = body;
@@ -409,10 +437,12 @@ ASTNode* create_function_def(TypeSpec* return_type, char* name,
     }
     node->type = NODE_FUNCTION_DEF;
     node->line = line;
+    node->inferred_type = NULL;
     node->function_def.return_type = return_type;
     node->function_def.name = strdup(name);
     node->function_def.parameters = parameters;
     node->function_def.body = body;
+    node->function_def.is_inline = 0;  /* Default: sem anotação inline */
     return node;
 }
 
@@ -424,6 +454,7 @@ ASTNode* create_type_def(char* name, NodeList* members, int line) {
     }
     node->type = NODE_TYPE_DEF;
     node->line = line;
+    node->inferred_type = NULL;
     node->type_def.name = strdup(name);
     node->type_def.members = members;
     return node;
@@ -437,6 +468,7 @@ ASTNode* create_import(char* module_name, int line) {
     }
     node->type = NODE_IMPORT;
     node->line = line;
+    node->inferred_type = NULL;
     node->import.module_name = strdup(module_name);
     return node;
 }
@@ -454,6 +486,7 @@ ASTNode* create_program(NodeList* imports, NodeList* definitions,
     }
     node->type = NODE_PROGRAM;
     node->line = line;
+    node->inferred_type = NULL;
     node->program.imports = imports;
     node->program.definitions = definitions;
     node->program.main_function = main_function;
@@ -473,6 +506,8 @@ TypeSpec* create_type_spec(DataType base_type, TypeSpec* element_type, char* typ
     spec->base_type = base_type;
     spec->element_type = element_type;
     spec->type_name = type_name ? strdup(type_name) : NULL;
+    spec->domain_max = -1;
+    spec->modulus = 0;
     return spec;
 }
 
@@ -509,6 +544,7 @@ char* node_type_to_string(NodeType type) {
         case NODE_FLOAT_LITERAL: return "FLOAT_LITERAL";
         case NODE_BOOL_LITERAL: return "BOOL_LITERAL";
         case NODE_COMPLEX_LITERAL: return "COMPLEX_LITERAL";
+        case NODE_BIGINT_LITERAL: return "BIGINT_LITERAL";
         case NODE_STRING_LITERAL: return "STRING_LITERAL";
         case NODE_CHAR_LITERAL: return "CHAR_LITERAL";
         case NODE_IDENTIFIER: return "IDENTIFIER";
@@ -547,6 +583,8 @@ char* data_type_to_string(DataType type) {
         case TYPE_COMPLEX: return "complex";
         case TYPE_CHAR: return "char";
         case TYPE_STRING: return "string";
+        case TYPE_BIGINT: return "bigint";
+        case TYPE_MOD: return "mod";
         case TYPE_VOID: return "void";
         case TYPE_ARRAY: return "array";
         case TYPE_MATRIX: return "matrix";
@@ -595,6 +633,8 @@ void print_type_spec(TypeSpec* type, int indent) {
 
     print_indent(indent);
     printf("(TYPE %s", data_type_to_string(type->base_type));
+    if (type->domain_max >= 0) printf(" 0..%d", type->domain_max);
+    if (type->modulus > 0) printf(" %d", type->modulus);
 
     if (type->element_type) {
         printf("\n");
@@ -652,6 +692,10 @@ void print_ast(ASTNode* node, int indent) {
             printf("(COMPLEX %s)\n", node->complex_literal.value);
             break;
 
+        case NODE_BIGINT_LITERAL:
+            printf("(BIGINT %s)\n", node->bigint_literal.digits);
+            break;
+
         case NODE_STRING_LITERAL:
             printf("(STRING \"%s\")\n", node->string_literal.value);
             break;
@@ -935,7 +979,8 @@ void print_ast(ASTNode* node, int indent) {
         /* DEFINIÇÕES */
         /* ================================================================ */
         case NODE_FUNCTION_DEF:
-            printf("(FUNCTION %s\n", node->function_def.name);
+            printf("(FUNCTION %s%s\n", node->function_def.name,
+                   node->function_def.is_inline ? " inline" : "");
 
             print_indent(indent + 1);
             printf("(RETURN_TYPE\n");
@@ -1074,6 +1119,10 @@ void free_ast(ASTNode* node) {
             }
             break;
 
+        case NODE_BIGINT_LITERAL:
+            free(node->bigint_literal.digits);
+            break;
+
         case NODE_STRING_LITERAL:
             if (node->string_literal.value != NULL) {
                 free(node->string_literal.value);
@@ -1465,4 +1514,509 @@ int count_ast_nodes(ASTNode* node) {
     }
 
     return count;
-}
\ No newline at end of file
+}
+/* ========================================================================== */
+/* CÓPIA PROFUNDA DA AST */
+/* ========================================================================== */
+
+TypeSpec* copy_type_spec(TypeSpec* spec) {
+    if (spec == NULL) return NULL;
+    TypeSpec* copy = create_type_spec(spec->base_type, copy_type_spec(spec->element_type), spec->type_name);
+    copy->domain_max = spec->domain_max;
+    copy->modulus = spec->modulus;
+    return copy;
+}
+
+NodeList* copy_node_list(NodeList* list) {
+    NodeList* head = NULL;
+    NodeList** tail = &head;
+    while (list) {
+        *tail = create_node_list(copy_ast(list->node), NULL);
+        tail = &(*tail)->next;
+        list = list->next;
+    }
+    return head;
+}
+
+static ParamList* copy_param_list(ParamList* list) {
+    if (list == NULL) return NULL;
+    return create_param_list(copy_type_spec(list->type), list->name, copy_param_list(list->next));
+}
+
+/* inferred_type é compartilhado (pertence à tabela de símbolos ou não é liberado por free_ast) */
+ASTNode* copy_ast(ASTNode* node) {
+    if (node == NULL) return NULL;
+
+    ASTNode* copy = (ASTNode*)malloc(sizeof(ASTNode));
+    if (!copy) {
+        fprintf(stderr, "ERRO FATAL: Falha ao alocar memória para cópia de nó\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, node, sizeof(ASTNode));
+
+    switch (node->type) {
+        case NODE_COMPLEX_LITERAL:
+            copy->complex_literal.value = strdup(node->complex_literal.value);
+            break;
+        case NODE_BIGINT_LITERAL:
+            copy->bigint_literal.digits = strdup(node->bigint_literal.digits);
+            break;
+        case NODE_STRING_LITERAL:
+            copy->string_literal.value = strdup(node->string_literal.value);
+            break;
+        case NODE_IDENTIFIER:
+            copy->identifier.name = strdup(node->identifier.name);
+            break;
+        case NODE_BINARY_OP:
+            copy->binary_op.left = copy_ast(node->binary_op.left);
+            copy->binary_op.right = copy_ast(node->binary_op.right);
+            break;
+        case NODE_UNARY_OP:
+            copy->unary_op.operand = copy_ast(node->unary_op.operand);
+            break;
+        case NODE_CALL:
+            copy->call.function = copy_ast(node->call.function);
+            copy->call.arguments = copy_node_list(node->call.arguments);
+            break;
+        case NODE_ARRAY_ACCESS:
+            copy->array_access.array = copy_ast(node->array_access.array);
+            copy->array_access.index = copy_ast(node->array_access.index);
+            break;
+        case NODE_MEMBER_ACCESS:
+            copy->member_access.object = copy_ast(node->member_access.object);
+            copy->member_access.member = strdup(node->member_access.member);
+            copy->member_access.args = copy_node_list(node->member_access.args);
+            break;
+        case NODE_ARRAY_LITERAL:
+            copy->array_literal.elements = copy_node_list(node->array_literal.elements);
+            break;
+        case NODE_MATRIX_LITERAL:
+            copy->matrix_literal.rows = copy_node_list(node->matrix_literal.rows);
+            break;
+        case NODE_SET_LITERAL:
+            copy->set_literal.elements = copy_node_list(node->set_literal.elements);
+            break;
+        case NODE_DECLARATION:
+            copy->declaration.var_type = copy_type_spec(node->declaration.var_type);
+            copy->declaration.name = strdup(node->declaration.name);
+            copy->declaration.initializer = copy_ast(node->declaration.initializer);
+            break;
+        case NODE_ASSIGNMENT:
+            copy->assignment.target = copy_ast(node->assignment.target);
+            copy->assignment.value = copy_ast(node->assignment.value);
+            break;
+        case NODE_IF_STMT:
+            copy->if_stmt.condition = copy_ast(node->if_stmt.condition);
+            copy->if_stmt.then_block = copy_node_list(node->if_stmt.then_block);
+            copy->if_stmt.elif_parts = copy_node_list(node->if_stmt.elif_parts);
+            copy->if_stmt.else_block = copy_node_list(node->if_stmt.else_block);
+            break;
+        case NODE_WHILE_STMT:
+            copy->while_stmt.condition = copy_ast(node->while_stmt.condition);
+            copy->while_stmt.body = copy_node_list(node->while_stmt.body);
+            break;
+        case NODE_FOR_STMT:
+            copy->for_stmt.iterator = strdup(node->for_stmt.iterator);
+            copy->for_stmt.index_var = node->for_stmt.index_var ? strdup(node->for_stmt.index_var) : NULL;
+            copy->for_stmt.iterable = copy_ast(node->for_stmt.iterable);
+            copy->for_stmt.body = copy_node_list(node->for_stmt.body);
+            break;
+        case NODE_RETURN_STMT:
+            copy->return_stmt.value = copy_ast(node->return_stmt.value);
+            break;
+        case NODE_EXPR_STMT:
+            copy->expr_stmt.expression = copy_ast(node->expr_stmt.expression);
+            break;
+        case NODE_TRY_STMT:
+            copy->try_stmt.try_block = copy_node_list(node->try_stmt.try_block);
+            copy->try_stmt.catch_clauses = copy_node_list(node->try_stmt.catch_clauses);
+            copy->try_stmt.finally_block = copy_node_list(node->try_stmt.finally_block);
+            break;
+        case NODE_CATCH_CLAUSE:
+            copy->catch_clause.exception_type = copy_type_spec(node->catch_clause.exception_type);
+            copy->catch_clause.var_name = strdup(node->catch_clause.var_name);
+            copy->catch_clause.body = copy_node_list(node->catch_clause.body);
+            break;
+        case NODE_FUNCTION_DEF:
+            copy->function_def.return_type = copy_type_spec(node->function_def.return_type);
+            copy->function_def.name = strdup(node->function_def.name);
+            copy->function_def.parameters = copy_param_list(node->function_def.parameters);
+            copy->function_def.body = copy_node_list(node->function_def.body);
+            break;
+        case NODE_TYPE_DEF:
+            copy->type_def.name = strdup(node->type_def.name);
+            copy->type_def.members = copy_node_list(node->type_def.members);
+            break;
+        case NODE_IMPORT:
+            copy->import.module_name = strdup(node->import.module_name);
+            break;
+        case NODE_PROGRAM:
+            copy->program.imports = copy_node_list(node->program.imports);
+            copy->program.definitions = copy_node_list(node->program.definitions);
+            copy->program.main_function = copy_ast(node->program.main_function);
+            break;
+        default:
+            // Literais primitivos e break/continue não têm filhos
+            break;
+    }
+
+    return copy;
+}
+
+/* ========================================================================== */
+/* PERCURSO GENÉRICO DA AST */
+/* ========================================================================== */
+
+void ast_walk_list(NodeList* list, int (*visit)(ASTNode* node, void* data), void* data) {
+    while (list) {
+        ast_walk(list->node, visit, data);
+        list = list->next;
+    }
+}
+
+void ast_walk(ASTNode* node, int (*visit)(ASTNode* node, void* data), void* data) {
+    if (node == NULL) return;
+    if (visit(node, data)) return;
+
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            ast_walk(node->binary_op.left, visit, data);
+            ast_walk(node->binary_op.right, visit, data);
+            break;
+        case NODE_UNARY_OP:
+            ast_walk(node->unary_op.operand, visit, data);
+            break;
+        case NODE_CALL:
+            ast_walk(node->call.function, visit, data);
+            ast_walk_list(node->call.arguments, visit, data);
+            break;
+        case NODE_ARRAY_ACCESS:
+            ast_walk(node->array_access.array, visit, data);
+            ast_walk(node->array_access.index, visit, data);
+            break;
+        case NODE_MEMBER_ACCESS:
+            ast_walk(node->member_access.object, visit, data);
+            ast_walk_list(node->member_access.args, visit, data);
+            break;
+        case NODE_ARRAY_LITERAL:
+            ast_walk_list(node->array_literal.elements, visit, data);
+            break;
+        case NODE_MATRIX_LITERAL:
+            ast_walk_list(node->matrix_literal.rows, visit, data);
+            break;
+        case NODE_SET_LITERAL:
+            ast_walk_list(node->set_literal.elements, visit, data);
+            break;
+        case NODE_DECLARATION:
+            ast_walk(node->declaration.initializer, visit, data);
+            break;
+        case NODE_ASSIGNMENT:
+            ast_walk(node->assignment.target, visit, data);
+            ast_walk(node->assignment.value, visit, data);
+            break;
+        case NODE_IF_STMT:
+            ast_walk(node->if_stmt.condition, visit, data);
+            ast_walk_list(node->if_stmt.then_block, visit, data);
+            ast_walk_list(node->if_stmt.elif_parts, visit, data);
+            ast_walk_list(node->if_stmt.else_block, visit, data);
+            break;
+        case NODE_WHILE_STMT:
+            ast_walk(node->while_stmt.condition, visit, data);
+            ast_walk_list(node->while_stmt.body, visit, data);
+            break;
+        case NODE_FOR_STMT:
+            ast_walk(node->for_stmt.iterable, visit, data);
+            ast_walk_list(node->for_stmt.body, visit, data);
+            break;
+        case NODE_RETURN_STMT:
+            ast_walk(node->return_stmt.value, visit, data);
+            break;
+        case NODE_EXPR_STMT:
+            ast_walk(node->expr_stmt.expression, visit, data);
+            break;
+        case NODE_TRY_STMT:
+            ast_walk_list(node->try_stmt.try_block, visit, data);
+            ast_walk_list(node->try_stmt.catch_clauses, visit, data);
+            ast_walk_list(node->try_stmt.finally_block, visit, data);
+            break;
+        case NODE_CATCH_CLAUSE:
+            ast_walk_list(node->catch_clause.body, visit, data);
+            break;
+        case NODE_FUNCTION_DEF:
+            ast_walk_list(node->function_def.body, visit, data);
+            break;
+        case NODE_TYPE_DEF:
+            ast_walk_list(node->type_def.members, visit, data);
+            break;
+        case NODE_PROGRAM:
+            ast_walk_list(node->program.imports, visit, data);
+            ast_walk_list(node->program.definitions, visit, data);
+            ast_walk(node->program.main_function, visit, data);
+            break;
+        default:
+            break;
+    }
+}
+
+/* ========================================================================== */
+/* INFERÊNCIA DE TIPOS */
+/* ========================================================================== */
+/*
+ * Reticulado numérico: bool < char < int < bigint < float < complex. Operações
+ * aritméticas resultam no supremo dos operandos, promovido ao menos a int
+ * (como em C); comparações, operadores lógicos e `in` resultam em bool.
+ * Chamadas usam o tipo de retorno registrado na tabela de símbolos (built-ins
+ * registrados em main.c ou funções do usuário). NULL significa desconhecido.
+ *
+ * Os TypeSpec primitivos devolvidos por lattice_type são compartilhados e,
+ * como os demais inferred_type, nunca são liberados por free_ast.
+ */
+
+static const DataType lattice_order[] = { TYPE_BOOL, TYPE_CHAR, TYPE_INT, TYPE_BIGINT, TYPE_FLOAT, TYPE_COMPLEX };
+#define LATTICE_INT_RANK 2
+
+TypeSpec* lattice_type(DataType base) {
+    static TypeSpec* cache[TYPE_CUSTOM + 1];
+    if ((int)base < 0 || base > TYPE_CUSTOM) return NULL;
+    if (!cache[base]) cache[base] = create_type_spec(base, NULL, NULL);
+    return cache[base];
+}
+
+static int lattice_rank(TypeSpec* t) {
+    if (!t || t->type_name) return -1;
+    switch (t->base_type) {
+        case TYPE_BOOL: return 0;
+        case TYPE_CHAR: return 1;
+        case TYPE_INT: return 2;
+        case TYPE_BIGINT: return 3;
+        case TYPE_FLOAT: return 4;
+        case TYPE_COMPLEX: return 5;
+        default: return -1;
+    }
+}
+
+TypeSpec* type_join(TypeSpec* a, TypeSpec* b) {
+    int ra = lattice_rank(a);
+    int rb = lattice_rank(b);
+    if (ra < 0 || rb < 0) return NULL;
+    return lattice_type(lattice_order[ra > rb ? ra : rb]);
+}
+
+/* Promoção aritmética: bool e char operam como int */
+static TypeSpec* arithmetic_type(TypeSpec* t) {
+    int r = lattice_rank(t);
+    if (r < 0) return NULL;
+    return lattice_type(lattice_order[r < LATTICE_INT_RANK ? LATTICE_INT_RANK : r]);
+}
+
+static int is_base_type(TypeSpec* t, DataType base) {
+    return t && t->base_type == base;
+}
+
+/* A @ B é matriz; A @ v (v vetor) é um vetor com o tipo de elemento de A */
+static TypeSpec* matmul_type(TypeSpec* l, TypeSpec* r) {
+    int r_is_vector = r && r->base_type == TYPE_ARRAY &&
+                      !(r->element_type && r->element_type->base_type == TYPE_ARRAY);
+    if (!l || !r_is_vector) return l;
+    TypeSpec* elem = l->base_type == TYPE_MATRIX ? l->element_type :
+                     (l->element_type ? l->element_type->element_type : NULL);
+    return create_type_spec(TYPE_ARRAY, elem, NULL);
+}
+
+/* transpose/trace/determinant dependem da matriz recebida; zeros/ones/identity, input_matrix e read_matrix/read_csv são matrix[float] */
+static TypeSpec* matrix_builtin_type(const char* name, NodeList* args) {
+    TypeSpec* m = args && args->node ? args->node->inferred_type : NULL;
+    TypeSpec* elem = NULL;
+    if (m && m->base_type == TYPE_MATRIX) elem = m->element_type;
+    else if (m && m->base_type == TYPE_ARRAY && m->element_type && m->element_type->base_type == TYPE_ARRAY)
+        elem = m->element_type->element_type;
+
+    if (strcmp(name, "transpose") == 0) return elem ? m : NULL;
+    if (strcmp(name, "trace") == 0) return elem;
+    if (strcmp(name, "determinant") == 0) {
+        // Matrizes de inteiros têm determinante inteiro exato (Bareiss no runtime)
+        if (is_base_type(elem, TYPE_INT) || is_base_type(elem, TYPE_CHAR)) return lattice_type(TYPE_INT);
+        return lattice_type(is_base_type(elem, TYPE_COMPLEX) ? TYPE_COMPLEX : TYPE_FLOAT);
+    }
+    if (strcmp(name, "zeros") == 0 || strcmp(name, "ones") == 0 || strcmp(name, "identity") == 0 ||
+        strcmp(name, "input_matrix") == 0 || strcmp(name, "read_matrix") == 0 || strcmp(name, "read_csv") == 0)
+        return create_type_spec(TYPE_MATRIX, lattice_type(TYPE_FLOAT), NULL);
+    // Sem contexto input_array(n) lê int[], read_array(arquivo) e load_npy(arquivo) float[]; numa declaração adotam o tipo da variável
+    if (strcmp(name, "input_array") == 0) return create_type_spec(TYPE_ARRAY, lattice_type(TYPE_INT), NULL);
+    if (strcmp(name, "read_array") == 0 || strcmp(name, "load_npy") == 0) return create_type_spec(TYPE_ARRAY, lattice_type(TYPE_FLOAT), NULL);
+    return NULL;
+}
+
+/* Operações entre conjuntos devolvem um conjunto do tipo do primeiro argumento */
+static TypeSpec* set_builtin_type(const char* name, NodeList* args) {
+    TypeSpec* a = args && args->node ? args->node->inferred_type : NULL;
+    if (strcmp(name, "union") == 0 || strcmp(name, "difference") == 0 ||
+        strcmp(name, "intersection") == 0 || strcmp(name, "symmetric_diff") == 0)
+        return is_base_type(a, TYPE_SET) ? a : NULL;
+    if (strcmp(name, "is_subset") == 0 || strcmp(name, "is_superset") == 0) return lattice_type(TYPE_BOOL);
+    return NULL;
+}
+
+/* sum/mean/prod de complex[] são complex; variance/std são float */
+static TypeSpec* stats_builtin_type(const char* name, NodeList* args) {
+    TypeSpec* a = args && args->node ? args->node->inferred_type : NULL;
+    int is_complex = a && a->base_type == TYPE_ARRAY && is_base_type(a->element_type, TYPE_COMPLEX);
+    // sum/prod de mod[p][] continuam em mod[p]
+    if (a && a->base_type == TYPE_ARRAY && is_base_type(a->element_type, TYPE_MOD) &&
+        (strcmp(name, "sum") == 0 || strcmp(name, "prod") == 0))
+        return a->element_type;
+    if (strcmp(name, "sum") == 0 || strcmp(name, "mean") == 0 || strcmp(name, "prod") == 0)
+        return lattice_type(is_complex ? TYPE_COMPLEX : TYPE_FLOAT);
+    if (strcmp(name, "variance") == 0 || strcmp(name, "std") == 0) return lattice_type(TYPE_FLOAT);
+    // min_element/max_element devolvem o tipo do elemento
+    if ((strcmp(name, "min_element") == 0 || strcmp(name, "max_element") == 0) && is_base_type(a, TYPE_ARRAY))
+        return a->element_type;
+    return NULL;
+}
+
+TypeSpec* infer_node_type(ASTNode* node) {
+    if (!node) return NULL;
+
+    switch (node->type) {
+        case NODE_INT_LITERAL: return lattice_type(TYPE_INT);
+        case NODE_FLOAT_LITERAL: return lattice_type(TYPE_FLOAT);
+        case NODE_BOOL_LITERAL: return lattice_type(TYPE_BOOL);
+        case NODE_CHAR_LITERAL: return lattice_type(TYPE_CHAR);
+        case NODE_COMPLEX_LITERAL: return lattice_type(TYPE_COMPLEX);
+        case NODE_BIGINT_LITERAL: return lattice_type(TYPE_BIGINT);
+        case NODE_STRING_LITERAL: return lattice_type(TYPE_STRING);
+
+        case NODE_IDENTIFIER:
+            // Resolvido na tabela de símbolos durante a análise sintática (respeita escopos)
+            return node->inferred_type;
+
+        case NODE_BINARY_OP: {
+            TypeSpec* l = node->binary_op.left ? node->binary_op.left->inferred_type : NULL;
+            TypeSpec* r = node->binary_op.right ? node->binary_op.right->inferred_type : NULL;
+            switch (node->binary_op.op) {
+                case OP_EQ: case OP_NEQ: case OP_LT: case OP_GT: case OP_LE: case OP_GE:
+                case OP_AND: case OP_OR: case OP_IN:
+                    return lattice_type(TYPE_BOOL);
+                case OP_MATMUL:
+                    return matmul_type(l, r);
+                default:
+                    break;
+            }
+            if (is_base_type(l, TYPE_SET)) return l;
+            if (is_base_type(r, TYPE_SET)) return r;
+            // mod[p] absorve o inteiro do outro lado
+            if (is_base_type(l, TYPE_MOD)) return l;
+            if (is_base_type(r, TYPE_MOD)) return r;
+            TypeSpec* t = arithmetic_type(type_join(l, r));
+            // int ^ int só é int com expoente literal não negativo; senão segue em float (pow), como 2 ^ -1 == 0.5
+            if (node->binary_op.op == OP_POWER && is_base_type(t, TYPE_INT) &&
+                !(node->binary_op.right && node->binary_op.right->type == NODE_INT_LITERAL &&
+                  node->binary_op.right->int_literal.value >= 0))
+                return lattice_type(TYPE_FLOAT);
+            return t;
+        }
+
+        case NODE_UNARY_OP: {
+            TypeSpec* t = node->unary_op.operand ? node->unary_op.operand->inferred_type : NULL;
+            switch (node->unary_op.op) {
+                case OP_NOT: return lattice_type(TYPE_BOOL);
+                case OP_UNARY_MINUS:
+                case OP_UNARY_PLUS: return is_base_type(t, TYPE_MOD) ? t : arithmetic_type(t);
+                default: return t;
+            }
+        }
+
+        case NODE_CALL: {
+            // O identificador da função carrega o tipo de retorno registrado
+            ASTNode* f = node->call.function;
+            if (f && f->type == NODE_IDENTIFIER && strcmp(f->identifier.name, "matmul") == 0 &&
+                node->call.arguments && node->call.arguments->next) {
+                return matmul_type(node->call.arguments->node->inferred_type,
+                                   node->call.arguments->next->node->inferred_type);
+            }
+            if (f && f->type == NODE_IDENTIFIER) {
+                TypeSpec* t = matrix_builtin_type(f->identifier.name, node->call.arguments);
+                if (!t) t = set_builtin_type(f->identifier.name, node->call.arguments);
+                if (!t) t = stats_builtin_type(f->identifier.name, node->call.arguments);
+                if (t) return t;
+            }
+            if (f && f->type == NODE_IDENTIFIER && f->inferred_type &&
+                f->inferred_type->base_type != TYPE_VOID) {
+                return f->inferred_type;
+            }
+            return NULL;
+        }
+
+        case NODE_ARRAY_ACCESS: {
+            TypeSpec* t = node->array_access.array ? node->array_access.array->inferred_type : NULL;
+            if (!t) return NULL;
+            if (t->base_type == TYPE_ARRAY) return t->element_type;
+            if (t->base_type == TYPE_STRING) return lattice_type(TYPE_CHAR);
+            if (t->base_type == TYPE_MATRIX) {
+                // m[i] é uma linha; m[i][j] chega ao tipo do elemento pelo caso TYPE_ARRAY
+                return create_type_spec(TYPE_ARRAY, t->element_type, NULL);
+            }
+            return NULL;
+        }
+
+        default:
+            return node->inferred_type;
+    }
+}
+
+static void infer_expression(ASTNode* node) {
+    if (!node) return;
+    NodeList* it = NULL;
+
+    switch (node->type) {
+        case NODE_BINARY_OP:
+            infer_expression(node->binary_op.left);
+            infer_expression(node->binary_op.right);
+            break;
+        case NODE_UNARY_OP:
+            infer_expression(node->unary_op.operand);
+            break;
+        case NODE_CALL:
+            infer_expression(node->call.function);
+            for (it = node->call.arguments; it; it = it->next) infer_expression(it->node);
+            break;
+        case NODE_ARRAY_ACCESS:
+            infer_expression(node->array_access.array);
+            infer_expression(node->array_access.index);
+            break;
+        case NODE_MEMBER_ACCESS:
+            infer_expression(node->member_access.object);
+            for (it = node->member_access.args; it; it = it->next) infer_expression(it->node);
+            return;
+        case NODE_ARRAY_LITERAL:
+            for (it = node->array_literal.elements; it; it = it->next) infer_expression(it->node);
+            return;
+        case NODE_SET_LITERAL:
+            for (it = node->set_literal.elements; it; it = it->next) infer_expression(it->node);
+            return;
+        case NODE_MATRIX_LITERAL:
+            for (it = node->matrix_literal.rows; it; it = it->next) infer_expression(it->node);
+            return;
+        default:
+            break;
+    }
+    node->inferred_type = infer_node_type(node);
+}
+
+static int visit_infer(ASTNode* node, void* data) {
+    (void)data;
+    switch (node->type) {
+        case NODE_BINARY_OP: case NODE_UNARY_OP: case NODE_CALL:
+        case NODE_ARRAY_ACCESS: case NODE_MEMBER_ACCESS:
+        case NODE_ARRAY_LITERAL: case NODE_SET_LITERAL: case NODE_MATRIX_LITERAL:
+            infer_expression(node);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Recalcula de baixo para cima o tipo de todas as expressões do programa */
+void infer_types(ASTNode* root) {
+    ast_walk(root, visit_infer, NULL);
+}
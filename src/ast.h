@@ -7,7 +7,7 @@
 
 typedef enum {
     TYPE_INT, TYPE_FLOAT, TYPE_BOOL, TYPE_COMPLEX, TYPE_CHAR,
-    TYPE_STRING, TYPE_VOID, TYPE_UNDEFINED, TYPE_ARRAY, TYPE_MATRIX, TYPE_SET,
+    TYPE_STRING, TYPE_BIGINT, TYPE_MOD, TYPE_VOID, TYPE_UNDEFINED, TYPE_ARRAY, TYPE_MATRIX, TYPE_SET,
     TYPE_GRAPH, TYPE_CUSTOM
 } DataType;
 
@@ -21,7 +21,7 @@ typedef enum {
 
 typedef enum {
     NODE_INT_LITERAL, NODE_FLOAT_LITERAL, NODE_BOOL_LITERAL,
-    NODE_COMPLEX_LITERAL, NODE_STRING_LITERAL, NODE_CHAR_LITERAL,
+    NODE_COMPLEX_LITERAL, NODE_STRING_LITERAL, NODE_CHAR_LITERAL, NODE_BIGINT_LITERAL,
     NODE_IDENTIFIER, NODE_BINARY_OP, NODE_UNARY_OP, NODE_CALL,
     NODE_ARRAY_ACCESS, NODE_MEMBER_ACCESS, NODE_ARRAY_LITERAL,
     NODE_MATRIX_LITERAL, NODE_SET_LITERAL, NODE_DECLARATION,
@@ -36,6 +36,8 @@ typedef struct TypeSpec {
     DataType base_type;
     struct TypeSpec* element_type;
     char* type_name;
+    int domain_max;  // set[int; 0..N]: N (representado como bitset); -1 = sem limite
+    int modulus;     // mod[p]: p (2 <= p < 2^31); 0 nos demais tipos
 } TypeSpec;
 
 typedef struct NodeList {
@@ -60,6 +62,7 @@ typedef struct ASTNode {
         struct { double value; } float_literal;
         struct { int value; } bool_literal;
         struct { char* value; } complex_literal;
+        struct { char* digits; } bigint_literal;  // inteiro maior que INT_MAX, em decimal
         struct { char* value; } string_literal;
         struct { char value; } char_literal;
         struct { char* name; } identifier;
@@ -152,6 +155,7 @@ typedef struct ASTNode {
             char* name;
             ParamList* parameters;
             NodeList* body;
+            int is_inline;
         } function_def;
 
         struct {
@@ -176,6 +180,7 @@ ASTNode* create_int_literal(int value, int line);
 ASTNode* create_float_literal(double value, int line);
 ASTNode* create_bool_literal(int value, int line);
 ASTNode* create_complex_literal(char* value, int line);
+ASTNode* create_bigint_literal(char* digits, int line);
 ASTNode* create_string_literal(char* value, int line);
 ASTNode* create_char_literal(char value, int line);
 ASTNode* create_identifier(char* name, int line);
@@ -220,6 +225,21 @@ void free_node_list(NodeList* list);
 void free_param_list(ParamList* list);
 void free_type_spec(TypeSpec* spec);
 
+/* Cópia profunda (usada pelas transformações da AST) */
+ASTNode* copy_ast(ASTNode* node);
+NodeList* copy_node_list(NodeList* list);
+TypeSpec* copy_type_spec(TypeSpec* spec);
+
+/* Percorre a AST em pré-ordem; se visit retornar != 0 os filhos do nó são ignorados */
+void ast_walk(ASTNode* node, int (*visit)(ASTNode* node, void* data), void* data);
+void ast_walk_list(NodeList* list, int (*visit)(ASTNode* node, void* data), void* data);
+
+/* Inferência de tipos (reticulado bool < char < int < float < complex) */
+TypeSpec* lattice_type(DataType base);
+TypeSpec* type_join(TypeSpec* a, TypeSpec* b);
+TypeSpec* infer_node_type(ASTNode* node);
+void infer_types(ASTNode* root);
+
 /* Funções de debug */
 int count_ast_nodes(ASTNode* node);
 
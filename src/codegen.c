@@ -9,6 +9,12 @@ void codegen_literal_elements(CodeGenContext* ctx, ASTNode* literal, const char*
 void codegen_array_literal(CodeGenContext* ctx, ASTNode* literal);
 void codegen_matrix_literal(CodeGenContext* ctx, ASTNode* literal);
 void codegen_set_literal(CodeGenContext* ctx, ASTNode* literal);
+static int codegen_set_method(CodeGenContext* ctx, ASTNode* obj, const char* method, NodeList* args);
+static const char* codegen_set_suffix(TypeSpec* set_type);
+static int codegen_is_mod(TypeSpec* t);
+static void codegen_mod_coerce(CodeGenContext* ctx, ASTNode* e, TypeSpec* target);
+static void codegen_mod_stats_call(CodeGenContext* ctx, const char* name, ASTNode* arr);
+static const char* codegen_call_name(ASTNode* e);
 
 #define CG_DEBUG 0
 #if CG_DEBUG
@@ -26,7 +32,14 @@ CodeGenContext* codegen_create(FILE* output) {
     ctx->indent_level = 0;
     ctx->loop_top = -1;
     memset(ctx->loop_continue, 0, sizeof(ctx->loop_continue));
+    ctx->loop_big_count = 0;
     ctx->alloc_count = 0;
+    ctx->program = NULL;
+    ctx->current_function = NULL;
+    ctx->tail_label = -1;
+    ctx->tail_acc_op = -1;
+    ctx->emit_structured = 0;
+    ctx->error_count = 0;
     return ctx;
 }
 
@@ -63,6 +76,18 @@ void codegen_emit(CodeGenContext* ctx, const char* format, ...) {
     va_end(args);
 }
 
+/* Erro de geração: informado como os de análise e contado, para que o main não compile o C gerado */
+void codegen_error(CodeGenContext* ctx, ASTNode* node, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "Erro: ");
+    vfprintf(stderr, format, args);
+    if (node) fprintf(stderr, " (linha %d)", node->line);
+    fprintf(stderr, "\n");
+    va_end(args);
+    ctx->error_count++;
+}
+
 const char* codegen_type_to_c(TypeSpec* type) {
     if (!type) return "void";
 
@@ -70,6 +95,9 @@ const char* codegen_type_to_c(TypeSpec* type) {
         return type->type_name;
     }
 
+    if (codegen_is_matrix_type(type)) return codegen_matrix_ptr_type(type);
+    if (codegen_is_set_type(type)) return codegen_set_ptr_type(type);
+
     switch (type->base_type) {
         case TYPE_INT: return "int";
         case TYPE_FLOAT: return "double";
@@ -78,6 +106,8 @@ const char* codegen_type_to_c(TypeSpec* type) {
         case TYPE_STRING: return "char*";
         case TYPE_VOID: return "void";
         case TYPE_COMPLEX: return "double complex";
+        case TYPE_BIGINT: return "mathc_bigint*";
+        case TYPE_MOD: return "unsigned";
         case TYPE_ARRAY: {
             static char type_buffer[256];
             if (type->element_type) {
@@ -92,7 +122,6 @@ const char* codegen_type_to_c(TypeSpec* type) {
             }
             return "void*";
         }
-        case TYPE_MATRIX: return "void*";
         case TYPE_SET: return "void*";
         case TYPE_GRAPH: return "void*";
         default: return "void";
@@ -100,128 +129,45 @@ const char* codegen_type_to_c(TypeSpec* type) {
 }
 
 void codegen_runtime_helpers(CodeGenContext* ctx) {
-    fputs("typedef struct { int start; int end; int step; } range_t;\n", ctx->output);
-    fputs("static inline range_t make_range(int s, int e, int st){ range_t r={s,e,st}; return r; }\n", ctx->output);
-    fputs("static inline int range_has_next(range_t* r, int i){ return r->step>0 ? i<r->end : i>r->end; }\n", ctx->output);
+    // Número de iterações de range(lo, hi, step) para passos conhecidos só em tempo de execução
+    fputs("static inline int mathc_range_count(int lo, int hi, int step){ if (step == 0) { fprintf(stderr, \"Erro: range com passo zero\\n\"); exit(1); } if (step > 0) return hi > lo ? (int)(((long long)hi - lo + step - 1) / step) : 0; return lo > hi ? (int)(((long long)lo - hi - step - 1) / -step) : 0; }\n", ctx->output);
+    // Só usado com expoente literal não negativo; resultado fora de int é erro, como em factorial/modpow
+    fputs("static void mathc_ipow_overflow(int b, int e) { fprintf(stderr, \"Erro: resultado de %d ^ %d não cabe em int (use bigint)\\n\", b, e); exit(1); }\n", ctx->output);
+    fputs("static inline int mathc_ipow(int b, int e) {\n"
+          "    long long r = 1, x = b;\n"
+          "    for (int k = e; k > 0; ) {\n"
+          "        if (k & 1) { r *= x; if (r > 2147483647LL || r < -2147483648LL) mathc_ipow_overflow(b, e); }\n"
+          "        k >>= 1;\n"
+          "        if (k) { x *= x; if (x > 2147483648LL) mathc_ipow_overflow(b, e); }\n"
+          "    }\n"
+          "    return (int)r;\n"
+          "}\n", ctx->output);
     fputs("static inline int mathc_floor_div(int a, int b){ if (b == 0) { fprintf(stderr, \"Erro: Divisao por zero\\n\"); exit(1); } int q = a / b; int r = a % b; if ((r != 0) && ((r > 0) != (b > 0))) q--; return q; }\n", ctx->output);
     fputs("static inline double max(double a, double b) { return (a > b) ? a : b; }\n", ctx->output);
     fputs("static inline double min(double a, double b) { return (a < b) ? a : b; }\n", ctx->output);
-    fputs("static inline double mathc_sum(int* arr, int len) {\n", ctx->output);
-    fputs("    double s = 0.0; int i = 0; goto L_sum_check;\n", ctx->output);
-    fputs("L_sum_body: s += arr[i]; i++;\n", ctx->output);
-    fputs("L_sum_check: if (i < len) goto L_sum_body; return s;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline double mathc_mean(int* arr, int len) {\n", ctx->output);
-    fputs("    if (len == 0) return 0.0; return mathc_sum(arr, len) / len;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline double mathc_prod(int* arr, int len) {\n", ctx->output);
-    fputs("    double p = 1.0; int i = 0; goto L_prod_check;\n", ctx->output);
-    fputs("L_prod_body: p *= arr[i]; i++;\n", ctx->output);
-    fputs("L_prod_check: if (i < len) goto L_prod_body; return p;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline double mathc_variance(int* arr, int len) {\n", ctx->output);
-    fputs("    if (len == 0) return 0.0;\n", ctx->output);
-    fputs("    double m = mathc_mean(arr, len); double var = 0.0; int i = 0; goto L_var_check;\n", ctx->output);
-    fputs("L_var_body: { double diff = arr[i] - m; var += diff * diff; i++; }\n", ctx->output);
-    fputs("L_var_check: if (i < len) goto L_var_body; return var / len;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline double mathc_std(int* arr, int len) { return sqrt(mathc_variance(arr, len)); }\n", ctx->output);
-
-    fputs("static inline void mathc_sort(int* arr, int len) {\n", ctx->output);
-    fputs("    int i = 0; goto L_sort_i_check;\n", ctx->output);
-    fputs("L_sort_i_body: { int j = i + 1; goto L_sort_j_check;\n", ctx->output);
-    fputs("L_sort_j_body: if (arr[j] < arr[i]) { int tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp; } j++;\n", ctx->output);
-    fputs("L_sort_j_check: if (j < len) goto L_sort_j_body; i++; }\n", ctx->output);
-    fputs("L_sort_i_check: if (i < len - 1) goto L_sort_i_body;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline void mathc_reverse(int* arr, int len) {\n", ctx->output);
-    fputs("    int i = 0; int j = len - 1; goto L_rev_check;\n", ctx->output);
-    fputs("L_rev_body: { int tmp = arr[i]; arr[i] = arr[j]; arr[j] = tmp; i++; j--; }\n", ctx->output);
-    fputs("L_rev_check: if (i < j) goto L_rev_body;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_pop(int* arr, int* len_ptr) {\n", ctx->output);
-    fputs("    if (*len_ptr == 0) return 0;\n", ctx->output);
-    fputs("    (*len_ptr)--; return arr[*len_ptr];\n", ctx->output);
-    fputs("}\n\n", ctx->output);
-
-    // Funções matemáticas avançadas
-    fputs("static inline int mathc_factorial(int n) {\n", ctx->output);
-    fputs("    if (n < 0) return 0; if (n <= 1) return 1;\n", ctx->output);
-    fputs("    int result = 1; int i = 2; goto L_fact_check;\n", ctx->output);
-    fputs("L_fact_body: result *= i; i++;\n", ctx->output);
-    fputs("L_fact_check: if (i <= n) goto L_fact_body; return result;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_gcd(int a, int b) {\n", ctx->output);
-    fputs("    if (a < 0) a = -a; if (b < 0) b = -b;\n", ctx->output);
-    fputs("    goto L_gcd_check;\n", ctx->output);
-    fputs("L_gcd_body: { int temp = b; b = a % b; a = temp; }\n", ctx->output);
-    fputs("L_gcd_check: if (b != 0) goto L_gcd_body; return a;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_lcm(int a, int b) {\n", ctx->output);
-    fputs("    if (a == 0 || b == 0) return 0;\n", ctx->output);
-    fputs("    int g = mathc_gcd(a, b);\n", ctx->output);
-    fputs("    if (a < 0) a = -a; if (b < 0) b = -b;\n", ctx->output);
-    fputs("    return (a / g) * b;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_isprime(int n) {\n", ctx->output);
-    fputs("    if (n < 2) return 0;\n", ctx->output);
-    fputs("    if (n == 2) return 1;\n", ctx->output);
-    fputs("    if (n % 2 == 0) return 0;\n", ctx->output);
-    fputs("    int i = 3; int limit = (int)sqrt(n); goto L_prime_check;\n", ctx->output);
-    fputs("L_prime_body: if (n % i == 0) return 0; i += 2;\n", ctx->output);
-    fputs("L_prime_check: if (i <= limit) goto L_prime_body; return 1;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_combinations(int n, int k) {\n", ctx->output);
-    fputs("    if (k > n || k < 0) return 0;\n", ctx->output);
-    fputs("    if (k == 0 || k == n) return 1;\n", ctx->output);
-    fputs("    if (k > n - k) k = n - k;\n", ctx->output);
-    fputs("    int result = 1; int i = 0; goto L_comb_check;\n", ctx->output);
-    fputs("L_comb_body: result = result * (n - i) / (i + 1); i++;\n", ctx->output);
-    fputs("L_comb_check: if (i < k) goto L_comb_body; return result;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_permutations(int n, int k) {\n", ctx->output);
-    fputs("    if (k > n || k < 0) return 0;\n", ctx->output);
-    fputs("    int result = 1; int i = 0; goto L_perm_check;\n", ctx->output);
-    fputs("L_perm_body: result *= (n - i); i++;\n", ctx->output);
-    fputs("L_perm_check: if (i < k) goto L_perm_body; return result;\n", ctx->output);
-    fputs("}\n\n", ctx->output);
 
-    // Funções adicionais para arrays
-    fputs("static inline int mathc_min_element(int* arr, int len) {\n", ctx->output);
-    fputs("    if (len == 0) return 0;\n", ctx->output);
-    fputs("    int min_val = arr[0]; int i = 1; goto L_minelem_check;\n", ctx->output);
-    fputs("L_minelem_body: if (arr[i] < min_val) min_val = arr[i]; i++;\n", ctx->output);
-    fputs("L_minelem_check: if (i < len) goto L_minelem_body; return min_val;\n", ctx->output);
+    // Vetores dinâmicos: ponteiro + nome__len + nome__cap. Capacidade 0 indica buffer
+    // emprestado (parâmetro, literal na pilha) ou vazio: ao crescer copia em vez de realloc
+    fputs("static void* mathc_vec_realloc(void* ptr, int len, int* cap, int new_cap, size_t elem) {\n", ctx->output);
+    fputs("    void* p;\n", ctx->output);
+    fputs("    if (*cap > 0) p = realloc(ptr, elem * (size_t)new_cap);\n", ctx->output);
+    fputs("    else { p = malloc(elem * (size_t)new_cap); if (p && len > 0) memcpy(p, ptr, elem * (size_t)len); }\n", ctx->output);
+    fputs("    if (!p) { fprintf(stderr, \"Erro: memória insuficiente para %d elementos\\n\", new_cap); exit(1); }\n", ctx->output);
+    fputs("    *cap = new_cap; return p;\n", ctx->output);
     fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_max_element(int* arr, int len) {\n", ctx->output);
-    fputs("    if (len == 0) return 0;\n", ctx->output);
-    fputs("    int max_val = arr[0]; int i = 1; goto L_maxelem_check;\n", ctx->output);
-    fputs("L_maxelem_body: if (arr[i] > max_val) max_val = arr[i]; i++;\n", ctx->output);
-    fputs("L_maxelem_check: if (i < len) goto L_maxelem_body; return max_val;\n", ctx->output);
+    fputs("static inline void* mathc_vec_grow(void* ptr, int len, int* cap, int need, size_t elem) {\n", ctx->output);
+    fputs("    if (need <= *cap) return ptr;\n", ctx->output);
+    fputs("    int c = *cap > 0 ? *cap * 2 : 4; if (c < need) c = need;\n", ctx->output);
+    fputs("    return mathc_vec_realloc(ptr, len, cap, c, elem);\n", ctx->output);
     fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_find(int* arr, int len, int val) {\n", ctx->output);
-    fputs("    int i = 0; goto L_find_check;\n", ctx->output);
-    fputs("L_find_body: if (arr[i] == val) return i; i++;\n", ctx->output);
-    fputs("L_find_check: if (i < len) goto L_find_body; return -1;\n", ctx->output);
+    fputs("static inline void* mathc_vec_reserve(void* ptr, int len, int* cap, int n, size_t elem) {\n", ctx->output);
+    fputs("    if (n <= *cap || n <= 0) return ptr;\n", ctx->output);
+    fputs("    return mathc_vec_realloc(ptr, len, cap, n < len ? len : n, elem);\n", ctx->output);
     fputs("}\n", ctx->output);
-
-    fputs("static inline int mathc_count(int* arr, int len, int val) {\n", ctx->output);
-    fputs("    int cnt = 0; int i = 0; goto L_count_check;\n", ctx->output);
-    fputs("L_count_body: if (arr[i] == val) cnt++; i++;\n", ctx->output);
-    fputs("L_count_check: if (i < len) goto L_count_body; return cnt;\n", ctx->output);
+    fputs("static inline void* mathc_vec_shrink(void* ptr, int len, int* cap, size_t elem) {\n", ctx->output);
+    fputs("    if (*cap <= len) return ptr;\n", ctx->output);
+    fputs("    if (len == 0) { free(ptr); *cap = 0; return NULL; }\n", ctx->output);
+    fputs("    return mathc_vec_realloc(ptr, len, cap, len, elem);\n", ctx->output);
     fputs("}\n\n", ctx->output);
 
     // Wrapper para sqrt que converte resultado complexo quando necessário
@@ -236,71 +182,238 @@ void codegen_runtime_helpers(CodeGenContext* ctx) {
     fputs("static inline double complex mathc_conjugate(double complex z) { return conj(z); }\n", ctx->output);
     fputs("static inline double mathc_phase(double complex z) { return carg(z); }\n", ctx->output);
     fputs("static inline double mathc_magnitude(double complex z) { return cabs(z); }\n\n", ctx->output);
+}
 
-    fputs("static inline int mathc_cardinality(int* set, int len) { return len; }\n\n", ctx->output);
-
-    fputs("typedef struct { int* ptr; int len; } set_result_t;\n", ctx->output);
-
-    // set_union com labels/goto
-    fputs("static inline set_result_t set_union(int* a, int a_len, int* b, int b_len) {\n", ctx->output);
-    fputs("    int* result = malloc(sizeof(int) * (a_len + b_len));\n", ctx->output);
-    fputs("    int result_len = 0;\n", ctx->output);
-    fputs("    int i = 0; goto L_u_copy_check;\n", ctx->output);
-    fputs("L_u_copy_body: result[result_len++] = a[i]; i++;\n", ctx->output);
-    fputs("L_u_copy_check: if (i < a_len) goto L_u_copy_body;\n", ctx->output);
-    fputs("    i = 0; goto L_u_bcheck;\n", ctx->output);
-    fputs("L_u_bbody: { int found = 0; int j = 0; goto L_u_bjcheck;\n", ctx->output);
-    fputs("L_u_bjbody: if (b[i] == a[j]) { found = 1; goto L_u_bjend; } j++;\n", ctx->output);
-    fputs("L_u_bjcheck: if (j < a_len) goto L_u_bjbody;\n", ctx->output);
-    fputs("L_u_bjend: if (!found) { result[result_len++] = b[i]; } i++; }\n", ctx->output);
-    fputs("L_u_bcheck: if (i < b_len) goto L_u_bbody;\n", ctx->output);
-    fputs("    set_result_t r = {result, result_len}; return r;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    // set_difference com labels/goto
-    fputs("static inline set_result_t set_difference(int* a, int a_len, int* b, int b_len) {\n", ctx->output);
-    fputs("    int* result = malloc(sizeof(int) * a_len);\n", ctx->output);
-    fputs("    int result_len = 0;\n", ctx->output);
-    fputs("    int i = 0; goto L_d_acheck;\n", ctx->output);
-    fputs("L_d_abody: { int found = 0; int j = 0; goto L_d_bcheck;\n", ctx->output);
-    fputs("L_d_bbody: if (a[i] == b[j]) { found = 1; goto L_d_bend; } j++;\n", ctx->output);
-    fputs("L_d_bcheck: if (j < b_len) goto L_d_bbody;\n", ctx->output);
-    fputs("L_d_bend: if (!found) { result[result_len++] = a[i]; } i++; }\n", ctx->output);
-    fputs("L_d_acheck: if (i < a_len) goto L_d_abody;\n", ctx->output);
-    fputs("    set_result_t r = {result, result_len}; return r;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    // set_contains com labels/goto
-    fputs("static inline int set_contains(int* set, int set_len, int element) {\n", ctx->output);
-    fputs("    int i = 0; goto L_c_check;\n", ctx->output);
-    fputs("L_c_body: if (set[i] == element) return 1; i++;\n", ctx->output);
-    fputs("L_c_check: if (i < set_len) goto L_c_body; return 0;\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    // set_is_subset com labels/goto
-    fputs("static inline int set_is_subset(int* a, int a_len, int* b, int b_len) {\n", ctx->output);
-    fputs("    int i = 0; goto L_s_check;\n", ctx->output);
-    fputs("L_s_body: if (!set_contains(b, b_len, a[i])) return 0; i++;\n", ctx->output);
-    fputs("L_s_check: if (i < a_len) goto L_s_body; return 1;\n", ctx->output);
-    fputs("}\n\n", ctx->output);
+/* ========================================================================== */
+/* SAÍDA (print / println) */
+/* ========================================================================== */
+/*
+ * Tudo o que o programa escreve em stdout (print, println e as impressões de
+ * arrays, matrizes, conjuntos e bigint) passa por um buffer de
+ * MATHC_OUT_SIZE bytes, enviado com um único fwrite quando enche e no fim do
+ * programa (atexit). Se stdout é um terminal, cada fim de linha também
+ * esvazia o buffer, e a leitura de stdin mostra antes o prompt pendente.
+ *
+ * Inteiros são formatados à mão, dois dígitos por vez. float sai na menor
+ * sequência de dígitos que relê o mesmo double (0.1 em vez de
+ * 0.10000000000000001, 1/3 com 16 dígitos), calculada com inteiros de 128
+ * bits para 1e-5 <= |x| < 1e17; fora dessa faixa procura a menor precisão
+ * de %.*e que relê x. Valores inteiros saem sem ponto (3.0 imprime 3) e a
+ * notação científica (1e-05, 1e+17) fica para |x| < 1e-4 e |x| >= 1e17.
+ */
+
+static const char* output_runtime =
+    "static char mathc_out_buf[MATHC_OUT_SIZE];\n"
+    "static int mathc_out_len = 0;\n"
+    "static int mathc_out_tty = -1;  // -1 até a primeira escrita; 1 se stdout é um terminal\n"
+    "static void mathc_out_flush(void) {\n"
+    "    if (mathc_out_len > 0) fwrite(mathc_out_buf, 1, (size_t)mathc_out_len, stdout);\n"
+    "    mathc_out_len = 0;\n"
+    "    fflush(stdout);\n"
+    "}\n"
+    "/* Garante n bytes livres no buffer (n <= MATHC_OUT_SIZE) e devolve o fim atual */\n"
+    "static inline char* mathc_out_reserve(int n) {\n"
+    "    if (__builtin_expect(mathc_out_tty < 0, 0)) { mathc_out_tty = isatty(fileno(stdout)); atexit(mathc_out_flush); }\n"
+    "    if (mathc_out_len + n > MATHC_OUT_SIZE) mathc_out_flush();\n"
+    "    return mathc_out_buf + mathc_out_len;\n"
+    "}\n"
+    "/* Antes de ler stdin: o que foi escrito num terminal (um prompt sem \\n) aparece */\n"
+    "static inline void mathc_out_sync(void) { if (mathc_out_tty > 0 && mathc_out_len > 0) mathc_out_flush(); }\n"
+    "static void mathc_out_write(const char* s, size_t n) {\n"
+    "    while (n > 0) {\n"
+    "        size_t k = n < MATHC_OUT_SIZE ? n : MATHC_OUT_SIZE;\n"
+    "        memcpy(mathc_out_reserve((int)k), s, k);\n"
+    "        mathc_out_len += (int)k; s += k; n -= k;\n"
+    "    }\n"
+    "}\n"
+    "static inline void mathc_out_char(char c) { *mathc_out_reserve(1) = c; mathc_out_len++; }\n"
+    "static inline void mathc_out_str(const char* s) { if (!s) s = \"(null)\"; mathc_out_write(s, strlen(s)); }\n"
+    "/* Fim de linha: num terminal cada linha é enviada na hora */\n"
+    "static inline void mathc_out_newline(void) { mathc_out_char('\\n'); if (mathc_out_tty > 0) mathc_out_flush(); }\n"
+    "\n"
+    "static const char mathc_digit_pairs[201] =\n"
+    "    \"00010203040506070809101112131415161718192021222324252627282930313233343536373839\"\n"
+    "    \"40414243444546474849505152535455565758596061626364656667686970717273747576777879\"\n"
+    "    \"8081828384858687888990919293949596979899\";\n"
+    "/* Escreve os dígitos de v terminando em end (dois por vez) e devolve o início */\n"
+    "static inline char* mathc_fmt_u64(char* end, unsigned long long v) {\n"
+    "    while (v >= 100) { unsigned d = (unsigned)(v % 100) * 2; v /= 100; *--end = mathc_digit_pairs[d + 1]; *--end = mathc_digit_pairs[d]; }\n"
+    "    if (v >= 10) { unsigned d = (unsigned)v * 2; *--end = mathc_digit_pairs[d + 1]; *--end = mathc_digit_pairs[d]; }\n"
+    "    else *--end = (char)('0' + v);\n"
+    "    return end;\n"
+    "}\n"
+    "static inline void mathc_out_ll(long long v) {\n"
+    "    char tmp[24];\n"
+    "    char* end = tmp + sizeof(tmp);\n"
+    "    char* s = mathc_fmt_u64(end, v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v);\n"
+    "    if (v < 0) *--s = '-';\n"
+    "    int n = (int)(end - s);\n"
+    "    memcpy(mathc_out_reserve(n), s, (size_t)n);\n"
+    "    mathc_out_len += n;\n"
+    "}\n"
+    "\n"
+    "static const unsigned long long mathc_pow10_u64[20] = {\n"
+    "    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,\n"
+    "    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,\n"
+    "    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,\n"
+    "    1000000000000000000ULL, 10000000000000000000ULL };\n"
+    "/*\n"
+    " * Menor sequência de dígitos que relê x (x > 0 finito): x = 4f·2^q e o\n"
+    " * intervalo que arredonda para x, [4f - 2, 4f + 2]·2^q (metade abaixo numa\n"
+    " * potência de 2), é escalado por 10^k para cair em [10^16, 10^17) com\n"
+    " * aritmética exata de 128 bits. Corta-se um dígito enquanto o intervalo\n"
+    " * ainda contém um múltiplo de 10 e fica o candidato mais próximo de x.\n"
+    " * Devolve 0 fora de 1e-5 <= x < 1e17, onde as contas não cabem em 128 bits.\n"
+    " */\n"
+    "static int mathc_fmt_shortest(double x, char* digits, int* n, int* exp10) {\n"
+    "    unsigned long long bits;\n"
+    "    memcpy(&bits, &x, sizeof(bits));\n"
+    "    int be = (int)(bits >> 52) & 0x7ff;\n"
+    "    unsigned long long f = bits & ((1ULL << 52) - 1);\n"
+    "    if (be == 0) return 0;\n"
+    "    int lower = (f == 0 && be > 1) ? 1 : 2;\n"
+    "    f |= 1ULL << 52;\n"
+    "    int even = (f & 1) == 0;  // empate arredonda para mantissa par: extremos inclusos\n"
+    "    int q = be - 1077;\n"
+    "    unsigned long long m4 = f << 2;\n"
+    "    int e10 = (int)floor((be - 1023) * 0.30102999566398120);\n"
+    "    for (;;) {\n"
+    "        int k = 16 - e10;\n"
+    "        if (k < 0 || k > 21) return 0;\n"
+    "        unsigned __int128 p = k <= 19 ? (unsigned __int128)mathc_pow10_u64[k] : (unsigned __int128)mathc_pow10_u64[k - 10] * mathc_pow10_u64[10];\n"
+    "        unsigned __int128 xs = (unsigned __int128)m4 * p, ls = (unsigned __int128)(m4 - lower) * p, hs = (unsigned __int128)(m4 + 2) * p;\n"
+    "        unsigned long long xf, lo, hi;\n"
+    "        int frac;  // parte fracionária de x·10^k: 0 exata, 1 < 1/2, 2 = 1/2, 3 > 1/2\n"
+    "        if (q >= 0) {\n"
+    "            if (q > 10 || (xs << q) >> 64) return 0;\n"
+    "            xf = (unsigned long long)(xs << q); lo = (unsigned long long)(ls << q); hi = (unsigned long long)(hs << q);\n"
+    "            frac = 0;\n"
+    "            if (!even) { lo++; hi--; }\n"
+    "        } else {\n"
+    "            int s = -q;\n"
+    "            if (s > 127 || (xs >> s) >> 64) return 0;\n"
+    "            unsigned __int128 mask = (((unsigned __int128)1) << s) - 1, half = ((unsigned __int128)1) << (s - 1);\n"
+    "            unsigned __int128 rx = xs & mask;\n"
+    "            xf = (unsigned long long)(xs >> s);\n"
+    "            frac = rx == 0 ? 0 : rx < half ? 1 : rx == half ? 2 : 3;\n"
+    "            lo = (unsigned long long)(ls >> s); hi = (unsigned long long)(hs >> s);\n"
+    "            if ((ls & mask) != 0 || !even) lo++;\n"
+    "            if ((hs & mask) == 0 && !even) hi--;\n"
+    "        }\n"
+    "        if (xf >= mathc_pow10_u64[17]) { e10++; continue; }\n"
+    "        if (xf < mathc_pow10_u64[16]) { e10--; continue; }\n"
+    "        int t = 0;\n"
+    "        while ((lo + 9) / 10 <= hi / 10) { lo = (lo + 9) / 10; hi /= 10; t++; }\n"
+    "        unsigned long long c = xf / mathc_pow10_u64[t], r = xf % mathc_pow10_u64[t], half_t = mathc_pow10_u64[t] / 2;\n"
+    "        if (t == 0) c += frac == 3 || (frac == 2 && (c & 1));\n"
+    "        else if (r > half_t || (r == half_t && (frac != 0 || (c & 1)))) c++;\n"
+    "        if (c < lo) c = lo;\n"
+    "        if (c > hi) c = hi;\n"
+    "        char tmp[24];\n"
+    "        char* end = tmp + sizeof(tmp);\n"
+    "        char* s = mathc_fmt_u64(end, c);\n"
+    "        int len = (int)(end - s);\n"
+    "        *exp10 = e10 + len - (17 - t);\n"
+    "        while (len > 1 && s[len - 1] == '0') len--;\n"
+    "        memcpy(digits, s, (size_t)len);\n"
+    "        *n = len;\n"
+    "        return 1;\n"
+    "    }\n"
+    "}\n"
+    "/* Escreve x em out (até 32 bytes): inteiros sem ponto, notação fixa para 1e-4 <= |x| < 1e17, científica fora */\n"
+    "static int mathc_fmt_double(char* out, double x) {\n"
+    "    char* p = out;\n"
+    "    if (isnan(x)) { if (signbit(x)) *p++ = '-'; memcpy(p, \"nan\", 3); return (int)(p - out) + 3; }\n"
+    "    if (signbit(x)) { *p++ = '-'; x = -x; }\n"
+    "    if (isinf(x)) { memcpy(p, \"inf\", 3); return (int)(p - out) + 3; }\n"
+    "    if (x < 9007199254740992.0 && x == (double)(long long)x) {\n"
+    "        char tmp[24];\n"
+    "        char* end = tmp + sizeof(tmp);\n"
+    "        char* s = mathc_fmt_u64(end, (unsigned long long)x);\n"
+    "        memcpy(p, s, (size_t)(end - s));\n"
+    "        return (int)(p - out) + (int)(end - s);\n"
+    "    }\n"
+    "    char d[24];\n"
+    "    int n, e;\n"
+    "    if (!mathc_fmt_shortest(x, d, &n, &e)) {\n"
+    "        // Subnormais e extremos: a menor precisão de %.*e que relê x\n"
+    "        char tmp[40];\n"
+    "        for (int prec = 0; prec < 17; prec++) {\n"
+    "            snprintf(tmp, sizeof(tmp), \"%.*e\", prec, x);\n"
+    "            if (strtod(tmp, NULL) == x) break;\n"
+    "        }\n"
+    "        n = 0;\n"
+    "        char* c = tmp;\n"
+    "        for (; *c != 'e'; c++) if (*c != '.') d[n++] = *c;\n"
+    "        e = atoi(c + 1);\n"
+    "        while (n > 1 && d[n - 1] == '0') n--;\n"
+    "    }\n"
+    "    if (e < -4 || e >= 17) {\n"
+    "        *p++ = d[0];\n"
+    "        if (n > 1) { *p++ = '.'; memcpy(p, d + 1, (size_t)(n - 1)); p += n - 1; }\n"
+    "        *p++ = 'e'; *p++ = e < 0 ? '-' : '+';\n"
+    "        int ae = e < 0 ? -e : e;\n"
+    "        if (ae >= 100) *p++ = (char)('0' + ae / 100);\n"
+    "        *p++ = (char)('0' + ae / 10 % 10); *p++ = (char)('0' + ae % 10);\n"
+    "    } else if (e < 0) {\n"
+    "        *p++ = '0'; *p++ = '.';\n"
+    "        for (int i = -1; i > e; i--) *p++ = '0';\n"
+    "        memcpy(p, d, (size_t)n); p += n;\n"
+    "    } else {\n"
+    "        for (int i = 0; i < n || i <= e; i++) {\n"
+    "            if (i == e + 1) *p++ = '.';\n"
+    "            *p++ = i < n ? d[i] : '0';\n"
+    "        }\n"
+    "    }\n"
+    "    return (int)(p - out);\n"
+    "}\n"
+    "static inline void mathc_out_double(double x) { char* p = mathc_out_reserve(32); mathc_out_len += mathc_fmt_double(p, x); }\n"
+    "\n"
+    "void mathc_print_int(int x) { mathc_out_ll(x); }\n"
+    "void mathc_print_float(double x) { mathc_out_double(x); }\n"
+    "void mathc_print_string(char* x) { mathc_out_str(x); }\n"
+    "void mathc_print_char(char x) { mathc_out_char(x); }\n"
+    "void mathc_print_complex(double complex x) { mathc_out_double(creal(x)); mathc_out_char(signbit(cimag(x)) ? '-' : '+'); mathc_out_double(fabs(cimag(x))); mathc_out_char('i'); }\n"
+    "void mathc_println_int(int x) { mathc_print_int(x); mathc_out_newline(); }\n"
+    "void mathc_println_float(double x) { mathc_print_float(x); mathc_out_newline(); }\n"
+    "void mathc_println_string(char* x) { mathc_print_string(x); mathc_out_newline(); }\n"
+    "void mathc_println_char(char x) { mathc_print_char(x); mathc_out_newline(); }\n"
+    "void mathc_println_complex(double complex x) { mathc_print_complex(x); mathc_out_newline(); }\n";
+
+static void codegen_output_runtime(CodeGenContext* ctx) {
+    fputs("#include <unistd.h>\n", ctx->output);
+    fputs("#define MATHC_OUT_SIZE (1 << 16)  // bytes acumulados antes de cada fwrite\n", ctx->output);
+    fputs(output_runtime, ctx->output);
+    fputs("\n", ctx->output);
 }
 
-void codegen_loop_push(CodeGenContext* ctx, int start, int end, int cont) {
+void codegen_loop_push(CodeGenContext* ctx, int start, int end, int cont, NodeList* body) {
     if (ctx->loop_top < 63) {
         ctx->loop_top++;
         ctx->loop_start[ctx->loop_top] = start;
         ctx->loop_end[ctx->loop_top] = end;
         ctx->loop_continue[ctx->loop_top] = cont;
+        ctx->loop_body[ctx->loop_top] = body;
+        ctx->loop_big_base[ctx->loop_top] = ctx->loop_big_count;
     }
 }
 
 void codegen_loop_pop(CodeGenContext* ctx) {
-    if (ctx->loop_top >= 0) ctx->loop_top--;
+    if (ctx->loop_top >= 0) {
+        ctx->loop_big_count = ctx->loop_big_base[ctx->loop_top];
+        ctx->loop_top--;
+    }
 }
 
 void codegen_record_alloc(CodeGenContext* ctx, const char* name) {
+    codegen_record_alloc_fn(ctx, name, NULL);
+}
+
+/* Alocação liberada por uma função própria do runtime (ex.: mathc_set_free_int) */
+void codegen_record_alloc_fn(CodeGenContext* ctx, const char* name, const char* free_fn) {
     if (ctx->alloc_count < 256 && name) {
         ctx->alloc_names[ctx->alloc_count] = strdup(name);
+        ctx->alloc_free_fns[ctx->alloc_count] = free_fn;
         ctx->alloc_count++;
     }
 }
@@ -309,7 +422,7 @@ void codegen_emit_frees(CodeGenContext* ctx) {
     for (int i = 0; i < ctx->alloc_count; i++) {
         if (ctx->alloc_names[i]) {
             codegen_emit_indent(ctx);
-            codegen_emit(ctx, "free(%s);\n", ctx->alloc_names[i]);
+            codegen_emit(ctx, "%s(%s);\n", ctx->alloc_free_fns[i] ? ctx->alloc_free_fns[i] : "free", ctx->alloc_names[i]);
             free(ctx->alloc_names[i]);
             ctx->alloc_names[i] = NULL;
         }
@@ -317,29 +430,96 @@ void codegen_emit_frees(CodeGenContext* ctx) {
     ctx->alloc_count = 0;
 }
 
+/* array.add(x) / push(array, x): crescimento geométrico (amortizado O(1)) */
+static void codegen_vec_push(CodeGenContext* ctx, ASTNode* obj, ASTNode* value) {
+    codegen_emit(ctx, "(");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, " = mathc_vec_grow(");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, ", ");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__len, &");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__cap, ");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__len + 1, sizeof(*");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, ")), ");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "[");
+    codegen_expression(ctx, obj);
+    // O incremento vem depois da atribuição: o valor pode ler len(v)
+    codegen_emit(ctx, "__len] = ");
+    TypeSpec* t = obj->inferred_type;
+    codegen_mod_coerce(ctx, value, t && t->base_type == TYPE_ARRAY ? t->element_type : NULL);
+    codegen_emit(ctx, ", ");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__len++)");
+}
+
+/* array.pop() / pop(array): remove e devolve o último elemento (0 se vazio) */
+static void codegen_vec_pop(CodeGenContext* ctx, ASTNode* obj) {
+    codegen_emit(ctx, "(");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__len > 0 ? ");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "[--");
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, "__len] : 0)");
+}
+
 void codegen_member_access(CodeGenContext* ctx, ASTNode* member) {
     if (!member || member->type != NODE_MEMBER_ACCESS) { codegen_emit(ctx, "/* membro inválido */"); return; }
 
     ASTNode* obj = member->member_access.object;
     const char* method = member->member_access.member;
 
+    if (codegen_is_set_type(obj->inferred_type) &&
+        codegen_set_method(ctx, obj, method, member->member_access.args)) {
+        return;
+    }
+
     if (obj->inferred_type && obj->inferred_type->base_type == TYPE_ARRAY) {
-        if (strcmp(method, "add") == 0 && member->member_access.args) {
+        if (obj->type != NODE_IDENTIFIER) {
+            // Os métodos mexem em v__len/v__cap: linhas m[i] têm tamanho fixo
+            codegen_error(ctx, member, "%s requer um vetor por variável (linha de matriz tem tamanho fixo)", method);
+            codegen_emit(ctx, "0");
+            return;
+        }
+        if ((strcmp(method, "add") == 0 || strcmp(method, "push") == 0) && member->member_access.args) {
+            codegen_vec_push(ctx, obj, member->member_access.args->node);
+            return;
+        } else if (strcmp(method, "pop") == 0) {
+            codegen_vec_pop(ctx, obj);
+            return;
+        } else if (strcmp(method, "reserve") == 0 && member->member_access.args) {
+            // array.reserve(n): capacidade exata n, sem alterar o tamanho
             codegen_emit(ctx, "(");
             codegen_expression(ctx, obj);
-            codegen_emit(ctx, " = realloc(");
+            codegen_emit(ctx, " = mathc_vec_reserve(");
+            codegen_expression(ctx, obj);
+            codegen_emit(ctx, ", ");
+            codegen_expression(ctx, obj);
+            codegen_emit(ctx, "__len, &");
             codegen_expression(ctx, obj);
+            codegen_emit(ctx, "__cap, ");
+            codegen_expression(ctx, member->member_access.args->node);
             codegen_emit(ctx, ", sizeof(*");
             codegen_expression(ctx, obj);
-            codegen_emit(ctx, ") * (");
+            codegen_emit(ctx, ")))");
+            return;
+        } else if (strcmp(method, "shrink_to_fit") == 0) {
+            codegen_emit(ctx, "(");
             codegen_expression(ctx, obj);
-            codegen_emit(ctx, "__len + 1)), ");
+            codegen_emit(ctx, " = mathc_vec_shrink(");
             codegen_expression(ctx, obj);
-            codegen_emit(ctx, "[");
+            codegen_emit(ctx, ", ");
             codegen_expression(ctx, obj);
-            codegen_emit(ctx, "__len++] = ");
-            codegen_expression(ctx, member->member_access.args->node);
-            codegen_emit(ctx, ")");
+            codegen_emit(ctx, "__len, &");
+            codegen_expression(ctx, obj);
+            codegen_emit(ctx, "__cap, sizeof(*");
+            codegen_expression(ctx, obj);
+            codegen_emit(ctx, ")))");
             return;
         } else if (strcmp(method, "remove") == 0 && member->member_access.args) {
             codegen_emit(ctx, "(memmove(&");
@@ -401,151 +581,5517 @@ void codegen_member_access(CodeGenContext* ctx, ASTNode* member) {
     }
 }
 
-void codegen_for(CodeGenContext* ctx, ASTNode* for_node) {
-    if (!for_node || for_node->type != NODE_FOR_STMT) return;
-    int startL = codegen_new_label(ctx);
-    int endL = codegen_new_label(ctx);
+/* ========================================================================== */
+/* ANÁLISE DE ESCAPE DE LITERAIS */
+/* ========================================================================== */
+/*
+ * Um array/conjunto/matriz declarado com literal "escapa" quando o ponteiro
+ * pode sobreviver à função ou ser realocado: `return v`, `w = v`,
+ * `T[] w = v`, métodos (`v.push(x)`), built-ins que redimensionam e funções
+ * que devolvem coleções recebendo `v`. Literais que não escapam vivem na
+ * pilha; se além disso todos os elementos são constantes e `v` nunca é
+ * escrito (nem passado a funções que podem escrever), viram tabelas
+ * `static const`. Somente os que escapam continuam em malloc + free no fim.
+ */
+
+#define ESCAPE_MAX_STACK_ELEMS 4096
+
+typedef enum { LITERAL_HEAP, LITERAL_STACK, LITERAL_STATIC } LiteralStorage;
+
+typedef struct EscapeScan {
+    ASTNode* program;
+    const char* name;
+    int escapes;
+    int writes;
+} EscapeScan;
+
+/* Built-ins que apenas leem o array recebido */
+static const char* escape_readonly_builtins[] = {
+    "len", "print", "println", "sum", "mean", "prod", "std", "variance",
+    "min_element", "max_element", "find", "count",
+    "union", "intersection", "difference", "symmetric_diff",
+    "is_subset", "is_superset", "cardinality", "transpose", "determinant", "trace", NULL
+};
+
+/* Built-ins que alteram os elementos sem trocar o ponteiro */
+static const char* escape_inplace_builtins[] = { "sort", "reverse", NULL };
+
+static int escape_in_list(const char** list, const char* name) {
+    for (int i = 0; list[i]; i++) {
+        if (strcmp(list[i], name) == 0) return 1;
+    }
+    return 0;
+}
 
-    ASTNode* iterable = for_node->for_stmt.iterable;
-    const char* iterName = for_node->for_stmt.iterator;
-    const char* idxName = for_node->for_stmt.index_var;
+static int escape_is_name(ASTNode* node, const char* name) {
+    return node && node->type == NODE_IDENTIFIER && strcmp(node->identifier.name, name) == 0;
+}
 
-    // Range-based
-    if (iterable->type == NODE_CALL && iterable->call.function->type == NODE_IDENTIFIER && strcmp(iterable->call.function->identifier.name, "range") == 0) {
-        NodeList* args = iterable->call.arguments;
-        int argc = 0; for (NodeList* t=args;t;t=t->next) argc++;
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int %s_index = 0;\n", iterName);
-        codegen_emit_indent(ctx);
-        if (argc == 1) {
-            codegen_emit(ctx, "range_t %s_range = make_range(0, ", iterName); codegen_expression(ctx, args->node); codegen_emit(ctx, ", 1);\n");
-        } else {
-            codegen_emit(ctx, "range_t %s_range = make_range(", iterName); codegen_expression(ctx, args->node); codegen_emit(ctx, ", "); codegen_expression(ctx, args->next->node); codegen_emit(ctx, ", 1);\n");
+static int escape_is_element_of(ASTNode* node, const char* name) {
+    while (node && node->type == NODE_ARRAY_ACCESS) {
+        if (escape_is_name(node->array_access.array, name)) return 1;
+        node = node->array_access.array;
+    }
+    return 0;
+}
+
+static ASTNode* escape_find_function(ASTNode* program, const char* name) {
+    if (!program || program->type != NODE_PROGRAM) return NULL;
+    for (NodeList* d = program->program.definitions; d; d = d->next) {
+        if (d->node && d->node->type == NODE_FUNCTION_DEF && d->node->function_def.name &&
+            strcmp(d->node->function_def.name, name) == 0) {
+            return d->node;
         }
-        int continueL = codegen_new_label(ctx);
-        codegen_loop_push(ctx, startL, endL, continueL);
-        codegen_emit(ctx, "L%d:\n", startL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "if (!range_has_next(&%s_range, %s_index)) goto L%d;\n", iterName, iterName, endL);
-        // Bloco por iteração
-        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = %s_index;\n", iterName, iterName);
-        // Corpo
-        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
-        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
-        // Continue + incremento
-        codegen_emit(ctx, "L%d:\n", continueL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "%s_index += %s_range.step;\n", iterName, iterName);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
-        codegen_emit(ctx, "L%d:\n", endL);
-        codegen_loop_pop(ctx);
+    }
+    return NULL;
+}
+
+static int escape_is_row_of(ASTNode* node, const char* name);
+
+static void escape_check_call(EscapeScan* scan, ASTNode* call) {
+    int passed = 0;
+    for (NodeList* a = call->call.arguments; a; a = a->next) {
+        if (escape_is_name(a->node, scan->name)) passed = 1;
+        // Uma linha m[i] passada adiante pode ser alterada pela função
+        if (escape_is_row_of(a->node, scan->name)) scan->writes = 1;
+    }
+    if (!passed) return;
+
+    const char* fname = call->call.function && call->call.function->type == NODE_IDENTIFIER ?
+        call->call.function->identifier.name : NULL;
+    if (!fname) { scan->escapes = 1; return; }
+    if (escape_in_list(escape_readonly_builtins, fname)) return;
+    if (escape_in_list(escape_inplace_builtins, fname)) { scan->writes = 1; return; }
+
+    ASTNode* callee = escape_find_function(scan->program, fname);
+    if (!callee) {
+        // Built-in que pode realocar (append, push, pop...) ou desconhecido
+        scan->escapes = 1;
         return;
     }
+    // Parâmetros são ponteiros: a função pode escrever e, se devolve coleção, repassar o ponteiro
+    scan->writes = 1;
+    TypeSpec* rt = callee->function_def.return_type;
+    if (rt && (rt->base_type == TYPE_ARRAY || rt->base_type == TYPE_SET ||
+               rt->base_type == TYPE_MATRIX || rt->base_type == TYPE_CUSTOM)) {
+        scan->escapes = 1;
+    }
+}
 
-    if (iterable->type == NODE_ARRAY_LITERAL) {
-        int arrId = codegen_new_temp(ctx);
-        int count = 0; NodeList* el = iterable->array_literal.elements; while (el){count++; el=el->next;}
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int* _arr%d = malloc(sizeof(int)*%d);\n", arrId, count);
-        el = iterable->array_literal.elements; int pos=0;
-        while (el){ codegen_emit_indent(ctx); codegen_emit(ctx, "_arr%d[%d] = ", arrId, pos); codegen_expression(ctx, el->node); codegen_emit(ctx, ";\n"); el=el->next; pos++; }
-        int continueL = codegen_new_label(ctx);
-        codegen_loop_push(ctx, startL, endL, continueL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int _i%d = 0;\n", arrId);
-        codegen_emit(ctx, "L%d:\n", startL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "if (_i%d >= %d) goto L%d;\n", arrId, count, endL);
-        // Bloco por iteração
-        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _arr%d[_i%d];\n", iterName, arrId, arrId);
-        if (idxName) { codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _i%d;\n", idxName, arrId); }
-        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
-        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
-        codegen_emit(ctx, "L%d:\n", continueL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "_i%d++;\n", arrId);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
-        codegen_emit(ctx, "L%d:\n", endL);
-        codegen_loop_pop(ctx);
+static int visit_escape_scan(ASTNode* node, void* data);
+
+/* Marca como escrita qualquer indexação da linha ligada em `for (linha in m)` */
+static int visit_escape_row_index(ASTNode* node, void* data) {
+    EscapeScan* scan = (EscapeScan*)data;
+    if (node->type == NODE_ARRAY_ACCESS && escape_is_element_of(node, scan->name)) scan->writes = 1;
+    return 0;
+}
+
+/*
+ * Em `for (linha in m)` sobre uma matriz, linha aponta para os dados de m:
+ * escrever, indexar ou repassar a linha no corpo conta como escrita em m
+ * (uma tabela static const não pode ser alterada pelo apelido).
+ */
+static void escape_check_row_alias(EscapeScan* scan, ASTNode* loop) {
+    if (!escape_is_name(loop->for_stmt.iterable, scan->name) || !loop->for_stmt.iterator) return;
+    EscapeScan row = *scan;
+    row.name = loop->for_stmt.iterator;
+    row.escapes = 0;
+    row.writes = 0;
+    ast_walk_list(loop->for_stmt.body, visit_escape_scan, &row);
+    ast_walk_list(loop->for_stmt.body, visit_escape_row_index, &row);
+    if (row.writes || row.escapes) scan->writes = 1;
+    if (row.escapes) scan->escapes = 1;
+}
+
+/* Linha m[i] usada como valor: vira um ponteiro para os dados de m (int[] r = m[0]) */
+static int escape_is_row_of(ASTNode* node, const char* name) {
+    return node && node->type == NODE_ARRAY_ACCESS && escape_is_name(node->array_access.array, name);
+}
+
+static int visit_escape_scan(ASTNode* node, void* data) {
+    EscapeScan* scan = (EscapeScan*)data;
+    switch (node->type) {
+        case NODE_FOR_STMT:
+            escape_check_row_alias(scan, node);
+            break;
+        case NODE_RETURN_STMT:
+            if (escape_is_name(node->return_stmt.value, scan->name) ||
+                escape_is_row_of(node->return_stmt.value, scan->name)) scan->escapes = 1;
+            break;
+        case NODE_DECLARATION:
+            if (escape_is_name(node->declaration.initializer, scan->name)) scan->escapes = 1;
+            // O apelido da linha pode ser escrito: conta como escrita na matriz
+            if (escape_is_row_of(node->declaration.initializer, scan->name)) scan->writes = 1;
+            break;
+        case NODE_ASSIGNMENT:
+            if (escape_is_name(node->assignment.value, scan->name)) scan->escapes = 1;
+            if (escape_is_row_of(node->assignment.value, scan->name)) scan->writes = 1;
+            if (escape_is_element_of(node->assignment.target, scan->name)) scan->writes = 1;
+            // v = outro vetor troca o ponteiro: o buffer antigo precisa ser do heap
+            if (escape_is_name(node->assignment.target, scan->name)) scan->escapes = 1;
+            break;
+        case NODE_UNARY_OP:
+            if (escape_is_element_of(node->unary_op.operand, scan->name)) scan->writes = 1;
+            break;
+        case NODE_CALL:
+            escape_check_call(scan, node);
+            break;
+        case NODE_MEMBER_ACCESS:
+            if (escape_is_name(node->member_access.object, scan->name)) scan->escapes = 1;
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+static int escape_is_constant(ASTNode* e) {
+    if (!e) return 0;
+    switch (e->type) {
+        case NODE_INT_LITERAL: case NODE_FLOAT_LITERAL: case NODE_BOOL_LITERAL:
+        case NODE_CHAR_LITERAL: case NODE_STRING_LITERAL:
+            return 1;
+        case NODE_UNARY_OP:
+            return (e->unary_op.op == OP_UNARY_MINUS || e->unary_op.op == OP_UNARY_PLUS) &&
+                   escape_is_constant(e->unary_op.operand);
+        default:
+            return 0;
+    }
+}
+
+static int escape_all_constant(NodeList* elements) {
+    for (NodeList* el = elements; el; el = el->next) {
+        if (el->node && el->node->type == NODE_ARRAY_LITERAL) {
+            if (!escape_all_constant(el->node->array_literal.elements)) return 0;
+        } else if (!escape_is_constant(el->node)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Decide onde guardar o literal `elements` (total de `count` elementos) atribuído a `name` */
+static LiteralStorage codegen_literal_storage(CodeGenContext* ctx, const char* name,
+                                              NodeList* elements, int count) {
+    if (!ctx->current_function || count <= 0 || count > ESCAPE_MAX_STACK_ELEMS) return LITERAL_HEAP;
+
+    EscapeScan scan;
+    scan.program = ctx->program;
+    scan.name = name;
+    scan.escapes = 0;
+    scan.writes = 0;
+    ast_walk_list(ctx->current_function->function_def.body, visit_escape_scan, &scan);
+
+    if (scan.escapes) return LITERAL_HEAP;
+    if (!scan.writes && escape_all_constant(elements)) return LITERAL_STATIC;
+    return LITERAL_STACK;
+}
+
+/* Inicializador C `{a, b, c}` (linhas aninhadas para matrizes) */
+static void codegen_literal_initializer(CodeGenContext* ctx, NodeList* elements) {
+    codegen_emit(ctx, "{");
+    for (NodeList* el = elements; el; el = el->next) {
+        if (el->node && el->node->type == NODE_ARRAY_LITERAL) {
+            codegen_literal_initializer(ctx, el->node->array_literal.elements);
+        } else {
+            codegen_expression(ctx, el->node);
+        }
+        if (el->next) codegen_emit(ctx, ", ");
+    }
+    codegen_emit(ctx, "}");
+}
+
+/* Tipo C dos elementos de um literal sem tipo declarado (for x in [...]) */
+static const char* codegen_literal_elem_type(NodeList* elements) {
+    TypeSpec* t = NULL;
+    int strings = 1;
+    for (NodeList* el = elements; el; el = el->next) {
+        TypeSpec* et = el->node ? el->node->inferred_type : NULL;
+        if (!et || et->base_type != TYPE_STRING) strings = 0;
+    }
+    if (strings && elements) return "char*";
+    for (NodeList* el = elements; el; el = el->next) {
+        TypeSpec* et = el->node ? el->node->inferred_type : NULL;
+        t = t ? type_join(t, et) : et;
+        if (!t) return "int";
+    }
+    return t ? codegen_type_to_c(t) : "int";
+}
+
+/* Tipo C do iterador ao percorrer uma variável array/conjunto */
+static const char* codegen_iter_elem_type(ASTNode* iterable) {
+    TypeSpec* t = iterable ? iterable->inferred_type : NULL;
+    if (!t || (t->base_type != TYPE_ARRAY && t->base_type != TYPE_SET) || !t->element_type ||
+        t->element_type->base_type == TYPE_ARRAY) {
+        return "int";
+    }
+    return codegen_type_to_c(t->element_type);
+}
+
+/* Quantidade de iterações sobre uma variável: linhas de matriz, elementos do conjunto ou nome__len */
+static void codegen_iter_count(CodeGenContext* ctx, ASTNode* iterable) {
+    if (codegen_is_matrix_type(iterable->inferred_type)) codegen_emit(ctx, "%s->rows", iterable->identifier.name);
+    else if (codegen_is_set_type(iterable->inferred_type))
+        codegen_emit(ctx, "mathc_set_sorted_%s(%s)->len", codegen_set_suffix(iterable->inferred_type), iterable->identifier.name);
+    else codegen_emit(ctx, "%s__len", iterable->identifier.name);
+}
+
+/* Liga o iterador ao elemento _i<id>; sobre matrizes, a linha vira um array (ponteiro + __len) */
+static void codegen_iter_bind(CodeGenContext* ctx, ASTNode* iterable, const char* iterName, int id) {
+    const char* arrName = iterable->identifier.name;
+    codegen_emit_indent(ctx);
+    if (codegen_is_matrix_type(iterable->inferred_type)) {
+        TypeSpec* elem = iterable->inferred_type->base_type == TYPE_MATRIX ?
+            iterable->inferred_type->element_type : iterable->inferred_type->element_type->element_type;
+        const char* c_type = elem ? codegen_type_to_c(elem) : "int";
+        codegen_emit(ctx, "%s* %s = %s->data + _i%d * %s->stride;\n", c_type, iterName, arrName, id, arrName);
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "int %s__len = %s->cols;\n", iterName, arrName);
         return;
     }
+    codegen_emit(ctx, "%s %s = %s%s[_i%d];\n", codegen_iter_elem_type(iterable), iterName, arrName,
+                 codegen_is_set_type(iterable->inferred_type) ? "->items" : "", id);
+}
 
-    if (iterable->type == NODE_IDENTIFIER) {
-        int arrId = codegen_new_temp(ctx);
-        int continueL = codegen_new_label(ctx);
-        codegen_loop_push(ctx, startL, endL, continueL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int _len%d = %s__len;\n", arrId, iterable->identifier.name);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int _i%d = 0;\n", arrId);
-        codegen_emit(ctx, "L%d:\n", startL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "if (_i%d >= _len%d) goto L%d;\n", arrId, arrId, endL);
-        // Bloco por iteração
-        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
-        codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = %s[_i%d];\n", iterName, iterable->identifier.name, arrId);
-        if (idxName) { codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _i%d;\n", idxName, arrId); }
-        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
-        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
-        codegen_emit(ctx, "L%d:\n", continueL);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "_i%d++;\n", arrId);
-        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
-        codegen_emit(ctx, "L%d:\n", endL);
-        codegen_loop_pop(ctx);
+/*
+ * Declara `T* name` apontando para armazenamento de pilha ou estático. Para
+ * literais constantes somente leitura emite uma tabela static const; caso
+ * contrário um array local preenchido elemento a elemento (preserva a ordem
+ * de avaliação das expressões).
+ */
+static void codegen_local_array(CodeGenContext* ctx, const char* elem_c_type, const char* name,
+                                NodeList* elements, int count, LiteralStorage storage) {
+    int id = codegen_new_temp(ctx);
+    if (storage == LITERAL_STATIC) {
+        codegen_emit(ctx, "static const %s _cst%d[%d] = ", elem_c_type, id, count);
+        codegen_literal_initializer(ctx, elements);
+        codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "%s* %s = (%s*)_cst%d;\n", elem_c_type, name, elem_c_type, id);
         return;
     }
+    codegen_emit(ctx, "%s _stk%d[%d];\n", elem_c_type, id, count);
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "%s* %s = _stk%d;\n", elem_c_type, name, id);
+    int idx = 0;
+    for (NodeList* el = elements; el; el = el->next, idx++) {
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "%s[%d] = ", name, idx);
+        codegen_expression(ctx, el->node);
+        codegen_emit(ctx, ";\n");
+    }
+}
 
-    // Fallback
-    codegen_emit_indent(ctx); codegen_emit(ctx, "/* iterador nao suportado */\n");
+/* ========================================================================== */
+/* MATRIZES CONTÍGUAS */
+/* ========================================================================== */
+/*
+ * matrix[T] e T[][] são um cabeçalho {rows, cols, stride, data} com os
+ * elementos em um único bloco row-major: m[i][j] vira
+ * m->data[i * m->stride + j]. No heap, cabeçalho e dados ficam na mesma
+ * alocação alinhada a MATHC_ALIGN bytes e cada linha começa alinhada
+ * (stride arredondado), então um único free libera tudo.
+ */
+
+typedef struct MatrixKind {
+    const char* suffix;   // mathc_matrix_<suffix>
+    const char* c_type;   // tipo C dos elementos
+    const char* acc_type; // tipo usado na eliminação (determinante)
+    const char* abs_fn;   // módulo de acc_type, para escolher o pivô
+    int exact_det;        // determinante inteiro exato (Bareiss) em vez de LU em acc_type
+} MatrixKind;
+
+static const MatrixKind matrix_kinds[] = {
+    { "int", "int", "double", "fabs", 1 },
+    { "float", "double", "double", "fabs", 0 },
+    { "complex", "double complex", "double complex", "cabs", 0 },
+    { "char", "char", "double", "fabs", 1 },
+};
+
+#define MATRIX_KIND_COUNT ((int)(sizeof(matrix_kinds) / sizeof(matrix_kinds[0])))
+
+int codegen_is_matrix_type(TypeSpec* t) {
+    if (!t) return 0;
+    if (t->base_type == TYPE_MATRIX) return 1;
+    return t->base_type == TYPE_ARRAY && t->element_type && t->element_type->base_type == TYPE_ARRAY;
 }
 
-void codegen_struct(CodeGenContext* ctx, ASTNode* type_def) {
-    if (!type_def || type_def->type != NODE_TYPE_DEF) return;
-    fputs("typedef struct ", ctx->output);
-    fputs(type_def->type_def.name, ctx->output);
-    fputs(" {\n", ctx->output);
-    NodeList* m = type_def->type_def.members;
-    while (m) {
-        ASTNode* n = m->node;
-        if (n && n->type == NODE_DECLARATION) {
-            codegen_emit_indent(ctx);
-            fputs(codegen_type_to_c(n->declaration.var_type), ctx->output);
-            fputc(' ', ctx->output);
-            fputs(n->declaration.name, ctx->output);
-            fputs(";\n", ctx->output);
+static TypeSpec* codegen_matrix_elem(TypeSpec* t) {
+    if (!t) return NULL;
+    if (t->base_type == TYPE_MATRIX) return t->element_type;
+    return t->element_type ? t->element_type->element_type : NULL;
+}
+
+static const MatrixKind* codegen_matrix_kind(TypeSpec* matrix_type) {
+    TypeSpec* elem = codegen_matrix_elem(matrix_type);
+    if (elem) {
+        switch (elem->base_type) {
+            case TYPE_FLOAT: return &matrix_kinds[1];
+            case TYPE_COMPLEX: return &matrix_kinds[2];
+            case TYPE_CHAR: return &matrix_kinds[3];
+            default: break;
         }
-        m = m->next;
     }
-    fputs("} ", ctx->output);
-    fputs(type_def->type_def.name, ctx->output);
-    fputs(";\n\n", ctx->output);
-    m = type_def->type_def.members;
-    while (m) {
-        ASTNode* n = m->node;
-        if (n && n->type == NODE_FUNCTION_DEF) {
-            const char* ret_type = n->function_def.return_type ? codegen_type_to_c(n->function_def.return_type) : "void";
-            fputs(ret_type, ctx->output);
-            fputs(" ", ctx->output);
-            fputs(n->function_def.name, ctx->output);
-            fputs("(", ctx->output);
+    return &matrix_kinds[0];
+}
 
-            fputs(type_def->type_def.name, ctx->output);
-            fputs(" this", ctx->output);
+/* Nome do tipo C (ponteiro para o cabeçalho) de uma matriz */
+const char* codegen_matrix_ptr_type(TypeSpec* matrix_type) {
+    static char buffers[MATRIX_KIND_COUNT][48];
+    const MatrixKind* k = codegen_matrix_kind(matrix_type);
+    char* buf = buffers[k - matrix_kinds];
+    snprintf(buf, sizeof(buffers[0]), "mathc_matrix_%s*", k->suffix);
+    return buf;
+}
 
-            ParamList* p = n->function_def.parameters;
-            while (p) {
-                fputs(", ", ctx->output);
-                fputs(codegen_type_to_c(p->type), ctx->output);
-                fputc(' ', ctx->output);
-                fputs(p->name, ctx->output);
-                p = p->next;
-            }
-            fputs(") {\n", ctx->output);
+static void codegen_matrix_runtime(CodeGenContext* ctx) {
+    fputs("#define MATHC_ALIGN 64\n", ctx->output);
+    // Bloco alinhado: cabeçalho ocupa os primeiros MATHC_ALIGN bytes, dados (zerados se pedido) em seguida
+    fputs("static void* mathc_matrix_block(int rows, int cols, size_t elem, int* stride, int zero) {\n", ctx->output);
+    fputs("    if (rows < 0 || cols < 0) { fprintf(stderr, \"Erro: dimensões inválidas %dx%d\\n\", rows, cols); exit(1); }\n", ctx->output);
+    fputs("    size_t per_line = elem < MATHC_ALIGN ? MATHC_ALIGN / elem : 1;\n", ctx->output);
+    fputs("    *stride = (int)(((size_t)cols + per_line - 1) / per_line * per_line);\n", ctx->output);
+    fputs("    size_t bytes = MATHC_ALIGN + elem * (size_t)rows * (size_t)*stride;\n", ctx->output);
+    fputs("    bytes = (bytes + MATHC_ALIGN - 1) / MATHC_ALIGN * MATHC_ALIGN;\n", ctx->output);
+    fputs("    void* block = aligned_alloc(MATHC_ALIGN, bytes);\n", ctx->output);
+    fputs("    if (!block) { fprintf(stderr, \"Erro: memória insuficiente para matriz %dx%d\\n\", rows, cols); exit(1); }\n", ctx->output);
+    fputs("    if (zero) memset(block, 0, bytes);\n", ctx->output);
+    fputs("    return block;\n", ctx->output);
+    fputs("}\n", ctx->output);
 
-            ctx->indent_level++;
-            NodeList* b = n->function_def.body;
-            while (b) {
-                if (b->node) codegen_statement(ctx, b->node);
-                b = b->next;
-            }
-            ctx->indent_level--;
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) {
+        const char* n = matrix_kinds[i].suffix;
+        const char* t = matrix_kinds[i].c_type;
+        fprintf(ctx->output, "typedef struct mathc_matrix_%s { int rows; int cols; int stride; %s* data; } mathc_matrix_%s;\n", n, t, n);
+        // _raw deixa o conteúdo indefinido, para quem vai sobrescrever todos os elementos
+        fprintf(ctx->output, "static mathc_matrix_%s* mathc_matrix_alloc_%s(int rows, int cols, int zero) {\n", n, n);
+        fprintf(ctx->output, "    int stride; mathc_matrix_%s* m = mathc_matrix_block(rows, cols, sizeof(%s), &stride, zero);\n", n, t);
+        fprintf(ctx->output, "    m->rows = rows; m->cols = cols; m->stride = stride; m->data = (%s*)((char*)m + MATHC_ALIGN);\n", t);
+        fputs("    return m;\n", ctx->output);
+        fputs("}\n", ctx->output);
+        fprintf(ctx->output, "static mathc_matrix_%s* mathc_matrix_new_%s(int rows, int cols) { return mathc_matrix_alloc_%s(rows, cols, 1); }\n", n, n, n);
+        fprintf(ctx->output, "static mathc_matrix_%s* mathc_matrix_raw_%s(int rows, int cols) { return mathc_matrix_alloc_%s(rows, cols, 0); }\n", n, n, n);
+    }
+    fputs("\n", ctx->output);
+}
+
+/* Impressão no formato [[a, b], [c, d]]; emitida depois das funções mathc_print_* */
+static void codegen_matrix_print_runtime(CodeGenContext* ctx) {
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) {
+        const char* n = matrix_kinds[i].suffix;
+        fprintf(ctx->output, "void mathc_print_matrix_%s(mathc_matrix_%s* m) {\n", n, n);
+        fputs("    mathc_out_char('[');\n", ctx->output);
+        fputs("    for (int i = 0; m && i < m->rows; i++) {\n", ctx->output);
+        fputs("        if (i > 0) mathc_out_write(\", \", 2);\n", ctx->output);
+        fputs("        mathc_out_char('[');\n", ctx->output);
+        fputs("        for (int j = 0; j < m->cols; j++) {\n", ctx->output);
+        fputs("            if (j > 0) mathc_out_write(\", \", 2);\n", ctx->output);
+        fprintf(ctx->output, "            mathc_print_%s(m->data[i * m->stride + j]);\n", n);
+        fputs("        }\n", ctx->output);
+        fputs("        mathc_out_char(']');\n", ctx->output);
+        fputs("    }\n", ctx->output);
+        fputs("    mathc_out_char(']');\n", ctx->output);
+        fputs("}\n", ctx->output);
+        fprintf(ctx->output, "void mathc_println_matrix_%s(mathc_matrix_%s* m) { mathc_print_matrix_%s(m); mathc_out_newline(); }\n", n, n, n);
+    }
+    fputs("\n", ctx->output);
+}
+
+/* Emite um trecho do runtime trocando cada $<letra de keys> pelo valor correspondente */
+static void codegen_emit_subst(CodeGenContext* ctx, const char* tmpl, const char* keys, const char* const* values) {
+    for (const char* c = tmpl; *c; c++) {
+        const char* key = c[0] == '$' && c[1] ? strchr(keys, c[1]) : NULL;
+        if (key) { fputs(values[key - keys], ctx->output); c++; }
+        else fputc(*c, ctx->output);
+    }
+}
+
+/*
+ * Runtime de matrizes: $N sufixo (int, float, ...), $T tipo C, $A tipo de
+ * acumulação e $F função de módulo
+ */
+static void codegen_emit_template(CodeGenContext* ctx, const char* tmpl, const MatrixKind* k) {
+    const char* values[] = { k->suffix, k->c_type, k->acc_type, k->abs_fn };
+    codegen_emit_subst(ctx, tmpl, "NTAF", values);
+}
+
+/* ========================================================================== */
+/* ENTRADA (input / input_array / input_matrix) */
+/* ========================================================================== */
+/*
+ * stdin é lido com read() em blocos de MATHC_IN_SIZE bytes. Números são
+ * palavras separadas por espaços ou quebras de linha, convertidas à mão no
+ * próprio buffer: inteiros dígito a dígito e floats com até 19 dígitos
+ * significativos em um inteiro de 64 bits; se a mantissa cabe em 53 bits e o
+ * expoente decimal em |e| <= 22, uma única multiplicação ou divisão por 10^e
+ * (exata) dá o double correto. O resto (mais dígitos, inf, nan, hexadecimal)
+ * vai para strtod. input_array(n) e input_matrix(l, c) preenchem o bloco
+ * contíguo direto, sem uma chamada por elemento no código gerado.
+ *
+ * input() de string lê o resto da linha atual. As linhas ficam em blocos de
+ * MATHC_IN_SIZE bytes que vivem até o fim do programa (string não tem dono
+ * no código gerado), em vez de um malloc por chamada.
+ */
+
+/* Conversão de uma palavra (s, n) sem terminador: usada por input e pelos leitores de arquivo */
+static const char* number_parse_runtime =
+    "static long long mathc_parse_ll(const char* s, int n) {\n"
+    "    int i = 0, neg = 0;\n"
+    "    if (n > 0 && (s[0] == '-' || s[0] == '+')) neg = s[i++] == '-';\n"
+    "    unsigned long long v = 0;\n"
+    "    while (i < n && (unsigned)(s[i] - '0') < 10) v = v * 10 + (unsigned)(s[i++] - '0');\n"
+    "    return (long long)(neg ? 0 - v : v);\n"
+    "}\n"
+    "static const double mathc_pow10_exact[23] = {\n"
+    "    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,\n"
+    "    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22\n"
+    "};\n"
+    "static double mathc_parse_double_slow(const char* s, int n) {\n"
+    "    char tmp[64];\n"
+    "    char* t = n < (int)sizeof(tmp) ? tmp : malloc((size_t)n + 1);\n"
+    "    if (!t) return 0.0;\n"
+    "    memcpy(t, s, (size_t)n);\n"
+    "    t[n] = 0;\n"
+    "    double x = strtod(t, NULL);\n"
+    "    if (t != tmp) free(t);\n"
+    "    return x;\n"
+    "}\n"
+    "static inline double mathc_parse_double(const char* s, int n) {\n"
+    "    int i = 0, neg = 0, digits = 0, exp10 = 0, exact = 1, any = 0;\n"
+    "    if (n > 0 && (s[0] == '-' || s[0] == '+')) neg = s[i++] == '-';\n"
+    "    unsigned long long m = 0;\n"
+    "    for (; i < n && (unsigned)(s[i] - '0') < 10; i++, any = 1) {\n"
+    "        if (digits < 19) { m = m * 10 + (unsigned)(s[i] - '0'); digits += m != 0; }\n"
+    "        else { exp10++; exact &= s[i] == '0'; }\n"
+    "    }\n"
+    "    if (i < n && s[i] == '.') {\n"
+    "        for (i++; i < n && (unsigned)(s[i] - '0') < 10; i++, any = 1) {\n"
+    "            if (digits < 19) { m = m * 10 + (unsigned)(s[i] - '0'); digits += m != 0; exp10--; }\n"
+    "            else exact &= s[i] == '0';\n"
+    "        }\n"
+    "    }\n"
+    "    if (any && i < n && (s[i] == 'e' || s[i] == 'E')) {\n"
+    "        int j = i + 1, eneg = 0, e = 0;\n"
+    "        if (j < n && (s[j] == '-' || s[j] == '+')) eneg = s[j++] == '-';\n"
+    "        if (j < n && (unsigned)(s[j] - '0') < 10) {\n"
+    "            for (; j < n && (unsigned)(s[j] - '0') < 10; j++) if (e < 100000) e = e * 10 + (s[j] - '0');\n"
+    "            exp10 += eneg ? -e : e;\n"
+    "            i = j;\n"
+    "        }\n"
+    "    }\n"
+    "    // Mantissa e 10^|e| exatos em double: uma única operação arredondada\n"
+    "    if (any && i == n && exact && m <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {\n"
+    "        double x = (double)m;\n"
+    "        x = exp10 < 0 ? x / mathc_pow10_exact[-exp10] : x * mathc_pow10_exact[exp10];\n"
+    "        return neg ? -x : x;\n"
+    "    }\n"
+    "#if defined(__x86_64__) && LDBL_MANT_DIG == 64\n"
+    "    // Até 19 dígitos: o produto em long double (64 bits de mantissa) só arredonda\n"
+    "    // errado para double se cair a menos de 1 ulp do ponto médio entre dois doubles\n"
+    "    if (any && i == n && exact && m != 0 && exp10 >= -27 && exp10 <= 27) {\n"
+    "        long double p = 1.0L, b = 10.0L;\n"
+    "        for (int e = exp10 < 0 ? -exp10 : exp10; e; e >>= 1, b *= b) if (e & 1) p *= b;\n"
+    "        long double x = exp10 < 0 ? (long double)m / p : (long double)m * p;\n"
+    "        unsigned long long bits;\n"
+    "        memcpy(&bits, &x, sizeof(bits));\n"
+    "        unsigned low = (unsigned)(bits & 0x7FF);\n"
+    "        if (low < 0x3FF || low > 0x401) return neg ? -(double)x : (double)x;\n"
+    "    }\n"
+    "#endif\n"
+    "    return mathc_parse_double_slow(s, n);\n"
+    "}\n";
+
+static const char* input_runtime =
+    "static char mathc_in_buf[MATHC_IN_SIZE];\n"
+    "static int mathc_in_pos = 0, mathc_in_len = 0, mathc_in_eof = 0;\n"
+    "/* Move o que falta ler para o início e completa o buffer; 0 se não veio nada */\n"
+    "static int mathc_in_fill(void) {\n"
+    "    int rest = mathc_in_len - mathc_in_pos;\n"
+    "    if (mathc_in_pos > 0) memmove(mathc_in_buf, mathc_in_buf + mathc_in_pos, (size_t)rest);\n"
+    "    mathc_in_pos = 0;\n"
+    "    mathc_in_len = rest;\n"
+    "    if (mathc_in_eof || rest == MATHC_IN_SIZE) return 0;\n"
+    "    mathc_out_sync();\n"
+    "    ssize_t n;\n"
+    "    do n = read(STDIN_FILENO, mathc_in_buf + rest, (size_t)(MATHC_IN_SIZE - rest)); while (n < 0 && errno == EINTR);\n"
+    "    if (n <= 0) { mathc_in_eof = 1; return 0; }\n"
+    "    mathc_in_len += (int)n;\n"
+    "    return 1;\n"
+    "}\n"
+    "/* Próxima palavra, inteira no buffer: devolve o tamanho (0 no fim da entrada) e o início em *s */\n"
+    "static inline int mathc_in_token(const char** s) {\n"
+    "    for (;;) {\n"
+    "        while (mathc_in_pos < mathc_in_len && (unsigned char)mathc_in_buf[mathc_in_pos] <= ' ') mathc_in_pos++;\n"
+    "        if (mathc_in_pos < mathc_in_len) break;\n"
+    "        if (!mathc_in_fill()) { *s = mathc_in_buf; return 0; }\n"
+    "    }\n"
+    "    int end = mathc_in_pos;\n"
+    "    for (;;) {\n"
+    "        while (end < mathc_in_len && (unsigned char)mathc_in_buf[end] > ' ') end++;\n"
+    "        if (end < mathc_in_len || mathc_in_eof) break;\n"
+    "        int off = end - mathc_in_pos;  // a palavra continua no próximo bloco\n"
+    "        int more = mathc_in_fill();\n"
+    "        end = mathc_in_pos + off;\n"
+    "        if (!more) break;\n"
+    "    }\n"
+    "    *s = mathc_in_buf + mathc_in_pos;\n"
+    "    int n = end - mathc_in_pos;\n"
+    "    mathc_in_pos = end;\n"
+    "    return n;\n"
+    "}\n"
+    "\n"
+    "/* Linhas lidas por input() de string: blocos que vivem até o fim do programa */\n"
+    "typedef struct mathc_in_chunk { struct mathc_in_chunk* next; size_t used, cap; char data[]; } mathc_in_chunk;\n"
+    "static mathc_in_chunk* mathc_in_strings = NULL;\n"
+    "static char* mathc_in_line = NULL;\n"
+    "static size_t mathc_in_line_cap = 0;\n"
+    "static char* mathc_in_keep(const char* s, size_t n) {\n"
+    "    mathc_in_chunk* c = mathc_in_strings;\n"
+    "    if (!c || c->cap - c->used < n + 1) {\n"
+    "        size_t cap = n + 1 > MATHC_IN_SIZE ? n + 1 : MATHC_IN_SIZE;\n"
+    "        c = malloc(sizeof(mathc_in_chunk) + cap);\n"
+    "        if (!c) { fprintf(stderr, \"Erro: memória insuficiente para string lida\\n\"); exit(1); }\n"
+    "        c->next = mathc_in_strings; c->used = 0; c->cap = cap;\n"
+    "        mathc_in_strings = c;\n"
+    "    }\n"
+    "    char* p = c->data + c->used;\n"
+    "    memcpy(p, s, n);\n"
+    "    p[n] = 0;\n"
+    "    c->used += n + 1;\n"
+    "    return p;\n"
+    "}\n"
+    "\n"
+    "int mathc_input_int(void) { const char* s; int n = mathc_in_token(&s); return (int)mathc_parse_ll(s, n); }\n"
+    "double mathc_input_float(void) { const char* s; int n = mathc_in_token(&s); return n ? mathc_parse_double(s, n) : 0.0; }\n"
+    "char mathc_input_char(void) {\n"
+    "    for (;;) {\n"
+    "        while (mathc_in_pos < mathc_in_len && (unsigned char)mathc_in_buf[mathc_in_pos] <= ' ') mathc_in_pos++;\n"
+    "        if (mathc_in_pos < mathc_in_len) return mathc_in_buf[mathc_in_pos++];\n"
+    "        if (!mathc_in_fill()) return 0;\n"
+    "    }\n"
+    "}\n"
+    "/* Resto da linha atual, sem o \\n (e sem o \\r de um \\r\\n) */\n"
+    "char* mathc_input_string(void) {\n"
+    "    size_t n = 0;\n"
+    "    for (;;) {\n"
+    "        const char* start = mathc_in_buf + mathc_in_pos;\n"
+    "        const char* nl = memchr(start, '\\n', (size_t)(mathc_in_len - mathc_in_pos));\n"
+    "        size_t k = nl ? (size_t)(nl - start) : (size_t)(mathc_in_len - mathc_in_pos);\n"
+    "        if (n + k + 1 > mathc_in_line_cap) {\n"
+    "            mathc_in_line_cap = (n + k + 1) * 2;\n"
+    "            mathc_in_line = realloc(mathc_in_line, mathc_in_line_cap);\n"
+    "            if (!mathc_in_line) { fprintf(stderr, \"Erro: memória insuficiente para string lida\\n\"); exit(1); }\n"
+    "        }\n"
+    "        memcpy(mathc_in_line + n, start, k);\n"
+    "        n += k;\n"
+    "        mathc_in_pos += (int)k;\n"
+    "        if (nl) { mathc_in_pos++; break; }\n"
+    "        if (!mathc_in_fill()) break;\n"
+    "    }\n"
+    "    if (n > 0 && mathc_in_line[n - 1] == '\\r') n--;\n"
+    "    return mathc_in_keep(n ? mathc_in_line : \"\", n);\n"
+    "}\n";
+
+/* input_array / input_matrix: $N sufixo, $T tipo C e $P conversor da palavra */
+static const char* input_fill_template =
+    "static void mathc_input_fill_$N($T* v, int n) {\n"
+    "    for (int i = 0; i < n; i++) {\n"
+    "        const char* s;\n"
+    "        int k = mathc_in_token(&s);\n"
+    "        v[i] = ($T)$P(s, k);\n"
+    "    }\n"
+    "}\n"
+    "static $T* mathc_input_array_$N(int n, int* out_len) {\n"
+    "    if (n < 0) n = 0;\n"
+    "    $T* v = malloc(sizeof($T) * (size_t)(n > 0 ? n : 1));\n"
+    "    if (!v) { fprintf(stderr, \"Erro: memória insuficiente para %d elementos\\n\", n); exit(1); }\n"
+    "    mathc_input_fill_$N(v, n);\n"
+    "    if (out_len) *out_len = n;\n"
+    "    return v;\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_input_matrix_$N(int rows, int cols) {\n"
+    "    mathc_matrix_$N* m = mathc_matrix_raw_$N(rows, cols);\n"
+    "    for (int i = 0; i < rows; i++) mathc_input_fill_$N(m->data + (size_t)i * m->stride, cols);\n"
+    "    return m;\n"
+    "}\n";
+
+static const char* input_builtins[] = { "input", "input_array", "input_matrix", NULL };
+
+static void codegen_number_parse_runtime(CodeGenContext* ctx) {
+    fputs("#include <errno.h>\n", ctx->output);
+    fputs("#include <float.h>\n", ctx->output);
+    fputs(number_parse_runtime, ctx->output);
+}
+
+static void codegen_input_runtime(CodeGenContext* ctx) {
+    fputs("#define MATHC_IN_SIZE (1 << 16)  // bytes pedidos a cada read de stdin\n", ctx->output);
+    fputs(input_runtime, ctx->output);
+    const char* int_values[] = { "int", "int", "mathc_parse_ll" };
+    const char* float_values[] = { "float", "double", "mathc_parse_double" };
+    codegen_emit_subst(ctx, input_fill_template, "NTP", int_values);
+    codegen_emit_subst(ctx, input_fill_template, "NTP", float_values);
+    fputs("\n", ctx->output);
+}
+
+/* input(), input_array(n), input_matrix(l, c), os read_* e load_npy adotam o tipo da variável que recebem */
+static void codegen_input_context(ASTNode* init, TypeSpec* target) {
+    static const char* matrix_readers[] = { "input_matrix", "read_matrix", "read_csv", NULL };
+    const char* name = codegen_call_name(init);
+    if (!name || !target) return;
+    if (strcmp(name, "load_npy") == 0) {
+        if (target->base_type == TYPE_ARRAY || codegen_is_matrix_type(target)) init->inferred_type = target;
+        return;
+    }
+    if (!escape_in_list(input_builtins, name) && strcmp(name, "read_array") != 0 &&
+        !escape_in_list(matrix_readers, name)) return;
+    if (strcmp(name, "input") == 0) {
+        if (target->base_type == TYPE_INT || target->base_type == TYPE_FLOAT || target->base_type == TYPE_BOOL ||
+            target->base_type == TYPE_CHAR || target->base_type == TYPE_STRING) init->inferred_type = target;
+    } else if (escape_in_list(matrix_readers, name)) {
+        if (codegen_is_matrix_type(target)) init->inferred_type = target;
+    } else if (target->base_type == TYPE_ARRAY && !codegen_is_matrix_type(target)) {
+        init->inferred_type = target;
+    }
+}
+
+/* Sufixo do runtime de input_array/input_matrix para o tipo de elemento; NULL se não houver */
+static const char* codegen_input_suffix(TypeSpec* elem) {
+    if (!elem) return NULL;
+    if (elem->base_type == TYPE_INT) return "int";
+    if (elem->base_type == TYPE_FLOAT) return "float";
+    return NULL;
+}
+
+/* ========================================================================== */
+/* ARQUIVOS DE NÚMEROS (read_array / read_matrix / read_csv) */
+/* ========================================================================== */
+/*
+ * O arquivo é mapeado com mmap (pipes e dispositivos são lidos inteiros para
+ * um bloco) e percorrido em duas passadas, cada uma dividida em trechos de
+ * pelo menos MATHC_SCAN_MIN bytes entre as threads do runtime. Os trechos
+ * terminam em fim de linha (num vetor basta um separador). A primeira
+ * passada só conta as palavras de cada trecho: com SSE2, 64 bytes viram uma
+ * máscara de separadores (espaço, controle, ',' e ';') e as palavras são os
+ * bits de não separador precedidos de separador (popcount). A soma de
+ * prefixos dá a posição de cada trecho no resultado, e a segunda passada
+ * converte as palavras direto no vetor ou na matriz (respeitando o stride).
+ *
+ * Em read_matrix cada linha não vazia é uma linha da matriz e todas precisam
+ * ter o mesmo número de valores; read_csv é igual, mas pula a primeira linha
+ * quando ela tem alguma palavra que não é número (cabeçalho).
+ */
+
+/* Conteúdo de um arquivo: mapeado com mmap, ou lido inteiro para o heap */
+static const char* file_view_runtime =
+    "typedef struct mathc_file_view { const char* data; size_t size; int mapped; } mathc_file_view;\n"
+    "static mathc_file_view mathc_file_open(const char* path) {\n"
+    "    mathc_file_view f = { NULL, 0, 0 };\n"
+    "    int fd = path ? open(path, O_RDONLY) : -1;\n"
+    "    if (fd < 0) { fprintf(stderr, \"Erro: não foi possível abrir '%s'\\n\", path ? path : \"(null)\"); exit(1); }\n"
+    "    struct stat st;\n"
+    "    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {\n"
+    "        f.size = (size_t)st.st_size;\n"
+    "        if (f.size == 0) { close(fd); return f; }\n"
+    "        // Privado e gravável: alterar um vetor sobre o mapeamento não altera o arquivo\n"
+    "        void* p = mmap(NULL, f.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);\n"
+    "        if (p != MAP_FAILED) {\n"
+    "            madvise(p, f.size, MADV_WILLNEED);\n"
+    "            close(fd);\n"
+    "            f.data = (const char*)p;\n"
+    "            f.mapped = 1;\n"
+    "            return f;\n"
+    "        }\n"
+    "    }\n"
+    "    // Pipe, dispositivo ou mmap recusado: lê tudo para um bloco que dobra\n"
+    "    size_t cap = 1 << 16, len = 0;\n"
+    "    char* buf = malloc(cap);\n"
+    "    for (;;) {\n"
+    "        if (!buf) { fprintf(stderr, \"Erro: memória insuficiente para '%s'\\n\", path); exit(1); }\n"
+    "        if (len == cap) { char* nb = realloc(buf, cap * 2); if (!nb) free(buf); buf = nb; cap *= 2; continue; }\n"
+    "        ssize_t n = read(fd, buf + len, cap - len);\n"
+    "        if (n < 0 && errno == EINTR) continue;\n"
+    "        if (n <= 0) break;\n"
+    "        len += (size_t)n;\n"
+    "    }\n"
+    "    close(fd);\n"
+    "    f.data = buf;\n"
+    "    f.size = len;\n"
+    "    return f;\n"
+    "}\n"
+    "static void mathc_file_close(mathc_file_view f) {\n"
+    "    if (f.mapped) munmap((void*)f.data, f.size);\n"
+    "    else free((void*)f.data);\n"
+    "}\n";
+
+static const char* files_runtime =
+    "#define MATHC_SCAN_SEP(c) ((unsigned char)(c) <= ' ' || (c) == ',' || (c) == ';')\n"
+    "/* Palavras em [p, end), que começa logo depois de um separador */\n"
+    "static long long mathc_scan_count(const char* p, const char* end) {\n"
+    "    long long n = 0;\n"
+    "    unsigned long long prev = 1;\n"
+    "#ifdef __SSE2__\n"
+    "    const __m128i k20 = _mm_set1_epi8(' '), kc = _mm_set1_epi8(','), ks = _mm_set1_epi8(';');\n"
+    "    for (; end - p >= 64; p += 64) {\n"
+    "        unsigned long long sep = 0;\n"
+    "        for (int j = 0; j < 4; j++) {\n"
+    "            __m128i v = _mm_loadu_si128((const __m128i*)(p + 16 * j));\n"
+    "            __m128i s = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, k20), k20),  // v <= ' ' sem sinal\n"
+    "                                     _mm_or_si128(_mm_cmpeq_epi8(v, kc), _mm_cmpeq_epi8(v, ks)));\n"
+    "            sep |= (unsigned long long)(unsigned)_mm_movemask_epi8(s) << (16 * j);\n"
+    "        }\n"
+    "        n += __builtin_popcountll(~sep & ((sep << 1) | prev));\n"
+    "        prev = sep >> 63;\n"
+    "    }\n"
+    "#endif\n"
+    "    for (; p < end; p++) {\n"
+    "        unsigned long long s = MATHC_SCAN_SEP(*p);\n"
+    "        n += !s & prev;\n"
+    "        prev = s;\n"
+    "    }\n"
+    "    return n;\n"
+    "}\n"
+    "/* Palavras da primeira linha não vazia a partir de p */\n"
+    "static int mathc_scan_first_row(const char* p, const char* end) {\n"
+    "    int n = 0;\n"
+    "    for (; p < end; p++) {\n"
+    "        if (*p == '\\n') { if (n) break; continue; }\n"
+    "        if (MATHC_SCAN_SEP(*p)) continue;\n"
+    "        n++;\n"
+    "        while (p + 1 < end && !MATHC_SCAN_SEP(p[1])) p++;\n"
+    "    }\n"
+    "    return n;\n"
+    "}\n"
+    "static int mathc_scan_is_number(const char* s, int n) {\n"
+    "    char tmp[64], *e;\n"
+    "    if (n <= 0 || n >= (int)sizeof(tmp)) return 0;\n"
+    "    memcpy(tmp, s, (size_t)n);\n"
+    "    tmp[n] = 0;\n"
+    "    strtod(tmp, &e);\n"
+    "    return e == tmp + n;\n"
+    "}\n"
+    "/* read_csv: pula a primeira linha se alguma palavra dela não for número */\n"
+    "static const char* mathc_scan_skip_header(const char* p, const char* end) {\n"
+    "    const char* nl = memchr(p, '\\n', (size_t)(end - p));\n"
+    "    const char* stop = nl ? nl : end;\n"
+    "    for (const char* q = p; q < stop; ) {\n"
+    "        if (MATHC_SCAN_SEP(*q)) { q++; continue; }\n"
+    "        const char* s = q;\n"
+    "        while (q < stop && !MATHC_SCAN_SEP(*q)) q++;\n"
+    "        if (!mathc_scan_is_number(s, (int)(q - s))) return nl ? nl + 1 : end;\n"
+    "    }\n"
+    "    return p;\n"
+    "}\n"
+    "\n"
+    "typedef struct mathc_scan_task {\n"
+    "    const char* p; const char* end;\n"
+    "    long long count;  // palavras do trecho (primeira passada)\n"
+    "    long long first;  // índice da primeira palavra do trecho no arquivo\n"
+    "    void* out;\n"
+    "    long long rows;   // 0 para vetor\n"
+    "    int cols, stride;\n"
+    "    int bad;          // linha com quantidade errada de valores\n"
+    "} mathc_scan_task;\n"
+    "static void* mathc_scan_count_task(void* arg) {\n"
+    "    mathc_scan_task* t = (mathc_scan_task*)arg;\n"
+    "    t->count = mathc_scan_count(t->p, t->end);\n"
+    "    return NULL;\n"
+    "}\n"
+    "/* Divide [p, end) em até MATHC_NUM_THREADS trechos que terminam em fim de linha (lines) ou em separador */\n"
+    "static int mathc_scan_split(const char* p, const char* end, mathc_scan_task* tasks, int lines) {\n"
+    "    size_t size = (size_t)(end - p);\n"
+    "    int nt = mathc_num_threads();\n"
+    "    if ((size_t)nt > size / MATHC_SCAN_MIN) nt = (int)(size / MATHC_SCAN_MIN);\n"
+    "    if (nt < 1) nt = 1;\n"
+    "    int used = 0;\n"
+    "    const char* start = p;\n"
+    "    for (int i = 1; i <= nt && start < end; i++) {\n"
+    "        const char* stop = end;\n"
+    "        if (i < nt) {\n"
+    "            stop = p + size / (size_t)nt * (size_t)i;\n"
+    "            if (stop < start) stop = start;\n"
+    "            if (lines) {\n"
+    "                const char* nl = memchr(stop, '\\n', (size_t)(end - stop));\n"
+    "                stop = nl ? nl + 1 : end;\n"
+    "            } else {\n"
+    "                while (stop < end && !MATHC_SCAN_SEP(*stop)) stop++;\n"
+    "            }\n"
+    "        }\n"
+    "        memset(&tasks[used], 0, sizeof(tasks[used]));\n"
+    "        tasks[used].p = start;\n"
+    "        tasks[used].end = stop;\n"
+    "        used++;\n"
+    "        start = stop;\n"
+    "    }\n"
+    "    return used;\n"
+    "}\n"
+    "/* Primeira passada e soma de prefixos: devolve o total de palavras */\n"
+    "static long long mathc_scan_plan(mathc_scan_task* tasks, int nt) {\n"
+    "    mathc_parallel_run(mathc_scan_count_task, tasks, sizeof(tasks[0]), nt);\n"
+    "    long long total = 0;\n"
+    "    for (int t = 0; t < nt; t++) { tasks[t].first = total; total += tasks[t].count; }\n"
+    "    return total;\n"
+    "}\n";
+
+/* $N sufixo, $T tipo C e $P conversor da palavra */
+static const char* files_template =
+    "static void* mathc_scan_parse_$N(void* arg) {\n"
+    "    mathc_scan_task* t = (mathc_scan_task*)arg;\n"
+    "    const char* p = t->p;\n"
+    "    const char* end = t->end;\n"
+    "    $T* out = ($T*)t->out;\n"
+    "    long long k = t->first;\n"
+    "    int cols = t->cols, col = 0, bad = 0;\n"
+    "    long long row = cols ? k / cols : 0;\n"
+    "    if (cols && k % cols) bad = 1;\n"
+    "    while (p < end) {\n"
+    "        if (MATHC_SCAN_SEP(*p)) {\n"
+    "            if (*p == '\\n' && col) { bad |= col != cols; row++; col = 0; }\n"
+    "            p++;\n"
+    "            continue;\n"
+    "        }\n"
+    "        const char* s = p;\n"
+    "        while (p < end && !MATHC_SCAN_SEP(*p)) p++;\n"
+    "        $T x = ($T)$P(s, (int)(p - s));\n"
+    "        if (!cols) out[k++] = x;\n"
+    "        else if (col < cols && row < t->rows) out[row * t->stride + col++] = x;\n"
+    "        else bad = 1;\n"
+    "    }\n"
+    "    if (col) bad |= col != cols;\n"
+    "    t->bad = bad;\n"
+    "    return NULL;\n"
+    "}\n"
+    "static $T* mathc_read_array_$N(const char* path, int* out_len) {\n"
+    "    mathc_file_view f = mathc_file_open(path);\n"
+    "    mathc_scan_task tasks[MATHC_MAX_THREADS];\n"
+    "    int nt = mathc_scan_split(f.data, f.data + f.size, tasks, 0);\n"
+    "    long long total = mathc_scan_plan(tasks, nt);\n"
+    "    if (total > 2147483647LL) { fprintf(stderr, \"Erro: '%s' tem valores demais para um vetor\\n\", path); exit(1); }\n"
+    "    $T* v = malloc(sizeof($T) * (size_t)(total > 0 ? total : 1));\n"
+    "    if (!v) { fprintf(stderr, \"Erro: memória insuficiente para %lld elementos\\n\", total); exit(1); }\n"
+    "    for (int t = 0; t < nt; t++) tasks[t].out = v;\n"
+    "    mathc_parallel_run(mathc_scan_parse_$N, tasks, sizeof(tasks[0]), nt);\n"
+    "    mathc_file_close(f);\n"
+    "    if (out_len) *out_len = (int)total;\n"
+    "    return v;\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_read_matrix_$N(const char* path, int csv) {\n"
+    "    mathc_file_view f = mathc_file_open(path);\n"
+    "    const char* p = f.data;\n"
+    "    const char* end = f.data + f.size;\n"
+    "    if (csv && p) p = mathc_scan_skip_header(p, end);\n"
+    "    int cols = p ? mathc_scan_first_row(p, end) : 0;\n"
+    "    mathc_scan_task tasks[MATHC_MAX_THREADS];\n"
+    "    int nt = p ? mathc_scan_split(p, end, tasks, 1) : 0;\n"
+    "    long long total = mathc_scan_plan(tasks, nt);\n"
+    "    int bad = cols && total % cols != 0;\n"
+    "    long long rows = cols && !bad ? total / cols : 0;\n"
+    "    if ((double)rows * cols > 2147483647.0) {\n"
+    "        fprintf(stderr, \"Erro: '%s' tem valores demais para uma matriz\\n\", path);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    mathc_matrix_$N* m = mathc_matrix_raw_$N((int)rows, cols);\n"
+    "    for (int t = 0; t < nt; t++) {\n"
+    "        tasks[t].out = m->data; tasks[t].rows = rows; tasks[t].cols = cols; tasks[t].stride = m->stride;\n"
+    "    }\n"
+    "    if (!bad) mathc_parallel_run(mathc_scan_parse_$N, tasks, sizeof(tasks[0]), nt);\n"
+    "    for (int t = 0; t < nt; t++) bad |= tasks[t].bad;\n"
+    "    mathc_file_close(f);\n"
+    "    if (bad) {\n"
+    "        fprintf(stderr, \"Erro: as linhas de '%s' não têm todas %d valores\\n\", path, cols);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    return m;\n"
+    "}\n";
+
+static const char* file_builtins[] = { "read_array", "read_matrix", "read_csv", NULL };
+
+static void codegen_file_view_runtime(CodeGenContext* ctx) {
+    fputs("#include <errno.h>\n", ctx->output);
+    fputs("#include <fcntl.h>\n", ctx->output);
+    fputs("#include <sys/mman.h>\n", ctx->output);
+    fputs("#include <sys/stat.h>\n", ctx->output);
+    fputs(file_view_runtime, ctx->output);
+}
+
+static void codegen_files_runtime(CodeGenContext* ctx) {
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("#include <emmintrin.h>\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("#define MATHC_SCAN_MIN (1 << 20)  // bytes mínimos por thread\n", ctx->output);
+    fputs(files_runtime, ctx->output);
+    const char* int_values[] = { "int", "int", "mathc_parse_ll" };
+    const char* float_values[] = { "float", "double", "mathc_parse_double" };
+    codegen_emit_subst(ctx, files_template, "NTP", int_values);
+    codegen_emit_subst(ctx, files_template, "NTP", float_values);
+    fputs("\n", ctx->output);
+}
+
+/* ========================================================================== */
+/* ARQUIVOS .npy (load_npy / save_npy) */
+/* ========================================================================== */
+/*
+ * Formato binário do NumPy: assinatura, um dicionário Python em texto com
+ * descr, fortran_order e shape, e os elementos em seguida. load_npy mapeia o
+ * arquivo e, se o dtype é o do destino (<f8 para float, <i4 para int), a
+ * ordem é C e os dados estão alinhados, o vetor ou a matriz aponta direto
+ * para o mapeamento (privado: alterações não chegam ao arquivo). Numa
+ * matriz o alinhamento exige dados em múltiplo de MATHC_ALIGN e cols múltiplo
+ * dos elementos de uma linha de cache, para que stride == cols. Nos outros
+ * casos (outro dtype, ordem Fortran, pipe) os elementos são convertidos para
+ * um bloco novo.
+ *
+ * Um vetor mapeado tem capacidade 0 (emprestado: o primeiro add copia) e é
+ * liberado por mathc_npy_release, que desfaz o mapeamento; uma matriz
+ * mapeada guarda o mapeamento depois do cabeçalho. save_npy escreve o
+ * cabeçalho (versão 1.0, alinhado a 64 bytes) e os dados com um único writev,
+ * ou num único bloco quando as linhas da matriz têm preenchimento.
+ */
+
+static const char* npy_runtime =
+    "#include <sys/uio.h>\n"
+    "#include <stdint.h>\n"
+    "typedef struct mathc_npy_header {\n"
+    "    char kind;        // 'f', 'i', 'u' ou 'b'\n"
+    "    int size;         // bytes por elemento\n"
+    "    int fortran;      // ordem de coluna\n"
+    "    int ndim;\n"
+    "    long long shape[8];\n"
+    "    long long count;  // produto de shape\n"
+    "    size_t offset;    // início dos dados no arquivo\n"
+    "} mathc_npy_header;\n"
+    "static void mathc_npy_fail(const char* path, const char* why) {\n"
+    "    fprintf(stderr, \"Erro: '%s' não é um .npy válido (%s)\\n\", path, why);\n"
+    "    exit(1);\n"
+    "}\n"
+    "/* Valor da chave 'name' do dicionário em [d, e), já sem ':' e espaços */\n"
+    "static const char* mathc_npy_key(const char* d, const char* e, const char* name) {\n"
+    "    size_t n = strlen(name);\n"
+    "    for (const char* q = d; q + n + 2 <= e; q++) {\n"
+    "        if ((*q == '\\'' || *q == '\"') && memcmp(q + 1, name, n) == 0 && q[n + 1] == *q) {\n"
+    "            q += n + 2;\n"
+    "            while (q < e && (*q == ' ' || *q == ':')) q++;\n"
+    "            return q < e ? q : NULL;\n"
+    "        }\n"
+    "    }\n"
+    "    return NULL;\n"
+    "}\n"
+    "static mathc_npy_header mathc_npy_parse(const char* path, const char* p, size_t size) {\n"
+    "    mathc_npy_header h;\n"
+    "    memset(&h, 0, sizeof(h));\n"
+    "    if (size < 10 || memcmp(p, \"\\x93NUMPY\", 6) != 0) mathc_npy_fail(path, \"assinatura\");\n"
+    "    const unsigned char* u = (const unsigned char*)p;\n"
+    "    size_t hlen, start;\n"
+    "    if (u[6] == 1) { hlen = u[8] | (size_t)u[9] << 8; start = 10; }\n"
+    "    else if ((u[6] == 2 || u[6] == 3) && size >= 12) { hlen = u[8] | (size_t)u[9] << 8 | (size_t)u[10] << 16 | (size_t)u[11] << 24; start = 12; }\n"
+    "    else mathc_npy_fail(path, \"versão\");\n"
+    "    if (start + hlen > size) mathc_npy_fail(path, \"cabeçalho truncado\");\n"
+    "    const char* d = p + start;\n"
+    "    const char* e = d + hlen;\n"
+    "\n"
+    "    const char* q = mathc_npy_key(d, e, \"descr\");\n"
+    "    if (!q || e - q < 4 || (*q != '\\'' && *q != '\"')) mathc_npy_fail(path, \"descr\");\n"
+    "    char order = q[1];\n"
+    "    h.kind = q[2];\n"
+    "    for (q += 3; q < e && (unsigned)(*q - '0') < 10; q++) h.size = h.size * 10 + (*q - '0');\n"
+    "    int ok = (h.kind == 'f' && (h.size == 4 || h.size == 8)) || (h.kind == 'b' && h.size == 1) ||\n"
+    "             ((h.kind == 'i' || h.kind == 'u') && (h.size == 1 || h.size == 2 || h.size == 4 || h.size == 8));\n"
+    "    if (!ok) mathc_npy_fail(path, \"dtype não suportado\");\n"
+    "#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__\n"
+    "    if (h.size > 1 && order != '>') mathc_npy_fail(path, \"ordem de bytes\");\n"
+    "#else\n"
+    "    if (h.size > 1 && order != '<' && order != '=') mathc_npy_fail(path, \"ordem de bytes\");\n"
+    "#endif\n"
+    "\n"
+    "    q = mathc_npy_key(d, e, \"fortran_order\");\n"
+    "    h.fortran = q && *q == 'T';\n"
+    "    q = mathc_npy_key(d, e, \"shape\");\n"
+    "    if (!q || *q != '(') mathc_npy_fail(path, \"shape\");\n"
+    "    h.count = 1;\n"
+    "    for (q++; q < e && *q != ')'; ) {\n"
+    "        if (*q == ' ' || *q == ',') { q++; continue; }\n"
+    "        if ((unsigned)(*q - '0') >= 10 || h.ndim == 8) mathc_npy_fail(path, \"shape\");\n"
+    "        long long dim = 0;\n"
+    "        for (; q < e && (unsigned)(*q - '0') < 10; q++) dim = dim * 10 + (*q - '0');\n"
+    "        h.shape[h.ndim++] = dim;\n"
+    "        h.count *= dim;\n"
+    "    }\n"
+    "    h.offset = start + hlen;\n"
+    "    if (h.count > (long long)((size - h.offset) / (size_t)h.size)) mathc_npy_fail(path, \"dados truncados\");\n"
+    "    return h;\n"
+    "}\n"
+    "\n"
+    "/* Mapeamentos entregues como vetor: mathc_npy_release desfaz o que reconhece e faz free do resto */\n"
+    "typedef struct mathc_npy_mapping { const void* data; mathc_file_view file; struct mathc_npy_mapping* next; } mathc_npy_mapping;\n"
+    "static mathc_npy_mapping* mathc_npy_maps = NULL;\n"
+    "static void mathc_npy_keep(const void* data, mathc_file_view f) {\n"
+    "    mathc_npy_mapping* m = malloc(sizeof(mathc_npy_mapping));\n"
+    "    if (!m) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    m->data = data; m->file = f; m->next = mathc_npy_maps;\n"
+    "    mathc_npy_maps = m;\n"
+    "}\n"
+    "static void mathc_npy_release(void* p) {\n"
+    "    for (mathc_npy_mapping** it = &mathc_npy_maps; *it; it = &(*it)->next) {\n"
+    "        if ((*it)->data == p) {\n"
+    "            mathc_npy_mapping* m = *it;\n"
+    "            *it = m->next;\n"
+    "            mathc_file_close(m->file);\n"
+    "            free(m);\n"
+    "            return;\n"
+    "        }\n"
+    "    }\n"
+    "    free(p);\n"
+    "}\n"
+    "\n"
+    "/* Cabeçalho versão 1.0; assinatura + dicionário + '\\n' ocupam um múltiplo de 64 bytes */\n"
+    "static size_t mathc_npy_header_text(char* out, const char* descr, int ndim, long long rows, long long cols) {\n"
+    "    char dict[160];\n"
+    "    int n = ndim == 1\n"
+    "        ? snprintf(dict, sizeof(dict), \"{'descr': '%s', 'fortran_order': False, 'shape': (%lld,), }\", descr, rows)\n"
+    "        : snprintf(dict, sizeof(dict), \"{'descr': '%s', 'fortran_order': False, 'shape': (%lld, %lld), }\", descr, rows, cols);\n"
+    "    size_t total = (10 + (size_t)n + 1 + 63) / 64 * 64;\n"
+    "    size_t hlen = total - 10;\n"
+    "    memcpy(out, \"\\x93NUMPY\\x01\\x00\", 8);\n"
+    "    out[8] = (char)(hlen & 0xFF);\n"
+    "    out[9] = (char)(hlen >> 8);\n"
+    "    memcpy(out + 10, dict, (size_t)n);\n"
+    "    memset(out + 10 + n, ' ', hlen - (size_t)n - 1);\n"
+    "    out[total - 1] = '\\n';\n"
+    "    return total;\n"
+    "}\n"
+    "static void mathc_npy_write(const char* path, struct iovec* iov, int cnt) {\n"
+    "    int fd = path ? open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;\n"
+    "    if (fd < 0) { fprintf(stderr, \"Erro: não foi possível criar '%s'\\n\", path ? path : \"(null)\"); exit(1); }\n"
+    "    while (cnt > 0) {\n"
+    "        ssize_t n = writev(fd, iov, cnt);\n"
+    "        if (n < 0 && errno == EINTR) continue;\n"
+    "        if (n < 0) { fprintf(stderr, \"Erro: falha ao escrever '%s'\\n\", path); exit(1); }\n"
+    "        while (cnt > 0 && (size_t)n >= iov->iov_len) { n -= (ssize_t)iov->iov_len; iov++; cnt--; }\n"
+    "        if (cnt > 0) { iov->iov_base = (char*)iov->iov_base + n; iov->iov_len -= (size_t)n; }\n"
+    "    }\n"
+    "    close(fd);\n"
+    "}\n";
+
+/* $N sufixo, $T tipo C, $K tipo do dtype ('f' ou 'i') e $D descr gravado */
+static const char* npy_template =
+    "static $T mathc_npy_elem_$N(const mathc_npy_header* h, const char* data, long long i) {\n"
+    "    const char* s = data + (size_t)i * (size_t)h->size;\n"
+    "    union { double f8; float f4; long long i8; int i4; short i2; signed char i1;\n"
+    "            unsigned long long u8; unsigned u4; unsigned short u2; unsigned char u1; } v;\n"
+    "    memcpy(&v, s, (size_t)h->size);\n"
+    "    switch (h->kind) {\n"
+    "        case 'f': return h->size == 8 ? ($T)v.f8 : ($T)v.f4;\n"
+    "        case 'i': return h->size == 8 ? ($T)v.i8 : h->size == 4 ? ($T)v.i4 : h->size == 2 ? ($T)v.i2 : ($T)v.i1;\n"
+    "        case 'u': return h->size == 8 ? ($T)v.u8 : h->size == 4 ? ($T)v.u4 : h->size == 2 ? ($T)v.u2 : ($T)v.u1;\n"
+    "        default: return ($T)(v.u1 != 0);\n"
+    "    }\n"
+    "}\n"
+    "static $T* mathc_load_npy_array_$N(const char* path, int* out_len, int* out_cap) {\n"
+    "    mathc_file_view f = mathc_file_open(path);\n"
+    "    mathc_npy_header h = mathc_npy_parse(path, f.data, f.size);\n"
+    "    if (h.count > 2147483647LL) mathc_npy_fail(path, \"elementos demais para um vetor\");\n"
+    "    if (h.fortran && h.ndim > 2) mathc_npy_fail(path, \"fortran_order com mais de 2 dimensões\");\n"
+    "    int n = (int)h.count;\n"
+    "    int same = h.kind == '$K' && h.size == (int)sizeof($T);\n"
+    "    int transposed = h.fortran && h.ndim == 2;\n"
+    "    const char* data = f.data + h.offset;\n"
+    "    if (out_len) *out_len = n;\n"
+    "    // Mesmo dtype em ordem C: o vetor é o próprio mapeamento\n"
+    "    if (f.mapped && same && !transposed && n > 0 && h.offset % sizeof($T) == 0) {\n"
+    "        mathc_npy_keep(data, f);\n"
+    "        if (out_cap) *out_cap = 0;\n"
+    "        return ($T*)data;\n"
+    "    }\n"
+    "    $T* v = malloc(sizeof($T) * (size_t)(n > 0 ? n : 1));\n"
+    "    if (!v) { fprintf(stderr, \"Erro: memória insuficiente para %d elementos\\n\", n); exit(1); }\n"
+    "    if (same && !transposed) {\n"
+    "        if (n > 0) memcpy(v, data, sizeof($T) * (size_t)n);\n"
+    "    } else {\n"
+    "        long long rows = transposed ? h.shape[0] : 1, cols = transposed ? h.shape[1] : n;\n"
+    "        for (long long k = 0; k < n; k++) v[k] = mathc_npy_elem_$N(&h, data, transposed ? (k % cols) * rows + k / cols : k);\n"
+    "    }\n"
+    "    mathc_file_close(f);\n"
+    "    if (out_cap) *out_cap = n;\n"
+    "    return v;\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_load_npy_matrix_$N(const char* path) {\n"
+    "    mathc_file_view f = mathc_file_open(path);\n"
+    "    mathc_npy_header h = mathc_npy_parse(path, f.data, f.size);\n"
+    "    if (h.ndim != 2) mathc_npy_fail(path, \"uma matriz precisa de 2 dimensões\");\n"
+    "    long long rows = h.shape[0], cols = h.shape[1];\n"
+    "    if (rows > 2147483647LL || cols > 2147483647LL || h.count > 2147483647LL) mathc_npy_fail(path, \"elementos demais para uma matriz\");\n"
+    "    int same = h.kind == '$K' && h.size == (int)sizeof($T);\n"
+    "    const char* data = f.data + h.offset;\n"
+    "    size_t per_line = MATHC_ALIGN / sizeof($T);\n"
+    "    // Linhas já alinhadas e sem preenchimento: a matriz usa o mapeamento\n"
+    "    if (f.mapped && same && !h.fortran && h.count > 0 && cols % (long long)per_line == 0 && (uintptr_t)data % MATHC_ALIGN == 0) {\n"
+    "        mathc_matrix_$N* m = malloc(sizeof(mathc_matrix_$N) + sizeof(mathc_file_view));\n"
+    "        if (!m) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "        m->rows = (int)rows; m->cols = (int)cols; m->stride = (int)cols; m->data = ($T*)data;\n"
+    "        memcpy(m + 1, &f, sizeof(f));\n"
+    "        return m;\n"
+    "    }\n"
+    "    mathc_matrix_$N* m = mathc_matrix_raw_$N((int)rows, (int)cols);\n"
+    "    for (long long i = 0; i < rows; i++) {\n"
+    "        $T* row = m->data + (size_t)i * m->stride;\n"
+    "        if (same && !h.fortran) memcpy(row, data + (size_t)(i * cols) * sizeof($T), sizeof($T) * (size_t)cols);\n"
+    "        else for (long long j = 0; j < cols; j++) row[j] = mathc_npy_elem_$N(&h, data, h.fortran ? j * rows + i : i * cols + j);\n"
+    "    }\n"
+    "    mathc_file_close(f);\n"
+    "    return m;\n"
+    "}\n"
+    "/* Matriz de load_npy: se os dados não seguem o cabeçalho, o mapeamento está guardado depois dele */\n"
+    "static void mathc_npy_release_matrix_$N(mathc_matrix_$N* m) {\n"
+    "    if (m && (char*)m->data != (char*)m + MATHC_ALIGN) {\n"
+    "        mathc_file_view f;\n"
+    "        memcpy(&f, m + 1, sizeof(f));\n"
+    "        mathc_file_close(f);\n"
+    "    }\n"
+    "    free(m);\n"
+    "}\n"
+    "static void mathc_save_npy_array_$N(const char* path, const $T* v, int n) {\n"
+    "    char head[256];\n"
+    "    size_t hl = mathc_npy_header_text(head, \"$D\", 1, n > 0 ? n : 0, 0);\n"
+    "    struct iovec iov[2] = { { head, hl }, { (void*)v, sizeof($T) * (size_t)(n > 0 ? n : 0) } };\n"
+    "    mathc_npy_write(path, iov, n > 0 ? 2 : 1);\n"
+    "}\n"
+    "static void mathc_save_npy_matrix_$N(const char* path, const mathc_matrix_$N* m) {\n"
+    "    if (!m) { fprintf(stderr, \"Erro: save_npy de matriz nula\\n\"); exit(1); }\n"
+    "    char head[256];\n"
+    "    size_t hl = mathc_npy_header_text(head, \"$D\", 2, m->rows, m->cols);\n"
+    "    size_t row = sizeof($T) * (size_t)m->cols;\n"
+    "    if (m->stride == m->cols || m->rows <= 1) {\n"
+    "        struct iovec iov[2] = { { head, hl }, { (void*)m->data, row * (size_t)m->rows } };\n"
+    "        mathc_npy_write(path, iov, 2);\n"
+    "        return;\n"
+    "    }\n"
+    "    // Linhas com preenchimento: cabeçalho e linhas juntos num único bloco\n"
+    "    char* buf = malloc(hl + row * (size_t)m->rows);\n"
+    "    if (!buf) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    memcpy(buf, head, hl);\n"
+    "    for (int i = 0; i < m->rows; i++) memcpy(buf + hl + row * (size_t)i, m->data + (size_t)i * m->stride, row);\n"
+    "    struct iovec iov[1] = { { buf, hl + row * (size_t)m->rows } };\n"
+    "    mathc_npy_write(path, iov, 1);\n"
+    "    free(buf);\n"
+    "}\n";
+
+static const char* npy_builtins[] = { "load_npy", "save_npy", NULL };
+
+static void codegen_npy_runtime(CodeGenContext* ctx) {
+    fputs(npy_runtime, ctx->output);
+    const char* int_values[] = { "int", "int", "i", "<i4" };
+    const char* float_values[] = { "float", "double", "f", "<f8" };
+    codegen_emit_subst(ctx, npy_template, "NTKD", int_values);
+    codegen_emit_subst(ctx, npy_template, "NTKD", float_values);
+    fputs("\n", ctx->output);
+}
+
+/* save_npy(arquivo, x): x é int[]/float[] (identificador, pelo tamanho) ou matrix[int]/matrix[float] */
+static void codegen_save_npy_call(CodeGenContext* ctx, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    ASTNode* x = args && args->next ? args->next->node : NULL;
+    TypeSpec* t = x ? x->inferred_type : NULL;
+    if (x && codegen_is_matrix_type(t)) {
+        const char* suffix = codegen_input_suffix(codegen_matrix_elem(t));
+        if (suffix) {
+            codegen_emit(ctx, "mathc_save_npy_matrix_%s(", suffix);
+            codegen_expression(ctx, args->node);
+            codegen_emit(ctx, ", ");
+            codegen_expression(ctx, x);
+            codegen_emit(ctx, ")");
+            return;
+        }
+    } else if (x && t && t->base_type == TYPE_ARRAY && x->type == NODE_IDENTIFIER) {
+        const char* suffix = codegen_input_suffix(t->element_type);
+        if (suffix) {
+            codegen_emit(ctx, "mathc_save_npy_array_%s(", suffix);
+            codegen_expression(ctx, args->node);
+            codegen_emit(ctx, ", %s, %s__len)", x->identifier.name, x->identifier.name);
+            return;
+        }
+    }
+    codegen_error(ctx, call, "save_npy(arquivo, x) requer int[], float[], matrix[int] ou matrix[float] (vetor por variável)");
+    codegen_emit(ctx, "(void)0");
+}
+
+/* load_npy(arquivo) fora de uma declaração de vetor: só matriz, com o tipo vindo do contexto */
+static void codegen_load_npy_call(CodeGenContext* ctx, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    TypeSpec* t = call->inferred_type;
+    int matrix = codegen_is_matrix_type(t);
+    const char* suffix = matrix ? codegen_input_suffix(codegen_matrix_elem(t)) :
+                         codegen_input_suffix(t && t->base_type == TYPE_ARRAY ? t->element_type : NULL);
+    if (!args || !suffix) {
+        codegen_error(ctx, call, "load_npy(arquivo) requer int[], float[], matrix[int] ou matrix[float]");
+        codegen_emit(ctx, "NULL");
+        return;
+    }
+    if (!matrix) {
+        codegen_error(ctx, call, "load_npy de um vetor só cabe em `T[] v = load_npy(...)` ou `v = load_npy(...)`");
+        codegen_emit(ctx, "NULL");
+        return;
+    }
+    codegen_emit(ctx, "mathc_load_npy_matrix_%s(", suffix);
+    codegen_expression(ctx, args->node);
+    codegen_emit(ctx, ")");
+}
+
+/* ========================================================================== */
+/* PRODUTO DE MATRIZES (@ / matmul) */
+/* ========================================================================== */
+/*
+ * C = A @ B percorre blocos MC x KC de A contra painéis KC x NC de B, que
+ * cabem no cache. Para float o bloco usa um microkernel AVX2/FMA 4x8
+ * (escolhido em tempo de execução). Sem AVX2, o laço i-k-j compilado com
+ * -O3 vira SSE2. As linhas de C são divididas entre threads quando o
+ * produto passa de MATHC_PAR_MIN_WORK multiplicações. A @ v (matriz por
+ * vetor) usa produtos escalares SIMD por linha (GEMV). O runtime só é
+ * emitido quando o programa usa @ ou matmul.
+ */
+
+static const char* matmul_kernel_template =
+    "static void mathc_gemm_scalar_$N(const void* pa, const void* pb, void* pc, int i0, int i1) {\n"
+    "    const mathc_matrix_$N* A = (const mathc_matrix_$N*)pa;\n"
+    "    const mathc_matrix_$N* B = (const mathc_matrix_$N*)pb;\n"
+    "    mathc_matrix_$N* C = (mathc_matrix_$N*)pc;\n"
+    "    int k = A->cols, n = B->cols;\n"
+    "    for (int pp = 0; pp < k; pp += MATHC_KC) {\n"
+    "        int pe = pp + MATHC_KC < k ? pp + MATHC_KC : k;\n"
+    "        for (int ii = i0; ii < i1; ii += MATHC_MC) {\n"
+    "            int ie = ii + MATHC_MC < i1 ? ii + MATHC_MC : i1;\n"
+    "            for (int i = ii; i < ie; i++) {\n"
+    "                $T* restrict c = C->data + (size_t)i * C->stride;\n"
+    "                const $T* a = A->data + (size_t)i * A->stride;\n"
+    "                for (int p = pp; p < pe; p++) {\n"
+    "                    $T av = a[p];\n"
+    "                    const $T* restrict b = B->data + (size_t)p * B->stride;\n"
+    "                    for (int j = 0; j < n; j++) c[j] += av * b[j];\n"
+    "                }\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_gemv_scalar_$N(const void* pa, const void* px, void* py, int i0, int i1) {\n"
+    "    const mathc_matrix_$N* A = (const mathc_matrix_$N*)pa;\n"
+    "    const $T* x = (const $T*)px;\n"
+    "    $T* y = ($T*)py;\n"
+    "    for (int i = i0; i < i1; i++) {\n"
+    "        const $T* a = A->data + (size_t)i * A->stride;\n"
+    "        $T s = 0;\n"
+    "        for (int j = 0; j < A->cols; j++) s += a[j] * x[j];\n"
+    "        y[i] = s;\n"
+    "    }\n"
+    "}\n";
+
+static const char* matmul_api_template =
+    "static mathc_matrix_$N* mathc_matmul_$N(const mathc_matrix_$N* A, const mathc_matrix_$N* B) {\n"
+    "    if (!A || !B || A->cols != B->rows) {\n"
+    "        fprintf(stderr, \"Erro: dimensões incompatíveis em @ (%dx%d @ %dx%d)\\n\", A ? A->rows : 0, A ? A->cols : 0, B ? B->rows : 0, B ? B->cols : 0);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    mathc_matrix_$N* C = mathc_matrix_new_$N(A->rows, B->cols);\n"
+    "    mathc_parallel_rows(mathc_gemm_rows_$N, A, B, C, A->rows, (double)A->rows * A->cols * B->cols);\n"
+    "    return C;\n"
+    "}\n"
+    "static $T* mathc_gemv_$N(const mathc_matrix_$N* A, const $T* x, int xlen, int* out_len) {\n"
+    "    if (!A || A->cols != xlen) {\n"
+    "        fprintf(stderr, \"Erro: dimensões incompatíveis em @ (%dx%d @ vetor de %d)\\n\", A ? A->rows : 0, A ? A->cols : 0, xlen);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    $T* y = ($T*)malloc(sizeof($T) * (size_t)(A->rows > 0 ? A->rows : 1));\n"
+    "    if (!y) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    mathc_parallel_rows(mathc_gemv_rows_$N, A, x, y, A->rows, (double)A->rows * A->cols);\n"
+    "    if (out_len) *out_len = A->rows;\n"
+    "    return y;\n"
+    "}\n";
+
+static const char* matmul_wrapper_template =
+    "static void mathc_gemm_rows_$N(const void* a, const void* b, void* c, int i0, int i1) { mathc_gemm_scalar_$N(a, b, c, i0, i1); }\n"
+    "static void mathc_gemv_rows_$N(const void* a, const void* x, void* y, int i0, int i1) { mathc_gemv_scalar_$N(a, x, y, i0, i1); }\n";
+
+/*
+ * Threads do runtime, compartilhadas por @ e sort: MATHC_NUM_THREADS limita
+ * quantas são usadas (padrão: número de processadores). mathc_parallel_run
+ * executa count tarefas de size bytes cada, a primeira na thread atual; se
+ * pthread_create falhar a tarefa roda na thread atual, então o resultado
+ * nunca depende de quantas threads de fato foram criadas.
+ */
+static void codegen_threads_runtime(CodeGenContext* ctx) {
+    fputs("#include <pthread.h>\n", ctx->output);
+    fputs("#include <unistd.h>\n", ctx->output);
+    fputs("#define MATHC_MAX_THREADS 64\n", ctx->output);
+    fputs("static int mathc_num_threads(void) {\n", ctx->output);
+    fputs("    static int cached = 0;\n", ctx->output);
+    fputs("    if (cached > 0) return cached;\n", ctx->output);
+    fputs("    const char* env = getenv(\"MATHC_NUM_THREADS\");\n", ctx->output);
+    fputs("    int n = env ? atoi(env) : 0;\n", ctx->output);
+    fputs("    if (n <= 0) { long p = sysconf(_SC_NPROCESSORS_ONLN); n = p > 0 ? (int)p : 1; }\n", ctx->output);
+    fputs("    if (n > MATHC_MAX_THREADS) n = MATHC_MAX_THREADS;\n", ctx->output);
+    fputs("    cached = n;\n", ctx->output);
+    fputs("    return n;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static void mathc_parallel_run(void* (*fn)(void*), void* tasks, size_t size, int count) {\n", ctx->output);
+    fputs("    pthread_t th[MATHC_MAX_THREADS];\n", ctx->output);
+    fputs("    int started[MATHC_MAX_THREADS];\n", ctx->output);
+    fputs("    char* base = (char*)tasks;\n", ctx->output);
+    fputs("    for (int t = 1; t < count; t++) started[t] = pthread_create(&th[t], NULL, fn, base + size * t) == 0;\n", ctx->output);
+    fputs("    if (count > 0) fn(base);\n", ctx->output);
+    fputs("    for (int t = 1; t < count; t++) {\n", ctx->output);
+    fputs("        if (started[t]) pthread_join(th[t], NULL);\n", ctx->output);
+    fputs("        else fn(base + size * t);\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("}\n\n", ctx->output);
+}
+
+static void codegen_matmul_runtime(CodeGenContext* ctx) {
+    fputs("#if defined(__x86_64__) || defined(__i386__)\n", ctx->output);
+    fputs("#include <immintrin.h>\n", ctx->output);
+    fputs("#define MATHC_X86 1\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_MC 64\n", ctx->output);
+    fputs("#define MATHC_KC 256\n", ctx->output);
+    fputs("#define MATHC_NC 512\n", ctx->output);
+    fputs("#define MATHC_PAR_MIN_WORK (1 << 21)\n", ctx->output);
+    fputs("static int mathc_has_avx2(void) {\n", ctx->output);
+    fputs("#ifdef MATHC_X86\n", ctx->output);
+    fputs("    static int v = -1;\n", ctx->output);
+    fputs("    if (v < 0) { __builtin_cpu_init(); v = __builtin_cpu_supports(\"avx2\") && __builtin_cpu_supports(\"fma\"); }\n", ctx->output);
+    fputs("    return v;\n", ctx->output);
+    fputs("#else\n", ctx->output);
+    fputs("    return 0;\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("typedef void (*mathc_rows_fn)(const void* a, const void* b, void* c, int i0, int i1);\n", ctx->output);
+    fputs("typedef struct mathc_rows_task { mathc_rows_fn fn; const void* a; const void* b; void* c; int i0; int i1; } mathc_rows_task;\n", ctx->output);
+    fputs("static void* mathc_rows_worker(void* arg) {\n", ctx->output);
+    fputs("    mathc_rows_task* t = (mathc_rows_task*)arg;\n", ctx->output);
+    fputs("    t->fn(t->a, t->b, t->c, t->i0, t->i1);\n", ctx->output);
+    fputs("    return NULL;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static void mathc_parallel_rows(mathc_rows_fn fn, const void* a, const void* b, void* c, int m, double work) {\n", ctx->output);
+    fputs("    int nt = mathc_num_threads();\n", ctx->output);
+    fputs("    mathc_has_avx2();  // detecta a CPU antes de criar threads\n", ctx->output);
+    fputs("    if (work < MATHC_PAR_MIN_WORK || nt < 2 || m < 8) { fn(a, b, c, 0, m); return; }\n", ctx->output);
+    fputs("    if (nt > m / 4) nt = m / 4;\n", ctx->output);
+    fputs("    int chunk = ((m + nt - 1) / nt + 3) & ~3;\n", ctx->output);
+    fputs("    mathc_rows_task tasks[MATHC_MAX_THREADS];\n", ctx->output);
+    fputs("    int used = 0;\n", ctx->output);
+    fputs("    for (int i0 = 0; i0 < m && used < nt; i0 += chunk, used++) {\n", ctx->output);
+    fputs("        tasks[used].fn = fn; tasks[used].a = a; tasks[used].b = b; tasks[used].c = c;\n", ctx->output);
+    fputs("        tasks[used].i0 = i0; tasks[used].i1 = i0 + chunk < m ? i0 + chunk : m;\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("    mathc_parallel_run(mathc_rows_worker, tasks, sizeof(tasks[0]), used);\n", ctx->output);
+    fputs("}\n", ctx->output);
+
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) codegen_emit_template(ctx, matmul_kernel_template, &matrix_kinds[i]);
+
+    // float: microkernel AVX2/FMA e produtos escalares SSE2/AVX2
+    fputs("#ifdef MATHC_X86\n", ctx->output);
+    fputs("__attribute__((target(\"avx2,fma\")))\n", ctx->output);
+    fputs("static void mathc_dgemm_avx2(const void* pa, const void* pb, void* pc, int i0, int i1) {\n", ctx->output);
+    fputs("    const mathc_matrix_float* A = (const mathc_matrix_float*)pa;\n", ctx->output);
+    fputs("    const mathc_matrix_float* B = (const mathc_matrix_float*)pb;\n", ctx->output);
+    fputs("    mathc_matrix_float* C = (mathc_matrix_float*)pc;\n", ctx->output);
+    fputs("    int k = A->cols, n = B->cols;\n", ctx->output);
+    fputs("    size_t as = A->stride, bs = B->stride, cs = C->stride;\n", ctx->output);
+    fputs("    for (int jj = 0; jj < n; jj += MATHC_NC) {\n", ctx->output);
+    fputs("        int je = jj + MATHC_NC < n ? jj + MATHC_NC : n;\n", ctx->output);
+    fputs("        for (int pp = 0; pp < k; pp += MATHC_KC) {\n", ctx->output);
+    fputs("            int pe = pp + MATHC_KC < k ? pp + MATHC_KC : k;\n", ctx->output);
+    fputs("            for (int ii = i0; ii < i1; ii += MATHC_MC) {\n", ctx->output);
+    fputs("                int ie = ii + MATHC_MC < i1 ? ii + MATHC_MC : i1;\n", ctx->output);
+    fputs("                int i = ii;\n", ctx->output);
+    fputs("                for (; i + 4 <= ie; i += 4) {\n", ctx->output);
+    fputs("                    const double* a0 = A->data + (size_t)i * as;\n", ctx->output);
+    fputs("                    const double* a1 = a0 + as;\n", ctx->output);
+    fputs("                    const double* a2 = a1 + as;\n", ctx->output);
+    fputs("                    const double* a3 = a2 + as;\n", ctx->output);
+    fputs("                    double* c0 = C->data + (size_t)i * cs;\n", ctx->output);
+    fputs("                    double* c1 = c0 + cs;\n", ctx->output);
+    fputs("                    double* c2 = c1 + cs;\n", ctx->output);
+    fputs("                    double* c3 = c2 + cs;\n", ctx->output);
+    fputs("                    int j = jj;\n", ctx->output);
+    fputs("                    for (; j + 8 <= je; j += 8) {\n", ctx->output);
+    fputs("                        __m256d x00 = _mm256_loadu_pd(c0 + j), x01 = _mm256_loadu_pd(c0 + j + 4);\n", ctx->output);
+    fputs("                        __m256d x10 = _mm256_loadu_pd(c1 + j), x11 = _mm256_loadu_pd(c1 + j + 4);\n", ctx->output);
+    fputs("                        __m256d x20 = _mm256_loadu_pd(c2 + j), x21 = _mm256_loadu_pd(c2 + j + 4);\n", ctx->output);
+    fputs("                        __m256d x30 = _mm256_loadu_pd(c3 + j), x31 = _mm256_loadu_pd(c3 + j + 4);\n", ctx->output);
+    fputs("                        const double* b = B->data + (size_t)pp * bs + j;\n", ctx->output);
+    fputs("                        for (int p = pp; p < pe; p++, b += bs) {\n", ctx->output);
+    fputs("                            __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4);\n", ctx->output);
+    fputs("                            __m256d av = _mm256_broadcast_sd(a0 + p);\n", ctx->output);
+    fputs("                            x00 = _mm256_fmadd_pd(av, b0, x00); x01 = _mm256_fmadd_pd(av, b1, x01);\n", ctx->output);
+    fputs("                            av = _mm256_broadcast_sd(a1 + p);\n", ctx->output);
+    fputs("                            x10 = _mm256_fmadd_pd(av, b0, x10); x11 = _mm256_fmadd_pd(av, b1, x11);\n", ctx->output);
+    fputs("                            av = _mm256_broadcast_sd(a2 + p);\n", ctx->output);
+    fputs("                            x20 = _mm256_fmadd_pd(av, b0, x20); x21 = _mm256_fmadd_pd(av, b1, x21);\n", ctx->output);
+    fputs("                            av = _mm256_broadcast_sd(a3 + p);\n", ctx->output);
+    fputs("                            x30 = _mm256_fmadd_pd(av, b0, x30); x31 = _mm256_fmadd_pd(av, b1, x31);\n", ctx->output);
+    fputs("                        }\n", ctx->output);
+    fputs("                        _mm256_storeu_pd(c0 + j, x00); _mm256_storeu_pd(c0 + j + 4, x01);\n", ctx->output);
+    fputs("                        _mm256_storeu_pd(c1 + j, x10); _mm256_storeu_pd(c1 + j + 4, x11);\n", ctx->output);
+    fputs("                        _mm256_storeu_pd(c2 + j, x20); _mm256_storeu_pd(c2 + j + 4, x21);\n", ctx->output);
+    fputs("                        _mm256_storeu_pd(c3 + j, x30); _mm256_storeu_pd(c3 + j + 4, x31);\n", ctx->output);
+    fputs("                    }\n", ctx->output);
+    fputs("                    for (; j < je; j++) {\n", ctx->output);
+    fputs("                        double s0 = c0[j], s1 = c1[j], s2 = c2[j], s3 = c3[j];\n", ctx->output);
+    fputs("                        for (int p = pp; p < pe; p++) {\n", ctx->output);
+    fputs("                            double bv = B->data[(size_t)p * bs + j];\n", ctx->output);
+    fputs("                            s0 += a0[p] * bv; s1 += a1[p] * bv; s2 += a2[p] * bv; s3 += a3[p] * bv;\n", ctx->output);
+    fputs("                        }\n", ctx->output);
+    fputs("                        c0[j] = s0; c1[j] = s1; c2[j] = s2; c3[j] = s3;\n", ctx->output);
+    fputs("                    }\n", ctx->output);
+    fputs("                }\n", ctx->output);
+    fputs("                for (; i < ie; i++) {\n", ctx->output);
+    fputs("                    const double* a = A->data + (size_t)i * as;\n", ctx->output);
+    fputs("                    double* c = C->data + (size_t)i * cs;\n", ctx->output);
+    fputs("                    for (int p = pp; p < pe; p++) {\n", ctx->output);
+    fputs("                        double av = a[p];\n", ctx->output);
+    fputs("                        const double* b = B->data + (size_t)p * bs;\n", ctx->output);
+    fputs("                        for (int j = jj; j < je; j++) c[j] += av * b[j];\n", ctx->output);
+    fputs("                    }\n", ctx->output);
+    fputs("                }\n", ctx->output);
+    fputs("            }\n", ctx->output);
+    fputs("        }\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("__attribute__((target(\"avx2,fma\")))\n", ctx->output);
+    fputs("static double mathc_ddot_avx2(const double* a, const double* b, int n) {\n", ctx->output);
+    fputs("    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();\n", ctx->output);
+    fputs("    int j = 0;\n", ctx->output);
+    fputs("    for (; j + 8 <= n; j += 8) {\n", ctx->output);
+    fputs("        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j), s0);\n", ctx->output);
+    fputs("        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j + 4), _mm256_loadu_pd(b + j + 4), s1);\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("    double t[4];\n", ctx->output);
+    fputs("    _mm256_storeu_pd(t, _mm256_add_pd(s0, s1));\n", ctx->output);
+    fputs("    double s = (t[0] + t[1]) + (t[2] + t[3]);\n", ctx->output);
+    fputs("    for (; j < n; j++) s += a[j] * b[j];\n", ctx->output);
+    fputs("    return s;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static double mathc_ddot_sse2(const double* a, const double* b, int n) {\n", ctx->output);
+    fputs("    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();\n", ctx->output);
+    fputs("    int j = 0;\n", ctx->output);
+    fputs("    for (; j + 4 <= n; j += 4) {\n", ctx->output);
+    fputs("        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));\n", ctx->output);
+    fputs("        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + j + 2), _mm_loadu_pd(b + j + 2)));\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("    double t[2];\n", ctx->output);
+    fputs("    _mm_storeu_pd(t, _mm_add_pd(s0, s1));\n", ctx->output);
+    fputs("    double s = t[0] + t[1];\n", ctx->output);
+    fputs("    for (; j < n; j++) s += a[j] * b[j];\n", ctx->output);
+    fputs("    return s;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("static void mathc_gemm_rows_float(const void* a, const void* b, void* c, int i0, int i1) {\n", ctx->output);
+    fputs("#ifdef MATHC_X86\n", ctx->output);
+    fputs("    if (mathc_has_avx2()) { mathc_dgemm_avx2(a, b, c, i0, i1); return; }\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("    mathc_gemm_scalar_float(a, b, c, i0, i1);\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static void mathc_gemv_rows_float(const void* pa, const void* px, void* py, int i0, int i1) {\n", ctx->output);
+    fputs("#ifdef MATHC_X86\n", ctx->output);
+    fputs("    const mathc_matrix_float* A = (const mathc_matrix_float*)pa;\n", ctx->output);
+    fputs("    int avx2 = mathc_has_avx2();\n", ctx->output);
+    fputs("    for (int i = i0; i < i1; i++) {\n", ctx->output);
+    fputs("        const double* row = A->data + (size_t)i * A->stride;\n", ctx->output);
+    fputs("        ((double*)py)[i] = avx2 ? mathc_ddot_avx2(row, (const double*)px, A->cols) : mathc_ddot_sse2(row, (const double*)px, A->cols);\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("#else\n", ctx->output);
+    fputs("    mathc_gemv_scalar_float(pa, px, py, i0, i1);\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("}\n", ctx->output);
+
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) {
+        if (strcmp(matrix_kinds[i].suffix, "float") != 0) codegen_emit_template(ctx, matmul_wrapper_template, &matrix_kinds[i]);
+    }
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) codegen_emit_template(ctx, matmul_api_template, &matrix_kinds[i]);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+static int visit_uses_matmul(ASTNode* node, void* data) {
+    int* found = (int*)data;
+    if (node->type == NODE_BINARY_OP && node->binary_op.op == OP_MATMUL) *found = 1;
+    if (node->type == NODE_CALL && node->call.function && node->call.function->type == NODE_IDENTIFIER &&
+        strcmp(node->call.function->identifier.name, "matmul") == 0) *found = 1;
+    return *found;
+}
+
+static int codegen_program_uses_matmul(ASTNode* program) {
+    int found = 0;
+    ast_walk(program, visit_uses_matmul, &found);
+    return found;
+}
+
+/* Operando direito vetor (T[]) faz A @ v virar GEMV */
+static int codegen_is_vector_type(TypeSpec* t) {
+    return t && t->base_type == TYPE_ARRAY && !codegen_is_matrix_type(t);
+}
+
+/* A @ B (ou matmul(A, B)); `len_target` recebe o tamanho do vetor resultante de um GEMV (obrigatório nele) */
+static void codegen_matmul(CodeGenContext* ctx, ASTNode* left, ASTNode* right, const char* len_target) {
+    TypeSpec* lt = left ? left->inferred_type : NULL;
+    TypeSpec* rt = right ? right->inferred_type : NULL;
+    if (!codegen_is_matrix_type(lt) && !codegen_is_matrix_type(rt) &&
+        !codegen_is_vector_type(lt) && !codegen_is_vector_type(rt)) {
+        // Escalares: @ degenera para o produto comum
+        codegen_emit(ctx, "(");
+        codegen_expression(ctx, left);
+        codegen_emit(ctx, " * ");
+        codegen_expression(ctx, right);
+        codegen_emit(ctx, ")");
+        return;
+    }
+    if (!codegen_is_matrix_type(lt)) {
+        codegen_error(ctx, left, "operando esquerdo de @ precisa ser matriz");
+        codegen_emit(ctx, "0");
+        return;
+    }
+    const MatrixKind* k = codegen_matrix_kind(lt);
+    if (codegen_is_vector_type(rt) && !len_target) {
+        codegen_error(ctx, left, "A @ v devolve um vetor novo: use-o em `T[] w = A @ v` ou `w = A @ v`");
+        codegen_emit(ctx, "NULL");
+        return;
+    }
+    if (codegen_is_vector_type(rt) && right->type == NODE_IDENTIFIER) {
+        codegen_emit(ctx, "mathc_gemv_%s(", k->suffix);
+        codegen_expression(ctx, left);
+        codegen_emit(ctx, ", %s, %s__len, &%s)", right->identifier.name, right->identifier.name, len_target);
+        return;
+    }
+    if (!codegen_is_matrix_type(rt) || codegen_matrix_kind(rt) != k) {
+        codegen_error(ctx, right, "@ requer matrizes do mesmo tipo de elemento");
+        codegen_emit(ctx, "0");
+        return;
+    }
+    codegen_emit(ctx, "mathc_matmul_%s(", k->suffix);
+    codegen_expression(ctx, left);
+    codegen_emit(ctx, ", ");
+    codegen_expression(ctx, right);
+    codegen_emit(ctx, ")");
+}
+
+/* Inicializador que produz uma matriz/vetor novo no heap (A @ B, matmul(A, B)) */
+static int codegen_is_matmul_expr(ASTNode* e, ASTNode** left, ASTNode** right) {
+    if (!e) return 0;
+    if (e->type == NODE_BINARY_OP && e->binary_op.op == OP_MATMUL) {
+        *left = e->binary_op.left;
+        *right = e->binary_op.right;
+        return 1;
+    }
+    if (e->type == NODE_CALL && e->call.function && e->call.function->type == NODE_IDENTIFIER &&
+        strcmp(e->call.function->identifier.name, "matmul") == 0 &&
+        e->call.arguments && e->call.arguments->next) {
+        *left = e->call.arguments->node;
+        *right = e->call.arguments->next->node;
+        return 1;
+    }
+    return 0;
+}
+
+/* ========================================================================== */
+/* OPERAÇÕES DE MATRIZES (transpose, determinant, trace, identity, zeros, ones) */
+/* ========================================================================== */
+/*
+ * transpose divide recursivamente a maior dimensão até blocos de
+ * MATHC_TB x MATHC_TB, que cabem no L1 tanto na leitura quanto na escrita
+ * (cache-oblivious). determinant faz LU com pivotamento parcial, O(n^3/3),
+ * sobre uma cópia em $A; em matrizes int/char usa Bareiss, exato. zeros/identity usam o memset do bloco e ones
+ * preenche o bloco inteiro (incluindo o preenchimento do stride) com um laço
+ * contíguo que o gcc transforma em stores vetoriais. Com um único argumento,
+ * zeros/ones geram uma matriz n x n (cols < 0 no runtime).
+ */
+
+#define MATRIX_OPS_BLOCK 32
+
+static const char* matrix_ops_template =
+    "static void mathc_transpose_rec_$N(const $T* restrict a, size_t as, $T* restrict b, size_t bs, int r0, int r1, int c0, int c1) {\n"
+    "    while (r1 - r0 > MATHC_TB || c1 - c0 > MATHC_TB) {\n"
+    "        if (r1 - r0 >= c1 - c0) {\n"
+    "            int rm = r0 + (r1 - r0) / 2;\n"
+    "            mathc_transpose_rec_$N(a, as, b, bs, r0, rm, c0, c1);\n"
+    "            r0 = rm;\n"
+    "        } else {\n"
+    "            int cm = c0 + (c1 - c0) / 2;\n"
+    "            mathc_transpose_rec_$N(a, as, b, bs, r0, r1, c0, cm);\n"
+    "            c0 = cm;\n"
+    "        }\n"
+    "    }\n"
+    "    for (int j = c0; j < c1; j++) {\n"
+    "        $T* restrict out = b + (size_t)j * bs;\n"
+    "        for (int i = r0; i < r1; i++) out[i] = a[(size_t)i * as + j];\n"
+    "    }\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_transpose_$N(const mathc_matrix_$N* A) {\n"
+    "    if (!A) { fprintf(stderr, \"Erro: transpose de matriz nula\\n\"); exit(1); }\n"
+    "    mathc_matrix_$N* B = mathc_matrix_raw_$N(A->cols, A->rows);\n"
+    "    mathc_transpose_rec_$N(A->data, A->stride, B->data, B->stride, 0, A->rows, 0, A->cols);\n"
+    "    return B;\n"
+    "}\n"
+    "static $T mathc_trace_$N(const mathc_matrix_$N* A) {\n"
+    "    $T s = 0;\n"
+    "    int n = A ? (A->rows < A->cols ? A->rows : A->cols) : 0;\n"
+    "    for (int i = 0; i < n; i++) s += A->data[(size_t)i * A->stride + i];\n"
+    "    return s;\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_zeros_$N(int rows, int cols) {\n"
+    "    return mathc_matrix_new_$N(rows, cols < 0 ? rows : cols);\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_ones_$N(int rows, int cols) {\n"
+    "    mathc_matrix_$N* m = mathc_matrix_raw_$N(rows, cols < 0 ? rows : cols);\n"
+    "    $T* restrict d = m->data;\n"
+    "    size_t total = (size_t)m->rows * m->stride;\n"
+    "    for (size_t i = 0; i < total; i++) d[i] = 1;\n"
+    "    return m;\n"
+    "}\n"
+    "static mathc_matrix_$N* mathc_identity_$N(int n) {\n"
+    "    mathc_matrix_$N* m = mathc_matrix_new_$N(n, n);\n"
+    "    for (int i = 0; i < n; i++) m->data[(size_t)i * m->stride + i] = 1;\n"
+    "    return m;\n"
+    "}\n";
+
+/* determinant de matrix[float]/matrix[complex]: LU com pivotamento parcial em $A */
+static const char* determinant_lu_template =
+    "static $A mathc_determinant_$N(const mathc_matrix_$N* A) {\n"
+    "    if (!A || A->rows != A->cols) {\n"
+    "        fprintf(stderr, \"Erro: determinant requer matriz quadrada (%dx%d)\\n\", A ? A->rows : 0, A ? A->cols : 0);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    int n = A->rows;\n"
+    "    $A* lu = ($A*)malloc(sizeof($A) * ((size_t)n * n > 0 ? (size_t)n * n : 1));\n"
+    "    if (!lu) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    for (int i = 0; i < n; i++)\n"
+    "        for (int j = 0; j < n; j++) lu[(size_t)i * n + j] = A->data[(size_t)i * A->stride + j];\n"
+    "    $A det = 1;\n"
+    "    for (int k = 0; k < n; k++) {\n"
+    "        int p = k;\n"
+    "        double best = $F(lu[(size_t)k * n + k]);\n"
+    "        for (int i = k + 1; i < n; i++) {\n"
+    "            double v = $F(lu[(size_t)i * n + k]);\n"
+    "            if (v > best) { best = v; p = i; }\n"
+    "        }\n"
+    "        if (best == 0) { det = 0; break; }\n"
+    "        $A* restrict rk = lu + (size_t)k * n;\n"
+    "        if (p != k) {\n"
+    "            $A* restrict rp = lu + (size_t)p * n;\n"
+    "            for (int j = k; j < n; j++) { $A t = rk[j]; rk[j] = rp[j]; rp[j] = t; }\n"
+    "            det = -det;\n"
+    "        }\n"
+    "        $A pivot = rk[k];\n"
+    "        det *= pivot;\n"
+    "        for (int i = k + 1; i < n; i++) {\n"
+    "            $A* restrict ri = lu + (size_t)i * n;\n"
+    "            $A f = ri[k] / pivot;\n"
+    "            if (f == 0) continue;\n"
+    "            for (int j = k + 1; j < n; j++) ri[j] -= f * rk[j];\n"
+    "        }\n"
+    "    }\n"
+    "    free(lu);\n"
+    "    return det;\n"
+    "}\n";
+
+/*
+ * determinant de matrix[int]/matrix[char]: eliminação de Bareiss, sem
+ * frações. Cada passo divide exatamente pelo pivô anterior, então os valores
+ * intermediários são menores da matriz e o resultado é exato; estouro do
+ * acumulador ou de int é erro de execução, em vez de truncar um double.
+ */
+static const char* determinant_exact_template =
+    "static int mathc_determinant_$N(const mathc_matrix_$N* A) {\n"
+    "    if (!A || A->rows != A->cols) {\n"
+    "        fprintf(stderr, \"Erro: determinant requer matriz quadrada (%dx%d)\\n\", A ? A->rows : 0, A ? A->cols : 0);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    int n = A->rows;\n"
+    "    if (n == 0) return 1;\n"
+    "    mathc_det_acc* b = malloc(sizeof(mathc_det_acc) * (size_t)n * n);\n"
+    "    if (!b) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    for (int i = 0; i < n; i++)\n"
+    "        for (int j = 0; j < n; j++) b[(size_t)i * n + j] = A->data[(size_t)i * A->stride + j];\n"
+    "    mathc_det_acc prev = 1;\n"
+    "    int sign = 1;\n"
+    "    for (int k = 0; k < n - 1; k++) {\n"
+    "        mathc_det_acc* rk = b + (size_t)k * n;\n"
+    "        if (rk[k] == 0) {\n"
+    "            int p = k + 1;\n"
+    "            while (p < n && b[(size_t)p * n + k] == 0) p++;\n"
+    "            if (p == n) { free(b); return 0; }\n"
+    "            mathc_det_acc* rp = b + (size_t)p * n;\n"
+    "            for (int j = k; j < n; j++) { mathc_det_acc t = rk[j]; rk[j] = rp[j]; rp[j] = t; }\n"
+    "            sign = -sign;\n"
+    "        }\n"
+    "        for (int i = k + 1; i < n; i++) {\n"
+    "            mathc_det_acc* ri = b + (size_t)i * n;\n"
+    "            for (int j = k + 1; j < n; j++) {\n"
+    "                mathc_det_acc x, y;\n"
+    "                if (__builtin_mul_overflow(ri[j], rk[k], &x) || __builtin_mul_overflow(ri[k], rk[j], &y) ||\n"
+    "                    __builtin_sub_overflow(x, y, &x)) mathc_det_overflow();\n"
+    "                ri[j] = x / prev;\n"
+    "            }\n"
+    "            ri[k] = 0;\n"
+    "        }\n"
+    "        prev = rk[k];\n"
+    "    }\n"
+    "    mathc_det_acc det = b[(size_t)(n - 1) * n + (n - 1)] * sign;\n"
+    "    free(b);\n"
+    "    if (det > 2147483647 || det < -2147483647 - 1) mathc_det_overflow();\n"
+    "    return (int)det;\n"
+    "}\n";
+
+static const char* matrix_op_builtins[] = { "transpose", "determinant", "trace", "identity", "zeros", "ones", NULL };
+
+/* Construtores cujo tipo de elemento vem do contexto (declaração ou atribuição) */
+static const char* matrix_ctor_builtins[] = { "identity", "zeros", "ones", NULL };
+
+static void codegen_matrix_ops_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fprintf(ctx->output, "#define MATHC_TB %d\n", MATRIX_OPS_BLOCK);
+    fputs("#ifdef __SIZEOF_INT128__\n", ctx->output);
+    fputs("typedef __int128 mathc_det_acc;\n", ctx->output);
+    fputs("#else\n", ctx->output);
+    fputs("typedef long long mathc_det_acc;\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("static void mathc_det_overflow(void) { fprintf(stderr, \"Erro: determinant não cabe em int (use matrix[float])\\n\"); exit(1); }\n", ctx->output);
+    for (int i = 0; i < MATRIX_KIND_COUNT; i++) {
+        codegen_emit_template(ctx, matrix_ops_template, &matrix_kinds[i]);
+        codegen_emit_template(ctx, matrix_kinds[i].exact_det ? determinant_exact_template : determinant_lu_template, &matrix_kinds[i]);
+    }
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+typedef struct BuiltinScan {
+    const char** names;
+    int found;
+} BuiltinScan;
+
+static int visit_uses_builtin(ASTNode* node, void* data) {
+    BuiltinScan* scan = (BuiltinScan*)data;
+    if (node->type == NODE_CALL && node->call.function && node->call.function->type == NODE_IDENTIFIER &&
+        escape_in_list(scan->names, node->call.function->identifier.name)) scan->found = 1;
+    return scan->found;
+}
+
+static int codegen_program_uses_builtin(ASTNode* program, const char** names) {
+    BuiltinScan scan = { names, 0 };
+    ast_walk(program, visit_uses_builtin, &scan);
+    return scan.found;
+}
+
+static const char* codegen_call_name(ASTNode* e) {
+    if (!e || e->type != NODE_CALL || !e->call.function || e->call.function->type != NODE_IDENTIFIER) return NULL;
+    return e->call.function->identifier.name;
+}
+
+/* zeros(n)/ones(n)/identity(n) como inicializador de `target` adotam o tipo de elemento dele */
+static void codegen_matrix_ctor_context(ASTNode* init, TypeSpec* target) {
+    const char* name = codegen_call_name(init);
+    if (name && escape_in_list(matrix_ctor_builtins, name) && codegen_is_matrix_type(target)) {
+        init->inferred_type = target;
+    }
+}
+
+/* Chamada a uma das operações; devolve 0 se `name` não for uma delas */
+static int codegen_matrix_op_call(CodeGenContext* ctx, const char* name, ASTNode* call) {
+    if (!escape_in_list(matrix_op_builtins, name)) return 0;
+    NodeList* args = call->call.arguments;
+    ASTNode* first = args ? args->node : NULL;
+
+    if (escape_in_list(matrix_ctor_builtins, name)) {
+        const MatrixKind* k = codegen_matrix_kind(call->inferred_type);
+        codegen_emit(ctx, "mathc_%s_%s(", name, k->suffix);
+        if (first) codegen_expression(ctx, first);
+        else codegen_emit(ctx, "0");
+        if (strcmp(name, "identity") != 0) {
+            codegen_emit(ctx, ", ");
+            if (args && args->next) codegen_expression(ctx, args->next->node);
+            else codegen_emit(ctx, "-1");
+        }
+        codegen_emit(ctx, ")");
+        return 1;
+    }
+
+    if (!first || !codegen_is_matrix_type(first->inferred_type)) {
+        codegen_error(ctx, call, "%s requer uma matriz", name);
+        codegen_emit(ctx, "0");
+        return 1;
+    }
+    codegen_emit(ctx, "mathc_%s_%s(", name, codegen_matrix_kind(first->inferred_type)->suffix);
+    codegen_expression(ctx, first);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+/* Inicializador que devolve uma matriz nova no heap, que passa a pertencer à função */
+static int codegen_is_fresh_matrix_expr(ASTNode* e) {
+    ASTNode *left = NULL, *right = NULL;
+    if (codegen_is_matmul_expr(e, &left, &right)) return 1;
+    const char* name = codegen_call_name(e);
+    if (name && (strcmp(name, "input_matrix") == 0 || strcmp(name, "read_matrix") == 0 || strcmp(name, "read_csv") == 0))
+        return 1;
+    return name && escape_in_list(matrix_op_builtins, name) &&
+           strcmp(name, "determinant") != 0 && strcmp(name, "trace") != 0;
+}
+
+/* Linhas de tamanhos diferentes não cabem em um bloco constante; vão para o heap com zeros */
+static int codegen_rows_rectangular(NodeList* rows_list, int cols) {
+    for (NodeList* row = rows_list; row; row = row->next) {
+        if (!row->node || row->node->type != NODE_ARRAY_LITERAL) return 0;
+        if (count_literal_elements(row->node) != cols) return 0;
+    }
+    return 1;
+}
+
+/* Atribuições m->data[r * stride + c] = e para cada elemento do literal */
+static void codegen_matrix_fill(CodeGenContext* ctx, const char* name, NodeList* rows_list, const char* stride) {
+    int r = 0;
+    for (NodeList* row = rows_list; row; row = row->next, r++) {
+        if (!row->node || row->node->type != NODE_ARRAY_LITERAL) continue;
+        int c = 0;
+        for (NodeList* el = row->node->array_literal.elements; el; el = el->next, c++) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "%s->data[%d * %s + %d] = ", name, r, stride, c);
+            codegen_expression(ctx, el->node);
+            codegen_emit(ctx, ";\n");
+        }
+    }
+}
+
+void codegen_matrix_declaration(CodeGenContext* ctx, ASTNode* stmt, TypeSpec* var_type) {
+    const char* name = stmt->declaration.name;
+    const MatrixKind* k = codegen_matrix_kind(var_type);
+    ASTNode* init = stmt->declaration.initializer;
+
+    // Aceita tanto o literal de matriz quanto um array de linhas: [[1, 2], [3, 4]]
+    NodeList* rows_list = NULL;
+    int is_literal = 0;
+    if (init && init->type == NODE_MATRIX_LITERAL) {
+        rows_list = init->matrix_literal.rows;
+        is_literal = 1;
+    } else if (init && init->type == NODE_ARRAY_LITERAL) {
+        rows_list = init->array_literal.elements;
+        is_literal = 1;
+    }
+
+    if (!is_literal) {
+        codegen_matrix_ctor_context(init, var_type);
+        codegen_input_context(init, var_type);
+        codegen_emit(ctx, "mathc_matrix_%s* %s = ", k->suffix, name);
+        if (init) codegen_expression(ctx, init);
+        else codegen_emit(ctx, "NULL");
+        codegen_emit(ctx, ";\n");
+        // Produto/transposta/construtor recém-alocado pertence à função
+        const char* call = codegen_call_name(init);
+        if (call && strcmp(call, "load_npy") == 0) {
+            // Pode apontar para um mapeamento do arquivo
+            const char* suffix = codegen_input_suffix(codegen_matrix_elem(var_type));
+            if (suffix) codegen_record_alloc_fn(ctx, name, strcmp(suffix, "int") == 0 ? "mathc_npy_release_matrix_int"
+                                                                                      : "mathc_npy_release_matrix_float");
+        } else if (codegen_is_fresh_matrix_expr(init)) {
+            codegen_record_alloc(ctx, name);
+        }
+        return;
+    }
+
+    int rows = 0, cols = 0;
+    for (NodeList* row = rows_list; row; row = row->next, rows++) {
+        int c = row->node && row->node->type == NODE_ARRAY_LITERAL ? count_literal_elements(row->node) : 0;
+        if (c > cols) cols = c;
+    }
+
+    LiteralStorage storage = codegen_rows_rectangular(rows_list, cols) ?
+        codegen_literal_storage(ctx, name, rows_list, rows * cols) : LITERAL_HEAP;
+
+    if (storage == LITERAL_HEAP) {
+        codegen_emit(ctx, "mathc_matrix_%s* %s = mathc_matrix_new_%s(%d, %d);\n", k->suffix, name, k->suffix, rows, cols);
+        char stride[160];
+        snprintf(stride, sizeof(stride), "%s->stride", name);
+        codegen_matrix_fill(ctx, name, rows_list, stride);
+        codegen_record_alloc(ctx, name);
+        return;
+    }
+
+    // Pilha/estático: stride = cols, dados em array alinhado e cabeçalho local
+    int id = codegen_new_temp(ctx);
+    if (storage == LITERAL_STATIC) {
+        codegen_emit(ctx, "static const _Alignas(MATHC_ALIGN) %s _cst%d[%d][%d] = ", k->c_type, id, rows, cols);
+        codegen_literal_initializer(ctx, rows_list);
+        codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "mathc_matrix_%s _mh%d = { %d, %d, %d, (%s*)_cst%d };\n", k->suffix, id, rows, cols, cols, k->c_type, id);
+    } else {
+        codegen_emit(ctx, "_Alignas(MATHC_ALIGN) %s _stk%d[%d];\n", k->c_type, id, rows * cols);
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "mathc_matrix_%s _mh%d = { %d, %d, %d, _stk%d };\n", k->suffix, id, rows, cols, cols, id);
+    }
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "mathc_matrix_%s* %s = &_mh%d;\n", k->suffix, name, id);
+    if (storage == LITERAL_STACK) {
+        char stride[16];
+        snprintf(stride, sizeof(stride), "%d", cols);
+        codegen_matrix_fill(ctx, name, rows_list, stride);
+    }
+}
+
+/* m[i][j] -> m->data[(i) * m->stride + (j)]; m[i] -> ponteiro para a linha i */
+static int codegen_matrix_access(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* base = expr->array_access.array;
+    if (base->type == NODE_ARRAY_ACCESS && base->array_access.array &&
+        codegen_is_matrix_type(base->array_access.array->inferred_type)) {
+        ASTNode* m = base->array_access.array;
+        codegen_expression(ctx, m);
+        codegen_emit(ctx, "->data[(");
+        codegen_expression(ctx, base->array_access.index);
+        codegen_emit(ctx, ") * ");
+        codegen_expression(ctx, m);
+        codegen_emit(ctx, "->stride + (");
+        codegen_expression(ctx, expr->array_access.index);
+        codegen_emit(ctx, ")]");
+        return 1;
+    }
+    if (codegen_is_matrix_type(base->inferred_type)) {
+        codegen_emit(ctx, "(");
+        codegen_expression(ctx, base);
+        codegen_emit(ctx, "->data + (");
+        codegen_expression(ctx, expr->array_access.index);
+        codegen_emit(ctx, ") * ");
+        codegen_expression(ctx, base);
+        codegen_emit(ctx, "->stride)");
+        return 1;
+    }
+    return 0;
+}
+
+/* ========================================================================== */
+/* CONJUNTOS (TABELA HASH) */
+/* ========================================================================== */
+/*
+ * set[T] é um ponteiro para {len, cap, sorted, items, groups, ctrl, keys}.
+ * items guarda os elementos em ordem crescente: inserções em ordem estendem
+ * o prefixo ordenado e as demais ficam numa cauda que é ordenada e
+ * intercalada com o prefixo antes da próxima iteração, impressão ou
+ * operação (mathc_set_sorted). União, interseção, diferença e diferença
+ * simétrica são intercalações lineares dos dois arrays; para int a
+ * interseção compara blocos de 4 com SSE2. O índice é uma tabela de endereçamento aberto
+ * no estilo swiss table: cada slot tem um byte de controle (0x80 = vazio,
+ * senão os 7 bits baixos do hash) e os slots são sondados em grupos de 16.
+ * Com SSE2 um único _mm_cmpeq_epi8 compara os 16 bytes do grupo. A carga
+ * máxima é de 7/8 e x in s é O(1) esperado.
+ *
+ * set[int; 0..N] (escrito pelo usuário ou escolhido pelo otimizador quando
+ * o domínio é limitado) usa mathc_set_bits: um bit por valor do domínio.
+ * União, interseção e diferenças são laços de OR/AND/XOR palavra a palavra,
+ * a cardinalidade é o popcount das palavras e a iteração percorre os bits
+ * ligados, já em ordem crescente.
+ */
+
+typedef struct SetKind {
+    const char* suffix;   // mathc_set_<suffix>
+    const char* c_type;   // tipo C dos elementos
+    const char* printer;  // mathc_print_<printer> imprime um elemento
+    const char* free_fn;  // liberação no fim da função
+} SetKind;
+
+static const SetKind set_kinds[] = {
+    { "int", "int", "int", "mathc_set_free_int" },
+    { "float", "double", "float", "mathc_set_free_float" },
+    { "char", "char", "char", "mathc_set_free_char" },
+    { "string", "char*", "string", "mathc_set_free_string" },
+    { "bits", "int", "int", "mathc_set_free_bits" },  // set[int; 0..N]
+};
+
+#define SET_KIND_COUNT ((int)(sizeof(set_kinds) / sizeof(set_kinds[0])))
+
+int codegen_is_set_type(TypeSpec* t) {
+    return t && t->base_type == TYPE_SET;
+}
+
+static const SetKind* codegen_set_kind(TypeSpec* set_type) {
+    TypeSpec* elem = set_type ? set_type->element_type : NULL;
+    if (elem) {
+        if (elem->base_type == TYPE_INT && set_type->domain_max >= 0) return &set_kinds[4];
+        switch (elem->base_type) {
+            case TYPE_FLOAT: return &set_kinds[1];
+            case TYPE_CHAR: return &set_kinds[2];
+            case TYPE_STRING: return &set_kinds[3];
+            default: break;
+        }
+    }
+    return &set_kinds[0];
+}
+
+static const char* codegen_set_suffix(TypeSpec* set_type) {
+    return codegen_set_kind(set_type)->suffix;
+}
+
+const char* codegen_set_ptr_type(TypeSpec* set_type) {
+    static char buffers[SET_KIND_COUNT][32];
+    const SetKind* k = codegen_set_kind(set_type);
+    char* buf = buffers[k - set_kinds];
+    snprintf(buf, sizeof(buffers[0]), "mathc_set_%s*", k->suffix);
+    return buf;
+}
+
+static void codegen_emit_set_template(CodeGenContext* ctx, const char* tmpl, const SetKind* k) {
+    const char* values[] = { k->suffix, k->c_type, k->printer };
+    codegen_emit_subst(ctx, tmpl, "NTP", values);
+}
+
+static const char* set_template =
+    "typedef struct mathc_set_$N {\n"
+    "    int len;\n"
+    "    int cap;\n"
+    "    int sorted;           // items[0..sorted) em ordem crescente; o resto foi inserido depois\n"
+    "    $T* items;\n"
+    "    int groups;\n"
+    "    unsigned char* ctrl;\n"
+    "    $T* keys;\n"
+    "} mathc_set_$N;\n"
+    "static void mathc_set_index_$N(mathc_set_$N* s, int groups) {\n"
+    "    free(s->ctrl);\n"
+    "    size_t slots = (size_t)groups * MATHC_GROUP;\n"
+    "    s->ctrl = (unsigned char*)malloc(slots * (1 + sizeof($T)));\n"
+    "    if (!s->ctrl) { fprintf(stderr, \"Erro: memória insuficiente para conjunto\\n\"); exit(1); }\n"
+    "    memset(s->ctrl, MATHC_CTRL_EMPTY, slots);\n"
+    "    s->keys = ($T*)(s->ctrl + slots);\n"
+    "    s->groups = groups;\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_new_$N(int hint) {\n"
+    "    mathc_set_$N* s = (mathc_set_$N*)calloc(1, sizeof(mathc_set_$N));\n"
+    "    if (!s) { fprintf(stderr, \"Erro: memória insuficiente para conjunto\\n\"); exit(1); }\n"
+    "    mathc_set_index_$N(s, mathc_set_groups_for(hint));\n"
+    "    if (hint > 0) s->items = ($T*)mathc_vec_reserve(NULL, 0, &s->cap, hint, sizeof($T));\n"
+    "    return s;\n"
+    "}\n"
+    "static void mathc_set_free_$N(mathc_set_$N* s) {\n"
+    "    if (!s) return;\n"
+    "    free(s->items);\n"
+    "    free(s->ctrl);\n"
+    "    free(s);\n"
+    "}\n"
+    "static int mathc_set_find_$N(const mathc_set_$N* s, $T x, unsigned long long h) {\n"
+    "    size_t gmask = (size_t)s->groups - 1, g = (size_t)(h >> 7) & gmask;\n"
+    "    unsigned char tag = (unsigned char)(h & 0x7f);\n"
+    "    for (size_t step = 1; ; step++) {\n"
+    "        const unsigned char* ctrl = s->ctrl + g * MATHC_GROUP;\n"
+    "        for (unsigned m = mathc_group_match(ctrl, tag); m; m &= m - 1) {\n"
+    "            size_t slot = g * MATHC_GROUP + (size_t)__builtin_ctz(m);\n"
+    "            if (mathc_cmp_$N(s->keys[slot], x) == 0) return (int)slot;\n"
+    "        }\n"
+    "        if (mathc_group_empty(ctrl)) return -1;\n"
+    "        g = (g + step) & gmask;  // sondagem triangular: visita todos os grupos\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_set_place_$N(mathc_set_$N* s, $T x, unsigned long long h) {\n"
+    "    size_t gmask = (size_t)s->groups - 1, g = (size_t)(h >> 7) & gmask;\n"
+    "    for (size_t step = 1; ; step++) {\n"
+    "        unsigned char* ctrl = s->ctrl + g * MATHC_GROUP;\n"
+    "        unsigned e = mathc_group_empty(ctrl);\n"
+    "        if (e) {\n"
+    "            size_t b = (size_t)__builtin_ctz(e);\n"
+    "            ctrl[b] = (unsigned char)(h & 0x7f);\n"
+    "            s->keys[g * MATHC_GROUP + b] = x;\n"
+    "            return;\n"
+    "        }\n"
+    "        g = (g + step) & gmask;\n"
+    "    }\n"
+    "}\n"
+    "/* Reconstrói o índice a partir de items (após uma operação que preencheu items direto) */\n"
+    "static void mathc_set_reindex_$N(mathc_set_$N* s) {\n"
+    "    mathc_set_index_$N(s, mathc_set_groups_for(s->len));\n"
+    "    for (int i = 0; i < s->len; i++) mathc_set_place_$N(s, s->items[i], mathc_hash_$N(s->items[i]));\n"
+    "}\n"
+    "static int mathc_set_add_$N(mathc_set_$N* s, $T x) {\n"
+    "    unsigned long long h = mathc_hash_$N(x);\n"
+    "    if (mathc_set_find_$N(s, x, h) >= 0) return 0;\n"
+    "    if ((size_t)(s->len + 1) * 8 > (size_t)s->groups * MATHC_GROUP * 7) {\n"
+    "        mathc_set_index_$N(s, s->groups * 2);\n"
+    "        for (int i = 0; i < s->len; i++) mathc_set_place_$N(s, s->items[i], mathc_hash_$N(s->items[i]));\n"
+    "    }\n"
+    "    mathc_set_place_$N(s, x, h);\n"
+    "    s->items = ($T*)mathc_vec_grow(s->items, s->len, &s->cap, s->len + 1, sizeof($T));\n"
+    "    // Inserção em ordem (o caso comum ao construir por laço) mantém o prefixo ordenado\n"
+    "    if (s->sorted == s->len && (s->len == 0 || mathc_cmp_$N(s->items[s->len - 1], x) < 0)) s->sorted++;\n"
+    "    s->items[s->len++] = x;\n"
+    "    return 1;\n"
+    "}\n"
+    "static int mathc_set_contains_$N(const mathc_set_$N* s, $T x) {\n"
+    "    return s && s->len > 0 && mathc_set_find_$N(s, x, mathc_hash_$N(x)) >= 0;\n"
+    "}\n"
+    "static int mathc_qcmp_$N(const void* a, const void* b) { return mathc_cmp_$N(*(const $T*)a, *(const $T*)b); }\n"
+    "/* Ordena a cauda inserida fora de ordem e a intercala com o prefixo ordenado */\n"
+    "static mathc_set_$N* mathc_set_sorted_$N(mathc_set_$N* s) {\n"
+    "    if (!s || s->sorted == s->len) return s;\n"
+    "    int p = s->sorted, t = s->len - p;\n"
+    "    qsort(s->items + p, (size_t)t, sizeof($T), mathc_qcmp_$N);\n"
+    "    if (p > 0 && mathc_cmp_$N(s->items[p - 1], s->items[p]) > 0) {\n"
+    "        $T* tail = ($T*)malloc(sizeof($T) * (size_t)t);\n"
+    "        if (!tail) { fprintf(stderr, \"Erro: memória insuficiente para conjunto\\n\"); exit(1); }\n"
+    "        memcpy(tail, s->items + p, sizeof($T) * (size_t)t);\n"
+    "        int i = p - 1, j = t - 1, k = s->len - 1;\n"
+    "        while (j >= 0) s->items[k--] = i >= 0 && mathc_cmp_$N(s->items[i], tail[j]) > 0 ? s->items[i--] : tail[j--];\n"
+    "        free(tail);\n"
+    "    }\n"
+    "    s->sorted = s->len;\n"
+    "    return s;\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_from_$N($T const* xs, int n) {\n"
+    "    mathc_set_$N* s = mathc_set_new_$N(n);\n"
+    "    for (int i = 0; i < n; i++) mathc_set_add_$N(s, xs[i]);\n"
+    "    return mathc_set_sorted_$N(s);\n"
+    "}\n"
+    "/* Resultado de uma intercalação: items já ordenados, falta só o índice */\n"
+    "static mathc_set_$N* mathc_set_merged_$N(mathc_set_$N* r, int len) {\n"
+    "    r->len = r->sorted = len;\n"
+    "    mathc_set_reindex_$N(r);\n"
+    "    return r;\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_union_$N(mathc_set_$N* a, mathc_set_$N* b) {\n"
+    "    mathc_set_sorted_$N(a); mathc_set_sorted_$N(b);\n"
+    "    mathc_set_$N* r = mathc_set_new_$N(a->len + b->len);\n"
+    "    int i = 0, j = 0, k = 0;\n"
+    "    while (i < a->len && j < b->len) {\n"
+    "        int c = mathc_cmp_$N(a->items[i], b->items[j]);\n"
+    "        r->items[k++] = c <= 0 ? a->items[i] : b->items[j];\n"
+    "        i += c <= 0; j += c >= 0;\n"
+    "    }\n"
+    "    while (i < a->len) r->items[k++] = a->items[i++];\n"
+    "    while (j < b->len) r->items[k++] = b->items[j++];\n"
+    "    return mathc_set_merged_$N(r, k);\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_difference_$N(mathc_set_$N* a, mathc_set_$N* b) {\n"
+    "    mathc_set_sorted_$N(a); mathc_set_sorted_$N(b);\n"
+    "    mathc_set_$N* r = mathc_set_new_$N(a->len);\n"
+    "    int i = 0, j = 0, k = 0;\n"
+    "    while (i < a->len && j < b->len) {\n"
+    "        int c = mathc_cmp_$N(a->items[i], b->items[j]);\n"
+    "        if (c < 0) r->items[k++] = a->items[i];\n"
+    "        i += c <= 0; j += c >= 0;\n"
+    "    }\n"
+    "    while (i < a->len) r->items[k++] = a->items[i++];\n"
+    "    return mathc_set_merged_$N(r, k);\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_symmetric_diff_$N(mathc_set_$N* a, mathc_set_$N* b) {\n"
+    "    mathc_set_sorted_$N(a); mathc_set_sorted_$N(b);\n"
+    "    mathc_set_$N* r = mathc_set_new_$N(a->len + b->len);\n"
+    "    int i = 0, j = 0, k = 0;\n"
+    "    while (i < a->len && j < b->len) {\n"
+    "        int c = mathc_cmp_$N(a->items[i], b->items[j]);\n"
+    "        if (c != 0) r->items[k++] = c < 0 ? a->items[i] : b->items[j];\n"
+    "        i += c <= 0; j += c >= 0;\n"
+    "    }\n"
+    "    while (i < a->len) r->items[k++] = a->items[i++];\n"
+    "    while (j < b->len) r->items[k++] = b->items[j++];\n"
+    "    return mathc_set_merged_$N(r, k);\n"
+    "}\n"
+    "static mathc_set_$N* mathc_set_intersection_$N(mathc_set_$N* a, mathc_set_$N* b) {\n"
+    "    mathc_set_sorted_$N(a); mathc_set_sorted_$N(b);\n"
+    "    mathc_set_$N* r = mathc_set_new_$N(a->len < b->len ? a->len : b->len);\n"
+    "    return mathc_set_merged_$N(r, mathc_intersect_items_$N(a->items, a->len, b->items, b->len, r->items));\n"
+    "}\n"
+    "static int mathc_set_is_subset_$N(const mathc_set_$N* a, const mathc_set_$N* b) {\n"
+    "    if (a->len > b->len) return 0;\n"
+    "    for (int i = 0; i < a->len; i++) {\n"
+    "        if (!mathc_set_contains_$N(b, a->items[i])) return 0;\n"
+    "    }\n"
+    "    return 1;\n"
+    "}\n"
+    "static int mathc_set_equal_$N(const mathc_set_$N* a, const mathc_set_$N* b) { return a->len == b->len && mathc_set_is_subset_$N(a, b); }\n"
+    "static int mathc_set_is_superset_$N(const mathc_set_$N* a, const mathc_set_$N* b) { return mathc_set_is_subset_$N(b, a); }\n"
+    "static void mathc_print_set_$N(mathc_set_$N* s) {\n"
+    "    mathc_set_sorted_$N(s);\n"
+    "    mathc_out_char('{');\n"
+    "    for (int i = 0; s && i < s->len; i++) {\n"
+    "        if (i > 0) mathc_out_write(\", \", 2);\n"
+    "        mathc_print_$P(s->items[i]);\n"
+    "    }\n"
+    "    mathc_out_char('}');\n"
+    "}\n"
+    "static void mathc_println_set_$N(mathc_set_$N* s) { mathc_print_set_$N(s); mathc_out_newline(); }\n";
+
+/* Interseção por intercalação escalar (int tem uma versão SSE2 própria) */
+static const char* set_intersect_template =
+    "static int mathc_intersect_items_$N($T const* a, int na, $T const* b, int nb, $T* out) {\n"
+    "    int i = 0, j = 0, k = 0;\n"
+    "    while (i < na && j < nb) {\n"
+    "        int c = mathc_cmp_$N(a[i], b[j]);\n"
+    "        if (c == 0) out[k++] = a[i];\n"
+    "        i += c <= 0; j += c >= 0;\n"
+    "    }\n"
+    "    return k;\n"
+    "}\n";
+
+/* set[int; 0..N]: vetor de bits; as operações entre conjuntos são palavra a palavra */
+static const char* set_bits_runtime =
+    "typedef struct mathc_set_bits {\n"
+    "    int len;              // cardinalidade (popcount das palavras)\n"
+    "    int domain;           // valores válidos: 0..domain-1\n"
+    "    int words;\n"
+    "    unsigned long long* bits;\n"
+    "    int* items;           // visão ordenada para iteração (mathc_set_sorted_bits)\n"
+    "    int cap;\n"
+    "    int stale;            // items desatualizado em relação a bits\n"
+    "} mathc_set_bits;\n"
+    "static mathc_set_bits* mathc_set_new_bits(int domain) {\n"
+    "    mathc_set_bits* s = (mathc_set_bits*)calloc(1, sizeof(mathc_set_bits));\n"
+    "    if (!s) { fprintf(stderr, \"Erro: memória insuficiente para conjunto\\n\"); exit(1); }\n"
+    "    s->domain = domain;\n"
+    "    s->words = (domain + 63) / 64;\n"
+    "    s->bits = (unsigned long long*)calloc((size_t)s->words + 1, sizeof(unsigned long long));\n"
+    "    if (!s->bits) { fprintf(stderr, \"Erro: memória insuficiente para conjunto\\n\"); exit(1); }\n"
+    "    return s;\n"
+    "}\n"
+    "static void mathc_set_free_bits(mathc_set_bits* s) {\n"
+    "    if (!s) return;\n"
+    "    free(s->bits);\n"
+    "    free(s->items);\n"
+    "    free(s);\n"
+    "}\n"
+    "static int mathc_set_add_bits(mathc_set_bits* s, int x) {\n"
+    "    if ((unsigned)x >= (unsigned)s->domain) {\n"
+    "        fprintf(stderr, \"Erro: %d fora do domínio 0..%d do conjunto\\n\", x, s->domain - 1);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    unsigned long long m = 1ULL << (x & 63), *w = &s->bits[x >> 6];\n"
+    "    if (*w & m) return 0;\n"
+    "    *w |= m;\n"
+    "    s->len++;\n"
+    "    s->stale = 1;\n"
+    "    return 1;\n"
+    "}\n"
+    "static int mathc_set_contains_bits(const mathc_set_bits* s, int x) {\n"
+    "    return s && (unsigned)x < (unsigned)s->domain && (s->bits[x >> 6] >> (x & 63) & 1);\n"
+    "}\n"
+    "static mathc_set_bits* mathc_set_from_bits(int const* xs, int n, int domain) {\n"
+    "    mathc_set_bits* s = mathc_set_new_bits(domain);\n"
+    "    for (int i = 0; i < n; i++) mathc_set_add_bits(s, xs[i]);\n"
+    "    return s;\n"
+    "}\n"
+    "/* Resultado de uma operação palavra a palavra: falta só a cardinalidade */\n"
+    "static mathc_set_bits* mathc_set_bits_done(mathc_set_bits* r) {\n"
+    "    int c = 0;\n"
+    "    for (int i = 0; i < r->words; i++) c += __builtin_popcountll(r->bits[i]);\n"
+    "    r->len = c;\n"
+    "    r->stale = 1;\n"
+    "    return r;\n"
+    "}\n"
+    "/* Preenche items com os bits ligados, em ordem crescente */\n"
+    "static mathc_set_bits* mathc_set_sorted_bits(mathc_set_bits* s) {\n"
+    "    if (!s || !s->stale) return s;\n"
+    "    s->items = (int*)mathc_vec_reserve(s->items, 0, &s->cap, s->len, sizeof(int));\n"
+    "    int k = 0;\n"
+    "    for (int i = 0; i < s->words; i++)\n"
+    "        for (unsigned long long w = s->bits[i]; w; w &= w - 1) s->items[k++] = i * 64 + __builtin_ctzll(w);\n"
+    "    s->stale = 0;\n"
+    "    return s;\n"
+    "}\n"
+    "static mathc_set_bits* mathc_set_union_bits(const mathc_set_bits* a, const mathc_set_bits* b) {\n"
+    "    if (a->words < b->words) { const mathc_set_bits* t = a; a = b; b = t; }\n"
+    "    mathc_set_bits* r = mathc_set_new_bits(a->domain > b->domain ? a->domain : b->domain);\n"
+    "    for (int i = 0; i < b->words; i++) r->bits[i] = a->bits[i] | b->bits[i];\n"
+    "    for (int i = b->words; i < a->words; i++) r->bits[i] = a->bits[i];\n"
+    "    return mathc_set_bits_done(r);\n"
+    "}\n"
+    "static mathc_set_bits* mathc_set_intersection_bits(const mathc_set_bits* a, const mathc_set_bits* b) {\n"
+    "    mathc_set_bits* r = mathc_set_new_bits(a->domain < b->domain ? a->domain : b->domain);\n"
+    "    for (int i = 0; i < r->words; i++) r->bits[i] = a->bits[i] & b->bits[i];\n"
+    "    return mathc_set_bits_done(r);\n"
+    "}\n"
+    "static mathc_set_bits* mathc_set_difference_bits(const mathc_set_bits* a, const mathc_set_bits* b) {\n"
+    "    mathc_set_bits* r = mathc_set_new_bits(a->domain);\n"
+    "    int n = a->words < b->words ? a->words : b->words;\n"
+    "    for (int i = 0; i < n; i++) r->bits[i] = a->bits[i] & ~b->bits[i];\n"
+    "    for (int i = n; i < a->words; i++) r->bits[i] = a->bits[i];\n"
+    "    return mathc_set_bits_done(r);\n"
+    "}\n"
+    "static mathc_set_bits* mathc_set_symmetric_diff_bits(const mathc_set_bits* a, const mathc_set_bits* b) {\n"
+    "    if (a->words < b->words) { const mathc_set_bits* t = a; a = b; b = t; }\n"
+    "    mathc_set_bits* r = mathc_set_new_bits(a->domain > b->domain ? a->domain : b->domain);\n"
+    "    for (int i = 0; i < b->words; i++) r->bits[i] = a->bits[i] ^ b->bits[i];\n"
+    "    for (int i = b->words; i < a->words; i++) r->bits[i] = a->bits[i];\n"
+    "    return mathc_set_bits_done(r);\n"
+    "}\n"
+    "static int mathc_set_is_subset_bits(const mathc_set_bits* a, const mathc_set_bits* b) {\n"
+    "    if (a->len > b->len) return 0;\n"
+    "    unsigned long long fora = 0;\n"
+    "    for (int i = 0; i < a->words; i++) fora |= a->bits[i] & ~(i < b->words ? b->bits[i] : 0);\n"
+    "    return fora == 0;\n"
+    "}\n"
+    "static int mathc_set_is_superset_bits(const mathc_set_bits* a, const mathc_set_bits* b) { return mathc_set_is_subset_bits(b, a); }\n"
+    "static int mathc_set_equal_bits(const mathc_set_bits* a, const mathc_set_bits* b) { return a->len == b->len && mathc_set_is_subset_bits(a, b); }\n"
+    "static void mathc_print_set_bits(const mathc_set_bits* s) {\n"
+    "    mathc_out_char('{');\n"
+    "    int first = 1;\n"
+    "    for (int i = 0; s && i < s->words; i++)\n"
+    "        for (unsigned long long w = s->bits[i]; w; w &= w - 1, first = 0) {\n"
+    "            if (!first) mathc_out_write(\", \", 2);\n"
+    "            mathc_out_ll(i * 64 + __builtin_ctzll(w));\n"
+    "        }\n"
+    "    mathc_out_char('}');\n"
+    "}\n"
+    "static void mathc_println_set_bits(const mathc_set_bits* s) { mathc_print_set_bits(s); mathc_out_newline(); }\n"
+    "/* Conversões quando um set[int; 0..N] encontra um set[int] comum */\n"
+    "static mathc_set_bits* mathc_set_bits_of_int(const mathc_set_int* s) {\n"
+    "    int domain = 0;\n"
+    "    for (int i = 0; i < s->len; i++) {\n"
+    "        if (s->items[i] < 0) { fprintf(stderr, \"Erro: %d fora do domínio de set[int; 0..N]\\n\", s->items[i]); exit(1); }\n"
+    "        if (s->items[i] >= domain) domain = s->items[i] + 1;\n"
+    "    }\n"
+    "    return mathc_set_from_bits(s->items, s->len, domain);\n"
+    "}\n"
+    "static mathc_set_int* mathc_set_int_of_bits(mathc_set_bits* s) {\n"
+    "    mathc_set_sorted_bits(s);\n"
+    "    return mathc_set_from_int(s->items, s->len);\n"
+    "}\n";
+
+static void codegen_set_runtime(CodeGenContext* ctx) {
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("#include <emmintrin.h>\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("#define MATHC_GROUP 16\n", ctx->output);
+    fputs("#define MATHC_CTRL_EMPTY 0x80\n", ctx->output);
+    // Bits i dos slots do grupo cujo controle é igual a tag / está vazio
+    fputs("static inline unsigned mathc_group_match(const unsigned char* g, unsigned char tag) {\n", ctx->output);
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("    __m128i v = _mm_loadu_si128((const __m128i*)g);\n", ctx->output);
+    fputs("    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)tag)));\n", ctx->output);
+    fputs("#else\n", ctx->output);
+    fputs("    unsigned m = 0;\n", ctx->output);
+    fputs("    for (int i = 0; i < MATHC_GROUP; i++) m |= (unsigned)(g[i] == tag) << i;\n", ctx->output);
+    fputs("    return m;\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static inline unsigned mathc_group_empty(const unsigned char* g) {\n", ctx->output);
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("    return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)g));\n", ctx->output);
+    fputs("#else\n", ctx->output);
+    fputs("    return mathc_group_match(g, MATHC_CTRL_EMPTY);\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("}\n", ctx->output);
+    // Menor potência de 2 de grupos que mantém n elementos abaixo da carga de 7/8
+    fputs("static int mathc_set_groups_for(int n) {\n", ctx->output);
+    fputs("    int groups = 1;\n", ctx->output);
+    fputs("    while ((size_t)groups * MATHC_GROUP * 7 < (size_t)n * 8) groups *= 2;\n", ctx->output);
+    fputs("    return groups;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    // Finalizador do murmur3: espalha os bits para o índice do grupo e os 7 bits do controle
+    fputs("static inline unsigned long long mathc_hash_mix(unsigned long long h) {\n", ctx->output);
+    fputs("    h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;\n", ctx->output);
+    fputs("    h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;\n", ctx->output);
+    fputs("    return h ^ (h >> 33);\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static inline unsigned long long mathc_hash_int(int x) { return mathc_hash_mix((unsigned)x); }\n", ctx->output);
+    fputs("static inline unsigned long long mathc_hash_char(char x) { return mathc_hash_mix((unsigned char)x); }\n", ctx->output);
+    fputs("static inline unsigned long long mathc_hash_float(double x) {\n", ctx->output);
+    fputs("    unsigned long long b;\n", ctx->output);
+    fputs("    if (x == 0) x = 0;  // -0.0 e 0.0 são o mesmo elemento\n", ctx->output);
+    fputs("    memcpy(&b, &x, sizeof(b));\n", ctx->output);
+    fputs("    return mathc_hash_mix(b);\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static inline unsigned long long mathc_hash_string(const char* x) {\n", ctx->output);
+    fputs("    unsigned long long h = 1469598103934665603ULL;\n", ctx->output);
+    fputs("    while (x && *x) { h ^= (unsigned char)*x++; h *= 1099511628211ULL; }\n", ctx->output);
+    fputs("    return mathc_hash_mix(h);\n", ctx->output);
+    fputs("}\n", ctx->output);
+    // Ordem total dos elementos (0 também decide a igualdade na tabela)
+    fputs("static inline int mathc_cmp_int(int a, int b) { return (a > b) - (a < b); }\n", ctx->output);
+    fputs("static inline int mathc_cmp_char(char a, char b) { return (a > b) - (a < b); }\n", ctx->output);
+    fputs("static inline int mathc_cmp_float(double a, double b) { return (a > b) - (a < b); }\n", ctx->output);
+    fputs("static inline int mathc_cmp_string(const char* a, const char* b) { return a == b ? 0 : !a ? -1 : !b ? 1 : strcmp(a, b); }\n", ctx->output);
+
+    // int: blocos de 4 de cada lado comparados em 4 rotações (SSE2), cauda escalar
+    fputs("static int mathc_intersect_items_int(const int* a, int na, const int* b, int nb, int* out) {\n", ctx->output);
+    fputs("    int i = 0, j = 0, k = 0;\n", ctx->output);
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("    while (i + 4 <= na && j + 4 <= nb) {\n", ctx->output);
+    fputs("        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));\n", ctx->output);
+    fputs("        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));\n", ctx->output);
+    fputs("        __m128i e0 = _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));\n", ctx->output);
+    fputs("        __m128i e1 = _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),\n", ctx->output);
+    fputs("                                  _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));\n", ctx->output);
+    fputs("        for (int m = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(e0, e1))); m; m &= m - 1) out[k++] = a[i + __builtin_ctz(m)];\n", ctx->output);
+    fputs("        int amax = a[i + 3], bmax = b[j + 3];\n", ctx->output);
+    fputs("        i += (amax <= bmax) * 4;\n", ctx->output);
+    fputs("        j += (bmax <= amax) * 4;\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("    while (i < na && j < nb) {\n", ctx->output);
+    fputs("        if (a[i] == b[j]) out[k++] = a[i];\n", ctx->output);
+    fputs("        int ai = a[i], bj = b[j];\n", ctx->output);
+    fputs("        i += ai <= bj; j += bj <= ai;\n", ctx->output);
+    fputs("    }\n", ctx->output);
+    fputs("    return k;\n", ctx->output);
+    fputs("}\n", ctx->output);
+    for (int i = 0; i < SET_KIND_COUNT; i++) {
+        if (strcmp(set_kinds[i].suffix, "bits") == 0) continue;
+        if (strcmp(set_kinds[i].suffix, "int") != 0) codegen_emit_set_template(ctx, set_intersect_template, &set_kinds[i]);
+        codegen_emit_set_template(ctx, set_template, &set_kinds[i]);
+    }
+    // Os laços palavra a palavra ficam vetorizados mesmo sem -O3
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs(set_bits_runtime, ctx->output);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+static int visit_uses_sets(ASTNode* node, void* data) {
+    int* found = (int*)data;
+    if (node->type == NODE_SET_LITERAL || codegen_is_set_type(node->inferred_type)) *found = 1;
+    if (node->type == NODE_DECLARATION && codegen_is_set_type(node->declaration.var_type)) *found = 1;
+    if (node->type == NODE_FUNCTION_DEF) {
+        if (codegen_is_set_type(node->function_def.return_type)) *found = 1;
+        for (ParamList* p = node->function_def.parameters; p; p = p->next) {
+            if (codegen_is_set_type(p->type)) *found = 1;
+        }
+    }
+    return *found;
+}
+
+static int codegen_program_uses_sets(ASTNode* program) {
+    int found = 0;
+    ast_walk(program, visit_uses_sets, &found);
+    return found;
+}
+
+/* Operações que devolvem um conjunto novo no heap */
+static const char* set_result_builtins[] = { "union", "difference", "intersection", "symmetric_diff", NULL };
+
+/* Predicados sobre dois conjuntos */
+static const char* set_predicate_builtins[] = { "is_subset", "is_superset", NULL };
+
+static const char* codegen_set_op_name(int op) {
+    switch (op) {
+        case OP_ADD: return "union";
+        case OP_SUB: return "difference";
+        default: return NULL;
+    }
+}
+
+/* Conjunto recém-alocado por uma expressão (a + b, a - b, union(a, b), ...) */
+static int codegen_is_fresh_set_expr(ASTNode* e) {
+    if (!e) return 0;
+    if (e->type == NODE_SET_LITERAL) return 1;
+    if (e->type == NODE_BINARY_OP && codegen_is_set_type(e->inferred_type) && codegen_set_op_name(e->binary_op.op)) return 1;
+    return e->type == NODE_CALL && e->call.function && e->call.function->type == NODE_IDENTIFIER &&
+           escape_in_list(set_result_builtins, e->call.function->identifier.name);
+}
+
+static int codegen_set_is_bits(const SetKind* k) {
+    return k == &set_kinds[4];
+}
+
+/* Conjunto vazio: capacidade inicial para a tabela, tamanho do domínio para o bitset */
+static void codegen_set_new(CodeGenContext* ctx, TypeSpec* set_type, int hint) {
+    const SetKind* k = codegen_set_kind(set_type);
+    codegen_emit(ctx, "mathc_set_new_%s(%d)", k->suffix, codegen_set_is_bits(k) ? set_type->domain_max + 1 : hint);
+}
+
+/* {a, b, c}: literal composto constante quando possível, senão conjunto vazio para inserções uma a uma */
+static void codegen_set_literal_value(CodeGenContext* ctx, TypeSpec* set_type, NodeList* elements) {
+    const SetKind* k = codegen_set_kind(set_type);
+    int count = 0;
+    for (NodeList* el = elements; el; el = el->next) count++;
+    if (count > 0 && escape_all_constant(elements)) {
+        codegen_emit(ctx, "mathc_set_from_%s((%s const[]){", k->suffix, k->c_type);
+        int first = 1;
+        for (NodeList* el = elements; el; el = el->next, first = 0) {
+            if (!first) codegen_emit(ctx, ", ");
+            codegen_expression(ctx, el->node);
+        }
+        codegen_emit(ctx, "}, %d", count);
+        if (codegen_set_is_bits(k)) codegen_emit(ctx, ", %d", set_type->domain_max + 1);
+        codegen_emit(ctx, ")");
+        return;
+    }
+    codegen_set_new(ctx, set_type, count);
+}
+
+/* Um literal sem tipo próprio ({1, 2} como operando) assume o tipo do outro conjunto */
+static void codegen_set_literal_context(ASTNode* e, TypeSpec* set_type) {
+    if (e && e->type == NODE_SET_LITERAL && !e->inferred_type && codegen_is_set_type(set_type)) e->inferred_type = set_type;
+}
+
+/* Expressão de conjunto na representação k: converte entre set[int] e set[int; 0..N] */
+static int codegen_set_operand(CodeGenContext* ctx, ASTNode* e, const SetKind* k) {
+    const SetKind* from = codegen_is_set_type(e->inferred_type) ? codegen_set_kind(e->inferred_type) : k;
+    if (from == k) {
+        codegen_expression(ctx, e);
+        return 0;
+    }
+    codegen_emit(ctx, "mathc_set_%s_of_%s(", k->suffix, from->suffix);
+    codegen_expression(ctx, e);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+void codegen_set_declaration(CodeGenContext* ctx, ASTNode* stmt, TypeSpec* var_type) {
+    const char* name = stmt->declaration.name;
+    const SetKind* k = codegen_set_kind(var_type);
+    ASTNode* init = stmt->declaration.initializer;
+
+    codegen_emit(ctx, "mathc_set_%s* %s = ", k->suffix, name);
+    if (!init) {
+        codegen_set_new(ctx, var_type, 0);
+        codegen_emit(ctx, ";\n");
+        codegen_record_alloc_fn(ctx, name, k->free_fn);
+        return;
+    }
+    if (init->type == NODE_SET_LITERAL) {
+        codegen_set_literal_value(ctx, var_type, init->set_literal.elements);
+        codegen_emit(ctx, ";\n");
+        if (!escape_all_constant(init->set_literal.elements)) {
+            for (NodeList* el = init->set_literal.elements; el; el = el->next) {
+                codegen_emit_indent(ctx);
+                codegen_emit(ctx, "mathc_set_add_%s(%s, ", k->suffix, name);
+                codegen_expression(ctx, el->node);
+                codegen_emit(ctx, ");\n");
+            }
+        }
+        codegen_record_alloc_fn(ctx, name, k->free_fn);
+        return;
+    }
+    int converted = codegen_set_operand(ctx, init, k);
+    codegen_emit(ctx, ";\n");
+    // Resultado de operação pertence à função; outro conjunto é apenas referenciado
+    if (converted || codegen_is_fresh_set_expr(init)) codegen_record_alloc_fn(ctx, name, k->free_fn);
+}
+
+/* a + b, a - b, x in s, a in b (subconjunto); devolve 0 se nenhum operando é conjunto */
+static int codegen_set_binary(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* left = expr->binary_op.left;
+    ASTNode* right = expr->binary_op.right;
+    codegen_set_literal_context(right, left->inferred_type);
+    codegen_set_literal_context(left, right->inferred_type);
+    int left_is_set = codegen_is_set_type(left->inferred_type);
+    int right_is_set = codegen_is_set_type(right->inferred_type);
+    if (!left_is_set && !right_is_set) return 0;
+
+    const SetKind* k = codegen_set_kind(left_is_set ? left->inferred_type : right->inferred_type);
+    const char* op = codegen_set_op_name(expr->binary_op.op);
+    if (op && left_is_set && right_is_set) {
+        codegen_emit(ctx, "mathc_set_%s_%s(", op, k->suffix);
+        codegen_set_operand(ctx, left, k);
+        codegen_emit(ctx, ", ");
+        codegen_set_operand(ctx, right, k);
+        codegen_emit(ctx, ")");
+    } else if ((expr->binary_op.op == OP_EQ || expr->binary_op.op == OP_NEQ) && left_is_set && right_is_set) {
+        codegen_emit(ctx, "%smathc_set_equal_%s(", expr->binary_op.op == OP_NEQ ? "!" : "", k->suffix);
+        codegen_set_operand(ctx, left, k);
+        codegen_emit(ctx, ", ");
+        codegen_set_operand(ctx, right, k);
+        codegen_emit(ctx, ")");
+    } else if (expr->binary_op.op == OP_IN && left_is_set && right_is_set) {
+        codegen_emit(ctx, "mathc_set_is_subset_%s(", k->suffix);
+        codegen_set_operand(ctx, left, k);
+        codegen_emit(ctx, ", ");
+        codegen_set_operand(ctx, right, k);
+        codegen_emit(ctx, ")");
+    } else if (expr->binary_op.op == OP_IN && right_is_set) {
+        codegen_emit(ctx, "mathc_set_contains_%s(", k->suffix);
+        codegen_expression(ctx, right);
+        codegen_emit(ctx, ", ");
+        codegen_expression(ctx, left);
+        codegen_emit(ctx, ")");
+    } else {
+        codegen_emit(ctx, "/* operacao de conjuntos nao suportada */");
+    }
+    return 1;
+}
+
+/* Operações de set_result_builtins/set_predicate_builtins e cardinality; devolve 0 se `name` não for uma delas */
+static int codegen_set_call(CodeGenContext* ctx, const char* name, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    ASTNode* a = args ? args->node : NULL;
+    ASTNode* b = args && args->next ? args->next->node : NULL;
+    int binary = escape_in_list(set_result_builtins, name) || escape_in_list(set_predicate_builtins, name);
+    if (!binary && strcmp(name, "cardinality") != 0) return 0;
+
+    if (binary && a && b) {
+        codegen_set_literal_context(b, a->inferred_type);
+        codegen_set_literal_context(a, b->inferred_type);
+    }
+
+    if (!a || !codegen_is_set_type(a->inferred_type) || (binary && (!b || !codegen_is_set_type(b->inferred_type)))) {
+        codegen_error(ctx, call, "%s requer conjuntos", name);
+        codegen_emit(ctx, "0");
+        return 1;
+    }
+    const SetKind* k = codegen_set_kind(a->inferred_type);
+    if (!binary) {
+        codegen_emit(ctx, "(");
+        codegen_expression(ctx, a);
+        codegen_emit(ctx, ")->len");
+        return 1;
+    }
+    codegen_emit(ctx, "mathc_set_%s_%s(", name, k->suffix);
+    codegen_expression(ctx, a);
+    codegen_emit(ctx, ", ");
+    codegen_set_operand(ctx, b, k);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+/* s.add(x) / s.contains(x) */
+static int codegen_set_method(CodeGenContext* ctx, ASTNode* obj, const char* method, NodeList* args) {
+    if (!args || (strcmp(method, "add") != 0 && strcmp(method, "contains") != 0)) return 0;
+    codegen_emit(ctx, "mathc_set_%s_%s(", method, codegen_set_kind(obj->inferred_type)->suffix);
+    codegen_expression(ctx, obj);
+    codegen_emit(ctx, ", ");
+    codegen_expression(ctx, args->node);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+/* ========================================================================== */
+/* FUNÇÕES DE ARRAYS (min_element, max_element, find, count, reverse, print) */
+/* ========================================================================== */
+/*
+ * Uma instância por tipo de elemento, escolhida pelo TypeSpec do array
+ * (mathc_find_float, mathc_print_array_string, ...). min_element e
+ * max_element usam a forma x < m ? x : m e count soma as comparações, que
+ * o gcc vetoriza; find conta os acertos em blocos de 64 elementos sem desvio
+ * (64 para o laço não ser desenrolado antes do vetorizador) e só varre o
+ * bloco em que houve acerto. Arrays de tipo desconhecido usam a versão int.
+ */
+
+typedef struct ElemKind {
+    const char* suffix;   // mathc_<função>_<suffix>
+    const char* c_type;   // tipo C dos elementos
+    const char* eq;       // a == b
+    const char* lt;       // a < b; NULL se o tipo não tem ordem
+    const char* zero;     // resultado de min_element/max_element de um array vazio
+    const char* printer;  // mathc_print_<printer> imprime um elemento
+} ElemKind;
+
+static const ElemKind elem_kinds[] = {
+    { "int", "int", "a == b", "a < b", "0", "int" },
+    { "float", "double", "a == b", "a < b", "0.0", "float" },
+    { "char", "char", "a == b", "a < b", "'\\0'", "char" },
+    { "bool", "bool", "a == b", "a < b", "false", "int" },
+    { "string", "char*", "strcmp(a, b) == 0", "strcmp(a, b) < 0", "\"\"", "string" },
+    { "complex", "double complex", "a == b", NULL, "0.0", "complex" },
+};
+
+#define ELEM_KIND_COUNT ((int)(sizeof(elem_kinds) / sizeof(elem_kinds[0])))
+
+static const char* array_helper_builtins[] = { "min_element", "max_element", "find", "count", "reverse", NULL };
+
+static const char* array_helper_template =
+    "static inline int mathc_elem_eq_$N($T a, $T b) { return $E; }\n"
+    "static void mathc_reverse_$N($T* a, int n) {\n"
+    "    for (int i = 0, j = n - 1; i < j; i++, j--) { $T t = a[i]; a[i] = a[j]; a[j] = t; }\n"
+    "}\n"
+    "static int mathc_find_$N($T const* a, int n, $T v) {\n"
+    "    int i = 0;\n"
+    "    for (; i + 64 <= n; i += 64) {\n"
+    "        int hit = 0;\n"
+    "        for (int j = 0; j < 64; j++) hit += mathc_elem_eq_$N(a[i + j], v);\n"
+    "        if (hit) break;\n"
+    "    }\n"
+    "    for (; i < n; i++) if (mathc_elem_eq_$N(a[i], v)) return i;\n"
+    "    return -1;\n"
+    "}\n"
+    "static int mathc_count_$N($T const* a, int n, $T v) {\n"
+    "    int c = 0;\n"
+    "    for (int i = 0; i < n; i++) c += mathc_elem_eq_$N(a[i], v);\n"
+    "    return c;\n"
+    "}\n";
+
+static const char* array_order_template =
+    "static inline int mathc_elem_lt_$N($T a, $T b) { return $L; }\n"
+    "static $T mathc_min_element_$N($T const* a, int n) {\n"
+    "    if (!a || n <= 0) return $Z;\n"
+    "    $T m = a[0];\n"
+    "    for (int i = 1; i < n; i++) m = mathc_elem_lt_$N(a[i], m) ? a[i] : m;\n"
+    "    return m;\n"
+    "}\n"
+    "static $T mathc_max_element_$N($T const* a, int n) {\n"
+    "    if (!a || n <= 0) return $Z;\n"
+    "    $T m = a[0];\n"
+    "    for (int i = 1; i < n; i++) m = mathc_elem_lt_$N(m, a[i]) ? a[i] : m;\n"
+    "    return m;\n"
+    "}\n";
+
+static const char* array_print_template =
+    "void mathc_print_array_$N($T const* a, int n) {\n"
+    "    mathc_out_char('[');\n"
+    "    for (int i = 0; i < n; i++) {\n"
+    "        if (i > 0) mathc_out_write(\", \", 2);\n"
+    "        mathc_print_$P(a[i]);\n"
+    "    }\n"
+    "    mathc_out_char(']');\n"
+    "}\n"
+    "void mathc_println_array_$N($T const* a, int n) { mathc_print_array_$N(a, n); mathc_out_newline(); }\n";
+
+static void codegen_elem_subst(CodeGenContext* ctx, const char* tmpl, const ElemKind* k) {
+    const char* values[] = { k->suffix, k->c_type, k->eq, k->lt ? k->lt : "0", k->zero, k->printer };
+    codegen_emit_subst(ctx, tmpl, "NTELZP", values);
+}
+
+static void codegen_array_helpers_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    for (int i = 0; i < ELEM_KIND_COUNT; i++) {
+        codegen_elem_subst(ctx, array_helper_template, &elem_kinds[i]);
+        if (elem_kinds[i].lt) codegen_elem_subst(ctx, array_order_template, &elem_kinds[i]);
+    }
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+static void codegen_array_print_runtime(CodeGenContext* ctx) {
+    for (int i = 0; i < ELEM_KIND_COUNT; i++) codegen_elem_subst(ctx, array_print_template, &elem_kinds[i]);
+    fputs("\n", ctx->output);
+}
+
+/* Instância de elem_kinds para o tipo do array; tipo desconhecido usa int */
+static const ElemKind* codegen_elem_kind(TypeSpec* array_type) {
+    TypeSpec* e = array_type && array_type->base_type == TYPE_ARRAY ? array_type->element_type : NULL;
+    const char* suffix = "int";
+    if (e) {
+        switch (e->base_type) {
+            case TYPE_FLOAT: suffix = "float"; break;
+            case TYPE_CHAR: suffix = "char"; break;
+            case TYPE_BOOL: suffix = "bool"; break;
+            case TYPE_STRING: suffix = "string"; break;
+            case TYPE_COMPLEX: suffix = "complex"; break;
+            default: break;
+        }
+    }
+    for (int i = 0; i < ELEM_KIND_COUNT; i++)
+        if (strcmp(elem_kinds[i].suffix, suffix) == 0) return &elem_kinds[i];
+    return &elem_kinds[0];
+}
+
+/* min_element/max_element/reverse(arr) e find/count(arr, valor) */
+static void codegen_array_helper_call(CodeGenContext* ctx, const char* name, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    ASTNode* arr = args ? args->node : NULL;
+    int needs_value = strcmp(name, "find") == 0 || strcmp(name, "count") == 0;
+    if (!arr || arr->type != NODE_IDENTIFIER || (needs_value && !args->next)) {
+        codegen_error(ctx, call, "%s requer uma variável array%s", name, needs_value ? " e um valor" : "");
+        codegen_emit(ctx, "0");
+        return;
+    }
+    const ElemKind* k = codegen_elem_kind(arr->inferred_type);
+    if (!k->lt && (strcmp(name, "min_element") == 0 || strcmp(name, "max_element") == 0)) {
+        codegen_error(ctx, call, "%s requer elementos ordenáveis", name);
+        codegen_emit(ctx, "0");
+        return;
+    }
+    codegen_emit(ctx, "mathc_%s_%s(%s, %s__len", name, k->suffix, arr->identifier.name, arr->identifier.name);
+    if (needs_value) {
+        codegen_emit(ctx, ", ");
+        codegen_expression(ctx, args->next->node);
+    }
+    codegen_emit(ctx, ")");
+}
+
+/* ========================================================================== */
+/* ESTATÍSTICAS (sum, mean, prod, variance, std) */
+/* ========================================================================== */
+/*
+ * Uma versão por tipo de elemento (int, float, complex), escolhida pelo tipo
+ * do array. int soma em long long (exata até 2^31 elementos). float e complex
+ * usam soma compensada de Kahan com quatro acumuladores SSE2 de dois
+ * doubles: os lanes são as posições pares e ímpares do float[] ou as partes
+ * real e imaginária do complex[]. variance percorre a memória uma vez: cada
+ * bloco de MATHC_STAT_BLOCK elementos tem média e desvios calculados com ele
+ * ainda no cache e é combinado ao acumulado pela fórmula de Chan (Welford
+ * por blocos). Variância populacional (divide por n); a de complex é
+ * E|z - média|^2.
+ */
+
+static const char* stats_builtins[] = { "sum", "mean", "prod", "variance", "std", NULL };
+
+// variance/std/prod de int e float; $S acumula as somas do bloco (long long para int)
+static const char* stats_m2_template =
+    "static double mathc_m2_$N(const $T* a, int n, double* mean_out) {\n"
+    "    double mean = 0.0, m2 = 0.0;\n"
+    "    long long cnt = 0;\n"
+    "    for (int b = 0; b < n; b += MATHC_STAT_BLOCK) {\n"
+    "        int m = n - b < MATHC_STAT_BLOCK ? n - b : MATHC_STAT_BLOCK, i;\n"
+    "        const $T* x = a + b;\n"
+    "        $S s0 = 0, s1 = 0, s2 = 0, s3 = 0;\n"
+    "        for (i = 0; i + 4 <= m; i += 4) { s0 += x[i]; s1 += x[i + 1]; s2 += x[i + 2]; s3 += x[i + 3]; }\n"
+    "        for (; i < m; i++) s0 += x[i];\n"
+    "        double mb = (double)((s0 + s1) + (s2 + s3)) / m;\n"
+    "        double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;\n"
+    "        for (i = 0; i + 4 <= m; i += 4) {\n"
+    "            double d0 = x[i] - mb, d1 = x[i + 1] - mb, d2 = x[i + 2] - mb, d3 = x[i + 3] - mb;\n"
+    "            q0 += d0 * d0; q1 += d1 * d1; q2 += d2 * d2; q3 += d3 * d3;\n"
+    "        }\n"
+    "        for (; i < m; i++) { double d = x[i] - mb; q0 += d * d; }\n"
+    "        long long tot = cnt + m;\n"
+    "        double delta = mb - mean;\n"
+    "        mean += delta * m / tot;\n"
+    "        m2 += ((q0 + q1) + (q2 + q3)) + delta * delta * ((double)cnt * m / tot);\n"
+    "        cnt = tot;\n"
+    "    }\n"
+    "    *mean_out = mean;\n"
+    "    return m2;\n"
+    "}\n"
+    "static double mathc_variance_$N(const $T* a, int n) {\n"
+    "    if (!a || n <= 0) return 0.0;\n"
+    "    double mean;\n"
+    "    return mathc_m2_$N(a, n, &mean) / n;\n"
+    "}\n"
+    "static double mathc_std_$N(const $T* a, int n) { return sqrt(mathc_variance_$N(a, n)); }\n"
+    "static double mathc_prod_$N(const $T* a, int n) {\n"
+    "    double p0 = 1.0, p1 = 1.0, p2 = 1.0, p3 = 1.0;\n"
+    "    int i = 0;\n"
+    "    for (; i + 4 <= n; i += 4) { p0 *= a[i]; p1 *= a[i + 1]; p2 *= a[i + 2]; p3 *= a[i + 3]; }\n"
+    "    for (; i < n; i++) p0 *= a[i];\n"
+    "    return (p0 * p1) * (p2 * p3);\n"
+    "}\n";
+
+static const char* stats_runtime =
+    // Soma de Kahan de n pares de doubles intercalados: out[0] = pares, out[1] = ímpares
+    "static void mathc_kahan_pairs(const double* x, size_t n, double out[2]) {\n"
+    "    double s[2] = { 0.0, 0.0 }, c[2] = { 0.0, 0.0 };\n"
+    "    size_t i = 0;\n"
+    "#ifdef __SSE2__\n"
+    "    __m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;\n"
+    "    __m128d c0 = s0, c1 = s0, c2 = s0, c3 = s0;\n"
+    "#define MATHC_KAHAN_STEP(s_, c_, v_) do { \\\n"
+    "        __m128d y_ = _mm_sub_pd((v_), c_), t_ = _mm_add_pd(s_, y_); \\\n"
+    "        c_ = _mm_sub_pd(_mm_sub_pd(t_, s_), y_); s_ = t_; \\\n"
+    "    } while (0)\n"
+    "    for (; i + 4 <= n; i += 4) {\n"
+    "        MATHC_KAHAN_STEP(s0, c0, _mm_loadu_pd(x + 2 * i));\n"
+    "        MATHC_KAHAN_STEP(s1, c1, _mm_loadu_pd(x + 2 * i + 2));\n"
+    "        MATHC_KAHAN_STEP(s2, c2, _mm_loadu_pd(x + 2 * i + 4));\n"
+    "        MATHC_KAHAN_STEP(s3, c3, _mm_loadu_pd(x + 2 * i + 6));\n"
+    "    }\n"
+    "    // s - c é a soma de cada acumulador; os quatro entram na cauda compensada\n"
+    "    double r[8];\n"
+    "    _mm_storeu_pd(r, _mm_sub_pd(s0, c0)); _mm_storeu_pd(r + 2, _mm_sub_pd(s1, c1));\n"
+    "    _mm_storeu_pd(r + 4, _mm_sub_pd(s2, c2)); _mm_storeu_pd(r + 6, _mm_sub_pd(s3, c3));\n"
+    "#undef MATHC_KAHAN_STEP\n"
+    "    for (int k = 0; k < 8; k++) {\n"
+    "        double y = r[k] - c[k & 1], t = s[k & 1] + y;\n"
+    "        c[k & 1] = (t - s[k & 1]) - y; s[k & 1] = t;\n"
+    "    }\n"
+    "#endif\n"
+    "    for (; i < n; i++) {\n"
+    "        for (int l = 0; l < 2; l++) {\n"
+    "            double y = x[2 * i + l] - c[l], t = s[l] + y;\n"
+    "            c[l] = (t - s[l]) - y; s[l] = t;\n"
+    "        }\n"
+    "    }\n"
+    "    out[0] = s[0] - c[0];\n"
+    "    out[1] = s[1] - c[1];\n"
+    "}\n"
+    "\n"
+    "// int: long long com quatro acumuladores (o gcc vetoriza a extensão e as somas)\n"
+    "static double mathc_sum_int(const int* a, int n) {\n"
+    "    long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;\n"
+    "    int i = 0;\n"
+    "    for (; i + 4 <= n; i += 4) { s0 += a[i]; s1 += a[i + 1]; s2 += a[i + 2]; s3 += a[i + 3]; }\n"
+    "    for (; i < n; i++) s0 += a[i];\n"
+    "    return (double)((s0 + s1) + (s2 + s3));\n"
+    "}\n"
+    "static double mathc_mean_int(const int* a, int n) { return n > 0 ? mathc_sum_int(a, n) / n : 0.0; }\n"
+    "\n"
+    "static double mathc_sum_float(const double* a, int n) {\n"
+    "    if (!a || n <= 0) return 0.0;\n"
+    "    double r[2];\n"
+    "    mathc_kahan_pairs(a, (size_t)n / 2, r);\n"
+    "    // r[0] + r[1] (+ o último elemento quando n é ímpar), ainda compensado\n"
+    "    double rest[2] = { r[1], (n & 1) ? a[n - 1] : 0.0 }, s = r[0], c = 0.0;\n"
+    "    for (int k = 0; k < 2; k++) { double y = rest[k] - c, t = s + y; c = (t - s) - y; s = t; }\n"
+    "    return s - c;\n"
+    "}\n"
+    "static double mathc_mean_float(const double* a, int n) { return n > 0 ? mathc_sum_float(a, n) / n : 0.0; }\n"
+    "\n"
+    "static double complex mathc_sum_complex(const double complex* a, int n) {\n"
+    "    if (!a || n <= 0) return 0.0;\n"
+    "    double r[2];\n"
+    "    mathc_kahan_pairs((const double*)a, (size_t)n, r);  // double complex = double[2] (C99 6.2.5)\n"
+    "    return r[0] + r[1] * I;\n"
+    "}\n"
+    "static double complex mathc_mean_complex(const double complex* a, int n) {\n"
+    "    return n > 0 ? mathc_sum_complex(a, n) / n : 0.0;\n"
+    "}\n"
+    "// Produto sem a recuperação de inf/NaN do Anexo G (__muldc3): dois acumuladores independentes\n"
+    "static double complex mathc_prod_complex(const double complex* a, int n) {\n"
+    "    double r0 = 1.0, i0 = 0.0, r1 = 1.0, i1 = 0.0;\n"
+    "    int k = 0;\n"
+    "    for (; k + 2 <= n; k += 2) {\n"
+    "        double ar = creal(a[k]), ai = cimag(a[k]), br = creal(a[k + 1]), bi = cimag(a[k + 1]);\n"
+    "        double t0 = r0 * ar - i0 * ai, t1 = r1 * br - i1 * bi;\n"
+    "        i0 = r0 * ai + i0 * ar; r0 = t0;\n"
+    "        i1 = r1 * bi + i1 * br; r1 = t1;\n"
+    "    }\n"
+    "    if (k < n) { double ar = creal(a[k]), ai = cimag(a[k]), t0 = r0 * ar - i0 * ai; i0 = r0 * ai + i0 * ar; r0 = t0; }\n"
+    "    return (r0 * r1 - i0 * i1) + (r0 * i1 + i0 * r1) * I;\n"
+    "}\n"
+    "// E|z - média|^2 = variância da parte real + variância da imaginária, por blocos como em mathc_m2\n"
+    "static double mathc_variance_complex(const double complex* a, int n) {\n"
+    "    if (!a || n <= 0) return 0.0;\n"
+    "    const double* x = (const double*)a;\n"
+    "    double mr = 0.0, mi = 0.0, m2 = 0.0;\n"
+    "    long long cnt = 0;\n"
+    "    for (int b = 0; b < n; b += MATHC_STAT_BLOCK) {\n"
+    "        int m = n - b < MATHC_STAT_BLOCK ? n - b : MATHC_STAT_BLOCK, i;\n"
+    "        const double* y = x + 2 * (size_t)b;\n"
+    "        double sr0 = 0.0, si0 = 0.0, sr1 = 0.0, si1 = 0.0;\n"
+    "        for (i = 0; i + 2 <= m; i += 2) { sr0 += y[2 * i]; si0 += y[2 * i + 1]; sr1 += y[2 * i + 2]; si1 += y[2 * i + 3]; }\n"
+    "        if (i < m) { sr0 += y[2 * i]; si0 += y[2 * i + 1]; }\n"
+    "        double br = (sr0 + sr1) / m, bi = (si0 + si1) / m;\n"
+    "        double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;\n"
+    "        for (i = 0; i + 2 <= m; i += 2) {\n"
+    "            double d0 = y[2 * i] - br, d1 = y[2 * i + 1] - bi, d2 = y[2 * i + 2] - br, d3 = y[2 * i + 3] - bi;\n"
+    "            q0 += d0 * d0; q1 += d1 * d1; q2 += d2 * d2; q3 += d3 * d3;\n"
+    "        }\n"
+    "        if (i < m) { double d0 = y[2 * i] - br, d1 = y[2 * i + 1] - bi; q0 += d0 * d0; q1 += d1 * d1; }\n"
+    "        long long tot = cnt + m;\n"
+    "        double dr = br - mr, di = bi - mi, w = (double)m / tot;\n"
+    "        mr += dr * w; mi += di * w;\n"
+    "        m2 += ((q0 + q2) + (q1 + q3)) + (dr * dr + di * di) * ((double)cnt * w);\n"
+    "        cnt = tot;\n"
+    "    }\n"
+    "    return m2 / n;\n"
+    "}\n"
+    "static double mathc_std_complex(const double complex* a, int n) { return sqrt(mathc_variance_complex(a, n)); }\n";
+
+static void codegen_stats_runtime(CodeGenContext* ctx) {
+    fputs("#ifdef __SSE2__\n", ctx->output);
+    fputs("#include <emmintrin.h>\n", ctx->output);
+    fputs("#endif\n", ctx->output);
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_STAT_BLOCK 512  // elementos por bloco de variance: cabem no L1\n", ctx->output);
+    fputs(stats_runtime, ctx->output);
+    const char* int_values[] = { "int", "int", "long long" };
+    const char* float_values[] = { "float", "double", "double" };
+    codegen_emit_subst(ctx, stats_m2_template, "NTS", int_values);
+    codegen_emit_subst(ctx, stats_m2_template, "NTS", float_values);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+/*
+ * sum/mean/prod/variance/std(arr): escolhe a versão pelo tipo de elemento.
+ * arr é uma variável array (ponteiro + arr__len), um literal (vira um
+ * literal composto C de tamanho conhecido) ou uma linha m[i] de uma matriz
+ * (m->cols elementos a partir da linha); outra expressão é erro.
+ */
+static void codegen_stats_call(CodeGenContext* ctx, const char* name, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    ASTNode* arr = args ? args->node : NULL;
+    ASTNode* matrix = arr && arr->type == NODE_ARRAY_ACCESS && arr->array_access.array &&
+                      arr->array_access.array->type == NODE_IDENTIFIER &&
+                      codegen_is_matrix_type(arr->array_access.array->inferred_type) ? arr->array_access.array : NULL;
+    if (!arr || (arr->type != NODE_IDENTIFIER && arr->type != NODE_ARRAY_LITERAL && !matrix)) {
+        codegen_error(ctx, call, "%s requer uma variável array, um literal ou uma linha de matriz", name);
+        codegen_emit(ctx, "0");
+        return;
+    }
+    if (arr->type == NODE_ARRAY_LITERAL) {
+        // Tipo pelos elementos (o literal sozinho não tem tipo declarado)
+        int count = count_literal_elements(arr);
+        const char* c_type = codegen_literal_elem_type(arr->array_literal.elements);
+        const char* suffix = strcmp(c_type, "int") == 0 ? "int" : strcmp(c_type, "double") == 0 ? "float" :
+                             strcmp(c_type, "double complex") == 0 ? "complex" : NULL;
+        if (!suffix) {
+            codegen_error(ctx, call, "%s requer array de int, float ou complex", name);
+            codegen_emit(ctx, "0");
+        } else if (count == 0) {
+            codegen_emit(ctx, "mathc_%s_%s(NULL, 0)", name, suffix);
+        } else {
+            codegen_emit(ctx, "mathc_%s_%s((%s[])", name, suffix, c_type);
+            codegen_literal_initializer(ctx, arr->array_literal.elements);
+            codegen_emit(ctx, ", %d)", count);
+        }
+        return;
+    }
+    TypeSpec* t = arr->inferred_type;
+    TypeSpec* elem = matrix ? codegen_matrix_elem(matrix->inferred_type) :
+                     t && t->base_type == TYPE_ARRAY ? t->element_type : NULL;
+    const char* suffix = "int";
+    if (elem) {
+        switch (elem->base_type) {
+            case TYPE_INT: suffix = "int"; break;
+            case TYPE_FLOAT: suffix = "float"; break;
+            case TYPE_COMPLEX: suffix = "complex"; break;
+            case TYPE_MOD:
+                if (!matrix) {
+                    codegen_mod_stats_call(ctx, name, arr);
+                    return;
+                }
+                // fallthrough
+            default:
+                codegen_error(ctx, call, "%s requer array de int, float ou complex", name);
+                codegen_emit(ctx, "0");
+                return;
+        }
+    }
+    if (matrix) {
+        codegen_emit(ctx, "mathc_%s_%s(", name, suffix);
+        codegen_expression(ctx, arr);
+        codegen_emit(ctx, ", %s->cols)", matrix->identifier.name);
+    } else {
+        codegen_emit(ctx, "mathc_%s_%s(%s, %s__len)", name, suffix, arr->identifier.name, arr->identifier.name);
+    }
+}
+
+/* ========================================================================== */
+/* ORDENAÇÃO (sort) */
+/* ========================================================================== */
+/*
+ * sort(arr) ordena int, float e char em ordem crescente. Cada elemento é
+ * comparado por uma chave sem sinal que preserva a ordem (int com o bit de
+ * sinal invertido, float pelos bits IEEE na ordem total: -0 antes de 0 e
+ * NaN no fim). A partir de MATHC_RADIX_MIN elementos por byte de chave
+ * (512 para int, 1024 para float) usa radix sort LSD de um byte por passada (estável; passadas em que todos caem no mesmo balde são
+ * puladas); abaixo, introsort: quicksort com mediana de três, heapsort se a
+ * recursão passar de 2·log2(n) e inserção nos trechos de até
+ * MATHC_SORT_SMALL elementos. Chaves iguais só ocorrem para valores
+ * idênticos, então o resultado é o mesmo de uma ordenação estável.
+ */
+
+typedef struct SortKind {
+    const char* suffix;   // mathc_sort_<suffix>
+    const char* c_type;   // tipo C dos elementos
+    const char* key_type; // chave sem sinal que preserva a ordem
+} SortKind;
+
+static const SortKind sort_kinds[] = {
+    { "int", "int", "unsigned" },
+    { "float", "double", "unsigned long long" },
+    { "char", "char", "unsigned char" },
+};
+
+#define SORT_KIND_COUNT ((int)(sizeof(sort_kinds) / sizeof(sort_kinds[0])))
+
+static const char* sort_builtins[] = { "sort", NULL };
+
+static const char* sort_template =
+    "static void mathc_insertion_sort_$N($T* a, int n) {\n"
+    "    for (int i = 1; i < n; i++) {\n"
+    "        $T x = a[i];\n"
+    "        $K k = mathc_sort_key_$N(x);\n"
+    "        int j = i - 1;\n"
+    "        while (j >= 0 && mathc_sort_key_$N(a[j]) > k) { a[j + 1] = a[j]; j--; }\n"
+    "        a[j + 1] = x;\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_heap_sort_$N($T* a, int n) {\n"
+    "    for (int i = n / 2 - 1, end = n; end > 1; ) {\n"
+    "        int root;\n"
+    "        if (i >= 0) root = i--;                                  // construção do heap\n"
+    "        else { $T t = a[0]; a[0] = a[--end]; a[end] = t; root = 0; }  // extração do máximo\n"
+    "        $T x = a[root];\n"
+    "        for (int c; (c = 2 * root + 1) < end; root = c) {\n"
+    "            if (c + 1 < end && mathc_sort_key_$N(a[c + 1]) > mathc_sort_key_$N(a[c])) c++;\n"
+    "            if (mathc_sort_key_$N(a[c]) <= mathc_sort_key_$N(x)) break;\n"
+    "            a[root] = a[c];\n"
+    "        }\n"
+    "        a[root] = x;\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_introsort_$N($T* a, int n, int depth) {\n"
+    "    while (n > MATHC_SORT_SMALL) {\n"
+    "        if (depth-- == 0) { mathc_heap_sort_$N(a, n); return; }\n"
+    "        // Mediana de três: a[0] <= a[m] <= a[n - 1] e o pivô é a[m]\n"
+    "        int m = n / 2;\n"
+    "        $T t;\n"
+    "        if (mathc_sort_key_$N(a[m]) < mathc_sort_key_$N(a[0])) { t = a[m]; a[m] = a[0]; a[0] = t; }\n"
+    "        if (mathc_sort_key_$N(a[n - 1]) < mathc_sort_key_$N(a[0])) { t = a[n - 1]; a[n - 1] = a[0]; a[0] = t; }\n"
+    "        if (mathc_sort_key_$N(a[n - 1]) < mathc_sort_key_$N(a[m])) { t = a[n - 1]; a[n - 1] = a[m]; a[m] = t; }\n"
+    "        $K p = mathc_sort_key_$N(a[m]);\n"
+    "        int i = -1, j = n;\n"
+    "        for (;;) {  // partição de Hoare: a[0..j] <= p <= a[j+1..n)\n"
+    "            do i++; while (mathc_sort_key_$N(a[i]) < p);\n"
+    "            do j--; while (p < mathc_sort_key_$N(a[j]));\n"
+    "            if (i >= j) break;\n"
+    "            t = a[i]; a[i] = a[j]; a[j] = t;\n"
+    "        }\n"
+    "        // Recursão no lado menor, laço no maior: pilha O(log n)\n"
+    "        if (j + 1 < n - j - 1) { mathc_introsort_$N(a, j + 1, depth); a += j + 1; n -= j + 1; }\n"
+    "        else { mathc_introsort_$N(a + j + 1, n - j - 1, depth); n = j + 1; }\n"
+    "    }\n"
+    "    mathc_insertion_sort_$N(a, n);\n"
+    "}\n"
+    "static int mathc_radix_sort_$N($T* a, int n) {\n"
+    "    enum { BYTES = sizeof($K) };\n"
+    "    $T* tmp = ($T*)malloc(sizeof($T) * (size_t)n);\n"
+    "    if (!tmp) return 0;\n"
+    "    size_t count[BYTES][256];\n"
+    "    memset(count, 0, sizeof(count));\n"
+    "    for (int i = 0; i < n; i++) {\n"
+    "        $K k = mathc_sort_key_$N(a[i]);\n"
+    "        for (int b = 0; b < BYTES; b++) count[b][(k >> (8 * b)) & 255]++;\n"
+    "    }\n"
+    "    $T *src = a, *dst = tmp;\n"
+    "    for (int b = 0; b < BYTES; b++) {\n"
+    "        size_t* c = count[b];\n"
+    "        if (c[(mathc_sort_key_$N(src[0]) >> (8 * b)) & 255] == (size_t)n) continue;\n"
+    "        for (size_t d = 0, sum = 0; d < 256; d++) { size_t t = c[d]; c[d] = sum; sum += t; }\n"
+    "        for (int i = 0; i < n; i++) dst[c[(mathc_sort_key_$N(src[i]) >> (8 * b)) & 255]++] = src[i];\n"
+    "        $T* t = src; src = dst; dst = t;\n"
+    "    }\n"
+    "    if (src != a) memcpy(a, src, sizeof($T) * (size_t)n);\n"
+    "    free(tmp);\n"
+    "    return 1;\n"
+    "}\n"
+    "static void mathc_sort_seq_$N($T* a, int n) {\n"
+    "    if (!a || n < 2) return;\n"
+    "    if (n >= MATHC_RADIX_MIN * (int)sizeof($K) && mathc_radix_sort_$N(a, n)) return;\n"
+    "    int depth = 0;\n"
+    "    for (int m = n; m > 1; m >>= 1) depth += 2;\n"
+    "    mathc_introsort_$N(a, n, depth);\n"
+    "}\n";
+
+/*
+ * Ordenação paralela por amostragem regular (PSRS) em três fases, cada uma
+ * um mathc_parallel_run com p tarefas:
+ *   1. cada tarefa ordena um bloco contíguo de a com mathc_sort_seq;
+ *   2. p - 1 separadores são escolhidos entre p - 1 amostras regulares de
+ *      cada bloco; a fatia t (chaves entre os separadores t - 1 e t) de
+ *      todos os blocos é copiada para tmp[out[t]..out[t + 1]);
+ *   3. cada tarefa intercala, dois a dois, os p trechos ordenados da sua
+ *      fatia, alternando entre tmp e a, e deixa o resultado em a.
+ * Com chaves distintas nenhuma fatia passa de 2n/p elementos. O resultado
+ * é o mesmo da versão sequencial, qualquer que seja o número de threads.
+ */
+static const char* par_sort_template =
+    "typedef struct mathc_psort_$N {\n"
+    "    $T* a; $T* tmp; int p;\n"
+    "    int start[MATHC_MAX_THREADS + 1];                    // bloco i: a[start[i]..start[i + 1])\n"
+    "    int cut[MATHC_MAX_THREADS + 1][MATHC_MAX_THREADS];   // fatia t do bloco i: [cut[t][i], cut[t + 1][i])\n"
+    "    int out[MATHC_MAX_THREADS + 1];                      // fatia t na saída: [out[t], out[t + 1])\n"
+    "} mathc_psort_$N;\n"
+    "typedef struct mathc_psort_task_$N { mathc_psort_$N* s; int t; } mathc_psort_task_$N;\n"
+    "static void* mathc_psort_blocks_$N(void* arg) {\n"
+    "    mathc_psort_task_$N* k = (mathc_psort_task_$N*)arg;\n"
+    "    mathc_sort_seq_$N(k->s->a + k->s->start[k->t], k->s->start[k->t + 1] - k->s->start[k->t]);\n"
+    "    return NULL;\n"
+    "}\n"
+    "static void* mathc_psort_gather_$N(void* arg) {\n"
+    "    mathc_psort_task_$N* k = (mathc_psort_task_$N*)arg;\n"
+    "    mathc_psort_$N* s = k->s;\n"
+    "    $T* dst = s->tmp + s->out[k->t];\n"
+    "    for (int i = 0; i < s->p; i++) {\n"
+    "        int lo = s->cut[k->t][i], m = s->cut[k->t + 1][i] - lo;\n"
+    "        memcpy(dst, s->a + lo, sizeof($T) * (size_t)m);\n"
+    "        dst += m;\n"
+    "    }\n"
+    "    return NULL;\n"
+    "}\n"
+    "static void mathc_merge_runs_$N(const $T* x, int nx, const $T* y, int ny, $T* dst) {\n"
+    "    int i = 0, j = 0;\n"
+    "    while (i < nx && j < ny) {\n"
+    "        if (mathc_sort_key_$N(y[j]) < mathc_sort_key_$N(x[i])) *dst++ = y[j++];\n"
+    "        else *dst++ = x[i++];\n"
+    "    }\n"
+    "    memcpy(dst, x + i, sizeof($T) * (size_t)(nx - i));\n"
+    "    memcpy(dst + (nx - i), y + j, sizeof($T) * (size_t)(ny - j));\n"
+    "}\n"
+    "static void* mathc_psort_merge_$N(void* arg) {\n"
+    "    mathc_psort_task_$N* k = (mathc_psort_task_$N*)arg;\n"
+    "    mathc_psort_$N* s = k->s;\n"
+    "    int o = s->out[k->t], len = s->out[k->t + 1] - o;\n"
+    "    int b[MATHC_MAX_THREADS + 1], r = 0;  // limites dos trechos não vazios, relativos a o\n"
+    "    b[0] = 0;\n"
+    "    for (int i = 0; i < s->p; i++) {\n"
+    "        int m = s->cut[k->t + 1][i] - s->cut[k->t][i];\n"
+    "        if (m > 0) { b[r + 1] = b[r] + m; r++; }\n"
+    "    }\n"
+    "    $T *src = s->tmp + o, *dst = s->a + o;\n"
+    "    while (r > 1) {\n"
+    "        int w = 0;\n"
+    "        for (int i = 0; i < r; i += 2, w++) {\n"
+    "            if (i + 1 < r) mathc_merge_runs_$N(src + b[i], b[i + 1] - b[i], src + b[i + 1], b[i + 2] - b[i + 1], dst + b[i]);\n"
+    "            else memcpy(dst + b[i], src + b[i], sizeof($T) * (size_t)(b[i + 1] - b[i]));\n"
+    "            b[w] = b[i];\n"
+    "        }\n"
+    "        b[w] = b[r];\n"
+    "        r = w;\n"
+    "        $T* t = src; src = dst; dst = t;\n"
+    "    }\n"
+    "    if (src != s->a + o) memcpy(s->a + o, src, sizeof($T) * (size_t)len);\n"
+    "    return NULL;\n"
+    "}\n"
+    "// Primeira posição de a[lo..hi) com chave >= k (o bloco já está ordenado)\n"
+    "static int mathc_lower_bound_$N(const $T* a, int lo, int hi, $K k) {\n"
+    "    while (lo < hi) {\n"
+    "        int mid = lo + (hi - lo) / 2;\n"
+    "        if (mathc_sort_key_$N(a[mid]) < k) lo = mid + 1;\n"
+    "        else hi = mid;\n"
+    "    }\n"
+    "    return lo;\n"
+    "}\n"
+    "static int mathc_parallel_sort_$N($T* a, int n, int p) {\n"
+    "    mathc_psort_$N* s = (mathc_psort_$N*)malloc(sizeof(mathc_psort_$N));\n"
+    "    $T* tmp = ($T*)malloc(sizeof($T) * (size_t)n);\n"
+    "    $T* samples = ($T*)malloc(sizeof($T) * (size_t)p * (size_t)p);\n"
+    "    if (!s || !tmp || !samples) { free(s); free(tmp); free(samples); return 0; }\n"
+    "    s->a = a; s->tmp = tmp; s->p = p;\n"
+    "    mathc_psort_task_$N tasks[MATHC_MAX_THREADS];\n"
+    "    for (int t = 0; t < p; t++) { tasks[t].s = s; tasks[t].t = t; }\n"
+    "    for (int i = 0; i <= p; i++) s->start[i] = (int)((long long)n * i / p);\n"
+    "    mathc_parallel_run(mathc_psort_blocks_$N, tasks, sizeof(tasks[0]), p);\n"
+    "\n"
+    "    // Amostras regulares de cada bloco; os separadores são amostras igualmente espaçadas\n"
+    "    int ns = 0;\n"
+    "    for (int i = 0; i < p; i++) {\n"
+    "        int m = s->start[i + 1] - s->start[i];\n"
+    "        for (int j = 1; j < p; j++) samples[ns++] = a[s->start[i] + (int)((long long)m * j / p)];\n"
+    "    }\n"
+    "    mathc_sort_seq_$N(samples, ns);\n"
+    "    for (int i = 0; i < p; i++) { s->cut[0][i] = s->start[i]; s->cut[p][i] = s->start[i + 1]; }\n"
+    "    for (int t = 1; t < p; t++) {\n"
+    "        $K k = mathc_sort_key_$N(samples[(long long)ns * t / p]);\n"
+    "        for (int i = 0; i < p; i++) s->cut[t][i] = mathc_lower_bound_$N(a, s->cut[t - 1][i], s->start[i + 1], k);\n"
+    "    }\n"
+    "    for (int t = 0; t <= p; t++) {\n"
+    "        long long o = 0;\n"
+    "        for (int i = 0; i < p; i++) o += s->cut[t][i] - s->start[i];\n"
+    "        s->out[t] = (int)o;\n"
+    "    }\n"
+    "    mathc_parallel_run(mathc_psort_gather_$N, tasks, sizeof(tasks[0]), p);\n"
+    "    mathc_parallel_run(mathc_psort_merge_$N, tasks, sizeof(tasks[0]), p);\n"
+    "    free(samples); free(tmp); free(s);\n"
+    "    return 1;\n"
+    "}\n"
+    "static void mathc_sort_$N($T* a, int n) {\n"
+    "    if (!a || n < 2) return;\n"
+    "    if (n >= MATHC_PAR_SORT_MIN) {\n"
+    "        int p = mathc_num_threads();\n"
+    "        if (p > n / MATHC_PAR_SORT_GRAIN) p = n / MATHC_PAR_SORT_GRAIN;\n"
+    "        if (p >= 2 && mathc_parallel_sort_$N(a, n, p)) return;\n"
+    "    }\n"
+    "    mathc_sort_seq_$N(a, n);\n"
+    "}\n";
+
+static void codegen_sort_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_SORT_SMALL 16\n", ctx->output);
+    fputs("#define MATHC_RADIX_MIN 128  // por byte de chave: cada byte custa uma passada\n", ctx->output);
+    fputs("#define MATHC_PAR_SORT_MIN (1 << 17)    // abaixo disso sort nunca cria threads\n", ctx->output);
+    fputs("#define MATHC_PAR_SORT_GRAIN (1 << 15)  // elementos mínimos por thread\n", ctx->output);
+    fputs("static inline unsigned mathc_sort_key_int(int x) { return (unsigned)x ^ 0x80000000u; }\n", ctx->output);
+    fputs("static inline unsigned long long mathc_sort_key_float(double x) {\n", ctx->output);
+    fputs("    unsigned long long b;\n", ctx->output);
+    fputs("    memcpy(&b, &x, sizeof(b));\n", ctx->output);
+    fputs("    return b ^ (-(b >> 63) | 0x8000000000000000ULL);  // negativos: inverte tudo; positivos: só o sinal\n", ctx->output);
+    fputs("}\n", ctx->output);
+    fputs("static inline unsigned char mathc_sort_key_char(char x) { return (unsigned char)x ^ ((char)-1 < 0 ? 0x80 : 0); }\n", ctx->output);
+    for (int i = 0; i < SORT_KIND_COUNT; i++) {
+        const char* values[] = { sort_kinds[i].suffix, sort_kinds[i].c_type, sort_kinds[i].key_type };
+        codegen_emit_subst(ctx, sort_template, "NTK", values);
+        codegen_emit_subst(ctx, par_sort_template, "NTK", values);
+    }
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+/* sort(arr): escolhe a versão pelo tipo de elemento do array */
+static void codegen_sort_call(CodeGenContext* ctx, ASTNode* call) {
+    NodeList* args = call->call.arguments;
+    ASTNode* arr = args ? args->node : NULL;
+    TypeSpec* t = arr ? arr->inferred_type : NULL;
+    if (!arr || arr->type != NODE_IDENTIFIER || !t || t->base_type != TYPE_ARRAY || !t->element_type) {
+        codegen_error(ctx, call, "sort requer uma variável array");
+        codegen_emit(ctx, "0");
+        return;
+    }
+    const char* suffix = NULL;
+    switch (t->element_type->base_type) {
+        case TYPE_INT: suffix = "int"; break;
+        case TYPE_FLOAT: suffix = "float"; break;
+        case TYPE_CHAR: suffix = "char"; break;
+        default: break;
+    }
+    if (!suffix) {
+        codegen_error(ctx, call, "sort requer array de int, float ou char");
+        codegen_emit(ctx, "0");
+        return;
+    }
+    codegen_emit(ctx, "mathc_sort_%s(%s, %s__len)", suffix, arr->identifier.name, arr->identifier.name);
+}
+
+/* ========================================================================== */
+/* TEORIA DOS NÚMEROS (gcd, lcm, modpow, modinv, factorial_mod, binomial_mod) */
+/* ========================================================================== */
+/*
+ * Núcleos em 64 bits sem sinal; os builtins recebem e devolvem int e acusam
+ * erro de execução quando o resultado não cabe em int, em vez de estourar
+ * em silêncio. gcd é o binário de Stein (deslocamentos com ctz no lugar de
+ * divisões); mulmod usa __int128 quando o gcc tem. Miller-Rabin é
+ * determinístico para 64 bits: bases {2, 7, 61} abaixo de 2^32 e as sete
+ * bases de Sinclair acima.
+ *
+ * factorial_mod e binomial_mod guardam n! e 1/n! módulo p numa tabela que
+ * cresce sob demanda (até MATHC_FACT_TABLE_MAX entradas) e é refeita quando
+ * p muda; binomial_mod exige p primo e usa Lucas para n >= p.
+ */
+
+static const char* number_theory_builtins[] = {
+    "gcd", "lcm", "factorial", "combinations", "permutations",
+    "modpow", "modinv", "factorial_mod", "binomial_mod", NULL
+};
+
+static const char* number_theory_runtime =
+    "#ifdef __SIZEOF_INT128__\n"
+    "static inline unsigned long long mathc_mulmod_u64(unsigned long long a, unsigned long long b, unsigned long long m) {\n"
+    "    return (unsigned long long)((unsigned __int128)a * b % m);\n"
+    "}\n"
+    "#else\n"
+    "static inline unsigned long long mathc_mulmod_u64(unsigned long long a, unsigned long long b, unsigned long long m) {\n"
+    "    if (m <= 0xFFFFFFFFULL) return a % m * (b % m) % m;\n"
+    "    unsigned long long r = 0;\n"
+    "    for (a %= m, b %= m; b; b >>= 1) {\n"
+    "        if (b & 1) r = r >= m - a ? r - (m - a) : r + a;\n"
+    "        a = a >= m - a ? a - (m - a) : a + a;\n"
+    "    }\n"
+    "    return r;\n"
+    "}\n"
+    "#endif\n"
+    "static unsigned long long mathc_powmod_u64(unsigned long long b, unsigned long long e, unsigned long long m) {\n"
+    "    unsigned long long r = 1 % m;\n"
+    "    for (b %= m; e; e >>= 1) {\n"
+    "        if (e & 1) r = mathc_mulmod_u64(r, b, m);\n"
+    "        b = mathc_mulmod_u64(b, b, m);\n"
+    "    }\n"
+    "    return r;\n"
+    "}\n"
+    "// Teste forte de Miller-Rabin com base a para n ímpar, n - 1 = d * 2^s\n"
+    "static int mathc_mr_witness(unsigned long long n, unsigned long long d, int s, unsigned long long a) {\n"
+    "    a %= n;\n"
+    "    if (a == 0) return 1;\n"
+    "    unsigned long long x = mathc_powmod_u64(a, d, n);\n"
+    "    if (x == 1 || x == n - 1) return 1;\n"
+    "    for (int i = 1; i < s; i++) {\n"
+    "        x = mathc_mulmod_u64(x, x, n);\n"
+    "        if (x == n - 1) return 1;\n"
+    "    }\n"
+    "    return 0;\n"
+    "}\n"
+    "static int mathc_miller_rabin(unsigned long long n) {\n"
+    "    static const unsigned char small[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };\n"
+    "    if (n < 2) return 0;\n"
+    "    for (int i = 0; i < 12; i++) {\n"
+    "        if (n == small[i]) return 1;\n"
+    "        if (n % small[i] == 0) return 0;\n"
+    "    }\n"
+    "    if (n < 37 * 37) return 1;\n"
+    "    unsigned long long d = n - 1;\n"
+    "    int s = 0;\n"
+    "    while (!(d & 1)) { d >>= 1; s++; }\n"
+    "    static const unsigned long long b32[] = { 2, 7, 61 };\n"
+    "    static const unsigned long long b64[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };\n"
+    "    const unsigned long long* bases = n < 4294967296ULL ? b32 : b64;\n"
+    "    int nb = n < 4294967296ULL ? 3 : 7;\n"
+    "    for (int i = 0; i < nb; i++)\n"
+    "        if (!mathc_mr_witness(n, d, s, bases[i])) return 0;\n"
+    "    return 1;\n"
+    "}\n"
+    "static int mathc_nt_int(unsigned long long v, const char* fn) {\n"
+    "    if (v > 2147483647ULL) { fprintf(stderr, \"Erro: resultado de %s não cabe em int (use bigint)\\n\", fn); exit(1); }\n"
+    "    return (int)v;\n"
+    "}\n"
+    "static inline unsigned long long mathc_nt_abs(int x) { return x < 0 ? 0ULL - (unsigned long long)x : (unsigned long long)x; }\n"
+    "static inline unsigned long long mathc_gcd_u64(unsigned long long a, unsigned long long b) {\n"
+    "    if (a == 0) return b;\n"
+    "    if (b == 0) return a;\n"
+    "    int k = __builtin_ctzll(a | b);\n"
+    "    a >>= __builtin_ctzll(a);\n"
+    "    b >>= __builtin_ctzll(b);\n"
+    "    while (a != b) {\n"
+    "        // Ambos ímpares: a diferença é par; sem desvios (cmov)\n"
+    "        unsigned long long d = a > b ? a - b : b - a;\n"
+    "        a = a < b ? a : b;\n"
+    "        b = d >> __builtin_ctzll(d);\n"
+    "    }\n"
+    "    return a << k;\n"
+    "}\n"
+    "static inline int mathc_gcd(int a, int b) { return mathc_nt_int(mathc_gcd_u64(mathc_nt_abs(a), mathc_nt_abs(b)), \"gcd\"); }\n"
+    "static inline int mathc_lcm(int a, int b) {\n"
+    "    if (a == 0 || b == 0) return 0;\n"
+    "    unsigned long long x = mathc_nt_abs(a), y = mathc_nt_abs(b);\n"
+    "    return mathc_nt_int(x / mathc_gcd_u64(x, y) * y, \"lcm\");\n"
+    "}\n"
+    "static int mathc_factorial(int n) {\n"
+    "    if (n < 0) return 0;\n"
+    "    unsigned long long r = 1;\n"
+    "    for (int i = 2; i <= n; i++) {\n"
+    "        r *= (unsigned long long)i;\n"
+    "        if (r > 2147483647ULL) return mathc_nt_int(r, \"factorial\");\n"
+    "    }\n"
+    "    return (int)r;\n"
+    "}\n"
+    "// C(n, i+1) = C(n, i) * (n - i) / (i + 1) é exato e cresce até i = k <= n/2\n"
+    "static int mathc_combinations(int n, int k) {\n"
+    "    if (k > n || k < 0) return 0;\n"
+    "    if (k > n - k) k = n - k;\n"
+    "    unsigned long long r = 1;\n"
+    "    for (int i = 0; i < k; i++) {\n"
+    "        r = r * (unsigned long long)(n - i) / (unsigned long long)(i + 1);\n"
+    "        if (r > 2147483647ULL) return mathc_nt_int(r, \"combinations\");\n"
+    "    }\n"
+    "    return (int)r;\n"
+    "}\n"
+    "static int mathc_permutations(int n, int k) {\n"
+    "    if (k > n || k < 0) return 0;\n"
+    "    unsigned long long r = 1;\n"
+    "    for (int i = 0; i < k; i++) {\n"
+    "        r *= (unsigned long long)(n - i);\n"
+    "        if (r > 2147483647ULL) return mathc_nt_int(r, \"permutations\");\n"
+    "    }\n"
+    "    return (int)r;\n"
+    "}\n"
+    "static unsigned long long mathc_nt_modulus(int m, const char* fn) {\n"
+    "    if (m <= 0) { fprintf(stderr, \"Erro: %s com módulo %d (precisa ser positivo)\\n\", fn, m); exit(1); }\n"
+    "    return (unsigned long long)m;\n"
+    "}\n"
+    "// Inverso de a módulo m por Euclides estendido; 0 se gcd(a, m) != 1\n"
+    "static unsigned long long mathc_modinv_u64(unsigned long long a, unsigned long long m) {\n"
+    "    long long t = 0, nt = 1;\n"
+    "    unsigned long long r = m, nr = a % m;\n"
+    "    while (nr) {\n"
+    "        unsigned long long q = r / nr, tr = r - q * nr;\n"
+    "        long long tt = t - (long long)q * nt;\n"
+    "        r = nr; nr = tr; t = nt; nt = tt;\n"
+    "    }\n"
+    "    if (r != 1) return 0;\n"
+    "    return t < 0 ? (unsigned long long)(t + (long long)m) : (unsigned long long)t;\n"
+    "}\n"
+    "static int mathc_modinv(int a, int m) {\n"
+    "    unsigned long long mm = mathc_nt_modulus(m, \"modinv\");\n"
+    "    unsigned long long x = (unsigned long long)(((long long)a % m + m) % m);\n"
+    "    if (mm == 1) return 0;\n"
+    "    unsigned long long r = mathc_modinv_u64(x, mm);\n"
+    "    if (r == 0) { fprintf(stderr, \"Erro: %d não tem inverso módulo %d\\n\", a, m); exit(1); }\n"
+    "    return (int)r;\n"
+    "}\n"
+    "// b^e mod m; expoente negativo usa o inverso de b\n"
+    "static int mathc_modpow(int b, int e, int m) {\n"
+    "    unsigned long long mm = mathc_nt_modulus(m, \"modpow\");\n"
+    "    long long ee = e;\n"
+    "    if (ee < 0) { b = mathc_modinv(b, m); ee = -ee; }\n"
+    "    return (int)mathc_powmod_u64((unsigned long long)(((long long)b % m + m) % m), (unsigned long long)ee, mm);\n"
+    "}\n"
+    "\n"
+    "typedef struct mathc_fact_table_t {\n"
+    "    unsigned p;       // módulo da tabela (0 = vazia)\n"
+    "    int prime;        // p é primo: inv é mantida\n"
+    "    int len;          // fact[0..len) e inv[0..len) prontos\n"
+    "    int cap;\n"
+    "    unsigned* fact;   // n! mod p\n"
+    "    unsigned* inv;    // (n!)^-1 mod p\n"
+    "} mathc_fact_table_t;\n"
+    "static mathc_fact_table_t mathc_fact_table;\n"
+    "// Garante fact[0..n] para o módulo p (n < p, n <= MATHC_FACT_TABLE_MAX)\n"
+    "static void mathc_fact_reserve(unsigned p, int n) {\n"
+    "    mathc_fact_table_t* t = &mathc_fact_table;\n"
+    "    if (t->p != p) { t->p = p; t->prime = mathc_miller_rabin(p); t->len = 0; }\n"
+    "    if (n < t->len) return;\n"
+    "    int want = t->len * 2 > n + 1 ? t->len * 2 : n + 1;\n"
+    "    if (want < 1024) want = 1024;\n"
+    "    if ((unsigned)want > p) want = (int)p;\n"
+    "    if (want > MATHC_FACT_TABLE_MAX + 1) want = MATHC_FACT_TABLE_MAX + 1;\n"
+    "    if (want > t->cap) {\n"
+    "        unsigned* f = (unsigned*)realloc(t->fact, sizeof(unsigned) * (size_t)want);\n"
+    "        unsigned* v = f ? (unsigned*)realloc(t->inv, sizeof(unsigned) * (size_t)want) : NULL;\n"
+    "        if (!f || !v) { fprintf(stderr, \"Erro: memória insuficiente para a tabela de fatoriais\\n\"); exit(1); }\n"
+    "        t->fact = f; t->inv = v; t->cap = want;\n"
+    "    }\n"
+    "    int i = t->len;\n"
+    "    if (i == 0) { t->fact[0] = 1 % p; i = 1; }\n"
+    "    for (; i < want; i++) t->fact[i] = (unsigned)((unsigned long long)t->fact[i - 1] * (unsigned)i % p);\n"
+    "    if (t->prime) {\n"
+    "        // Um único inverso no topo; os demais descem: 1/(i-1)! = i / i!\n"
+    "        t->inv[want - 1] = (unsigned)mathc_powmod_u64(t->fact[want - 1], p - 2, p);\n"
+    "        for (i = want - 1; i > t->len; i--) t->inv[i - 1] = (unsigned)((unsigned long long)t->inv[i] * (unsigned)i % p);\n"
+    "    }\n"
+    "    t->len = want;\n"
+    "}\n"
+    "static int mathc_factorial_mod(int n, int p) {\n"
+    "    unsigned long long m = mathc_nt_modulus(p, \"factorial_mod\");\n"
+    "    if (n < 0) return 0;\n"
+    "    if ((unsigned long long)n >= m) return 0;  // n! contém o fator p\n"
+    "    if (n <= MATHC_FACT_TABLE_MAX) { mathc_fact_reserve((unsigned)m, n); return (int)mathc_fact_table.fact[n]; }\n"
+    "    mathc_fact_reserve((unsigned)m, MATHC_FACT_TABLE_MAX);\n"
+    "    unsigned long long r = mathc_fact_table.fact[MATHC_FACT_TABLE_MAX];\n"
+    "    for (unsigned long long i = MATHC_FACT_TABLE_MAX + 1; i <= (unsigned long long)n; i++) r = r * i % m;\n"
+    "    return (int)r;\n"
+    "}\n"
+    "// C(n, k) mod p para 0 <= k <= n < p, p primo\n"
+    "static unsigned long long mathc_binomial_small(unsigned long long n, unsigned long long k, unsigned long long p) {\n"
+    "    if (n <= MATHC_FACT_TABLE_MAX) {\n"
+    "        mathc_fact_reserve((unsigned)p, (int)n);\n"
+    "        const mathc_fact_table_t* t = &mathc_fact_table;\n"
+    "        return (unsigned long long)t->fact[n] * t->inv[k] % p * t->inv[n - k] % p;\n"
+    "    }\n"
+    "    if (k > n - k) k = n - k;\n"
+    "    unsigned long long num = 1, den = 1;\n"
+    "    for (unsigned long long i = 0; i < k; i++) { num = num * ((n - i) % p) % p; den = den * ((i + 1) % p) % p; }\n"
+    "    return num * mathc_powmod_u64(den, p - 2, p) % p;\n"
+    "}\n"
+    "static int mathc_binomial_mod(int n, int k, int p) {\n"
+    "    unsigned long long m = mathc_nt_modulus(p, \"binomial_mod\");\n"
+    "    if (!mathc_miller_rabin(m)) { fprintf(stderr, \"Erro: binomial_mod requer módulo primo (recebeu %d)\\n\", p); exit(1); }\n"
+    "    if (k < 0 || k > n) return 0;\n"
+    "    // Lucas: C(n, k) = prod C(n_i, k_i) nos dígitos de n e k na base p\n"
+    "    unsigned long long nn = (unsigned long long)n, kk = (unsigned long long)k, r = 1 % m;\n"
+    "    while (kk && r) {\n"
+    "        unsigned long long ni = nn % m, ki = kk % m;\n"
+    "        if (ki > ni) return 0;\n"
+    "        r = r * mathc_binomial_small(ni, ki, m) % m;\n"
+    "        nn /= m; kk /= m;\n"
+    "    }\n"
+    "    return (int)r;\n"
+    "}\n";
+
+static void codegen_number_theory_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_FACT_TABLE_MAX (1 << 22)  // entradas da tabela de fatoriais: 32 MB com os inversos\n", ctx->output);
+    fputs(number_theory_runtime, ctx->output);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+/* ========================================================================== */
+/* PRIMOS (isprime, next_prime, primes_up_to, factorize) */
+/* ========================================================================== */
+/*
+ * Crivo de Eratóstenes só com ímpares, um bit por número (bit i de
+ * words = 2i + 1, 1 = composto), construído sob demanda até
+ * MATHC_SIEVE_LIMIT (variável de ambiente; padrão 2^24, entre 2^16 e 2^32).
+ * Os primeiros 2^16 números são crivados direto; o resto, em segmentos de
+ * MATHC_SIEVE_SEGMENT números, que cabem no L1, usando os primos base já
+ * guardados (sqrt(2^32) = 2^16).
+ *
+ * isprime e next_prime só estendem o crivo quando isso se paga: cada
+ * consulta acima da parte pronta é respondida por Miller-Rabin (um teste
+ * custa tanto quanto crivar ~MATHC_SIEVE_AMORTIZE números) e conta um
+ * erro; o crivo cresce até n quando erros * MATHC_SIEVE_AMORTIZE cobrem a
+ * distância. primes_up_to sempre usa o crivo e, além do limite, criva
+ * segmentos temporários. factorize separa os primos pequenos por divisão e
+ * o resto com Pollard-rho (Brent), confirmando cada fator com Miller-Rabin.
+ */
+
+static const char* prime_builtins[] = { "isprime", "next_prime", "primes_up_to", "factorize", NULL };
+
+static const char* primes_runtime =
+    "typedef struct mathc_sieve_t {\n"
+    "    unsigned long long* words;  // bit i de words[w]: número 128w + 2i + 1\n"
+    "    unsigned long long built;   // números em [0, built) já crivados; múltiplo de 128\n"
+    "    unsigned long long limit;   // MATHC_SIEVE_LIMIT arredondado para múltiplo de 128\n"
+    "    unsigned long long misses;  // consultas acima de built desde a última extensão\n"
+    "} mathc_sieve_t;\n"
+    "static mathc_sieve_t mathc_sieve;\n"
+    "static unsigned long long mathc_sieve_limit(void) {\n"
+    "    if (mathc_sieve.limit == 0) {\n"
+    "        const char* env = getenv(\"MATHC_SIEVE_LIMIT\");\n"
+    "        long long v = env ? atoll(env) : 0;\n"
+    "        unsigned long long l = v > 0 ? (unsigned long long)v : MATHC_SIEVE_DEFAULT;\n"
+    "        if (l < 65536) l = 65536;  // os primos base (até 2^16) sempre vêm do cache\n"
+    "        if (l > 4294967296ULL) l = 4294967296ULL;\n"
+    "        mathc_sieve.limit = (l + 127) & ~127ULL;\n"
+    "    }\n"
+    "    return mathc_sieve.limit;\n"
+    "}\n"
+    "static inline int mathc_sieve_composite(const unsigned long long* words, unsigned long long n) {\n"
+    "    return (int)((words[n >> 7] >> ((n >> 1) & 63)) & 1);\n"
+    "}\n"
+    "// Marca os compostos ímpares de [lo, hi) em seg (seg[0] bit 0 = lo + 1; lo múltiplo de 128)\n"
+    "// com os primos base do cache; exige hi <= 65536^2 e o cache pronto até 65536\n"
+    "static void mathc_sieve_segment(unsigned long long* seg, unsigned long long lo, unsigned long long hi) {\n"
+    "    const unsigned long long* base = mathc_sieve.words;\n"
+    "    for (unsigned long long p = 3; p * p < hi; p += 2) {\n"
+    "        if (mathc_sieve_composite(base, p)) continue;\n"
+    "        unsigned long long m = p * p;\n"
+    "        if (m < lo) { m = (lo + p - 1) / p * p; if (!(m & 1)) m += p; }\n"
+    "        for (unsigned long long i = (m - lo) >> 1, end = (hi - lo) >> 1; i < end; i += p)\n"
+    "            seg[i >> 6] |= 1ULL << (i & 63);\n"
+    "    }\n"
+    "}\n"
+    "// Garante o crivo pronto até n (inclusive), n <= limite\n"
+    "static void mathc_sieve_extend(unsigned long long n) {\n"
+    "    unsigned long long limit = mathc_sieve_limit();\n"
+    "    if (n < mathc_sieve.built) return;\n"
+    "    unsigned long long target = mathc_sieve.built * 2;\n"
+    "    if (target < n + 1) target = n + 1;\n"
+    "    if (target < 65536) target = 65536;\n"
+    "    target = (target + 127) & ~127ULL;\n"
+    "    if (target > limit) target = limit;\n"
+    "    unsigned long long* w = (unsigned long long*)realloc(mathc_sieve.words, (size_t)(target / 128) * sizeof(*w));\n"
+    "    if (!w) { fprintf(stderr, \"Erro: memória insuficiente para o crivo até %llu\\n\", target); exit(1); }\n"
+    "    memset(w + mathc_sieve.built / 128, 0, (size_t)((target - mathc_sieve.built) / 128) * sizeof(*w));\n"
+    "    mathc_sieve.words = w;\n"
+    "    if (mathc_sieve.built == 0) {\n"
+    "        // Primeiro bloco: crivo direto, os primos base saem dele mesmo\n"
+    "        unsigned long long first = target < 65536 ? target : 65536;\n"
+    "        w[0] |= 1;  // 1 não é primo\n"
+    "        for (unsigned long long p = 3; p * p < first; p += 2) {\n"
+    "            if (mathc_sieve_composite(w, p)) continue;\n"
+    "            for (unsigned long long m = p * p; m < first; m += 2 * p) w[m >> 7] |= 1ULL << ((m >> 1) & 63);\n"
+    "        }\n"
+    "        mathc_sieve.built = first;\n"
+    "    }\n"
+    "    while (mathc_sieve.built < target) {\n"
+    "        unsigned long long lo = mathc_sieve.built, hi = lo + MATHC_SIEVE_SEGMENT < target ? lo + MATHC_SIEVE_SEGMENT : target;\n"
+    "        mathc_sieve_segment(w + lo / 128, lo, hi);\n"
+    "        mathc_sieve.built = hi;\n"
+    "    }\n"
+    "    mathc_sieve.misses = 0;\n"
+    "}\n"
+    "// 1 se n pode ser respondido pelo crivo (estendendo-o se já compensa)\n"
+    "static int mathc_sieve_covers(unsigned long long n) {\n"
+    "    if (n < mathc_sieve.built) return 1;\n"
+    "    if (n >= mathc_sieve_limit()) return 0;\n"
+    "    if (n >= 65536 && ++mathc_sieve.misses * MATHC_SIEVE_AMORTIZE < n - mathc_sieve.built) return 0;\n"
+    "    mathc_sieve_extend(n);\n"
+    "    return 1;\n"
+    "}\n"
+    "static int mathc_isprime_u64(unsigned long long n) {\n"
+    "    if (n < 3) return n == 2;\n"
+    "    if (!(n & 1)) return 0;\n"
+    "    if (mathc_sieve_covers(n)) return !mathc_sieve_composite(mathc_sieve.words, n);\n"
+    "    return mathc_miller_rabin(n);\n"
+    "}\n"
+    "static inline int mathc_isprime(int n) { return n > 1 && mathc_isprime_u64((unsigned long long)n); }\n"
+    "// Menor primo maior que n\n"
+    "static int mathc_next_prime(int n) {\n"
+    "    if (n < 2) return 2;\n"
+    "    unsigned long long c = (unsigned long long)n + 1;\n"
+    "    if (!(c & 1)) c++;\n"
+    "    if (mathc_sieve_covers(c)) {\n"
+    "        // Palavra a palavra: ~bits são os primos; a cauda fora do crivo cai no Miller-Rabin\n"
+    "        const unsigned long long* w = mathc_sieve.words;\n"
+    "        unsigned long long i = c >> 1, end = mathc_sieve.built >> 1;\n"
+    "        while (i < end) {\n"
+    "            unsigned long long free_bits = ~w[i >> 6] >> (i & 63);\n"
+    "            if (free_bits) { i += (unsigned long long)__builtin_ctzll(free_bits); if (i < end) c = 2 * i + 1; break; }\n"
+    "            i = (i | 63) + 1;\n"
+    "        }\n"
+    "        if (i < end && c <= 2147483647ULL) return (int)c;\n"
+    "        c = 2 * i + 1;\n"
+    "    }\n"
+    "    while (c <= 2147483647ULL && !mathc_isprime_u64(c)) c += 2;\n"
+    "    if (c > 2147483647ULL) { fprintf(stderr, \"Erro: next_prime(%d) não cabe em int\\n\", n); exit(1); }\n"
+    "    return (int)c;\n"
+    "}\n"
+    "// Primos <= n em um int[] novo (tamanho em *out_len)\n"
+    "static int* mathc_primes_up_to(int n, int* out_len) {\n"
+    "    int cap = n < 64 ? 32 : (int)(1.26 * n / log((double)n)) + 16;  // pi(n) < 1.26 n / ln n\n"
+    "    int* ps = (int*)malloc(sizeof(int) * (size_t)cap);\n"
+    "    if (!ps) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    int len = 0;\n"
+    "    if (n >= 2) ps[len++] = 2;\n"
+    "    unsigned long long top = (unsigned long long)(n > 0 ? n : 0) + 1;  // números [0, top)\n"
+    "    unsigned long long limit = mathc_sieve_limit();\n"
+    "    mathc_sieve_extend(top - 1 < limit ? top - 1 : limit - 1);\n"
+    "    unsigned long long* tmp = NULL;\n"
+    "    for (unsigned long long lo = 0; lo < top; lo += MATHC_SIEVE_SEGMENT) {\n"
+    "        unsigned long long hi = lo + MATHC_SIEVE_SEGMENT < top ? lo + MATHC_SIEVE_SEGMENT : top;\n"
+    "        const unsigned long long* w;\n"
+    "        if (hi <= mathc_sieve.built) w = mathc_sieve.words + lo / 128;\n"
+    "        else {\n"
+    "            // Além do crivo guardado: segmento temporário\n"
+    "            if (!tmp) tmp = (unsigned long long*)malloc(MATHC_SIEVE_SEGMENT / 128 * sizeof(*tmp));\n"
+    "            if (!tmp) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "            memset(tmp, 0, MATHC_SIEVE_SEGMENT / 128 * sizeof(*tmp));\n"
+    "            mathc_sieve_segment(tmp, lo, (hi + 127) & ~127ULL);\n"
+    "            w = tmp;\n"
+    "        }\n"
+    "        for (unsigned long long k = 0; k < (hi - lo + 127) / 128; k++) {\n"
+    "            unsigned long long bits = ~w[k];\n"
+    "            if (lo == 0 && k == 0) bits &= ~1ULL;  // 1\n"
+    "            while (bits) {\n"
+    "                unsigned long long p = lo + 128 * k + 2 * (unsigned long long)__builtin_ctzll(bits) + 1;\n"
+    "                bits &= bits - 1;\n"
+    "                if (p >= top) break;\n"
+    "                if (len == cap) ps = (int*)mathc_vec_realloc(ps, len, &cap, cap * 2, sizeof(int));\n"
+    "                ps[len++] = (int)p;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    free(tmp);\n"
+    "    if (out_len) *out_len = len;\n"
+    "    return ps;\n"
+    "}\n"
+    "// Pollard-rho com o ciclo de Brent; os |x - y| são multiplicados em lotes de\n"
+    "// MATHC_RHO_BATCH e testados com um gcd só por lote. n ímpar e composto\n"
+    "static unsigned long long mathc_rho_u64(unsigned long long n) {\n"
+    "    for (unsigned long long c = 1;; c++) {\n"
+    "        unsigned long long x = 2, y = 2, ys = 2, q = 1, g = 1;\n"
+    "#define MATHC_RHO_F(v) (v = mathc_mulmod_u64(v, v, n), v = v >= n - c ? v - (n - c) : v + c)\n"
+    "        for (unsigned long long r = 1; g == 1; r <<= 1) {\n"
+    "            x = y;\n"
+    "            for (unsigned long long i = 0; i < r; i++) MATHC_RHO_F(y);\n"
+    "            for (unsigned long long k = 0; k < r && g == 1; k += MATHC_RHO_BATCH) {\n"
+    "                ys = y;\n"
+    "                for (unsigned long long i = 0; i < MATHC_RHO_BATCH && i < r - k; i++) {\n"
+    "                    MATHC_RHO_F(y);\n"
+    "                    q = mathc_mulmod_u64(q, x > y ? x - y : y - x, n);\n"
+    "                }\n"
+    "                g = mathc_gcd_u64(q, n);\n"
+    "            }\n"
+    "        }\n"
+    "        // O lote passou do fator (ou q zerou): refaz passo a passo desde ys\n"
+    "        if (g == n) do { MATHC_RHO_F(ys); g = mathc_gcd_u64(x > ys ? x - ys : ys - x, n); } while (g == 1);\n"
+    "#undef MATHC_RHO_F\n"
+    "        if (g != n) return g;\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_factor_rec(unsigned long long n, unsigned long long* out, int* len) {\n"
+    "    if (n == 1) return;\n"
+    "    if (mathc_miller_rabin(n)) { out[(*len)++] = n; return; }\n"
+    "    unsigned long long d = mathc_rho_u64(n);\n"
+    "    mathc_factor_rec(d, out, len);\n"
+    "    mathc_factor_rec(n / d, out, len);\n"
+    "}\n"
+    "// Fatores primos de n em ordem crescente, com multiplicidade (no máximo 64)\n"
+    "static int mathc_factorize_u64(unsigned long long n, unsigned long long* out) {\n"
+    "    static const unsigned char small[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47 };\n"
+    "    int len = 0;\n"
+    "    if (n < 2) return 0;\n"
+    "    for (int i = 0; i < 15; i++)\n"
+    "        while (n % small[i] == 0) { out[len++] = small[i]; n /= small[i]; }\n"
+    "    mathc_factor_rec(n, out, &len);\n"
+    "    for (int i = 1; i < len; i++)\n"
+    "        for (int j = i; j > 0 && out[j - 1] > out[j]; j--) { unsigned long long t = out[j]; out[j] = out[j - 1]; out[j - 1] = t; }\n"
+    "    return len;\n"
+    "}\n"
+    "// factorize(n): fatores primos de |n| num int[] novo\n"
+    "static int* mathc_factorize(int n, int* out_len) {\n"
+    "    unsigned long long f[64];\n"
+    "    int len = mathc_factorize_u64(mathc_nt_abs(n), f);\n"
+    "    int* r = (int*)malloc(sizeof(int) * (size_t)(len > 0 ? len : 1));\n"
+    "    if (!r) { fprintf(stderr, \"Erro: memória insuficiente\\n\"); exit(1); }\n"
+    "    for (int i = 0; i < len; i++) r[i] = (int)f[i];\n"
+    "    if (out_len) *out_len = len;\n"
+    "    return r;\n"
+    "}\n";
+
+static void codegen_primes_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_SIEVE_DEFAULT (1ULL << 24)\n", ctx->output);
+    fputs("#define MATHC_SIEVE_SEGMENT (1ULL << 18)  // números por segmento: 16 KB de bits\n", ctx->output);
+    fputs("#define MATHC_SIEVE_AMORTIZE 256           // números crivados no tempo de um Miller-Rabin\n", ctx->output);
+    fputs("#define MATHC_RHO_BATCH 128                 // passos do Pollard-rho por gcd\n", ctx->output);
+    fputs(primes_runtime, ctx->output);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+/*
+ * Builtins que devolvem um vetor novo: o runtime recebe `int* out_len` como
+ * último argumento, e o tamanho vai direto para v__len (como no GEMV). Só
+ * cabem numa declaração `T[] v = f(...)` ou numa atribuição `v = f(...)`;
+ * em qualquer outra expressão o vetor não teria tamanho nem dono, e a
+ * compilação falha.
+ */
+static const char* array_result_builtins[] = { "primes_up_to", "factorize", "input_array", "read_array", NULL };
+
+static int codegen_is_array_result_call(ASTNode* e) {
+    return e && e->type == NODE_CALL && e->call.function && e->call.function->type == NODE_IDENTIFIER &&
+           escape_in_list(array_result_builtins, e->call.function->identifier.name);
+}
+
+static void codegen_array_result_call(CodeGenContext* ctx, ASTNode* call, const char* len_target) {
+    const char* name = call->call.function->identifier.name;
+    NodeList* args = call->call.arguments;
+    if (!args) {
+        codegen_error(ctx, call, "%s requer argumentos", name);
+        codegen_emit(ctx, "NULL");
+        return;
+    }
+    if (strcmp(name, "input_array") == 0 || strcmp(name, "read_array") == 0) {
+        // O tipo de elemento vem da variável que recebe
+        TypeSpec* t = call->inferred_type;
+        const char* suffix = codegen_input_suffix(t && t->base_type == TYPE_ARRAY ? t->element_type : NULL);
+        if (!suffix) {
+            codegen_error(ctx, call, "%s requer int[] ou float[]", name);
+            codegen_emit(ctx, "NULL");
+            return;
+        }
+        codegen_emit(ctx, "mathc_%s_%s(", name, suffix);
+    } else {
+        codegen_emit(ctx, "mathc_%s(", name);
+    }
+    for (; args; args = args->next) {
+        codegen_expression(ctx, args->node);
+        codegen_emit(ctx, ", ");
+    }
+    codegen_emit(ctx, "&%s)", len_target);
+}
+
+/* Índice de `name` entre as alocações liberadas no fim da função, ou -1 */
+static int codegen_find_alloc(CodeGenContext* ctx, const char* name) {
+    for (int i = ctx->alloc_count - 1; i >= 0; i--) {
+        if (ctx->alloc_names[i] && strcmp(ctx->alloc_names[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+/*
+ * v = f(...), v = A @ x ou v = load_npy(...) com v vetor: o valor novo é
+ * calculado antes (os argumentos podem ler v), o buffer antigo é liberado e
+ * v__len/v__cap passam a descrever o novo. v precisa ser dono do buffer.
+ */
+static int codegen_array_result_assignment(CodeGenContext* ctx, ASTNode* stmt) {
+    ASTNode* target = stmt->assignment.target;
+    ASTNode* value = stmt->assignment.value;
+    ASTNode* mm_left = NULL;
+    ASTNode* mm_right = NULL;
+    const char* call = codegen_call_name(value);
+    int npy = call && strcmp(call, "load_npy") == 0;
+    int gemv = codegen_is_matmul_expr(value, &mm_left, &mm_right) &&
+               mm_right && codegen_is_vector_type(mm_right->inferred_type);
+    if (stmt->assignment.op != OP_ASSIGN || !target || target->type != NODE_IDENTIFIER ||
+        !codegen_is_vector_type(target->inferred_type) ||
+        (!npy && !gemv && !codegen_is_array_result_call(value))) {
+        return 0;
+    }
+    const char* name = target->identifier.name;
+    int owner = codegen_find_alloc(ctx, name);
+    if (owner < 0) {
+        codegen_error(ctx, stmt, "%s = ... com um vetor novo requer um vetor local (declarado com T[] nesta função)", name);
+        codegen_emit(ctx, "(void)0;\n");
+        return 1;
+    }
+    char len_name[300];
+    snprintf(len_name, sizeof(len_name), "%s__len", name);
+    TypeSpec* t = target->inferred_type;
+    const char* elem_c_type = t->element_type ? codegen_type_to_c(t->element_type) : "int";
+    codegen_emit(ctx, "{\n");
+    ctx->indent_level++;
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "%s* mathc_novo = ", elem_c_type);
+    if (npy) {
+        const char* suffix = codegen_input_suffix(t->element_type);
+        if (!suffix || !value->call.arguments) {
+            codegen_error(ctx, stmt, "load_npy(arquivo) requer int[] ou float[]");
+            codegen_emit(ctx, "NULL");
+        } else {
+            codegen_emit(ctx, "mathc_load_npy_array_%s(", suffix);
+            codegen_expression(ctx, value->call.arguments->node);
+            codegen_emit(ctx, ", &%s__len, &%s__cap)", name, name);
+        }
+    } else if (gemv) {
+        codegen_matmul(ctx, mm_left, mm_right, len_name);
+    } else {
+        codegen_array_result_call(ctx, value, len_name);
+    }
+    codegen_emit(ctx, ";\n");
+    codegen_emit_indent(ctx);
+    // Num laço o buffer antigo pode ter vindo de um load_npy: mathc_npy_release também faz free
+    if (!ctx->alloc_free_fns[owner] && codegen_program_uses_builtin(ctx->program, npy_builtins)) {
+        ctx->alloc_free_fns[owner] = "mathc_npy_release";
+    }
+    codegen_emit(ctx, "%s(%s);\n", ctx->alloc_free_fns[owner] ? ctx->alloc_free_fns[owner] : "free", name);
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "%s = mathc_novo;\n", name);
+    if (!npy) {
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "%s__cap = %s;\n", name, len_name);
+    }
+    ctx->indent_level--;
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "}\n");
+    return 1;
+}
+
+/* ========================================================================== */
+/* GRANDES INTEIROS (bigint) */
+/* ========================================================================== */
+/*
+ * bigint guarda a magnitude em limbs de 32 bits (o menos significativo
+ * primeiro) e o sinal à parte, num único bloco com contador de referências.
+ * As operações chamadas pelo código gerado consomem os operandos: cada uso
+ * de uma variável passa mathc_big_ref(x), e os temporários de a * b + c são
+ * liberados ao longo da própria expressão. A variável é liberada no fim da
+ * função, ou ao fim de cada volta quando declarada direto no corpo de um laço.
+ *
+ * A multiplicação é a escolar abaixo de MATHC_KARATSUBA_MIN limbs no menor
+ * fator e Karatsuba acima; fatores desbalanceados são multiplicados em
+ * fatias do tamanho do menor. factorial e permutations usam árvore de
+ * produtos (os fatores crescem juntos, e o Karatsuba entra nos níveis altos);
+ * combinations soma os expoentes de Legendre de cada primo e multiplica as
+ * potências em árvore, sem dividir bigint. A divisão é o algoritmo D de Knuth.
+ * O texto decimal sai em blocos de 9 dígitos (divisão por 10^9, um limb).
+ *
+ * Promoção: uma expressão inteira em contexto bigint (inicializador,
+ * atribuição, operando de uma operação bigint, argumento ou retorno bigint)
+ * é refeita com as operações de bigint, de modo que factorial(n),
+ * combinations(n, k), permutations(n, k) e a ^ b nunca passam por int.
+ */
+
+static const char* bigint_runtime =
+    "typedef struct mathc_bigint {\n"
+    "    int refs;        // referências vivas (variáveis e operandos pendentes)\n"
+    "    int sign;        // -1, 0 ou 1\n"
+    "    int len;         // limbs em uso, sem zeros no topo\n"
+    "    int cap;\n"
+    "    unsigned d[];    // base 2^32, menos significativo primeiro\n"
+    "} mathc_bigint;\n"
+    "\n"
+    "static mathc_bigint* mathc_big_alloc(int cap) {\n"
+    "    if (cap < 1) cap = 1;\n"
+    "    mathc_bigint* x = (mathc_bigint*)malloc(sizeof(mathc_bigint) + sizeof(unsigned) * (size_t)cap);\n"
+    "    if (!x) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    x->refs = 1; x->sign = 0; x->len = 0; x->cap = cap;\n"
+    "    return x;\n"
+    "}\n"
+    "static inline mathc_bigint* mathc_big_ref(mathc_bigint* x) { x->refs++; return x; }\n"
+    "static inline void mathc_big_release(mathc_bigint* x) { if (x && --x->refs == 0) free(x); }\n"
+    "// x = v, liberando o valor anterior; v já pertence ao chamador\n"
+    "static inline void mathc_big_assign(mathc_bigint** x, mathc_bigint* v) { mathc_bigint* old = *x; *x = v; mathc_big_release(old); }\n"
+    "static mathc_bigint* mathc_big_norm(mathc_bigint* x, int sign) {\n"
+    "    while (x->len > 0 && x->d[x->len - 1] == 0) x->len--;\n"
+    "    x->sign = x->len ? sign : 0;\n"
+    "    return x;\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_from_ll(long long v) {\n"
+    "    mathc_bigint* x = mathc_big_alloc(2);\n"
+    "    unsigned long long m = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;\n"
+    "    x->d[0] = (unsigned)m; x->d[1] = (unsigned)(m >> 32); x->len = 2;\n"
+    "    return mathc_big_norm(x, v < 0 ? -1 : 1);\n"
+    "}\n"
+    "\n"
+    "/* ---- magnitudes (arrays de limbs) ---- */\n"
+    "// r[0..an] = a + b, an >= bn; devolve o carry final já gravado em r[an]\n"
+    "static void mathc_mag_add(unsigned* r, const unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    unsigned long long c = 0;\n"
+    "    int i = 0;\n"
+    "    for (; i < bn; i++) { c += (unsigned long long)a[i] + b[i]; r[i] = (unsigned)c; c >>= 32; }\n"
+    "    for (; i < an; i++) { c += a[i]; r[i] = (unsigned)c; c >>= 32; }\n"
+    "    r[an] = (unsigned)c;\n"
+    "}\n"
+    "// a[0..an) -= b[0..bn), com a >= b\n"
+    "static void mathc_mag_sub_inplace(unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    long long t = 0;\n"
+    "    int i = 0;\n"
+    "    for (; i < bn; i++) { t += (long long)a[i] - b[i]; a[i] = (unsigned)t; t >>= 32; }\n"
+    "    for (; t && i < an; i++) { t += a[i]; a[i] = (unsigned)t; t >>= 32; }\n"
+    "}\n"
+    "// a[0..an) += b[0..bn), sem estourar an\n"
+    "static void mathc_mag_add_inplace(unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    unsigned long long c = 0;\n"
+    "    int i = 0;\n"
+    "    for (; i < bn; i++) { c += (unsigned long long)a[i] + b[i]; a[i] = (unsigned)c; c >>= 32; }\n"
+    "    for (; c && i < an; i++) { c += a[i]; a[i] = (unsigned)c; c >>= 32; }\n"
+    "}\n"
+    "static int mathc_mag_cmp(const unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    if (an != bn) return an < bn ? -1 : 1;\n"
+    "    for (int i = an - 1; i >= 0; i--)\n"
+    "        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;\n"
+    "    return 0;\n"
+    "}\n"
+    "// r[0..an+bn) = a * b (escolar); r não pode ser a nem b\n"
+    "static void mathc_mag_mul_basic(unsigned* r, const unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    memset(r, 0, sizeof(unsigned) * (size_t)(an + bn));\n"
+    "    for (int j = 0; j < bn; j++) {\n"
+    "        unsigned long long c = 0, bj = b[j];\n"
+    "        if (!bj) continue;\n"
+    "        for (int i = 0; i < an; i++) { c += a[i] * bj + r[i + j]; r[i + j] = (unsigned)c; c >>= 32; }\n"
+    "        r[j + an] = (unsigned)c;\n"
+    "    }\n"
+    "}\n"
+    "static void mathc_mag_mul(unsigned* r, const unsigned* a, int an, const unsigned* b, int bn);\n"
+    "// Karatsuba com an >= bn > h = (an + 1) / 2:\n"
+    "// a*b = z0 + (z1 - z0 - z2) * B^h + z2 * B^2h, z1 = (a0 + a1)(b0 + b1)\n"
+    "static void mathc_mag_karatsuba(unsigned* r, const unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    int h = (an + 1) / 2, a1n = an - h, b1n = bn - h;\n"
+    "    int san = h + 1, sbn = h + 1, zn = san + sbn;\n"
+    "    unsigned* tmp = (unsigned*)malloc(sizeof(unsigned) * (size_t)(san + sbn + zn));\n"
+    "    if (!tmp) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    unsigned *sa = tmp, *sb = tmp + san, *z1 = tmp + san + sbn;\n"
+    "    mathc_mag_add(sa, a, h, a + h, a1n);\n"
+    "    mathc_mag_add(sb, b, h, b + h, b1n);\n"
+    "    mathc_mag_mul(r, a, h, b, h);                    // z0 em r[0..2h)\n"
+    "    mathc_mag_mul(r + 2 * h, a + h, a1n, b + h, b1n); // z2 em r[2h..an+bn)\n"
+    "    mathc_mag_mul(z1, sa, san, sb, sbn);\n"
+    "    mathc_mag_sub_inplace(z1, zn, r, 2 * h);\n"
+    "    mathc_mag_sub_inplace(z1, zn, r + 2 * h, a1n + b1n);\n"
+    "    int z1n = zn;\n"
+    "    while (z1n > 0 && z1[z1n - 1] == 0) z1n--;\n"
+    "    mathc_mag_add_inplace(r + h, an + bn - h, z1, z1n);\n"
+    "    free(tmp);\n"
+    "}\n"
+    "// r[0..an+bn) = a * b; escolhe escolar, Karatsuba ou fatias de b limbs de a\n"
+    "static void mathc_mag_mul(unsigned* r, const unsigned* a, int an, const unsigned* b, int bn) {\n"
+    "    if (an < bn) { const unsigned* t = a; a = b; b = t; int tn = an; an = bn; bn = tn; }\n"
+    "    if (bn == 0) { memset(r, 0, sizeof(unsigned) * (size_t)an); return; }\n"
+    "    if (bn < MATHC_KARATSUBA_MIN) { mathc_mag_mul_basic(r, a, an, b, bn); return; }\n"
+    "    if (2 * bn > an + 1) { mathc_mag_karatsuba(r, a, an, b, bn); return; }\n"
+    "    // Desbalanceado: fatias de bn limbs de a, cada uma bn x bn\n"
+    "    unsigned* part = (unsigned*)malloc(sizeof(unsigned) * (size_t)(2 * bn));\n"
+    "    if (!part) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    memset(r, 0, sizeof(unsigned) * (size_t)(an + bn));\n"
+    "    for (int off = 0; off < an; off += bn) {\n"
+    "        int n = an - off < bn ? an - off : bn;\n"
+    "        mathc_mag_mul(part, a + off, n, b, bn);\n"
+    "        mathc_mag_add_inplace(r + off, an + bn - off, part, n + bn);\n"
+    "    }\n"
+    "    free(part);\n"
+    "}\n"
+    "// Divide a[0..an) por d de um limb no lugar; devolve o resto\n"
+    "static unsigned mathc_mag_divmod_small(unsigned* a, int an, unsigned d) {\n"
+    "    unsigned long long rem = 0;\n"
+    "    for (int i = an - 1; i >= 0; i--) {\n"
+    "        unsigned long long cur = (rem << 32) | a[i];\n"
+    "        a[i] = (unsigned)(cur / d);\n"
+    "        rem = cur % d;\n"
+    "    }\n"
+    "    return (unsigned)rem;\n"
+    "}\n"
+    "// Knuth D: q[0..an-bn] = a / b, r[0..bn) = a % b; an >= bn >= 2, b[bn-1] != 0\n"
+    "static void mathc_mag_divmod(const unsigned* a, int an, const unsigned* b, int bn, unsigned* q, unsigned* r) {\n"
+    "    int s = __builtin_clz(b[bn - 1]);\n"
+    "    unsigned* un = (unsigned*)malloc(sizeof(unsigned) * (size_t)(an + 1 + bn));\n"
+    "    if (!un) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    unsigned* vn = un + an + 1;\n"
+    "    // Normaliza: o limb mais alto do divisor fica com o bit 31 ligado\n"
+    "    for (int i = bn - 1; i > 0; i--) vn[i] = (b[i] << s) | (s ? b[i - 1] >> (32 - s) : 0);\n"
+    "    vn[0] = b[0] << s;\n"
+    "    un[an] = s ? a[an - 1] >> (32 - s) : 0;\n"
+    "    for (int i = an - 1; i > 0; i--) un[i] = (a[i] << s) | (s ? a[i - 1] >> (32 - s) : 0);\n"
+    "    un[0] = a[0] << s;\n"
+    "    const unsigned long long B = 1ULL << 32;\n"
+    "    for (int j = an - bn; j >= 0; j--) {\n"
+    "        unsigned long long num = ((unsigned long long)un[j + bn] << 32) | un[j + bn - 1];\n"
+    "        unsigned long long qhat = num / vn[bn - 1], rhat = num % vn[bn - 1];\n"
+    "        while (qhat >= B || qhat * vn[bn - 2] > ((rhat << 32) | un[j + bn - 2])) {\n"
+    "            qhat--; rhat += vn[bn - 1];\n"
+    "            if (rhat >= B) break;\n"
+    "        }\n"
+    "        long long k = 0, t;\n"
+    "        for (int i = 0; i < bn; i++) {\n"
+    "            unsigned long long p = qhat * vn[i];\n"
+    "            t = (long long)un[i + j] - k - (long long)(p & 0xFFFFFFFFULL);\n"
+    "            un[i + j] = (unsigned)t;\n"
+    "            k = (long long)(p >> 32) - (t >> 32);\n"
+    "        }\n"
+    "        t = (long long)un[j + bn] - k;\n"
+    "        un[j + bn] = (unsigned)t;\n"
+    "        q[j] = (unsigned)qhat;\n"
+    "        if (t < 0) {\n"
+    "            // qhat passou de um: devolve o divisor\n"
+    "            q[j]--;\n"
+    "            unsigned long long c = 0;\n"
+    "            for (int i = 0; i < bn; i++) { c += (unsigned long long)un[i + j] + vn[i]; un[i + j] = (unsigned)c; c >>= 32; }\n"
+    "            un[j + bn] += (unsigned)c;\n"
+    "        }\n"
+    "    }\n"
+    "    for (int i = 0; i < bn - 1; i++) r[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0);\n"
+    "    r[bn - 1] = un[bn - 1] >> s;\n"
+    "    free(un);\n"
+    "}\n"
+    "\n"
+    "/* ---- operações com sinal (emprestam os operandos) ---- */\n"
+    "static mathc_bigint* mathc_big_addsub_b(const mathc_bigint* a, const mathc_bigint* b, int negate_b) {\n"
+    "    int bs = negate_b ? -b->sign : b->sign;\n"
+    "    if (!b->sign) { mathc_bigint* r = mathc_big_alloc(a->len); memcpy(r->d, a->d, sizeof(unsigned) * (size_t)a->len); r->len = a->len; return mathc_big_norm(r, a->sign); }\n"
+    "    if (!a->sign) { mathc_bigint* r = mathc_big_alloc(b->len); memcpy(r->d, b->d, sizeof(unsigned) * (size_t)b->len); r->len = b->len; return mathc_big_norm(r, bs); }\n"
+    "    if (a->sign == bs) {\n"
+    "        const mathc_bigint *x = a->len >= b->len ? a : b, *y = x == a ? b : a;\n"
+    "        mathc_bigint* r = mathc_big_alloc(x->len + 1);\n"
+    "        mathc_mag_add(r->d, x->d, x->len, y->d, y->len);\n"
+    "        r->len = x->len + 1;\n"
+    "        return mathc_big_norm(r, a->sign);\n"
+    "    }\n"
+    "    int c = mathc_mag_cmp(a->d, a->len, b->d, b->len);\n"
+    "    if (c == 0) return mathc_big_alloc(1);\n"
+    "    const mathc_bigint *x = c > 0 ? a : b, *y = c > 0 ? b : a;\n"
+    "    mathc_bigint* r = mathc_big_alloc(x->len);\n"
+    "    memcpy(r->d, x->d, sizeof(unsigned) * (size_t)x->len);\n"
+    "    r->len = x->len;\n"
+    "    mathc_mag_sub_inplace(r->d, r->len, y->d, y->len);\n"
+    "    return mathc_big_norm(r, c > 0 ? a->sign : bs);\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_mul_b(const mathc_bigint* a, const mathc_bigint* b) {\n"
+    "    if (!a->sign || !b->sign) return mathc_big_alloc(1);\n"
+    "    mathc_bigint* r = mathc_big_alloc(a->len + b->len);\n"
+    "    mathc_mag_mul(r->d, a->d, a->len, b->d, b->len);\n"
+    "    r->len = a->len + b->len;\n"
+    "    return mathc_big_norm(r, a->sign * b->sign);\n"
+    "}\n"
+    "// Quociente e resto truncados (como em C): q tem o sinal de a*b, r o de a\n"
+    "static void mathc_big_divmod_b(const mathc_bigint* a, const mathc_bigint* b, mathc_bigint** q, mathc_bigint** r) {\n"
+    "    if (!b->sign) { fprintf(stderr, \"Erro: divisão de bigint por zero\\n\"); exit(1); }\n"
+    "    if (mathc_mag_cmp(a->d, a->len, b->d, b->len) < 0) {\n"
+    "        if (q) *q = mathc_big_alloc(1);\n"
+    "        if (r) { *r = mathc_big_alloc(a->len); memcpy((*r)->d, a->d, sizeof(unsigned) * (size_t)a->len); (*r)->len = a->len; mathc_big_norm(*r, a->sign); }\n"
+    "        return;\n"
+    "    }\n"
+    "    mathc_bigint* qq = mathc_big_alloc(a->len - b->len + 1);\n"
+    "    mathc_bigint* rr = mathc_big_alloc(b->len);\n"
+    "    qq->len = a->len - b->len + 1;\n"
+    "    rr->len = b->len;\n"
+    "    if (b->len == 1) {\n"
+    "        memcpy(qq->d, a->d, sizeof(unsigned) * (size_t)a->len);\n"
+    "        qq->len = a->len;\n"
+    "        rr->d[0] = mathc_mag_divmod_small(qq->d, qq->len, b->d[0]);\n"
+    "    } else {\n"
+    "        mathc_mag_divmod(a->d, a->len, b->d, b->len, qq->d, rr->d);\n"
+    "    }\n"
+    "    mathc_big_norm(qq, a->sign * b->sign);\n"
+    "    mathc_big_norm(rr, a->sign);\n"
+    "    if (q) *q = qq; else mathc_big_release(qq);\n"
+    "    if (r) *r = rr; else mathc_big_release(rr);\n"
+    "}\n"
+    "static int mathc_big_cmp_b(const mathc_bigint* a, const mathc_bigint* b) {\n"
+    "    if (a->sign != b->sign) return a->sign < b->sign ? -1 : 1;\n"
+    "    int c = mathc_mag_cmp(a->d, a->len, b->d, b->len);\n"
+    "    return a->sign < 0 ? -c : c;\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_mul_small_inplace(mathc_bigint* x, unsigned m, unsigned add) {\n"
+    "    // x = x * m + add (x positivo ou zero, exclusivo do chamador)\n"
+    "    unsigned long long c = add;\n"
+    "    for (int i = 0; i < x->len; i++) { c += (unsigned long long)x->d[i] * m; x->d[i] = (unsigned)c; c >>= 32; }\n"
+    "    if (c) {\n"
+    "        if (x->len == x->cap) {\n"
+    "            mathc_bigint* y = mathc_big_alloc(x->cap * 2);\n"
+    "            memcpy(y->d, x->d, sizeof(unsigned) * (size_t)x->len);\n"
+    "            y->len = x->len; y->refs = x->refs;\n"
+    "            free(x); x = y;\n"
+    "        }\n"
+    "        x->d[x->len++] = (unsigned)c;\n"
+    "    }\n"
+    "    return mathc_big_norm(x, 1);\n"
+    "}\n"
+    "// Produto de lo..hi por árvore de produtos: os fatores crescem juntos e o Karatsuba entra nos níveis altos\n"
+    "static mathc_bigint* mathc_big_prod_range(long long lo, long long hi) {\n"
+    "    if (lo > hi) return mathc_big_from_ll(1);\n"
+    "    if (hi - lo < 16) {\n"
+    "        mathc_bigint* r = mathc_big_from_ll(lo);\n"
+    "        for (long long i = lo + 1; i <= hi; i++) r = mathc_big_mul_small_inplace(r, (unsigned)i, 0);\n"
+    "        return r;\n"
+    "    }\n"
+    "    long long mid = lo + (hi - lo) / 2;\n"
+    "    mathc_bigint* a = mathc_big_prod_range(lo, mid);\n"
+    "    mathc_bigint* b = mathc_big_prod_range(mid + 1, hi);\n"
+    "    mathc_bigint* r = mathc_big_mul_b(a, b);\n"
+    "    mathc_big_release(a); mathc_big_release(b);\n"
+    "    return r;\n"
+    "}\n"
+    "\n"
+    "/* ---- API usada pelo código gerado: consome os operandos ---- */\n"
+    "static mathc_bigint* mathc_big_add(mathc_bigint* a, mathc_bigint* b) { mathc_bigint* r = mathc_big_addsub_b(a, b, 0); mathc_big_release(a); mathc_big_release(b); return r; }\n"
+    "static mathc_bigint* mathc_big_sub(mathc_bigint* a, mathc_bigint* b) { mathc_bigint* r = mathc_big_addsub_b(a, b, 1); mathc_big_release(a); mathc_big_release(b); return r; }\n"
+    "static mathc_bigint* mathc_big_mul(mathc_bigint* a, mathc_bigint* b) { mathc_bigint* r = mathc_big_mul_b(a, b); mathc_big_release(a); mathc_big_release(b); return r; }\n"
+    "static mathc_bigint* mathc_big_div(mathc_bigint* a, mathc_bigint* b) { mathc_bigint* q; mathc_big_divmod_b(a, b, &q, NULL); mathc_big_release(a); mathc_big_release(b); return q; }\n"
+    "static mathc_bigint* mathc_big_mod(mathc_bigint* a, mathc_bigint* b) { mathc_bigint* r; mathc_big_divmod_b(a, b, NULL, &r); mathc_big_release(a); mathc_big_release(b); return r; }\n"
+    "// a // b arredonda para baixo: corrige o quociente truncado quando o resto tem sinal oposto ao divisor\n"
+    "static mathc_bigint* mathc_big_floor_div(mathc_bigint* a, mathc_bigint* b) {\n"
+    "    mathc_bigint *q, *r;\n"
+    "    mathc_big_divmod_b(a, b, &q, &r);\n"
+    "    if (r->sign && r->sign != b->sign) q = mathc_big_sub(q, mathc_big_from_ll(1));\n"
+    "    mathc_big_release(r); mathc_big_release(a); mathc_big_release(b);\n"
+    "    return q;\n"
+    "}\n"
+    "static int mathc_big_cmp(mathc_bigint* a, mathc_bigint* b) { int c = mathc_big_cmp_b(a, b); mathc_big_release(a); mathc_big_release(b); return c; }\n"
+    "static mathc_bigint* mathc_big_neg(mathc_bigint* a) {\n"
+    "    mathc_bigint* r = mathc_big_alloc(a->len);\n"
+    "    memcpy(r->d, a->d, sizeof(unsigned) * (size_t)a->len);\n"
+    "    r->len = a->len;\n"
+    "    mathc_big_norm(r, -a->sign);\n"
+    "    mathc_big_release(a);\n"
+    "    return r;\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_pow(mathc_bigint* b, int e) {\n"
+    "    if (e < 0) { fprintf(stderr, \"Erro: bigint ^ %d (expoente negativo)\\n\", e); exit(1); }\n"
+    "    mathc_bigint* r = mathc_big_from_ll(1);\n"
+    "    mathc_bigint* x = b;\n"
+    "    for (; e; e >>= 1) {\n"
+    "        if (e & 1) { mathc_bigint* t = mathc_big_mul_b(r, x); mathc_big_release(r); r = t; }\n"
+    "        if (e > 1) { mathc_bigint* t = mathc_big_mul_b(x, x); mathc_big_release(x); x = t; }\n"
+    "    }\n"
+    "    mathc_big_release(x);\n"
+    "    return r;\n"
+    "}\n"
+    "static double mathc_big_to_double(mathc_bigint* a) {\n"
+    "    double v = 0.0;\n"
+    "    for (int i = a->len - 1; i >= 0; i--) v = v * 4294967296.0 + a->d[i];\n"
+    "    v *= a->sign;\n"
+    "    mathc_big_release(a);\n"
+    "    return v;\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_factorial(int n) {\n"
+    "    if (n < 0) return mathc_big_alloc(1);\n"
+    "    return mathc_big_prod_range(1, n);\n"
+    "}\n"
+    "static mathc_bigint* mathc_big_permutations(int n, int k) {\n"
+    "    if (k > n || k < 0) return mathc_big_alloc(1);\n"
+    "    return mathc_big_prod_range((long long)n - k + 1, n);\n"
+    "}\n"
+    "// C(n, k) pelos expoentes de Legendre de cada primo p <= n: sem nenhuma divisão de bigint\n"
+    "static mathc_bigint* mathc_big_combinations(int n, int k) {\n"
+    "    if (k > n || k < 0) return mathc_big_alloc(1);\n"
+    "    if (k > n - k) k = n - k;\n"
+    "    if (k == 0) return mathc_big_from_ll(1);\n"
+    "    char* composite = (char*)calloc((size_t)n + 1, 1);\n"
+    "    unsigned* pows = (unsigned*)malloc(sizeof(unsigned) * ((size_t)n / 2 + 2));\n"
+    "    if (!composite || !pows) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    int np = 0;\n"
+    "    for (long long p = 2; p <= n; p++) {\n"
+    "        if (composite[p]) continue;\n"
+    "        for (long long m = p * p; m <= n; m += p) composite[m] = 1;\n"
+    "        int e = 0;\n"
+    "        for (long long q = p; q <= n; q *= p) e += (int)(n / q - k / q - (n - k) / q);\n"
+    "        // p^e cabe em um limb quando p > sqrt(n) (e <= 1); senão acumula enquanto couber\n"
+    "        unsigned long long acc = 1;\n"
+    "        for (int i = 0; i < e; i++) {\n"
+    "            if (acc * (unsigned long long)p > 0xFFFFFFFFULL) { pows[np++] = (unsigned)acc; acc = 1; }\n"
+    "            acc *= (unsigned long long)p;\n"
+    "        }\n"
+    "        if (acc > 1) pows[np++] = (unsigned)acc;\n"
+    "    }\n"
+    "    free(composite);\n"
+    "    // Árvore de produtos sobre os fatores de um limb\n"
+    "    mathc_bigint** level = (mathc_bigint**)malloc(sizeof(mathc_bigint*) * (size_t)(np > 0 ? np : 1));\n"
+    "    if (!level) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    for (int i = 0; i < np; i++) level[i] = mathc_big_from_ll(pows[i]);\n"
+    "    free(pows);\n"
+    "    int cnt = np;\n"
+    "    while (cnt > 1) {\n"
+    "        int m = 0;\n"
+    "        for (int i = 0; i + 1 < cnt; i += 2) level[m++] = mathc_big_mul(level[i], level[i + 1]);\n"
+    "        if (cnt & 1) level[m++] = level[cnt - 1];\n"
+    "        cnt = m;\n"
+    "    }\n"
+    "    mathc_bigint* r = cnt ? level[0] : mathc_big_from_ll(1);\n"
+    "    free(level);\n"
+    "    return r;\n"
+    "}\n"
+    "// Texto decimal: divide uma cópia por 10^9 em cada passada (divisor constante: multiplicação, não div)\n"
+    "static char* mathc_big_to_string_b(const mathc_bigint* a) {\n"
+    "    if (!a->sign) { char* s = (char*)malloc(2); s[0] = '0'; s[1] = 0; return s; }\n"
+    "    int n = a->len;\n"
+    "    unsigned* t = (unsigned*)malloc(sizeof(unsigned) * (size_t)n);\n"
+    "    unsigned* chunks = (unsigned*)malloc(sizeof(unsigned) * ((size_t)n * 32 / 29 + 2));\n"
+    "    if (!t || !chunks) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    memcpy(t, a->d, sizeof(unsigned) * (size_t)n);\n"
+    "    int nc = 0;\n"
+    "    while (n > 0) {\n"
+    "        unsigned long long rem = 0;\n"
+    "        for (int i = n - 1; i >= 0; i--) {\n"
+    "            unsigned long long cur = (rem << 32) | t[i];\n"
+    "            t[i] = (unsigned)(cur / 1000000000u);\n"
+    "            rem = cur % 1000000000u;\n"
+    "        }\n"
+    "        chunks[nc++] = (unsigned)rem;\n"
+    "        while (n > 0 && t[n - 1] == 0) n--;\n"
+    "    }\n"
+    "    char* s = (char*)malloc((size_t)nc * 9 + 2);\n"
+    "    if (!s) { fprintf(stderr, \"Erro: memória insuficiente para bigint\\n\"); exit(1); }\n"
+    "    char* p = s;\n"
+    "    if (a->sign < 0) *p++ = '-';\n"
+    "    p += sprintf(p, \"%u\", chunks[nc - 1]);\n"
+    "    for (int i = nc - 2; i >= 0; i--) {\n"
+    "        unsigned v = chunks[i];\n"
+    "        for (int k = 8; k >= 0; k--) { p[k] = (char)('0' + v % 10); v /= 10; }\n"
+    "        p += 9;\n"
+    "    }\n"
+    "    *p = 0;\n"
+    "    free(t); free(chunks);\n"
+    "    return s;\n"
+    "}\n"
+    "// Lê [+-]dígitos em blocos de 9: x = x * 10^9 + bloco\n"
+    "static mathc_bigint* mathc_big_from_string(const char* s) {\n"
+    "    int sign = 1;\n"
+    "    while (*s == ' ') s++;\n"
+    "    if (*s == '-' || *s == '+') { if (*s == '-') sign = -1; s++; }\n"
+    "    size_t n = strspn(s, \"0123456789\");\n"
+    "    if (n == 0) { fprintf(stderr, \"Erro: \\\"%s\\\" não é um inteiro\\n\", s); exit(1); }\n"
+    "    mathc_bigint* x = mathc_big_alloc((int)(n / 9) + 2);\n"
+    "    size_t first = n % 9 ? n % 9 : 9;\n"
+    "    for (size_t i = 0; i < n; ) {\n"
+    "        size_t w = i == 0 ? first : 9;\n"
+    "        unsigned v = 0, m = 1;\n"
+    "        for (size_t k = 0; k < w; k++) { v = v * 10 + (unsigned)(s[i + k] - '0'); m *= 10; }\n"
+    "        x = mathc_big_mul_small_inplace(x, m, v);\n"
+    "        i += w;\n"
+    "    }\n"
+    "    return mathc_big_norm(x, sign);\n"
+    "}\n"
+    "static void mathc_print_bigint(mathc_bigint* a) { char* s = mathc_big_to_string_b(a); mathc_out_str(s); free(s); mathc_big_release(a); }\n"
+    "static void mathc_println_bigint(mathc_bigint* a) { mathc_print_bigint(a); mathc_out_newline(); }\n";
+
+static void codegen_bigint_runtime(CodeGenContext* ctx) {
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    fputs("#define MATHC_KARATSUBA_MIN 32  // limbs do menor fator a partir dos quais o Karatsuba compensa (>= 4)\n", ctx->output);
+    fputs(bigint_runtime, ctx->output);
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+}
+
+static int codegen_is_bigint(TypeSpec* t) {
+    return t && t->base_type == TYPE_BIGINT && !t->type_name;
+}
+
+static int visit_uses_bigint(ASTNode* node, void* data) {
+    int* found = (int*)data;
+    if (node->type == NODE_BIGINT_LITERAL || codegen_is_bigint(node->inferred_type)) *found = 1;
+    if (node->type == NODE_DECLARATION && codegen_is_bigint(node->declaration.var_type)) *found = 1;
+    if (node->type == NODE_FUNCTION_DEF) {
+        if (codegen_is_bigint(node->function_def.return_type)) *found = 1;
+        for (ParamList* p = node->function_def.parameters; p; p = p->next) {
+            if (codegen_is_bigint(p->type)) *found = 1;
+        }
+    }
+    return *found;
+}
+
+static int codegen_program_uses_bigint(ASTNode* program) {
+    int found = 0;
+    ast_walk(program, visit_uses_bigint, &found);
+    return found;
+}
+
+/* Builtins inteiros recalculados em bigint quando o contexto pede */
+static const char* bigint_promoted_builtins[] = { "factorial", "combinations", "permutations", NULL };
+
+static const char* codegen_big_op_name(int op) {
+    switch (op) {
+        case OP_ADD: return "add";
+        case OP_SUB: return "sub";
+        case OP_MUL: return "mul";
+        case OP_DIV: return "div";
+        case OP_FLOOR_DIV: return "floor_div";
+        case OP_MOD: return "mod";
+        default: return NULL;
+    }
+}
+
+static const char* codegen_big_cmp_op(int op) {
+    switch (op) {
+        case OP_EQ: return "==";
+        case OP_NEQ: return "!=";
+        case OP_LT: return "<";
+        case OP_GT: return ">";
+        case OP_LE: return "<=";
+        case OP_GE: return ">=";
+        default: return NULL;
+    }
+}
+
+static int codegen_is_integral(TypeSpec* t) {
+    return t && !t->type_name &&
+           (t->base_type == TYPE_INT || t->base_type == TYPE_BOOL || t->base_type == TYPE_CHAR);
+}
+
+/* Valor bigint com referência própria (consumível); expressões inteiras são promovidas */
+static void codegen_big_value(CodeGenContext* ctx, ASTNode* e) {
+    if (!e) {
+        codegen_emit(ctx, "mathc_big_from_ll(0)");
+        return;
+    }
+    TypeSpec* t = e->inferred_type;
+    if (e->type == NODE_BIGINT_LITERAL) {
+        codegen_emit(ctx, "mathc_big_from_string(\"%s\")", e->bigint_literal.digits);
+        return;
+    }
+    if (codegen_is_bigint(t)) {
+        // Variável: nova referência; qualquer outra expressão bigint já devolve um valor novo
+        if (e->type == NODE_IDENTIFIER) codegen_emit(ctx, "mathc_big_ref(%s)", e->identifier.name);
+        else codegen_expression(ctx, e);
+        return;
+    }
+    if (t && t->base_type == TYPE_STRING) {
+        codegen_emit(ctx, "mathc_big_from_string(");
+        codegen_expression(ctx, e);
+        codegen_emit(ctx, ")");
+        return;
+    }
+    // int ^ n com expoente variável é float (pow), mas em bigint continua exato
+    int int_pow = e->type == NODE_BINARY_OP && e->binary_op.op == OP_POWER && e->binary_op.left && e->binary_op.right &&
+                  codegen_is_integral(e->binary_op.left->inferred_type) &&
+                  codegen_is_integral(e->binary_op.right->inferred_type);
+    if ((codegen_is_integral(t) || int_pow) && e->type == NODE_BINARY_OP) {
+        const char* fn = codegen_big_op_name(e->binary_op.op);
+        if (fn || e->binary_op.op == OP_POWER) {
+            codegen_emit(ctx, "mathc_big_%s(", fn ? fn : "pow");
+            codegen_big_value(ctx, e->binary_op.left);
+            codegen_emit(ctx, ", ");
+            // O expoente continua int
+            if (fn) codegen_big_value(ctx, e->binary_op.right);
+            else codegen_expression(ctx, e->binary_op.right);
+            codegen_emit(ctx, ")");
+            return;
+        }
+    }
+    if (codegen_is_integral(t) && e->type == NODE_UNARY_OP && e->unary_op.op == OP_UNARY_MINUS) {
+        codegen_emit(ctx, "mathc_big_neg(");
+        codegen_big_value(ctx, e->unary_op.operand);
+        codegen_emit(ctx, ")");
+        return;
+    }
+    if (e->type == NODE_CALL && e->call.function && e->call.function->type == NODE_IDENTIFIER &&
+        escape_in_list(bigint_promoted_builtins, e->call.function->identifier.name)) {
+        codegen_emit(ctx, "mathc_big_%s(", e->call.function->identifier.name);
+        for (NodeList* a = e->call.arguments; a; a = a->next) {
+            codegen_expression(ctx, a->node);
+            if (a->next) codegen_emit(ctx, ", ");
+        }
+        codegen_emit(ctx, ")");
+        return;
+    }
+    codegen_emit(ctx, "mathc_big_from_ll((long long)(");
+    codegen_expression(ctx, e);
+    codegen_emit(ctx, "))");
+}
+
+/* Operando de uma conta em ponto flutuante: o bigint é convertido para double */
+static void codegen_big_as_double(CodeGenContext* ctx, ASTNode* e) {
+    if (!codegen_is_bigint(e->inferred_type)) {
+        codegen_expression(ctx, e);
+        return;
+    }
+    codegen_emit(ctx, "mathc_big_to_double(");
+    codegen_big_value(ctx, e);
+    codegen_emit(ctx, ")");
+}
+
+/* Verdade de um operando de && / ||: bigint é verdadeiro quando não é zero */
+static void codegen_big_truth(CodeGenContext* ctx, ASTNode* e) {
+    if (!codegen_is_bigint(e->inferred_type)) {
+        codegen_expression(ctx, e);
+        return;
+    }
+    codegen_emit(ctx, "(mathc_big_cmp(");
+    codegen_big_value(ctx, e);
+    codegen_emit(ctx, ", mathc_big_from_ll(0)) != 0)");
+}
+
+/* a op b com algum operando bigint; devolve 0 se nenhum operando é bigint */
+static int codegen_big_binary(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* left = expr->binary_op.left;
+    ASTNode* right = expr->binary_op.right;
+    if (!left || !right) return 0;
+    if (!codegen_is_bigint(left->inferred_type) && !codegen_is_bigint(right->inferred_type)) return 0;
+
+    int op = expr->binary_op.op;
+    if (op == OP_AND || op == OP_OR) {
+        codegen_emit(ctx, "(");
+        codegen_big_truth(ctx, left);
+        codegen_emit(ctx, op == OP_AND ? " && " : " || ");
+        codegen_big_truth(ctx, right);
+        codegen_emit(ctx, ")");
+        return 1;
+    }
+
+    // Com float ou complex do outro lado a conta é feita em double
+    TypeSpec* lt = left->inferred_type;
+    TypeSpec* rt = right->inferred_type;
+    int real = (lt && (lt->base_type == TYPE_FLOAT || lt->base_type == TYPE_COMPLEX)) ||
+               (rt && (rt->base_type == TYPE_FLOAT || rt->base_type == TYPE_COMPLEX));
+    const char* cmp = codegen_big_cmp_op(op);
+    if (real) {
+        const char* infix = cmp;
+        switch (op) {
+            case OP_ADD: infix = "+"; break;
+            case OP_SUB: infix = "-"; break;
+            case OP_MUL: infix = "*"; break;
+            case OP_DIV: case OP_FLOOR_DIV: infix = "/"; break;
+            default: break;
+        }
+        if (op == OP_POWER || op == OP_MOD) codegen_emit(ctx, op == OP_POWER ? "pow(" : "fmod(");
+        else codegen_emit(ctx, op == OP_FLOOR_DIV ? "floor(" : "(");
+        codegen_big_as_double(ctx, left);
+        if (op == OP_POWER || op == OP_MOD) codegen_emit(ctx, ", ");
+        else codegen_emit(ctx, " %s ", infix ? infix : "/*op?*/");
+        codegen_big_as_double(ctx, right);
+        codegen_emit(ctx, ")");
+        return 1;
+    }
+
+    if (cmp) {
+        codegen_emit(ctx, "(mathc_big_cmp(");
+        codegen_big_value(ctx, left);
+        codegen_emit(ctx, ", ");
+        codegen_big_value(ctx, right);
+        codegen_emit(ctx, ") %s 0)", cmp);
+        return 1;
+    }
+    if (op == OP_POWER) {
+        codegen_emit(ctx, "mathc_big_pow(");
+        codegen_big_value(ctx, left);
+        codegen_emit(ctx, ", ");
+        if (codegen_is_bigint(right->inferred_type)) {
+            codegen_emit(ctx, "(int)mathc_big_to_double(");
+            codegen_big_value(ctx, right);
+            codegen_emit(ctx, ")");
+        } else {
+            codegen_expression(ctx, right);
+        }
+        codegen_emit(ctx, ")");
+        return 1;
+    }
+    const char* fn = codegen_big_op_name(op);
+    if (!fn) return 0;
+    codegen_emit(ctx, "mathc_big_%s(", fn);
+    codegen_big_value(ctx, left);
+    codegen_emit(ctx, ", ");
+    codegen_big_value(ctx, right);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+/* -x, !x, x++ e x-- com x bigint; devolve 0 para outros operandos */
+static int codegen_big_unary(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* x = expr->unary_op.operand;
+    if (!x || !codegen_is_bigint(x->inferred_type)) return 0;
+    switch (expr->unary_op.op) {
+        case OP_UNARY_MINUS:
+            codegen_emit(ctx, "mathc_big_neg(");
+            codegen_big_value(ctx, x);
+            codegen_emit(ctx, ")");
+            return 1;
+        case OP_UNARY_PLUS:
+            codegen_big_value(ctx, x);
+            return 1;
+        case OP_NOT:
+            codegen_emit(ctx, "(mathc_big_cmp(");
+            codegen_big_value(ctx, x);
+            codegen_emit(ctx, ", mathc_big_from_ll(0)) == 0)");
+            return 1;
+        case OP_PRE_INC: case OP_POST_INC:
+        case OP_PRE_DEC: case OP_POST_DEC:
+            if (x->type != NODE_IDENTIFIER) return 0;
+            codegen_emit(ctx, "mathc_big_assign(&%s, mathc_big_%s(mathc_big_ref(%s), mathc_big_from_ll(1)))",
+                         x->identifier.name,
+                         expr->unary_op.op == OP_PRE_INC || expr->unary_op.op == OP_POST_INC ? "add" : "sub",
+                         x->identifier.name);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void codegen_big_declaration(CodeGenContext* ctx, ASTNode* stmt) {
+    const char* name = stmt->declaration.name;
+    codegen_emit(ctx, "mathc_bigint* %s = ", name);
+    if (stmt->declaration.initializer) codegen_big_value(ctx, stmt->declaration.initializer);
+    else codegen_emit(ctx, "mathc_big_from_ll(0)");
+    codegen_emit(ctx, ";\n");
+    // No corpo da função: liberada no fim; num laço: a cada volta (codegen_big_loop_release)
+    if (ctx->loop_top < 0 && ctx->indent_level == 1) codegen_record_alloc_fn(ctx, name, "mathc_big_release");
+    // break, continue e return saindo da volta liberam as já declaradas
+    if (ctx->loop_top >= 0 && ctx->loop_big_count < 64) {
+        for (NodeList* s = ctx->loop_body[ctx->loop_top]; s; s = s->next) {
+            if (s->node == stmt) ctx->loop_bigs[ctx->loop_big_count++] = name;
+        }
+    }
+}
+
+/* x = v e x op= v: o valor anterior de x é liberado depois de lido */
+static void codegen_big_assignment(CodeGenContext* ctx, ASTNode* stmt) {
+    const char* name = stmt->assignment.target->identifier.name;
+    const char* fn = stmt->assignment.op == OP_ASSIGN ? NULL : codegen_big_op_name(stmt->assignment.op);
+    codegen_emit(ctx, "mathc_big_assign(&%s, ", name);
+    if (fn) codegen_emit(ctx, "mathc_big_%s(mathc_big_ref(%s), ", fn, name);
+    codegen_big_value(ctx, stmt->assignment.value);
+    if (fn) codegen_emit(ctx, ")");
+    codegen_emit(ctx, ")");
+}
+
+/* bigint declarados direto no corpo de um laço: liberados ao fim de cada volta */
+static void codegen_big_loop_release(CodeGenContext* ctx, NodeList* body) {
+    for (; body; body = body->next) {
+        ASTNode* s = body->node;
+        if (s && s->type == NODE_DECLARATION && codegen_is_bigint(s->declaration.var_type)) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "mathc_big_release(%s);\n", s->declaration.name);
+        }
+    }
+}
+
+/* break/continue: libera os bigint já declarados nesta volta (a indentação da linha já foi emitida) */
+static void codegen_big_loop_exit(CodeGenContext* ctx) {
+    for (int i = ctx->loop_big_count - 1; i >= ctx->loop_big_base[ctx->loop_top]; i--) {
+        codegen_emit(ctx, "mathc_big_release(%s);\n", ctx->loop_bigs[i]);
+        codegen_emit_indent(ctx);
+    }
+}
+
+static int codegen_big_has_locals(CodeGenContext* ctx) {
+    if (ctx->loop_big_count > 0) return 1;
+    for (int i = 0; i < ctx->alloc_count; i++) {
+        if (ctx->alloc_names[i] && ctx->alloc_free_fns[i] && strcmp(ctx->alloc_free_fns[i], "mathc_big_release") == 0) return 1;
+    }
+    return 0;
+}
+
+/* return numa função com bigint: o valor é calculado antes de liberar as variáveis */
+static void codegen_big_return(CodeGenContext* ctx, ASTNode* value) {
+    TypeSpec* rt = ctx->current_function ? ctx->current_function->function_def.return_type : NULL;
+    codegen_emit(ctx, "{\n");
+    ctx->indent_level++;
+    if (value) {
+        codegen_emit_indent(ctx);
+        if (codegen_is_bigint(rt)) {
+            codegen_emit(ctx, "mathc_bigint* _ret = ");
+            codegen_big_value(ctx, value);
+        } else {
+            codegen_emit(ctx, "%s%s _ret = ", codegen_type_to_c(rt), rt && rt->base_type == TYPE_CUSTOM ? "*" : "");
+            codegen_mod_coerce(ctx, value, rt);
+        }
+        codegen_emit(ctx, ";\n");
+    }
+    for (int i = 0; i < ctx->alloc_count; i++) {
+        if (ctx->alloc_names[i] && ctx->alloc_free_fns[i] && strcmp(ctx->alloc_free_fns[i], "mathc_big_release") == 0) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "mathc_big_release(%s);\n", ctx->alloc_names[i]);
+        }
+    }
+    for (int i = ctx->loop_big_count - 1; i >= 0; i--) {
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "mathc_big_release(%s);\n", ctx->loop_bigs[i]);
+    }
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, value ? "return _ret;\n" : "return;\n");
+    ctx->indent_level--;
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "}\n");
+}
+
+/* ========================================================================== */
+/* INTEIROS MÓDULO P (mod[p]) */
+/* ========================================================================== */
+/*
+ * mod[p] guarda o representante em [0, p) num unsigned. Como p é conhecido
+ * na compilação, o runtime é instanciado uma vez por módulo usado no
+ * programa (mathc_mod<p>_mul, ...) com p literal: o gcc troca o % de
+ * (a * b) % p por uma redução de Barrett (produto pelo inverso de p em
+ * ponto fixo, deslocamento e uma correção), sem instrução de divisão. Na
+ * medição (bench/mod_bench.c) isso empata com Montgomery, que ainda pagaria
+ * as conversões de entrada e saída. Soma e subtração são uma comparação e um
+ * ajuste.
+ * Literais inteiros são reduzidos na compilação; as demais expressões int
+ * entram por mathc_mod<p>_from.
+ *
+ * sum(v) acumula em 64 bits (2^31 parcelas menores que 2^31 não transbordam)
+ * e reduz uma única vez, num laço que o gcc vetoriza; prod(v) reparte o
+ * produto em 8 acumuladores independentes para não esperar a latência de
+ * cada redução. a ^ e é exponenciação por quadrados com e int (negativo usa
+ * o inverso) e a / b multiplica pelo inverso (Euclides estendido).
+ */
+
+static const char* mod_template =
+    "static inline unsigned mathc_mod$P_from(long long v) { long long r = v % $PLL; return (unsigned)(r < 0 ? r + $PLL : r); }\n"
+    "static inline unsigned mathc_mod$P_add(unsigned a, unsigned b) { unsigned s = a + b; return s >= $Pu ? s - $Pu : s; }\n"
+    "static inline unsigned mathc_mod$P_sub(unsigned a, unsigned b) { return a >= b ? a - b : a + ($Pu - b); }\n"
+    "static inline unsigned mathc_mod$P_neg(unsigned a) { return a ? $Pu - a : 0u; }\n"
+    "static inline unsigned mathc_mod$P_mul(unsigned a, unsigned b) { return (unsigned)((unsigned long long)a * b % $Pu); }\n"
+    "static unsigned mathc_mod$P_inv(unsigned a) {\n"
+    "    long long r0 = $PLL, r1 = a, t0 = 0, t1 = 1;\n"
+    "    while (r1) { long long q = r0 / r1, t; t = r0 - q * r1; r0 = r1; r1 = t; t = t0 - q * t1; t0 = t1; t1 = t; }\n"
+    "    if (r0 != 1) { fprintf(stderr, \"Erro: %u não é invertível módulo $P\\n\", a); exit(1); }\n"
+    "    return mathc_mod$P_from(t0);\n"
+    "}\n"
+    "static inline unsigned mathc_mod$P_div(unsigned a, unsigned b) { return mathc_mod$P_mul(a, mathc_mod$P_inv(b)); }\n"
+    "static unsigned mathc_mod$P_pow(unsigned b, long long e) {\n"
+    "    if (e < 0) { b = mathc_mod$P_inv(b); e = -e; }\n"
+    "    unsigned long long r = 1 % $Pu, x = b;\n"
+    "    while (e) { if (e & 1) r = r * x % $Pu; x = x * x % $Pu; e >>= 1; }\n"
+    "    return (unsigned)r;\n"
+    "}\n"
+    "static unsigned mathc_mod$P_sum(unsigned const* a, int n) {\n"
+    "    unsigned long long s = 0;\n"
+    "    for (int i = 0; i < n; i++) s += a[i];\n"
+    "    return (unsigned)(s % $Pu);\n"
+    "}\n"
+    "static unsigned mathc_mod$P_prod(unsigned const* a, int n) {\n"
+    "    unsigned long long acc[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };\n"
+    "    int i = 0;\n"
+    "    for (; i + 8 <= n; i += 8)\n"
+    "        for (int k = 0; k < 8; k++) acc[k] = acc[k] * a[i + k] % $Pu;\n"
+    "    for (; i < n; i++) acc[0] = acc[0] * a[i] % $Pu;\n"
+    "    for (int k = 1; k < 8; k++) acc[0] = acc[0] * acc[k] % $Pu;\n"
+    "    return (unsigned)(acc[0] % $Pu);\n"
+    "}\n"
+    "static void mathc_print_array_mod$P(unsigned const* a, int n) {\n"
+    "    mathc_out_char('[');\n"
+    "    for (int i = 0; i < n; i++) {\n"
+    "        if (i > 0) mathc_out_write(\", \", 2);\n"
+    "        mathc_out_ll(a[i]);\n"
+    "    }\n"
+    "    mathc_out_char(']');\n"
+    "}\n"
+    "static void mathc_println_array_mod$P(unsigned const* a, int n) { mathc_print_array_mod$P(a, n); mathc_out_newline(); }\n";
+
+static int codegen_is_mod(TypeSpec* t) {
+    return t && t->base_type == TYPE_MOD && !t->type_name && t->modulus > 0;
+}
+
+/* Módulos distintos usados no programa (uma instância do runtime por módulo) */
+typedef struct ModUses {
+    int* moduli;
+    int count;
+} ModUses;
+
+static void mod_uses_add(ModUses* u, TypeSpec* t) {
+    if (t && t->base_type == TYPE_ARRAY) t = t->element_type;
+    if (!codegen_is_mod(t)) return;
+    for (int i = 0; i < u->count; i++) {
+        if (u->moduli[i] == t->modulus) return;
+    }
+    u->moduli = realloc(u->moduli, sizeof(int) * (size_t)(u->count + 1));
+    u->moduli[u->count++] = t->modulus;
+}
+
+static int visit_uses_mod(ASTNode* node, void* data) {
+    ModUses* u = (ModUses*)data;
+    mod_uses_add(u, node->inferred_type);
+    if (node->type == NODE_DECLARATION) mod_uses_add(u, node->declaration.var_type);
+    if (node->type == NODE_FUNCTION_DEF) {
+        mod_uses_add(u, node->function_def.return_type);
+        for (ParamList* p = node->function_def.parameters; p; p = p->next) mod_uses_add(u, p->type);
+    }
+    return 0;
+}
+
+static void codegen_mod_runtime(CodeGenContext* ctx, ASTNode* program) {
+    ModUses u = { NULL, 0 };
+    ast_walk(program, visit_uses_mod, &u);
+    if (u.count == 0) return;
+    fputs("#pragma GCC push_options\n", ctx->output);
+    fputs("#pragma GCC optimize(\"O3\")\n", ctx->output);
+    for (int i = 0; i < u.count; i++) {
+        char digits[16];
+        snprintf(digits, sizeof(digits), "%d", u.moduli[i]);
+        const char* values[] = { digits };
+        codegen_emit_subst(ctx, mod_template, "P", values);
+    }
+    fputs("#pragma GCC pop_options\n\n", ctx->output);
+    free(u.moduli);
+}
+
+/* Literal inteiro (com - opcional): valor conhecido na compilação */
+static int codegen_mod_literal(ASTNode* e, long long* v) {
+    if (!e) return 0;
+    if (e->type == NODE_INT_LITERAL) { *v = e->int_literal.value; return 1; }
+    if (e->type == NODE_BOOL_LITERAL) { *v = e->bool_literal.value; return 1; }
+    if (e->type == NODE_UNARY_OP && e->unary_op.op == OP_UNARY_MINUS && codegen_mod_literal(e->unary_op.operand, v)) {
+        *v = -*v;
+        return 1;
+    }
+    return 0;
+}
+
+/* Valor de e reduzido ao módulo de t */
+static void codegen_mod_value(CodeGenContext* ctx, ASTNode* e, TypeSpec* t) {
+    long long v;
+    if (!e) {
+        codegen_emit(ctx, "0u");
+        return;
+    }
+    if (codegen_mod_literal(e, &v)) {
+        long long r = v % t->modulus;
+        codegen_emit(ctx, "%lldu", r < 0 ? r + t->modulus : r);
+        return;
+    }
+    TypeSpec* et = e->inferred_type;
+    if (codegen_is_mod(et) && et->modulus == t->modulus) {
+        codegen_expression(ctx, e);
+        return;
+    }
+    if (codegen_is_mod(et)) {
+        // Classes de módulos distintos não se convertem; passar por int é explícito
+        codegen_error(ctx, e, "mod[%d] usado onde se espera mod[%d] (atribua a um int antes)", et->modulus, t->modulus);
+        codegen_emit(ctx, "0u");
+        return;
+    }
+    codegen_emit(ctx, "mathc_mod%d_from((long long)(", t->modulus);
+    codegen_expression(ctx, e);
+    codegen_emit(ctx, "))");
+}
+
+/* Representante de uma expressão mod[p] como int (comparações com sinal); as demais passam direto */
+static void codegen_mod_plain(CodeGenContext* ctx, ASTNode* e) {
+    if (!e || !codegen_is_mod(e->inferred_type)) {
+        codegen_expression(ctx, e);
+        return;
+    }
+    codegen_emit(ctx, "(int)(");
+    codegen_expression(ctx, e);
+    codegen_emit(ctx, ")");
+}
+
+/* Valor de e num destino do tipo target (declaração, atribuição, argumento, retorno) */
+static void codegen_mod_coerce(CodeGenContext* ctx, ASTNode* e, TypeSpec* target) {
+    if (codegen_is_mod(target)) codegen_mod_value(ctx, e, target);
+    else codegen_mod_plain(ctx, e);
+}
+
+/* a op b com algum operando mod[p]; devolve 0 se nenhum operando é mod */
+static int codegen_mod_binary(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* left = expr->binary_op.left;
+    ASTNode* right = expr->binary_op.right;
+    if (!left || !right) return 0;
+    TypeSpec* t = codegen_is_mod(left->inferred_type) ? left->inferred_type :
+                  codegen_is_mod(right->inferred_type) ? right->inferred_type : NULL;
+    if (!t) return 0;
+
+    int op = expr->binary_op.op;
+    const char* fn = NULL;
+    if (op != OP_POWER && codegen_is_mod(left->inferred_type) && codegen_is_mod(right->inferred_type) &&
+        left->inferred_type->modulus != right->inferred_type->modulus) {
+        codegen_error(ctx, expr, "operandos mod[%d] e mod[%d] têm módulos diferentes",
+                      left->inferred_type->modulus, right->inferred_type->modulus);
+        codegen_emit(ctx, "0u");
+        return 1;
+    }
+    switch (op) {
+        case OP_ADD: fn = "add"; break;
+        case OP_SUB: fn = "sub"; break;
+        case OP_MUL: fn = "mul"; break;
+        case OP_DIV: fn = "div"; break;
+        case OP_POWER:
+            // O expoente é inteiro: um expoente mod[q] usa o representante
+            codegen_emit(ctx, "mathc_mod%d_pow(", t->modulus);
+            codegen_mod_value(ctx, left, t);
+            codegen_emit(ctx, ", (long long)(");
+            codegen_mod_plain(ctx, right);
+            codegen_emit(ctx, "))");
+            return 1;
+        case OP_EQ: case OP_NEQ:
+            // Congruência: os dois lados são reduzidos ao mesmo módulo
+            codegen_emit(ctx, "(");
+            codegen_mod_value(ctx, left, t);
+            codegen_emit(ctx, op == OP_EQ ? " == " : " != ");
+            codegen_mod_value(ctx, right, t);
+            codegen_emit(ctx, ")");
+            return 1;
+        case OP_LT: case OP_GT: case OP_LE: case OP_GE:
+            codegen_emit(ctx, "(");
+            codegen_mod_plain(ctx, left);
+            codegen_emit(ctx, " %s ", op == OP_LT ? "<" : op == OP_GT ? ">" : op == OP_LE ? "<=" : ">=");
+            codegen_mod_plain(ctx, right);
+            codegen_emit(ctx, ")");
+            return 1;
+        case OP_AND: case OP_OR:
+            codegen_emit(ctx, "(");
+            codegen_expression(ctx, left);
+            codegen_emit(ctx, op == OP_AND ? " && " : " || ");
+            codegen_expression(ctx, right);
+            codegen_emit(ctx, ")");
+            return 1;
+        default:
+            codegen_error(ctx, expr, "operador sem sentido em mod[%d]", t->modulus);
+            codegen_emit(ctx, "0u");
+            return 1;
+    }
+    codegen_emit(ctx, "mathc_mod%d_%s(", t->modulus, fn);
+    codegen_mod_value(ctx, left, t);
+    codegen_emit(ctx, ", ");
+    codegen_mod_value(ctx, right, t);
+    codegen_emit(ctx, ")");
+    return 1;
+}
+
+/* -x, +x, x++ e x-- com x mod[p]; devolve 0 para outros operandos */
+static int codegen_mod_unary(CodeGenContext* ctx, ASTNode* expr) {
+    ASTNode* x = expr->unary_op.operand;
+    if (!x || !codegen_is_mod(x->inferred_type)) return 0;
+    int p = x->inferred_type->modulus;
+    switch (expr->unary_op.op) {
+        case OP_UNARY_MINUS:
+            codegen_emit(ctx, "mathc_mod%d_neg(", p);
+            codegen_expression(ctx, x);
+            codegen_emit(ctx, ")");
+            return 1;
+        case OP_UNARY_PLUS:
+            codegen_expression(ctx, x);
+            return 1;
+        case OP_PRE_INC: case OP_POST_INC:
+        case OP_PRE_DEC: case OP_POST_DEC:
+            codegen_emit(ctx, "(");
+            codegen_expression(ctx, x);
+            codegen_emit(ctx, " = mathc_mod%d_%s(", p,
+                         expr->unary_op.op == OP_PRE_INC || expr->unary_op.op == OP_POST_INC ? "add" : "sub");
+            codegen_expression(ctx, x);
+            codegen_emit(ctx, ", 1u))");
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* x = v e x op= v com x mod[p] (variável ou elemento de array) */
+static void codegen_mod_assignment(CodeGenContext* ctx, ASTNode* stmt) {
+    ASTNode* target = stmt->assignment.target;
+    codegen_expression(ctx, target);
+    codegen_emit(ctx, " = ");
+    if (stmt->assignment.op == OP_ASSIGN) {
+        codegen_mod_value(ctx, stmt->assignment.value, target->inferred_type);
+        return;
+    }
+    ASTNode op;
+    memset(&op, 0, sizeof(op));
+    op.type = NODE_BINARY_OP;
+    op.binary_op.op = stmt->assignment.op;
+    op.binary_op.left = target;
+    op.binary_op.right = stmt->assignment.value;
+    op.inferred_type = target->inferred_type;
+    codegen_mod_binary(ctx, &op);
+}
+
+/* sum/prod de mod[p][]; as demais estatísticas não se aplicam */
+static void codegen_mod_stats_call(CodeGenContext* ctx, const char* name, ASTNode* arr) {
+    int p = arr->inferred_type->element_type->modulus;
+    if (strcmp(name, "sum") == 0 || strcmp(name, "prod") == 0) {
+        codegen_emit(ctx, "mathc_mod%d_%s(%s, %s__len)", p, name, arr->identifier.name, arr->identifier.name);
+    } else {
+        codegen_error(ctx, arr, "%s não se aplica a mod[%d]", name, p);
+        codegen_emit(ctx, "0");
+    }
+}
+
+/* ========================================================================== */
+/* RANGE(start, stop, step) */
+/* ========================================================================== */
+/*
+ * Os limites são avaliados uma única vez em locais _lo/_hi. Com passo
+ * constante o laço compara o contador diretamente (i < _hi ou i > _hi);
+ * com passo em tempo de execução o número de iterações _n é calculado
+ * antes do laço e o iterador é derivado do contador: i = _lo + _k * _st.
+ */
+
+typedef struct RangeLoop {
+    int id;
+    int const_step;   // 1 se o passo é uma constante inteira não nula
+    int step;         // valor do passo quando const_step
+} RangeLoop;
+
+static int codegen_const_int(ASTNode* expr, int* value) {
+    if (!expr) return 0;
+    if (expr->type == NODE_INT_LITERAL) {
+        *value = expr->int_literal.value;
+        return 1;
+    }
+    if (expr->type == NODE_UNARY_OP && expr->unary_op.operand &&
+        expr->unary_op.operand->type == NODE_INT_LITERAL) {
+        if (expr->unary_op.op == OP_UNARY_MINUS) { *value = -expr->unary_op.operand->int_literal.value; return 1; }
+        if (expr->unary_op.op == OP_UNARY_PLUS) { *value = expr->unary_op.operand->int_literal.value; return 1; }
+    }
+    return 0;
+}
+
+static int codegen_is_range(ASTNode* iterable) {
+    return iterable->type == NODE_CALL && iterable->call.function &&
+           iterable->call.function->type == NODE_IDENTIFIER &&
+           strcmp(iterable->call.function->identifier.name, "range") == 0;
+}
+
+/* Emite _lo/_hi (e _st/_n quando o passo não é constante) */
+static void codegen_range_bounds(CodeGenContext* ctx, ASTNode* call, RangeLoop* r) {
+    NodeList* args = call->call.arguments;
+    ASTNode* start = NULL;
+    ASTNode* stop = NULL;
+    ASTNode* step = NULL;
+    if (args && !args->next) {
+        stop = args->node;
+    } else if (args) {
+        start = args->node;
+        stop = args->next->node;
+        if (args->next->next) step = args->next->next->node;
+    }
+
+    r->id = codegen_new_temp(ctx);
+    r->step = 1;
+    r->const_step = step ? codegen_const_int(step, &r->step) && r->step != 0 : 1;
+
+    codegen_emit_indent(ctx); codegen_emit(ctx, "int _lo%d = ", r->id);
+    if (start) codegen_expression(ctx, start); else codegen_emit(ctx, "0");
+    codegen_emit(ctx, ";\n");
+    codegen_emit_indent(ctx); codegen_emit(ctx, "int _hi%d = ", r->id);
+    if (stop) codegen_expression(ctx, stop); else codegen_emit(ctx, "0");
+    codegen_emit(ctx, ";\n");
+    if (!r->const_step) {
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _st%d = ", r->id); codegen_expression(ctx, step); codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _n%d = mathc_range_count(_lo%d, _hi%d, _st%d);\n", r->id, r->id, r->id, r->id);
+    }
+}
+
+/* Condição de continuação do contador (sem parênteses externos) */
+static void codegen_range_cond(CodeGenContext* ctx, RangeLoop* r, const char* counter) {
+    if (r->const_step) codegen_emit(ctx, "%s %s _hi%d", counter, r->step > 0 ? "<" : ">", r->id);
+    else codegen_emit(ctx, "%s < _n%d", counter, r->id);
+}
+
+static void codegen_range_step(CodeGenContext* ctx, RangeLoop* r, const char* counter) {
+    if (!r->const_step || r->step == 1) codegen_emit(ctx, "%s++", counter);
+    else if (r->step == -1) codegen_emit(ctx, "%s--", counter);
+    else if (r->step < 0) codegen_emit(ctx, "%s -= %d", counter, -r->step);
+    else codegen_emit(ctx, "%s += %d", counter, r->step);
+}
+
+/* ========================================================================== */
+/* LAÇOS ESTRUTURADOS (--emit=structured) */
+/* ========================================================================== */
+/*
+ * Emite laços contados canônicos, com limites avaliados uma única vez, para
+ * que o vetorizador do gcc reconheça o número de iterações:
+ *
+ *     for (i in range(a, b, 2))  ->  { int _lo0 = a; int _hi0 = b;
+ *                                      for (int i = _lo0; i < _hi0; i += 2) { ... L1:; } }
+ *
+ * break/continue continuam usando a pilha de laços (goto para o rótulo de
+ * fim do laço / rótulo no fim do corpo), então o restante do gerador não muda.
+ */
+
+typedef struct AssignScan {
+    const char* name;
+    int found;
+} AssignScan;
+
+static int visit_assign_scan(ASTNode* node, void* data) {
+    AssignScan* scan = (AssignScan*)data;
+    ASTNode* target = NULL;
+    if (node->type == NODE_ASSIGNMENT) {
+        target = node->assignment.target;
+    } else if (node->type == NODE_UNARY_OP &&
+               (node->unary_op.op == OP_PRE_INC || node->unary_op.op == OP_PRE_DEC ||
+                node->unary_op.op == OP_POST_INC || node->unary_op.op == OP_POST_DEC)) {
+        target = node->unary_op.operand;
+    }
+    if (target && target->type == NODE_IDENTIFIER && strcmp(target->identifier.name, scan->name) == 0) {
+        scan->found = 1;
+    }
+    return scan->found;
+}
+
+/* O corpo escreve na variável? Se sim, o iterador precisa ser uma cópia do contador */
+static int codegen_body_assigns(NodeList* body, const char* name) {
+    AssignScan scan;
+    scan.name = name;
+    scan.found = 0;
+    ast_walk_list(body, visit_assign_scan, &scan);
+    return scan.found;
+}
+
+static void codegen_structured_body(CodeGenContext* ctx, NodeList* body, int continueL) {
+    NodeList* first = body;
+    while (body) {
+        if (body->node) codegen_statement(ctx, body->node);
+        body = body->next;
+    }
+    codegen_big_loop_release(ctx, first);
+    codegen_emit(ctx, "L%d:;\n", continueL);
+}
+
+int codegen_for_structured(CodeGenContext* ctx, ASTNode* for_node) {
+    ASTNode* iterable = for_node->for_stmt.iterable;
+    const char* iterName = for_node->for_stmt.iterator;
+    const char* idxName = for_node->for_stmt.index_var;
+    NodeList* body = for_node->for_stmt.body;
+
+    int isRange = codegen_is_range(iterable);
+    if (!isRange && iterable->type != NODE_IDENTIFIER) return 0;
+
+    int id = codegen_new_temp(ctx);
+    int continueL = codegen_new_label(ctx);
+    int endL = codegen_new_label(ctx);
+    codegen_loop_push(ctx, continueL, endL, continueL, body);
+
+    // A indentação desta linha já foi emitida por codegen_statement
+    codegen_emit(ctx, "{\n"); ctx->indent_level++;
+    if (isRange) {
+        RangeLoop r;
+        char counter[32];
+        codegen_range_bounds(ctx, iterable, &r);
+        int copy = !r.const_step || codegen_body_assigns(body, iterName);
+        if (r.const_step && !copy) snprintf(counter, sizeof(counter), "%s", iterName);
+        else snprintf(counter, sizeof(counter), r.const_step ? "_i%d" : "_k%d", r.id);
+        codegen_emit_indent(ctx);
+        if (r.const_step) codegen_emit(ctx, "for (int %s = _lo%d; ", counter, r.id);
+        else codegen_emit(ctx, "for (int %s = 0; ", counter);
+        codegen_range_cond(ctx, &r, counter);
+        codegen_emit(ctx, "; ");
+        codegen_range_step(ctx, &r, counter);
+        codegen_emit(ctx, ") {\n");
+        ctx->indent_level++;
+        if (copy) {
+            codegen_emit_indent(ctx);
+            if (r.const_step) codegen_emit(ctx, "int %s = %s;\n", iterName, counter);
+            else codegen_emit(ctx, "int %s = _lo%d + %s * _st%d;\n", iterName, r.id, counter, r.id);
+        }
+    } else {
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _len%d = ", id); codegen_iter_count(ctx, iterable); codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx); codegen_emit(ctx, "for (int _i%d = 0; _i%d < _len%d; _i%d++) {\n", id, id, id, id);
+        ctx->indent_level++;
+        codegen_iter_bind(ctx, iterable, iterName, id);
+        if (idxName) { codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _i%d;\n", idxName, id); }
+    }
+    codegen_structured_body(ctx, body, continueL);
+    ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
+    ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
+    codegen_emit(ctx, "L%d:;\n", endL);
+    codegen_loop_pop(ctx);
+    return 1;
+}
+
+void codegen_for(CodeGenContext* ctx, ASTNode* for_node) {
+    if (!for_node || for_node->type != NODE_FOR_STMT) return;
+    if (ctx->emit_structured && codegen_for_structured(ctx, for_node)) return;
+    int startL = codegen_new_label(ctx);
+    int endL = codegen_new_label(ctx);
+
+    ASTNode* iterable = for_node->for_stmt.iterable;
+    const char* iterName = for_node->for_stmt.iterator;
+    const char* idxName = for_node->for_stmt.index_var;
+
+    // Range-based: range(stop), range(start, stop) ou range(start, stop, step)
+    if (codegen_is_range(iterable)) {
+        RangeLoop r;
+        char counter[32];
+        codegen_range_bounds(ctx, iterable, &r);
+        snprintf(counter, sizeof(counter), r.const_step ? "_i%d" : "_k%d", r.id);
+        int continueL = codegen_new_label(ctx);
+        codegen_loop_push(ctx, startL, endL, continueL, for_node->for_stmt.body);
+        codegen_emit_indent(ctx);
+        if (r.const_step) codegen_emit(ctx, "int %s = _lo%d;\n", counter, r.id);
+        else codegen_emit(ctx, "int %s = 0;\n", counter);
+        codegen_emit(ctx, "L%d:\n", startL);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "if (!("); codegen_range_cond(ctx, &r, counter); codegen_emit(ctx, ")) goto L%d;\n", endL);
+        // Bloco por iteração
+        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
+        codegen_emit_indent(ctx);
+        if (r.const_step) codegen_emit(ctx, "int %s = %s;\n", iterName, counter);
+        else codegen_emit(ctx, "int %s = _lo%d + %s * _st%d;\n", iterName, r.id, counter, r.id);
+        // Corpo
+        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
+        codegen_big_loop_release(ctx, for_node->for_stmt.body);
+        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
+        // Continue + incremento
+        codegen_emit(ctx, "L%d:\n", continueL);
+        codegen_emit_indent(ctx); codegen_range_step(ctx, &r, counter); codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
+        codegen_emit(ctx, "L%d:\n", endL);
+        codegen_loop_pop(ctx);
+        return;
+    }
+
+    if (iterable->type == NODE_ARRAY_LITERAL) {
+        int arrId = codegen_new_temp(ctx);
+        int count = 0; NodeList* el = iterable->array_literal.elements; while (el){count++; el=el->next;}
+        if (count == 0) return;
+        // Literal do laço nunca escapa: tabela static const ou array na pilha, sem malloc
+        const char* elem_c_type = codegen_literal_elem_type(iterable->array_literal.elements);
+        if (escape_all_constant(iterable->array_literal.elements)) {
+            codegen_emit_indent(ctx); codegen_emit(ctx, "static const %s _arr%d[%d] = ", elem_c_type, arrId, count);
+            codegen_literal_initializer(ctx, iterable->array_literal.elements); codegen_emit(ctx, ";\n");
+        } else {
+            codegen_emit_indent(ctx); codegen_emit(ctx, "%s _arr%d[%d];\n", elem_c_type, arrId, count);
+            el = iterable->array_literal.elements; int pos=0;
+            while (el){ codegen_emit_indent(ctx); codegen_emit(ctx, "_arr%d[%d] = ", arrId, pos); codegen_expression(ctx, el->node); codegen_emit(ctx, ";\n"); el=el->next; pos++; }
+        }
+        int continueL = codegen_new_label(ctx);
+        codegen_loop_push(ctx, startL, endL, continueL, for_node->for_stmt.body);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _i%d = 0;\n", arrId);
+        codegen_emit(ctx, "L%d:\n", startL);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "if (_i%d >= %d) goto L%d;\n", arrId, count, endL);
+        // Bloco por iteração
+        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
+        codegen_emit_indent(ctx); codegen_emit(ctx, "%s %s = _arr%d[_i%d];\n", elem_c_type, iterName, arrId, arrId);
+        if (idxName) { codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _i%d;\n", idxName, arrId); }
+        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
+        codegen_big_loop_release(ctx, for_node->for_stmt.body);
+        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
+        codegen_emit(ctx, "L%d:\n", continueL);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "_i%d++;\n", arrId);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
+        codegen_emit(ctx, "L%d:\n", endL);
+        codegen_loop_pop(ctx);
+        return;
+    }
+
+    if (iterable->type == NODE_IDENTIFIER) {
+        int arrId = codegen_new_temp(ctx);
+        int continueL = codegen_new_label(ctx);
+        codegen_loop_push(ctx, startL, endL, continueL, for_node->for_stmt.body);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _len%d = ", arrId); codegen_iter_count(ctx, iterable); codegen_emit(ctx, ";\n");
+        codegen_emit_indent(ctx); codegen_emit(ctx, "int _i%d = 0;\n", arrId);
+        codegen_emit(ctx, "L%d:\n", startL);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "if (_i%d >= _len%d) goto L%d;\n", arrId, arrId, endL);
+        // Bloco por iteração
+        codegen_emit_indent(ctx); codegen_emit(ctx, "{\n"); ctx->indent_level++;
+        codegen_iter_bind(ctx, iterable, iterName, arrId);
+        if (idxName) { codegen_emit_indent(ctx); codegen_emit(ctx, "int %s = _i%d;\n", idxName, arrId); }
+        NodeList* body = for_node->for_stmt.body; while (body){ if (body->node) codegen_statement(ctx, body->node); body=body->next; }
+        codegen_big_loop_release(ctx, for_node->for_stmt.body);
+        ctx->indent_level--; codegen_emit_indent(ctx); codegen_emit(ctx, "}\n");
+        codegen_emit(ctx, "L%d:\n", continueL);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "_i%d++;\n", arrId);
+        codegen_emit_indent(ctx); codegen_emit(ctx, "goto L%d;\n", startL);
+        codegen_emit(ctx, "L%d:\n", endL);
+        codegen_loop_pop(ctx);
+        return;
+    }
+
+    // Fallback
+    codegen_emit_indent(ctx); codegen_emit(ctx, "/* iterador nao suportado */\n");
+}
+
+void codegen_struct(CodeGenContext* ctx, ASTNode* type_def) {
+    if (!type_def || type_def->type != NODE_TYPE_DEF) return;
+    fputs("typedef struct ", ctx->output);
+    fputs(type_def->type_def.name, ctx->output);
+    fputs(" {\n", ctx->output);
+    NodeList* m = type_def->type_def.members;
+    while (m) {
+        ASTNode* n = m->node;
+        if (n && n->type == NODE_DECLARATION) {
+            codegen_emit_indent(ctx);
+            fputs(codegen_type_to_c(n->declaration.var_type), ctx->output);
+            fputc(' ', ctx->output);
+            fputs(n->declaration.name, ctx->output);
+            fputs(";\n", ctx->output);
+        }
+        m = m->next;
+    }
+    fputs("} ", ctx->output);
+    fputs(type_def->type_def.name, ctx->output);
+    fputs(";\n\n", ctx->output);
+    m = type_def->type_def.members;
+    while (m) {
+        ASTNode* n = m->node;
+        if (n && n->type == NODE_FUNCTION_DEF) {
+            const char* ret_type = n->function_def.return_type ? codegen_type_to_c(n->function_def.return_type) : "void";
+            fputs(ret_type, ctx->output);
+            fputs(" ", ctx->output);
+            fputs(n->function_def.name, ctx->output);
+            fputs("(", ctx->output);
+
+            fputs(type_def->type_def.name, ctx->output);
+            fputs(" this", ctx->output);
+
+            ParamList* p = n->function_def.parameters;
+            while (p) {
+                fputs(", ", ctx->output);
+                fputs(codegen_type_to_c(p->type), ctx->output);
+                fputc(' ', ctx->output);
+                fputs(p->name, ctx->output);
+                p = p->next;
+            }
+            fputs(") {\n", ctx->output);
+
+            ctx->indent_level++;
+            NodeList* b = n->function_def.body;
+            while (b) {
+                if (b->node) codegen_statement(ctx, b->node);
+                b = b->next;
+            }
+            ctx->indent_level--;
+
+            fputs("}\n\n", ctx->output);
+        }
+        m = m->next;
+    }
+}
+
+/* ========================================================================== */
+/* ELIMINAÇÃO DE CHAMADAS DE CAUDA */
+/* ========================================================================== */
+/*
+ * `return f(a, b)` dentro da própria f vira reatribuição dos parâmetros e um
+ * goto para o rótulo de entrada da função. Recursões lineares em funções int
+ * da forma `return e + f(...)` / `return e * f(...)` ganham um acumulador:
+ *
+ *     def fun int fat(int n)          int fat(int n) {
+ *         if (n <= 1)                     int _tail_acc = 1;
+ *             return 1                L0:
+ *         return n * fat(n - 1)           if (n <= 1) return _tail_acc * (1);
+ *                                         _tail_acc = _tail_acc * (n);
+ *                                         n = n - 1; goto L0;
+ */
+
+#define TAIL_MAX_PARAMS 64
+
+typedef struct TailScan {
+    ASTNode* func;
+    int nparams;
+    int tail_calls;
+    int acc_op;
+    int unsafe;
+} TailScan;
+
+static int tail_count_params(ASTNode* func) {
+    int n = 0;
+    for (ParamList* p = func->function_def.parameters; p; p = p->next) n++;
+    return n;
+}
+
+static int tail_is_self_call(ASTNode* func, int nparams, ASTNode* expr) {
+    if (!expr || expr->type != NODE_CALL || !expr->call.function ||
+        expr->call.function->type != NODE_IDENTIFIER) return 0;
+    if (strcmp(expr->call.function->identifier.name, func->function_def.name) != 0) return 0;
+    int nargs = 0;
+    for (NodeList* a = expr->call.arguments; a; a = a->next) nargs++;
+    return nargs == nparams;
+}
+
+typedef struct TailSelfRef {
+    const char* name;
+    int found;
+} TailSelfRef;
+
+static int visit_tail_self_ref(ASTNode* node, void* data) {
+    TailSelfRef* ref = (TailSelfRef*)data;
+    if (node->type == NODE_CALL && node->call.function &&
+        node->call.function->type == NODE_IDENTIFIER &&
+        strcmp(node->call.function->identifier.name, ref->name) == 0) {
+        ref->found = 1;
+    }
+    return ref->found;
+}
+
+static int tail_mentions_self(ASTNode* func, ASTNode* expr) {
+    TailSelfRef ref;
+    ref.name = func->function_def.name;
+    ref.found = 0;
+    ast_walk(expr, visit_tail_self_ref, &ref);
+    return ref.found;
+}
+
+/* Decompõe `e op f(...)` ou `f(...) op e`: retorna a chamada e guarda `e` em *other */
+static ASTNode* tail_acc_split(ASTNode* func, int nparams, ASTNode* expr, int op, ASTNode** other) {
+    if (!expr || expr->type != NODE_BINARY_OP || (int)expr->binary_op.op != op) return NULL;
+    ASTNode* left = expr->binary_op.left;
+    ASTNode* right = expr->binary_op.right;
+    if (tail_is_self_call(func, nparams, right) && !tail_mentions_self(func, left)) {
+        *other = left;
+        return right;
+    }
+    if (tail_is_self_call(func, nparams, left) && !tail_mentions_self(func, right)) {
+        *other = right;
+        return left;
+    }
+    return NULL;
+}
+
+static int visit_tail_scan(ASTNode* node, void* data) {
+    TailScan* ts = (TailScan*)data;
+    ASTNode* other = NULL;
+    switch (node->type) {
+        case NODE_RETURN_STMT: {
+            ASTNode* value = node->return_stmt.value;
+            TypeSpec* rt = ts->func->function_def.return_type;
+            if (tail_is_self_call(ts->func, ts->nparams, value)) {
+                ts->tail_calls++;
+            } else if (ts->acc_op >= 0) {
+                if (tail_acc_split(ts->func, ts->nparams, value, ts->acc_op, &other)) ts->tail_calls++;
+            } else if (rt && rt->base_type == TYPE_INT && !rt->type_name) {
+                if (tail_acc_split(ts->func, ts->nparams, value, OP_ADD, &other)) {
+                    ts->acc_op = OP_ADD;
+                    ts->tail_calls++;
+                } else if (tail_acc_split(ts->func, ts->nparams, value, OP_MUL, &other)) {
+                    ts->acc_op = OP_MUL;
+                    ts->tail_calls++;
+                }
+            }
+            break;
+        }
+        case NODE_DECLARATION: {
+            // Alocações no corpo seriam refeitas a cada volta sem o free correspondente
+            TypeSpec* t = node->declaration.var_type;
+            if (t && ((t->base_type == TYPE_CUSTOM && !node->declaration.initializer) ||
+                      t->base_type == TYPE_ARRAY || t->base_type == TYPE_SET ||
+                      t->base_type == TYPE_MATRIX || t->base_type == TYPE_BIGINT)) {
+                ts->unsafe = 1;
+            }
+            break;
+        }
+        case NODE_ARRAY_LITERAL:
+        case NODE_SET_LITERAL:
+        case NODE_MATRIX_LITERAL:
+        case NODE_TRY_STMT:
+            ts->unsafe = 1;
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+/* Decide se a função corrente usa o rótulo de entrada (e o acumulador) */
+static void codegen_tail_setup(CodeGenContext* ctx, ASTNode* func, int is_main) {
+    ctx->current_function = func;
+    ctx->tail_label = -1;
+    ctx->tail_acc_op = -1;
+    if (is_main || !func->function_def.name) return;
+
+    TailScan ts;
+    ts.func = func;
+    ts.nparams = tail_count_params(func);
+    ts.tail_calls = 0;
+    ts.acc_op = -1;
+    ts.unsafe = ts.nparams > TAIL_MAX_PARAMS;
+    for (ParamList* p = func->function_def.parameters; p; p = p->next) {
+        if (p->type && (p->type->base_type == TYPE_ARRAY || p->type->base_type == TYPE_SET ||
+                        p->type->base_type == TYPE_MATRIX || p->type->base_type == TYPE_GRAPH ||
+                        p->type->base_type == TYPE_BIGINT || p->type->base_type == TYPE_MOD)) {
+            ts.unsafe = 1;
+        }
+    }
+    // O acumulador _tail_acc é int: mod[p] segue pela recursão comum
+    if (codegen_is_mod(func->function_def.return_type)) ts.unsafe = 1;
+    ast_walk_list(func->function_def.body, visit_tail_scan, &ts);
+
+    if (ts.tail_calls > 0 && !ts.unsafe) {
+        ctx->tail_label = codegen_new_label(ctx);
+        ctx->tail_acc_op = ts.acc_op;
+    }
+}
+
+/* Emite a chamada de cauda: argumentos avaliados antes de qualquer parâmetro mudar */
+static void codegen_tail_call(CodeGenContext* ctx, ASTNode* call, ASTNode* other) {
+    ParamList* params = ctx->current_function->function_def.parameters;
+    int temps[TAIL_MAX_PARAMS];
+    int n = 0;
+
+    codegen_emit(ctx, "{\n");
+    ctx->indent_level++;
 
-            fputs("}\n\n", ctx->output);
+    if (other) {
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "_tail_acc = _tail_acc %s (", ctx->tail_acc_op == OP_MUL ? "*" : "+");
+        codegen_expression(ctx, other);
+        codegen_emit(ctx, ");\n");
+    }
+
+    ParamList* p = params;
+    NodeList* a = call->call.arguments;
+    while (p && a) {
+        temps[n] = -1;
+        // f(n, x - 1): parâmetro repassado sem alteração não precisa de temporário
+        if (!(a->node->type == NODE_IDENTIFIER && strcmp(a->node->identifier.name, p->name) == 0)) {
+            temps[n] = codegen_new_temp(ctx);
+            codegen_emit_indent(ctx);
+            if (p->type && p->type->base_type == TYPE_CUSTOM) {
+                codegen_emit(ctx, "%s* _tmp%d = ", codegen_type_to_c(p->type), temps[n]);
+            } else {
+                codegen_emit(ctx, "%s _tmp%d = ", codegen_type_to_c(p->type), temps[n]);
+            }
+            codegen_expression(ctx, a->node);
+            codegen_emit(ctx, ";\n");
         }
-        m = m->next;
+        n++;
+        p = p->next;
+        a = a->next;
+    }
+
+    p = params;
+    for (int i = 0; i < n; i++, p = p->next) {
+        if (temps[i] < 0) continue;
+        codegen_emit_indent(ctx);
+        codegen_emit(ctx, "%s = _tmp%d;\n", p->name, temps[i]);
     }
+
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "goto L%d;\n", ctx->tail_label);
+    ctx->indent_level--;
+    codegen_emit_indent(ctx);
+    codegen_emit(ctx, "}\n");
 }
 
 void codegen_function(CodeGenContext* ctx, ASTNode* func) {
@@ -585,7 +6131,11 @@ void codegen_function(CodeGenContext* ctx, ASTNode* func) {
     while (params) {
         const char* pname = params->name ? params->name : "arg";
 
-        if (params->type && params->type->base_type == TYPE_ARRAY) {
+        if (codegen_is_matrix_type(params->type)) {
+            if (!first) codegen_emit(ctx, ", ");
+            codegen_emit(ctx, "%s %s", codegen_matrix_ptr_type(params->type), pname);
+            first = 0;
+        } else if (params->type && params->type->base_type == TYPE_ARRAY) {
             const char* elem_type = params->type->element_type ?
                 codegen_type_to_c(params->type->element_type) : "int";
 
@@ -613,6 +6163,25 @@ void codegen_function(CodeGenContext* ctx, ASTNode* func) {
     fflush(ctx->output);
     ctx->indent_level++;
 
+    // Arrays recebidos são emprestados: capacidade 0 faz o primeiro add copiar o buffer
+    for (ParamList* p = func->function_def.parameters; p; p = p->next) {
+        if (p->type && p->type->base_type == TYPE_ARRAY && !codegen_is_matrix_type(p->type) && p->name) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "int %s__cap = 0;\n", p->name);
+        }
+        // bigint recebido já vem com uma referência própria
+        if (codegen_is_bigint(p->type) && p->name) codegen_record_alloc_fn(ctx, p->name, "mathc_big_release");
+    }
+
+    codegen_tail_setup(ctx, func, is_main);
+    if (ctx->tail_label >= 0) {
+        if (ctx->tail_acc_op >= 0) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "int _tail_acc = %d;\n", ctx->tail_acc_op == OP_MUL ? 1 : 0);
+        }
+        codegen_emit(ctx, "L%d:;\n", ctx->tail_label);
+    }
+
     NodeList* body = func->function_def.body;
     while (body) {
         DBG("stmt node type=%d", body->node ? body->node->type : -1);
@@ -622,6 +6191,14 @@ void codegen_function(CodeGenContext* ctx, ASTNode* func) {
         body = body->next;
     }
 
+    // Cópia própria criada por add em um array recebido
+    for (ParamList* p = func->function_def.parameters; p; p = p->next) {
+        if (p->type && p->type->base_type == TYPE_ARRAY && !codegen_is_matrix_type(p->type) && p->name) {
+            codegen_emit_indent(ctx);
+            codegen_emit(ctx, "if (%s__cap > 0) free(%s);\n", p->name, p->name);
+        }
+    }
+
     ctx->indent_level--;
     codegen_emit(ctx, "\n");
     codegen_emit_frees(ctx);
@@ -633,6 +6210,9 @@ void codegen_function(CodeGenContext* ctx, ASTNode* func) {
     
     codegen_emit(ctx, "}\n\n");
     fflush(ctx->output);
+    ctx->current_function = NULL;
+    ctx->tail_label = -1;
+    ctx->tail_acc_op = -1;
 }
 
 void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
@@ -644,199 +6224,129 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
         case NODE_DECLARATION: {
             TypeSpec* var_type = stmt->declaration.var_type;
             const char* type_str = codegen_type_to_c(var_type);
+            codegen_input_context(stmt->declaration.initializer, var_type);
 
 
-            // Primeiro trata arrays multidimensionais
-            if (var_type && var_type->base_type == TYPE_ARRAY && var_type->element_type &&
-                var_type->element_type->base_type == TYPE_ARRAY) {
-
-                if (stmt->declaration.initializer && stmt->declaration.initializer->type == NODE_ARRAY_LITERAL &&
-                    stmt->declaration.initializer->array_literal.elements &&
-                    stmt->declaration.initializer->array_literal.elements->node &&
-                    stmt->declaration.initializer->array_literal.elements->node->type == NODE_ARRAY_LITERAL) {
-
-                    TypeSpec* elem_type = var_type->element_type->element_type;
-                    const char* elem_c_type = elem_type ? codegen_type_to_c(elem_type) : "int";
-
-                    int rows = count_literal_elements(stmt->declaration.initializer);
-                    int cols = 0;
-
-                    if (stmt->declaration.initializer->array_literal.elements &&
-                        stmt->declaration.initializer->array_literal.elements->node &&
-                        stmt->declaration.initializer->array_literal.elements->node->type == NODE_ARRAY_LITERAL) {
-                        cols = count_literal_elements(stmt->declaration.initializer->array_literal.elements->node);
-                    }
-
-                    codegen_emit(ctx, "%s** %s = malloc(sizeof(%s*) * %d);\n", elem_c_type, stmt->declaration.name, elem_c_type, rows);
-                    codegen_emit_indent(ctx);
-                    codegen_emit(ctx, "int %s__len = %d;\n", stmt->declaration.name, rows);
-                    codegen_emit_indent(ctx);
-                    codegen_emit(ctx, "for(int i = 0; i < %d; i++) %s[i] = malloc(sizeof(%s) * %d);\n",
-                                rows, stmt->declaration.name, elem_c_type, cols);
-
-                    // Inicializa elementos
-                    NodeList* row_list = stmt->declaration.initializer->array_literal.elements;
-                    int row_idx = 0;
-                    while (row_list) {
-                        if (row_list->node && row_list->node->type == NODE_ARRAY_LITERAL) {
-                            NodeList* col_list = row_list->node->array_literal.elements;
-                            int col_idx = 0;
-                            while (col_list && col_idx < cols) {
-                                codegen_emit_indent(ctx);
-                                codegen_emit(ctx, "%s[%d][%d] = ", stmt->declaration.name, row_idx, col_idx);
-                                codegen_expression(ctx, col_list->node);
-                                codegen_emit(ctx, ";\n");
-                                col_list = col_list->next;
-                                col_idx++;
-                            }
-                        }
-                        row_list = row_list->next;
-                        row_idx++;
-                    }
-                    codegen_record_alloc(ctx, stmt->declaration.name);
-                    return;
-                }
+            // Matrizes e arrays de arrays: bloco contíguo row-major com cabeçalho
+            if (codegen_is_matrix_type(var_type)) {
+                codegen_matrix_declaration(ctx, stmt, var_type);
+                return;
             }
 
             if (var_type && var_type->base_type == TYPE_ARRAY) {
                 TypeSpec* elem_type = var_type->element_type;
                 const char* elem_c_type = elem_type ? codegen_type_to_c(elem_type) : "int";
+                ASTNode *mm_left = NULL, *mm_right = NULL;
 
                 if (stmt->declaration.initializer && stmt->declaration.initializer->type == NODE_ARRAY_LITERAL) {
                     int count = 0; NodeList* el = stmt->declaration.initializer->array_literal.elements;
                     while (el) { count++; el = el->next; }
-                    codegen_emit(ctx, "%s* %s = malloc(sizeof(%s) * %d);\n", elem_c_type, stmt->declaration.name, elem_c_type, count);
+                    // Elementos mod[p] são convertidos para a forma de Montgomery um a um
+                    LiteralStorage storage = codegen_is_mod(elem_type) ? LITERAL_HEAP :
+                        codegen_literal_storage(ctx, stmt->declaration.name,
+                                                stmt->declaration.initializer->array_literal.elements, count);
+                    if (storage != LITERAL_HEAP) {
+                        codegen_local_array(ctx, elem_c_type, stmt->declaration.name,
+                                            stmt->declaration.initializer->array_literal.elements, count, storage);
+                        codegen_emit_indent(ctx);
+                        codegen_emit(ctx, "int %s__len = %d;\n", stmt->declaration.name, count);
+                        return;
+                    }
+                    if (count == 0) {
+                        codegen_emit(ctx, "%s* %s = NULL;\n", elem_c_type, stmt->declaration.name);
+                    } else {
+                        codegen_emit(ctx, "%s* %s = malloc(sizeof(%s) * %d);\n", elem_c_type, stmt->declaration.name, elem_c_type, count);
+                    }
                     codegen_emit_indent(ctx);
                     codegen_emit(ctx, "int %s__len = %d;\n", stmt->declaration.name, count);
+                    codegen_emit_indent(ctx);
+                    codegen_emit(ctx, "int %s__cap = %d;\n", stmt->declaration.name, count);
                     el = stmt->declaration.initializer->array_literal.elements;
                     int idx = 0;
                     while (el) {
                         codegen_emit_indent(ctx);
                         codegen_emit(ctx, "%s[%d] = ", stmt->declaration.name, idx);
-                        codegen_expression(ctx, el->node);
+                        codegen_mod_coerce(ctx, el->node, elem_type);
                         codegen_emit(ctx, ";\n");
                         el = el->next;
                         idx++;
                     }
                     codegen_record_alloc(ctx, stmt->declaration.name);
                     return;
-                } else {
-                    codegen_emit(ctx, "%s* %s", elem_c_type, stmt->declaration.name);
-                    if (stmt->declaration.initializer) {
-                        codegen_emit(ctx, " = ");
-                        codegen_expression(ctx, stmt->declaration.initializer);
-                    }
+                } else if (codegen_is_matmul_expr(stmt->declaration.initializer, &mm_left, &mm_right)) {
+                    // GEMV: A @ v devolve um vetor novo com A->rows elementos
+                    char len_name[300];
+                    snprintf(len_name, sizeof(len_name), "%s__len", stmt->declaration.name);
+                    codegen_emit(ctx, "int %s = 0;\n", len_name);
+                    codegen_emit_indent(ctx);
+                    codegen_emit(ctx, "%s* %s = ", elem_c_type, stmt->declaration.name);
+                    codegen_matmul(ctx, mm_left, mm_right, len_name);
                     codegen_emit(ctx, ";\n");
-                    return;
-                }
-            }
-            
-            if (var_type && var_type->base_type == TYPE_SET) {
-                TypeSpec* elem_type = var_type->element_type;
-                const char* elem_c_type = elem_type ? codegen_type_to_c(elem_type) : "int";
-
-                if (stmt->declaration.initializer && stmt->declaration.initializer->type == NODE_SET_LITERAL) {
-                    int count = 0; NodeList* el = stmt->declaration.initializer->set_literal.elements;
-                    while (el) { count++; el = el->next; }
-                    codegen_emit(ctx, "%s* %s = malloc(sizeof(%s) * %d);\n", elem_c_type, stmt->declaration.name, elem_c_type, count);
                     codegen_emit_indent(ctx);
-                    codegen_emit(ctx, "int %s__len = %d;\n", stmt->declaration.name, count);
-                    el = stmt->declaration.initializer->set_literal.elements;
-                    int idx = 0;
-                    while (el) {
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "%s[%d] = ", stmt->declaration.name, idx);
-                        codegen_expression(ctx, el->node);
-                        codegen_emit(ctx, ";\n");
-                        el = el->next;
-                        idx++;
-                    }
+                    codegen_emit(ctx, "int %s__cap = %s;\n", stmt->declaration.name, len_name);
                     codegen_record_alloc(ctx, stmt->declaration.name);
                     return;
-                } else {
-                    if (stmt->declaration.initializer &&
-                        stmt->declaration.initializer->type == NODE_BINARY_OP &&
-                        (stmt->declaration.initializer->binary_op.op == OP_ADD ||
-                         stmt->declaration.initializer->binary_op.op == OP_SUB)) {
-                        int temp_id = codegen_new_temp(ctx);
-                        codegen_emit(ctx, "set_result_t _tmp%d = ", temp_id);
-                        codegen_expression(ctx, stmt->declaration.initializer);
-                        codegen_emit(ctx, ";\n");
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "%s* %s = _tmp%d.ptr;\n", elem_c_type, stmt->declaration.name, temp_id);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "int %s__len = _tmp%d.len;\n", stmt->declaration.name, temp_id);
-                    } else {
-                        codegen_emit(ctx, "%s* %s", elem_c_type, stmt->declaration.name);
-                        if (stmt->declaration.initializer) {
-                            codegen_emit(ctx, " = ");
-                            codegen_expression(ctx, stmt->declaration.initializer);
-                        }
-                        codegen_emit(ctx, ";\n");
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "int %s__len = 0;\n", stmt->declaration.name);
+                } else if (codegen_call_name(stmt->declaration.initializer) &&
+                           strcmp(codegen_call_name(stmt->declaration.initializer), "load_npy") == 0) {
+                    // Capacidade 0 quando o vetor é o próprio mapeamento do arquivo
+                    const char* name = stmt->declaration.name;
+                    const char* suffix = codegen_input_suffix(elem_type);
+                    NodeList* args = stmt->declaration.initializer->call.arguments;
+                    codegen_emit(ctx, "int %s__len = 0;\n", name);
+                    codegen_emit_indent(ctx);
+                    codegen_emit(ctx, "int %s__cap = 0;\n", name);
+                    codegen_emit_indent(ctx);
+                    if (!suffix || !args) {
+                        codegen_error(ctx, stmt, "load_npy(arquivo) requer int[] ou float[]");
+                        codegen_emit(ctx, "%s* %s = NULL;\n", elem_c_type, name);
+                        return;
                     }
+                    codegen_emit(ctx, "%s* %s = mathc_load_npy_array_%s(", elem_c_type, name, suffix);
+                    codegen_expression(ctx, args->node);
+                    codegen_emit(ctx, ", &%s__len, &%s__cap);\n", name, name);
+                    codegen_record_alloc_fn(ctx, name, "mathc_npy_release");
                     return;
-                }
-            }
-
-            if (var_type && var_type->base_type == TYPE_MATRIX) {
-                TypeSpec* elem_type = var_type->element_type;
-                const char* elem_c_type = elem_type ? codegen_type_to_c(elem_type) : "int";
-
-                if (stmt->declaration.initializer && stmt->declaration.initializer->type == NODE_MATRIX_LITERAL) {
-                    int rows = count_literal_elements(stmt->declaration.initializer);
-                    int cols = 0;
-
-                    // Conta colunas da primeira linha
-                    if (stmt->declaration.initializer->matrix_literal.rows &&
-                        stmt->declaration.initializer->matrix_literal.rows->node &&
-                        stmt->declaration.initializer->matrix_literal.rows->node->type == NODE_ARRAY_LITERAL) {
-                        cols = count_literal_elements(stmt->declaration.initializer->matrix_literal.rows->node);
-                    }
-
-                    codegen_emit(ctx, "%s** %s = malloc(sizeof(%s*) * %d);\n", elem_c_type, stmt->declaration.name, elem_c_type, rows);
+                } else if (codegen_is_array_result_call(stmt->declaration.initializer)) {
+                    char len_name[300];
+                    snprintf(len_name, sizeof(len_name), "%s__len", stmt->declaration.name);
+                    codegen_emit(ctx, "int %s = 0;\n", len_name);
                     codegen_emit_indent(ctx);
-                    codegen_emit(ctx, "int %s__rows = %d;\n", stmt->declaration.name, rows);
+                    codegen_emit(ctx, "%s* %s = ", elem_c_type, stmt->declaration.name);
+                    codegen_array_result_call(ctx, stmt->declaration.initializer, len_name);
+                    codegen_emit(ctx, ";\n");
                     codegen_emit_indent(ctx);
-                    codegen_emit(ctx, "int %s__cols = %d;\n", stmt->declaration.name, cols);
+                    codegen_emit(ctx, "int %s__cap = %s;\n", stmt->declaration.name, len_name);
+                    codegen_record_alloc(ctx, stmt->declaration.name);
+                    return;
+                } else if (!stmt->declaration.initializer) {
+                    // Vetor vazio: o primeiro add aloca
+                    codegen_emit(ctx, "%s* %s = NULL;\n", elem_c_type, stmt->declaration.name);
                     codegen_emit_indent(ctx);
-                    // Loop de alocação por linhas usando labels/goto
-                    {
-                        int Ls = codegen_new_label(ctx);
-                        int Le = codegen_new_label(ctx);
-                        int tid = codegen_new_temp(ctx);
-                        codegen_emit(ctx, "int _i%d = 0;\n", tid);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "L%d:\n", Ls);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "if (!(_i%d < %d)) goto L%d;\n", tid, rows, Le);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "%s[_i%d] = malloc(sizeof(%s) * %d);\n", stmt->declaration.name, tid, elem_c_type, cols);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "_i%d++;\n", tid);
-                        codegen_emit_indent(ctx);
-                        codegen_emit(ctx, "goto L%d;\n", Ls);
-                        codegen_emit(ctx, "L%d:\n", Le);
-                    }
-
-                    codegen_literal_elements(ctx, stmt->declaration.initializer, stmt->declaration.name);
+                    codegen_emit(ctx, "int %s__len = 0;\n", stmt->declaration.name);
+                    codegen_emit_indent(ctx);
+                    codegen_emit(ctx, "int %s__cap = 0;\n", stmt->declaration.name);
                     codegen_record_alloc(ctx, stmt->declaration.name);
                     return;
                 } else {
-                    codegen_emit(ctx, "%s** %s", elem_c_type, stmt->declaration.name);
+                    codegen_emit(ctx, "%s* %s", elem_c_type, stmt->declaration.name);
                     if (stmt->declaration.initializer) {
                         codegen_emit(ctx, " = ");
                         codegen_expression(ctx, stmt->declaration.initializer);
                     }
-                codegen_emit(ctx, ";\n");
-                codegen_emit_indent(ctx);
-                codegen_emit(ctx, "int %s__rows = 0;\n", stmt->declaration.name);
-                codegen_emit_indent(ctx);
-                codegen_emit(ctx, "int %s__cols = 0;\n", stmt->declaration.name);
-                return;
+                    codegen_emit(ctx, ";\n");
+                    return;
                 }
             }
+            
+            if (codegen_is_set_type(var_type)) {
+                codegen_set_declaration(ctx, stmt, var_type);
+                return;
+            }
+
+            if (codegen_is_bigint(var_type)) {
+                codegen_big_declaration(ctx, stmt);
+                return;
+            }
 
             if (var_type && var_type->base_type == TYPE_CUSTOM) {
                 if (stmt->declaration.initializer) {
@@ -851,7 +6361,9 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
                 codegen_emit(ctx, "%s %s", type_str, stmt->declaration.name);
                 if (stmt->declaration.initializer) {
                     codegen_emit(ctx, " = ");
-                    codegen_expression(ctx, stmt->declaration.initializer);
+                    codegen_mod_coerce(ctx, stmt->declaration.initializer, var_type);
+                } else if (codegen_is_mod(var_type)) {
+                    codegen_emit(ctx, " = 0u");
                 }
                 codegen_emit(ctx, ";\n");
             }
@@ -864,10 +6376,23 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
         }
 
         case NODE_ASSIGNMENT: {
-            if (stmt->assignment.op == OP_ASSIGN) {
+            TypeSpec* target_type = stmt->assignment.target->inferred_type;
+            if (codegen_array_result_assignment(ctx, stmt)) break;
+            if (codegen_is_bigint(target_type) && stmt->assignment.target->type == NODE_IDENTIFIER) {
+                codegen_big_assignment(ctx, stmt);
+            } else if (codegen_is_mod(target_type)) {
+                codegen_mod_assignment(ctx, stmt);
+            } else if (stmt->assignment.op == OP_ASSIGN && codegen_is_set_type(target_type)) {
+                codegen_set_literal_context(stmt->assignment.value, target_type);
                 codegen_expression(ctx, stmt->assignment.target);
                 codegen_emit(ctx, " = ");
-                codegen_expression(ctx, stmt->assignment.value);
+                codegen_set_operand(ctx, stmt->assignment.value, codegen_set_kind(target_type));
+            } else if (stmt->assignment.op == OP_ASSIGN) {
+                codegen_matrix_ctor_context(stmt->assignment.value, target_type);
+                codegen_input_context(stmt->assignment.value, target_type);
+                codegen_expression(ctx, stmt->assignment.target);
+                codegen_emit(ctx, " = ");
+                codegen_mod_coerce(ctx, stmt->assignment.value, target_type);
             } else {
                 codegen_expression(ctx, stmt->assignment.target);
                 codegen_emit(ctx, " = ");
@@ -928,9 +6453,25 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
         }
 
         case NODE_WHILE_STMT: {
+            if (ctx->emit_structured) {
+                int continue_label = codegen_new_label(ctx);
+                int end_label = codegen_new_label(ctx);
+                codegen_loop_push(ctx, continue_label, end_label, continue_label, stmt->while_stmt.body);
+                codegen_emit(ctx, "while (");
+                codegen_expression(ctx, stmt->while_stmt.condition);
+                codegen_emit(ctx, ") {\n");
+                ctx->indent_level++;
+                codegen_structured_body(ctx, stmt->while_stmt.body, continue_label);
+                ctx->indent_level--;
+                codegen_emit_indent(ctx);
+                codegen_emit(ctx, "}\n");
+                codegen_emit(ctx, "L%d:;\n", end_label);
+                codegen_loop_pop(ctx);
+                break;
+            }
             int start_label = codegen_new_label(ctx);
             int end_label = codegen_new_label(ctx);
-            codegen_loop_push(ctx, start_label, end_label, start_label);
+            codegen_loop_push(ctx, start_label, end_label, start_label, stmt->while_stmt.body);
 
             codegen_emit(ctx, "L%d:\n", start_label);
             codegen_emit_indent(ctx);
@@ -946,6 +6487,7 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
                 }
                 body = body->next;
             }
+            codegen_big_loop_release(ctx, stmt->while_stmt.body);
             ctx->indent_level--;
 
             codegen_emit_indent(ctx);
@@ -956,9 +6498,34 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
         }
 
         case NODE_RETURN_STMT: {
-            if (stmt->return_stmt.value) {
+            ASTNode* value = stmt->return_stmt.value;
+            if (value && ctx->tail_label >= 0) {
+                ASTNode* func = ctx->current_function;
+                int nparams = tail_count_params(func);
+                ASTNode* other = NULL;
+                ASTNode* call = NULL;
+                if (tail_is_self_call(func, nparams, value)) {
+                    call = value;
+                } else if (ctx->tail_acc_op >= 0) {
+                    call = tail_acc_split(func, nparams, value, ctx->tail_acc_op, &other);
+                }
+                if (call) {
+                    codegen_tail_call(ctx, call, other);
+                    break;
+                }
+            }
+            if (codegen_big_has_locals(ctx) ||
+                (value && ctx->current_function && codegen_is_bigint(ctx->current_function->function_def.return_type))) {
+                codegen_big_return(ctx, value);
+            } else if (value) {
                 codegen_emit(ctx, "return ");
-                codegen_expression(ctx, stmt->return_stmt.value);
+                if (ctx->tail_acc_op >= 0) {
+                    codegen_emit(ctx, "_tail_acc %s (", ctx->tail_acc_op == OP_MUL ? "*" : "+");
+                    codegen_expression(ctx, value);
+                    codegen_emit(ctx, ")");
+                } else {
+                    codegen_mod_coerce(ctx, value, ctx->current_function ? ctx->current_function->function_def.return_type : NULL);
+                }
                 codegen_emit(ctx, ";\n");
             } else {
                 codegen_emit(ctx, "return;\n");
@@ -968,6 +6535,7 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
 
         case NODE_BREAK_STMT: {
             if (ctx->loop_top >= 0) {
+                codegen_big_loop_exit(ctx);
                 codegen_emit(ctx, "goto L%d;\n", ctx->loop_end[ctx->loop_top]);
             } else {
                 codegen_emit(ctx, "/* break fora do loop */\n");
@@ -979,6 +6547,7 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
             if (ctx->loop_top >= 0) {
                 int continue_target = ctx->loop_continue[ctx->loop_top] ?
                     ctx->loop_continue[ctx->loop_top] : ctx->loop_start[ctx->loop_top];
+                codegen_big_loop_exit(ctx);
                 codegen_emit(ctx, "goto L%d;\n", continue_target);
             } else {
                 codegen_emit(ctx, "/* continue fora do loop */\n");
@@ -1044,11 +6613,103 @@ void codegen_statement(CodeGenContext* ctx, ASTNode* stmt) {
         }
 
         default:
-            codegen_emit(ctx, "/* ERRO: comando desconhecido %d */\n", stmt->type);
+            codegen_error(ctx, stmt, "comando desconhecido %d", stmt->type);
             break;
     }
 }
 
+/* Um argumento de print/println: prefix é "mathc_print_" ou "mathc_println_" */
+static void codegen_print_arg(CodeGenContext* ctx, ASTNode* arg, const char* prefix) {
+    TypeSpec* arg_type = arg->inferred_type;
+
+    if (arg_type && codegen_is_matrix_type(arg_type)) {
+        codegen_emit(ctx, "%smatrix_%s(", prefix, codegen_matrix_kind(arg_type)->suffix);
+        codegen_expression(ctx, arg);
+        codegen_emit(ctx, ")");
+    } else if (arg_type) {
+        switch (arg_type->base_type) {
+            case TYPE_INT:
+            case TYPE_BOOL:
+                codegen_emit(ctx, "%sint(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_FLOAT:
+                codegen_emit(ctx, "%sfloat(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_STRING:
+                codegen_emit(ctx, "%sstring(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_COMPLEX:
+                codegen_emit(ctx, "%scomplex(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_CHAR:
+                codegen_emit(ctx, "%schar(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_BIGINT:
+                codegen_emit(ctx, "%sbigint(", prefix);
+                codegen_big_value(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_MOD:
+                codegen_emit(ctx, "%sint(", prefix);
+                codegen_mod_plain(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_ARRAY:
+                if (codegen_is_mod(arg_type->element_type) && arg->type == NODE_IDENTIFIER) {
+                    codegen_emit(ctx, "%sarray_mod%d(%s, %s__len)", prefix, arg_type->element_type->modulus,
+                                 arg->identifier.name, arg->identifier.name);
+                    break;
+                }
+                codegen_emit(ctx, "%sarray_%s(", prefix, codegen_elem_kind(arg_type)->suffix);
+                if (arg->type == NODE_IDENTIFIER) {
+                    codegen_expression(ctx, arg);
+                    codegen_emit(ctx, ", %s__len", arg->identifier.name);
+                } else {
+                    codegen_expression(ctx, arg);
+                    codegen_emit(ctx, ", 0");
+                }
+                codegen_emit(ctx, ")");
+                break;
+            case TYPE_SET:
+                codegen_emit(ctx, "%sset_%s(", prefix, codegen_set_kind(arg_type)->suffix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+            default:
+                codegen_emit(ctx, "%sint(", prefix);
+                codegen_expression(ctx, arg);
+                codegen_emit(ctx, ")");
+                break;
+        }
+    } else {
+        if (arg->type == NODE_INT_LITERAL || arg->type == NODE_BOOL_LITERAL) {
+            codegen_emit(ctx, "%sint(", prefix);
+        } else if (arg->type == NODE_FLOAT_LITERAL) {
+            codegen_emit(ctx, "%sfloat(", prefix);
+        } else if (arg->type == NODE_STRING_LITERAL) {
+            codegen_emit(ctx, "%sstring(", prefix);
+        } else if (arg->type == NODE_COMPLEX_LITERAL) {
+            codegen_emit(ctx, "%scomplex(", prefix);
+        } else if (arg->type == NODE_CHAR_LITERAL) {
+            codegen_emit(ctx, "%schar(", prefix);
+        } else {
+            codegen_emit(ctx, "%sfloat(", prefix);
+        }
+        codegen_expression(ctx, arg);
+        codegen_emit(ctx, ")");
+    }
+}
+
 void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
     if (!expr) return;
 
@@ -1058,9 +6719,13 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
             codegen_emit(ctx, "%d", expr->int_literal.value);
             break;
 
-        case NODE_FLOAT_LITERAL:
-            codegen_emit(ctx, "%g", expr->float_literal.value);
+        case NODE_FLOAT_LITERAL: {
+            // %.17g reproduz o double exato (%g arredondava para 6 dígitos: 1000000001.0 virava 1e+09)
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.17g", expr->float_literal.value);
+            codegen_emit(ctx, "%s%s", buf, strpbrk(buf, ".en") ? "" : ".0");
             break;
+        }
 
         case NODE_STRING_LITERAL:
             codegen_emit(ctx, "\"%s\"", expr->string_literal.value);
@@ -1148,9 +6813,14 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
             break;
 
         case NODE_BINARY_OP: {
+            if (codegen_big_binary(ctx, expr)) break;
+            if (codegen_mod_binary(ctx, expr)) break;
             if (expr->binary_op.op == OP_POWER) {
                 if (expr->inferred_type && expr->inferred_type->base_type == TYPE_COMPLEX) {
                     codegen_emit(ctx, "cpow(");
+                } else if (expr->inferred_type && expr->inferred_type->base_type == TYPE_INT) {
+                    // int ^ int permanece inteiro (exponenciação por quadrados, sem passar por double)
+                    codegen_emit(ctx, "mathc_ipow(");
                 } else {
                     codegen_emit(ctx, "pow(");
                 }
@@ -1169,97 +6839,39 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                 break;
             }
             if (expr->binary_op.op == OP_MATMUL) {
-                codegen_emit(ctx, "(");
-                codegen_expression(ctx, expr->binary_op.left);
-                codegen_emit(ctx, " * ");
-                codegen_expression(ctx, expr->binary_op.right);
-                codegen_emit(ctx, ")");
+                codegen_matmul(ctx, expr->binary_op.left, expr->binary_op.right, NULL);
                 break;
             }
-            ASTNode* left = expr->binary_op.left;
-            ASTNode* right = expr->binary_op.right;
-            bool left_is_set = left->inferred_type && left->inferred_type->base_type == TYPE_SET;
-            bool right_is_set = right->inferred_type && right->inferred_type->base_type == TYPE_SET;
-
-            if (left_is_set || right_is_set) {
-                switch (expr->binary_op.op) {
-                    case OP_ADD:
-                        codegen_emit(ctx, "set_union(");
-                        codegen_expression(ctx, left);
-                        codegen_emit(ctx, ", ");
-                        codegen_expression(ctx, left);
-                        codegen_emit(ctx, "__len, ");
-                        codegen_expression(ctx, right);
-                        codegen_emit(ctx, ", ");
-                        codegen_expression(ctx, right);
-                        codegen_emit(ctx, "__len)");
-                        break;
-                    case OP_SUB:
-                        codegen_emit(ctx, "set_difference(");
-                        codegen_expression(ctx, left);
-                        codegen_emit(ctx, ", ");
-                        codegen_expression(ctx, left);
-                        codegen_emit(ctx, "__len, ");
-                        codegen_expression(ctx, right);
-                        codegen_emit(ctx, ", ");
-                        codegen_expression(ctx, right);
-                        codegen_emit(ctx, "__len)");
-                        break;
-                    case OP_IN:
-                        if (left->type == NODE_IDENTIFIER && left->inferred_type &&
-                            (left->inferred_type->base_type == TYPE_SET || left->inferred_type->base_type == TYPE_ARRAY)) {
-                            codegen_emit(ctx, "set_is_subset(");
-                            codegen_expression(ctx, left);
-                            codegen_emit(ctx, ", ");
-                            codegen_expression(ctx, left);
-                            codegen_emit(ctx, "__len, ");
-                            codegen_expression(ctx, right);
-                            codegen_emit(ctx, ", ");
-                            codegen_expression(ctx, right);
-                            codegen_emit(ctx, "__len)");
-                        } else {
-                            codegen_emit(ctx, "set_contains(");
-                            codegen_expression(ctx, right);
-                            codegen_emit(ctx, ", ");
-                            codegen_expression(ctx, right);
-                            codegen_emit(ctx, "__len, ");
-                            codegen_expression(ctx, left);
-                            codegen_emit(ctx, ")");
-                        }
-                        break;
-                    default:
-                        codegen_emit(ctx, "/* operacao de conjuntos nao suportada */");
-                        break;
-                }
-            } else {
-                codegen_emit(ctx, "(");
-                codegen_expression(ctx, expr->binary_op.left);
-
-                switch (expr->binary_op.op) {
-                    case OP_ADD: codegen_emit(ctx, " + "); break;
-                    case OP_SUB: codegen_emit(ctx, " - "); break;
-                    case OP_MUL: codegen_emit(ctx, " * "); break;
-                    case OP_DIV: codegen_emit(ctx, " / "); break;
-                    case OP_MOD: codegen_emit(ctx, " %% "); break;
-                    case OP_EQ: codegen_emit(ctx, " == "); break;
-                    case OP_NEQ: codegen_emit(ctx, " != "); break;
-                    case OP_LT: codegen_emit(ctx, " < "); break;
-                    case OP_GT: codegen_emit(ctx, " > "); break;
-                    case OP_LE: codegen_emit(ctx, " <= "); break;
-                    case OP_GE: codegen_emit(ctx, " >= "); break;
-                    case OP_AND: codegen_emit(ctx, " && "); break;
-                    case OP_OR: codegen_emit(ctx, " || "); break;
-                    case OP_IN: codegen_emit(ctx, " /*in operator*/ "); break;
-                    default: codegen_emit(ctx, " /*op?*/ "); break;
-                }
-
-                codegen_expression(ctx, expr->binary_op.right);
-                codegen_emit(ctx, ")");
+            if (codegen_set_binary(ctx, expr)) break;
+            codegen_emit(ctx, "(");
+            codegen_expression(ctx, expr->binary_op.left);
+
+            switch (expr->binary_op.op) {
+                case OP_ADD: codegen_emit(ctx, " + "); break;
+                case OP_SUB: codegen_emit(ctx, " - "); break;
+                case OP_MUL: codegen_emit(ctx, " * "); break;
+                case OP_DIV: codegen_emit(ctx, " / "); break;
+                case OP_MOD: codegen_emit(ctx, " %% "); break;
+                case OP_EQ: codegen_emit(ctx, " == "); break;
+                case OP_NEQ: codegen_emit(ctx, " != "); break;
+                case OP_LT: codegen_emit(ctx, " < "); break;
+                case OP_GT: codegen_emit(ctx, " > "); break;
+                case OP_LE: codegen_emit(ctx, " <= "); break;
+                case OP_GE: codegen_emit(ctx, " >= "); break;
+                case OP_AND: codegen_emit(ctx, " && "); break;
+                case OP_OR: codegen_emit(ctx, " || "); break;
+                case OP_IN: codegen_emit(ctx, " /*in operator*/ "); break;
+                default: codegen_emit(ctx, " /*op?*/ "); break;
             }
+
+            codegen_expression(ctx, expr->binary_op.right);
+            codegen_emit(ctx, ")");
             break;
         }
 
         case NODE_UNARY_OP: {
+            if (codegen_big_unary(ctx, expr)) break;
+            if (codegen_mod_unary(ctx, expr)) break;
             switch (expr->unary_op.op) {
                 case OP_UNARY_PLUS:
                     codegen_emit(ctx, "(+");
@@ -1306,14 +6918,42 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
         case NODE_CALL: {
             if (expr->call.function && expr->call.function->type == NODE_IDENTIFIER) {
                 char* func_name = expr->call.function->identifier.name;
+                if (strcmp(func_name, "matmul") == 0) {
+                    NodeList* args = expr->call.arguments;
+                    codegen_matmul(ctx, args ? args->node : NULL, args && args->next ? args->next->node : NULL, NULL);
+                    return;
+                }
+                if (codegen_matrix_op_call(ctx, func_name, expr)) return;
+                if (codegen_set_call(ctx, func_name, expr)) return;
                 if (strcmp(func_name, "len") == 0) {
                     if (expr->call.arguments && expr->call.arguments->node) {
                         ASTNode* arg = expr->call.arguments->node;
+                        if (arg->type == NODE_IDENTIFIER && codegen_is_matrix_type(arg->inferred_type)) {
+                            codegen_emit(ctx, "%s->rows", arg->identifier.name);
+                            return;
+                        }
+                        if (codegen_is_set_type(arg->inferred_type)) {
+                            codegen_emit(ctx, "(");
+                            codegen_expression(ctx, arg);
+                            codegen_emit(ctx, ")->len");
+                            return;
+                        }
                         if (arg->type == NODE_IDENTIFIER) {
                             codegen_emit(ctx, "%s__len", arg->identifier.name);
                             return;
                         }
+                        // Linha m[i] de uma matriz: todas têm m->cols elementos
+                        if (arg->type == NODE_ARRAY_ACCESS && arg->array_access.array->type == NODE_IDENTIFIER &&
+                            codegen_is_matrix_type(arg->array_access.array->inferred_type)) {
+                            codegen_emit(ctx, "%s->cols", arg->array_access.array->identifier.name);
+                            return;
+                        }
                     }
+                    if (expr->call.arguments && codegen_is_array_result_call(expr->call.arguments->node)) {
+                        codegen_expression(ctx, expr->call.arguments->node);  // reporta o vetor sem dono
+                        return;
+                    }
+                    codegen_error(ctx, expr, "len requer um vetor, matriz ou conjunto (vetor por variável)");
                     codegen_emit(ctx, "0");
                     return;
                 }
@@ -1322,7 +6962,7 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                     // Determinar tipo baseado no contexto ou argumento
                     if (expr->inferred_type) {
                         switch (expr->inferred_type->base_type) {
-                            case TYPE_INT: codegen_emit(ctx, "mathc_input_int()"); return;
+                            case TYPE_INT: case TYPE_BOOL: codegen_emit(ctx, "mathc_input_int()"); return;
                             case TYPE_FLOAT: codegen_emit(ctx, "mathc_input_float()"); return;
                             case TYPE_STRING: codegen_emit(ctx, "mathc_input_string()"); return;
                             case TYPE_CHAR: codegen_emit(ctx, "mathc_input_char()"); return;
@@ -1333,6 +6973,47 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                     return;
                 }
 
+                if (strcmp(func_name, "input_matrix") == 0) {
+                    NodeList* args = expr->call.arguments;
+                    TypeSpec* t = expr->inferred_type;
+                    const char* suffix = codegen_is_matrix_type(t) ? codegen_input_suffix(codegen_matrix_elem(t)) : NULL;
+                    if (!args || !args->next || !suffix) {
+                        codegen_error(ctx, expr, "input_matrix(l, c) requer matrix[int] ou matrix[float]");
+                        codegen_emit(ctx, "NULL");
+                        return;
+                    }
+                    codegen_emit(ctx, "mathc_input_matrix_%s(", suffix);
+                    codegen_expression(ctx, args->node);
+                    codegen_emit(ctx, ", ");
+                    codegen_expression(ctx, args->next->node);
+                    codegen_emit(ctx, ")");
+                    return;
+                }
+
+                if (strcmp(func_name, "load_npy") == 0) {
+                    codegen_load_npy_call(ctx, expr);
+                    return;
+                }
+                if (strcmp(func_name, "save_npy") == 0) {
+                    codegen_save_npy_call(ctx, expr);
+                    return;
+                }
+
+                if (strcmp(func_name, "read_matrix") == 0 || strcmp(func_name, "read_csv") == 0) {
+                    NodeList* args = expr->call.arguments;
+                    TypeSpec* t = expr->inferred_type;
+                    const char* suffix = codegen_is_matrix_type(t) ? codegen_input_suffix(codegen_matrix_elem(t)) : NULL;
+                    if (!args || !suffix) {
+                        codegen_error(ctx, expr, "%s(arquivo) requer matrix[int] ou matrix[float]", func_name);
+                        codegen_emit(ctx, "NULL");
+                        return;
+                    }
+                    codegen_emit(ctx, "mathc_read_matrix_%s(", suffix);
+                    codegen_expression(ctx, args->node);
+                    codegen_emit(ctx, ", %d)", strcmp(func_name, "read_csv") == 0);
+                    return;
+                }
+
                 if (strcmp(func_name, "print") == 0 || strcmp(func_name, "println") == 0) {
                     int is_println = (strcmp(func_name, "println") == 0);
                     const char* prefix = is_println ? "mathc_println_" : "mathc_print_";
@@ -1340,123 +7021,50 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                     NodeList* args = expr->call.arguments;
 
                     if (!args) {
-                        if (is_println) codegen_emit(ctx, "printf(\"\\n\")");
+                        if (is_println) codegen_emit(ctx, "mathc_out_newline()");
                         return;
                     }
 
-                    ASTNode* arg = args->node;
-                    TypeSpec* arg_type = arg->inferred_type;
-
-                    if (arg_type) {
-                        switch (arg_type->base_type) {
-                            case TYPE_INT:
-                            case TYPE_BOOL:
-                                codegen_emit(ctx, "%sint(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_FLOAT:
-                                codegen_emit(ctx, "%sfloat(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_STRING:
-                                codegen_emit(ctx, "%sstring(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_COMPLEX:
-                                codegen_emit(ctx, "%scomplex(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_CHAR:
-                                codegen_emit(ctx, "%schar(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_ARRAY:
-                                codegen_emit(ctx, "%sarray(", prefix);
-                                if (arg->type == NODE_IDENTIFIER) {
-                                    codegen_expression(ctx, arg);
-                                    codegen_emit(ctx, ", %s__len", arg->identifier.name);
-                                } else {
-                                    codegen_expression(ctx, arg);
-                                    codegen_emit(ctx, ", 0");
-                                }
-                                codegen_emit(ctx, ")");
-                                break;
-                            case TYPE_SET:
-                                codegen_emit(ctx, "%sset(", prefix);
-                                if (arg->type == NODE_IDENTIFIER) {
-                                    codegen_expression(ctx, arg);
-                                    codegen_emit(ctx, ", %s__len", arg->identifier.name);
-                                } else {
-                                    codegen_expression(ctx, arg);
-                                    codegen_emit(ctx, ", 0");
-                                }
-                                codegen_emit(ctx, ")");
-                                break;
-                            default:
-                                codegen_emit(ctx, "%sint(", prefix);
-                                codegen_expression(ctx, arg);
-                                codegen_emit(ctx, ")");
-                                break;
-                        }
-                    } else {
-                        if (arg->type == NODE_INT_LITERAL || arg->type == NODE_BOOL_LITERAL) {
-                            codegen_emit(ctx, "%sint(", prefix);
-                        } else if (arg->type == NODE_FLOAT_LITERAL) {
-                            codegen_emit(ctx, "%sfloat(", prefix);
-                        } else if (arg->type == NODE_STRING_LITERAL) {
-                            codegen_emit(ctx, "%sstring(", prefix);
-                        } else if (arg->type == NODE_COMPLEX_LITERAL) {
-                            codegen_emit(ctx, "%scomplex(", prefix);
-                        } else if (arg->type == NODE_CHAR_LITERAL) {
-                            codegen_emit(ctx, "%schar(", prefix);
-                        } else {
-                            codegen_emit(ctx, "%sfloat(", prefix);
-                        }
-                        codegen_expression(ctx, arg);
-                        codegen_emit(ctx, ")");
+                    // print(a, b, c): os valores vão para o buffer de saída separados por espaço
+                    int multi = args->next != NULL;
+                    if (multi) codegen_emit(ctx, "(");
+                    for (; args; args = args->next) {
+                        codegen_print_arg(ctx, args->node, args->next ? "mathc_print_" : prefix);
+                        if (args->next) codegen_emit(ctx, ", mathc_out_char(' '), ");
                     }
+                    if (multi) codegen_emit(ctx, ")");
                     return;
-                } else if (strcmp(func_name, "sum") == 0 ||
-                          strcmp(func_name, "mean") == 0 ||
-                          strcmp(func_name, "prod") == 0 ||
-                          strcmp(func_name, "std") == 0 ||
-                          strcmp(func_name, "variance") == 0) {
-                    codegen_emit(ctx, "mathc_%s(", func_name);
-                    NodeList* args = expr->call.arguments;
-                    if (args && args->node && args->node->type == NODE_IDENTIFIER) {
-                        codegen_expression(ctx, args->node);
-                        codegen_emit(ctx, ", %s__len", args->node->identifier.name);
-                    } else {
-                        codegen_emit(ctx, "NULL, 0");
-                    }
-                    codegen_emit(ctx, ")");
+                } else if (escape_in_list(stats_builtins, func_name)) {
+                    codegen_stats_call(ctx, func_name, expr);
                     return;
-                } else if (strcmp(func_name, "sort") == 0 || strcmp(func_name, "reverse") == 0) {
-                    codegen_emit(ctx, "mathc_%s(", func_name);
+                } else if (strcmp(func_name, "sort") == 0) {
+                    codegen_sort_call(ctx, expr);
+                    return;
+                } else if (escape_in_list(array_helper_builtins, func_name)) {
+                    codegen_array_helper_call(ctx, func_name, expr);
+                    return;
+                } else if (escape_in_list(array_result_builtins, func_name)) {
+                    codegen_error(ctx, expr, "%s devolve um vetor novo: use-o em `T[] v = %s(...)` ou `v = %s(...)`",
+                                  func_name, func_name, func_name);
+                    codegen_emit(ctx, "NULL");
+                    return;
+                } else if (strcmp(func_name, "pop") == 0) {
                     NodeList* args = expr->call.arguments;
                     if (args && args->node && args->node->type == NODE_IDENTIFIER) {
-                        codegen_expression(ctx, args->node);
-                        codegen_emit(ctx, ", %s__len", args->node->identifier.name);
+                        codegen_vec_pop(ctx, args->node);
                     } else {
-                        codegen_emit(ctx, "NULL, 0");
+                        codegen_error(ctx, expr, "pop requer um vetor por variável (linha de matriz tem tamanho fixo)");
+                        codegen_emit(ctx, "0");
                     }
-                    codegen_emit(ctx, ")");
                     return;
-                } else if (strcmp(func_name, "pop") == 0) {
-                    codegen_emit(ctx, "mathc_pop(");
+                } else if (strcmp(func_name, "push") == 0 || strcmp(func_name, "append") == 0) {
                     NodeList* args = expr->call.arguments;
-                    if (args && args->node && args->node->type == NODE_IDENTIFIER) {
-                        codegen_expression(ctx, args->node);
-                        codegen_emit(ctx, ", &%s__len", args->node->identifier.name);
+                    if (args && args->node && args->node->type == NODE_IDENTIFIER && args->next) {
+                        codegen_vec_push(ctx, args->node, args->next->node);
                     } else {
-                        codegen_emit(ctx, "NULL, NULL");
+                        codegen_error(ctx, expr, "%s requer um vetor por variável e um valor", func_name);
+                        codegen_emit(ctx, "0");
                     }
-                    codegen_emit(ctx, ")");
                     return;
                 } else if (strcmp(func_name, "sqrt") == 0 ||
                           strcmp(func_name, "sin") == 0 ||
@@ -1521,6 +7129,11 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                           strcmp(func_name, "gcd") == 0 ||
                           strcmp(func_name, "lcm") == 0 ||
                           strcmp(func_name, "isprime") == 0 ||
+                          strcmp(func_name, "next_prime") == 0 ||
+                          strcmp(func_name, "modpow") == 0 ||
+                          strcmp(func_name, "modinv") == 0 ||
+                          strcmp(func_name, "factorial_mod") == 0 ||
+                          strcmp(func_name, "binomial_mod") == 0 ||
                           strcmp(func_name, "combinations") == 0 ||
                           strcmp(func_name, "permutations") == 0) {
                     codegen_emit(ctx, "mathc_%s(", func_name);
@@ -1540,6 +7153,10 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
             codegen_expression(ctx, expr->call.function);
             codegen_emit(ctx, "(");
 
+            // Parâmetros bigint recebem uma referência própria (a função chamada a libera)
+            ASTNode* callee = expr->call.function && expr->call.function->type == NODE_IDENTIFIER ?
+                escape_find_function(ctx->program, expr->call.function->identifier.name) : NULL;
+            ParamList* param = callee ? callee->function_def.parameters : NULL;
             NodeList* args = expr->call.arguments;
             int first = 1;
             while (args) {
@@ -1549,15 +7166,18 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
 
                 // Se o argumento é um array, passar também o tamanho
                 if (arg->type == NODE_IDENTIFIER && arg->inferred_type &&
-                    arg->inferred_type->base_type == TYPE_ARRAY) {
+                    arg->inferred_type->base_type == TYPE_ARRAY && !codegen_is_matrix_type(arg->inferred_type)) {
                     codegen_expression(ctx, arg);
                     codegen_emit(ctx, ", %s__len", arg->identifier.name);
+                } else if (param && codegen_is_bigint(param->type)) {
+                    codegen_big_value(ctx, arg);
                 } else {
-                    codegen_expression(ctx, arg);
+                    codegen_mod_coerce(ctx, arg, param ? param->type : NULL);
                 }
 
                 first = 0;
                 args = args->next;
+                if (param) param = param->next;
             }
             codegen_emit(ctx, ")");
             break;
@@ -1568,6 +7188,7 @@ void codegen_expression(CodeGenContext* ctx, ASTNode* expr) {
                 codegen_emit(ctx, "/* acesso invalido de array */");
                 break;
             }
+            if (codegen_matrix_access(ctx, expr)) break;
             codegen_expression(ctx, expr->array_access.array);
             codegen_emit(ctx, "[");
             codegen_expression(ctx, expr->array_access.index);
@@ -1681,21 +7302,29 @@ void codegen_literal_elements(CodeGenContext* ctx, ASTNode* literal, const char*
 }
 
 void codegen_array_literal(CodeGenContext* ctx, ASTNode* literal) {
-    codegen_emit(ctx, "/* ERRO: array literal usado em expressão */");
+    codegen_error(ctx, literal, "array literal usado em expressão");
+    codegen_emit(ctx, "0");
 }
 
 void codegen_matrix_literal(CodeGenContext* ctx, ASTNode* literal) {
-    codegen_emit(ctx, "/* ERRO: matrix literal usado em expressao */");
+    codegen_error(ctx, literal, "matrix literal usado em expressão");
+    codegen_emit(ctx, "0");
 }
 
 void codegen_set_literal(CodeGenContext* ctx, ASTNode* literal) {
-    codegen_emit(ctx, "/* ERRO: set literal usado em expressao */");
+    if (codegen_is_set_type(literal->inferred_type) && escape_all_constant(literal->set_literal.elements)) {
+        codegen_set_literal_value(ctx, literal->inferred_type, literal->set_literal.elements);
+        return;
+    }
+    codegen_error(ctx, literal, "set literal usado em expressão");
+    codegen_emit(ctx, "0");
 }
 
 void codegen_program(CodeGenContext* ctx, ASTNode* program) {
     if (!program) return;
     DBG("programa iniciado");
     if (!program || program->type != NODE_PROGRAM) { DBG(""); return; }
+    ctx->program = program;
 
     // Detectar imports
     int has_random = 0;
@@ -1729,48 +7358,35 @@ void codegen_program(CodeGenContext* ctx, ASTNode* program) {
     fputs("#ifndef E\n#define E 2.71828182845904523536\n#endif\n\n", ctx->output);
 
     codegen_runtime_helpers(ctx);
-
-    fputs("void mathc_print_int(int x) { printf(\"%d\", x); }\n", ctx->output);
-    fputs("void mathc_print_float(double x) { printf(\"%g\", x); }\n", ctx->output);
-    fputs("void mathc_print_string(char* x) { printf(\"%s\", x); }\n", ctx->output);
-    fputs("void mathc_print_char(char x) { printf(\"%c\", x); }\n", ctx->output);
-    fputs("void mathc_print_complex(double complex x) { printf(\"%g%+gi\", creal(x), cimag(x)); }\n", ctx->output);
-
-    fputs("void mathc_println_int(int x) { printf(\"%d\\n\", x); }\n", ctx->output);
-    fputs("void mathc_println_float(double x) { printf(\"%g\\n\", x); }\n", ctx->output);
-    fputs("void mathc_println_string(char* x) { printf(\"%s\\n\", x); }\n", ctx->output);
-    fputs("void mathc_println_char(char x) { printf(\"%c\\n\", x); }\n", ctx->output);
-    fputs("void mathc_println_complex(double complex x) { printf(\"%g%+gi\\n\", creal(x), cimag(x)); }\n", ctx->output);
-
-    // Funções de input
-    fputs("int mathc_input_int() { int x; scanf(\"%d\", &x); return x; }\n", ctx->output);
-    fputs("double mathc_input_float() { double x; scanf(\"%lf\", &x); return x; }\n", ctx->output);
-    fputs("char* mathc_input_string() { char* s = malloc(256); if(fgets(s, 256, stdin)) { s[strcspn(s, \"\\n\")] = 0; } return s; }\n", ctx->output);
-    fputs("char mathc_input_char() { char c; scanf(\" %c\", &c); return c; }\n", ctx->output);
-
-    fputs("void mathc_print_array(int* arr, int len) {\n", ctx->output);
-    fputs("    printf(\"[\"); int i = 0; goto L_pa_check;\n", ctx->output);
-    fputs("L_pa_body: if (i > 0) printf(\", \" ); printf(\"%d\", arr[i]); i++;\n", ctx->output);
-    fputs("L_pa_check: if (i < len) goto L_pa_body; printf(\"]\");\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("void mathc_println_array(int* arr, int len) {\n", ctx->output);
-    fputs("    printf(\"[\"); int i = 0; goto L_pla_check;\n", ctx->output);
-    fputs("L_pla_body: if (i > 0) printf(\", \" ); printf(\"%d\", arr[i]); i++;\n", ctx->output);
-    fputs("L_pla_check: if (i < len) goto L_pla_body; printf(\"]\\n\");\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("void mathc_print_set(int* set, int len) {\n", ctx->output);
-    fputs("    printf(\"{\"); int i = 0; goto L_ps_check;\n", ctx->output);
-    fputs("L_ps_body: if (i > 0) printf(\", \" ); printf(\"%d\", set[i]); i++;\n", ctx->output);
-    fputs("L_ps_check: if (i < len) goto L_ps_body; printf(\"}\");\n", ctx->output);
-    fputs("}\n", ctx->output);
-
-    fputs("void mathc_println_set(int* set, int len) {\n", ctx->output);
-    fputs("    printf(\"{\"); int i = 0; goto L_pls_check;\n", ctx->output);
-    fputs("L_pls_body: if (i > 0) printf(\", \" ); printf(\"%d\", set[i]); i++;\n", ctx->output);
-    fputs("L_pls_check: if (i < len) goto L_pls_body; printf(\"}\\n\");\n", ctx->output);
-    fputs("}\n\n", ctx->output);
+    codegen_output_runtime(ctx);
+    codegen_matrix_runtime(ctx);
+    int uses_matmul = codegen_program_uses_matmul(program);
+    int uses_sort = codegen_program_uses_builtin(program, sort_builtins);
+    int uses_files = codegen_program_uses_builtin(program, file_builtins);
+    if (uses_matmul || uses_sort || uses_files) codegen_threads_runtime(ctx);
+    if (uses_matmul) codegen_matmul_runtime(ctx);
+    if (codegen_program_uses_builtin(program, matrix_op_builtins)) codegen_matrix_ops_runtime(ctx);
+    if (codegen_program_uses_sets(program)) codegen_set_runtime(ctx);
+    if (codegen_program_uses_builtin(program, array_helper_builtins)) codegen_array_helpers_runtime(ctx);
+    if (codegen_program_uses_builtin(program, stats_builtins)) codegen_stats_runtime(ctx);
+    if (uses_sort) codegen_sort_runtime(ctx);
+    int uses_primes = codegen_program_uses_builtin(program, prime_builtins);
+    if (uses_primes || codegen_program_uses_builtin(program, number_theory_builtins)) codegen_number_theory_runtime(ctx);
+    if (uses_primes) codegen_primes_runtime(ctx);
+    if (codegen_program_uses_bigint(program)) codegen_bigint_runtime(ctx);
+    codegen_mod_runtime(ctx, program);
+
+    codegen_matrix_print_runtime(ctx);
+
+    int uses_input = codegen_program_uses_builtin(program, input_builtins);
+    if (uses_input || uses_files) codegen_number_parse_runtime(ctx);
+    if (uses_input) codegen_input_runtime(ctx);
+    int uses_npy = codegen_program_uses_builtin(program, npy_builtins);
+    if (uses_files || uses_npy) codegen_file_view_runtime(ctx);
+    if (uses_files) codegen_files_runtime(ctx);
+    if (uses_npy) codegen_npy_runtime(ctx);
+
+    codegen_array_print_runtime(ctx);
 
     NodeList* defs = program->program.definitions;
     while (defs) { if (defs->node && defs->node->type == NODE_TYPE_DEF) codegen_struct(ctx, defs->node); defs = defs->next; }
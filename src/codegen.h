@@ -13,8 +13,23 @@ typedef struct CodeGenContext {
     int loop_start[64];
     int loop_end[64];
     int loop_continue[64];
+    NodeList* loop_body[64];      // corpo de cada laço aberto
+    int loop_big_base[64];        // primeiro bigint do laço em loop_bigs
+    const char* loop_bigs[64];    // bigint declarados direto nos corpos abertos, em ordem
+    int loop_big_count;
     int alloc_count;
     char* alloc_names[256];
+    const char* alloc_free_fns[256];  // NULL = free()
+    // Programa completo (análise de escape consulta as assinaturas das funções)
+    ASTNode* program;
+    // Eliminação de chamadas de cauda da função corrente
+    ASTNode* current_function;
+    int tail_label;     // rótulo de entrada da função (-1 = desativado)
+    int tail_acc_op;    // OP_ADD/OP_MUL quando há acumulador, -1 caso contrário
+    // Modo de emissão de laços: 0 = goto (C restrito, padrão), 1 = for/while estruturados
+    int emit_structured;
+    // Erros de geração (argumento de tipo errado para um built-in...): o C gerado não é compilado
+    int error_count;
 } CodeGenContext;
 
 CodeGenContext* codegen_create(FILE* output);
@@ -25,24 +40,37 @@ void codegen_function(CodeGenContext* ctx, ASTNode* func);
 void codegen_statement(CodeGenContext* ctx, ASTNode* stmt);
 void codegen_expression(CodeGenContext* ctx, ASTNode* expr);
 void codegen_for(CodeGenContext* ctx, ASTNode* for_node);
+int codegen_for_structured(CodeGenContext* ctx, ASTNode* for_node);
 void codegen_struct(CodeGenContext* ctx, ASTNode* type_def);
 void codegen_runtime_helpers(CodeGenContext* ctx);
 
 int codegen_new_label(CodeGenContext* ctx);
 int codegen_new_temp(CodeGenContext* ctx);
 void codegen_emit(CodeGenContext* ctx, const char* format, ...);
+void codegen_error(CodeGenContext* ctx, ASTNode* node, const char* format, ...);
 void codegen_emit_indent(CodeGenContext* ctx);
 
 const char* codegen_type_to_c(TypeSpec* type);
 
-void codegen_loop_push(CodeGenContext* ctx, int start, int end, int cont);
+void codegen_loop_push(CodeGenContext* ctx, int start, int end, int cont, NodeList* body);
 void codegen_loop_pop(CodeGenContext* ctx);
 
 void codegen_member_access(CodeGenContext* ctx, ASTNode* member);
 
 const char* codegen_type_to_c(TypeSpec* type);
 
+// Matrizes contíguas (matrix[T] e T[][])
+int codegen_is_matrix_type(TypeSpec* type);
+const char* codegen_matrix_ptr_type(TypeSpec* matrix_type);
+void codegen_matrix_declaration(CodeGenContext* ctx, ASTNode* stmt, TypeSpec* var_type);
+
+// Conjuntos (set[T]) em tabela hash
+int codegen_is_set_type(TypeSpec* type);
+const char* codegen_set_ptr_type(TypeSpec* set_type);
+void codegen_set_declaration(CodeGenContext* ctx, ASTNode* stmt, TypeSpec* var_type);
+
 void codegen_record_alloc(CodeGenContext* ctx, const char* name);
+void codegen_record_alloc_fn(CodeGenContext* ctx, const char* name, const char* free_fn);
 void codegen_emit_frees(CodeGenContext* ctx);
 
 #endif // CODEGEN_H
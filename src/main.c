@@ -3,6 +3,7 @@
 #include <string.h>
 #include "ast.h"
 #include "codegen.h"
+#include "optimizer.h"
 #include "../libs/symbol-table.h"
 
 extern FILE* yyin;
@@ -14,14 +15,30 @@ int main(int argc, char** argv) {
     FILE* input_file = NULL;
     int result = 0;
     const char* output_dir = NULL;
+    const char* input_path = NULL;
+    int emit_structured = 0;
+    int gcc_optimize = 0;
+    OptimizerOptions opt_options;
+    opt_options.verbose = 0;
+    opt_options.inline_max_nodes = INLINE_MAX_NODES;
 
     // Processa argumentos da linha de comando
-    if (argc >= 2 && strcmp(argv[1], "-o") == 0 && argc >= 4) {
-        output_dir = argv[2];
-        // Desloca argumentos
-        argv[2] = argv[0]; // nome do programa
-        argv = &argv[2];
-        argc -= 2;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_dir = argv[++i];
+        } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            opt_options.verbose = 1;
+        } else if (strcmp(argv[i], "--emit=structured") == 0) {
+            emit_structured = 1;
+        } else if (strcmp(argv[i], "--emit=goto") == 0) {
+            emit_structured = 0;
+        } else if (strcmp(argv[i], "-O") == 0 || strcmp(argv[i], "--opt") == 0) {
+            gcc_optimize = 1;
+        } else if (strncmp(argv[i], "--inline-limit=", 15) == 0) {
+            opt_options.inline_max_nodes = atoi(argv[i] + 15);
+        } else if (!input_path) {
+            input_path = argv[i];
+        }
     }
 
     // Verifica variável de ambiente OUTPUT_DIR se não especificado via linha de comando
@@ -39,17 +56,22 @@ int main(int argc, char** argv) {
     printf("UFRN - Engenharia de Linguagens\n");
     printf("============================================================================\n\n");
 
-    if (argc > 1) {
-        input_file = fopen(argv[1], "r");
+    if (input_path) {
+        input_file = fopen(input_path, "r");
         if (!input_file) {
-            fprintf(stderr, "ERRO: Não foi possível abrir o arquivo '%s'\n", argv[1]);
+            fprintf(stderr, "ERRO: Não foi possível abrir o arquivo '%s'\n", input_path);
             return 1;
         }
         yyin = input_file;
-        printf("Analisando arquivo: %s\n\n", argv[1]);
+        printf("Analisando arquivo: %s\n\n", input_path);
     } else {
-        fprintf(stderr, "USO: %s [-o <output_dir>] <arquivo.math>\n", argv[0]);
+        fprintf(stderr, "USO: %s [-o <output_dir>] [-v] [-O] [--emit=goto|structured] [--inline-limit=N] <arquivo.math>\n", argv[0]);
         fprintf(stderr, "     -o <output_dir>: Diretório para arquivos de saída (padrão: build/tests)\n");
+        fprintf(stderr, "     -v, --verbose: Relata as decisões do otimizador (inlining, bitsets)\n");
+        fprintf(stderr, "     --emit=goto: Laços com labels/goto (C restrito, padrão)\n");
+        fprintf(stderr, "     -O, --opt: Compila o C gerado com gcc -O3 (padrão: -O0), em qualquer --emit\n");
+        fprintf(stderr, "     --emit=structured: Laços for/while canônicos (vetorizáveis com -O)\n");
+        fprintf(stderr, "     --inline-limit=N: Tamanho máximo (nós da AST) para inlining automático (padrão: %d)\n", INLINE_MAX_NODES);
         fprintf(stderr, "     Alternativamente, defina MATHC_OUTPUT_DIR=<dir>\n");
         return 1;
     }
@@ -64,6 +86,8 @@ int main(int argc, char** argv) {
 
     const char* builtins[] = {
         "print","println","input","range","len",
+        "input_array","input_matrix","read_array","read_matrix","read_csv",
+        "load_npy","save_npy",
         // Matemática básica
         "abs","sqrt","exp","log","log10","log2",
         "sin","cos","tan","asin","acos","atan","atan2",
@@ -75,6 +99,8 @@ int main(int argc, char** argv) {
         // Teoria dos números
         "factorial","gcd","lcm","isprime",
         "combinations","permutations",
+        "next_prime","primes_up_to",
+        "modpow","modinv","factorial_mod","binomial_mod","factorize",
         // Estatísticas de arrays
         "sum","mean","prod","std","variance",
         "sort","reverse","append","pop","push",
@@ -90,6 +116,8 @@ int main(int argc, char** argv) {
     };
     TypeSpec* types[] = {
         t_void,t_void,t_void,t_void,t_int,
+        t_void,t_void,t_void,t_void,t_void,
+        t_void,t_void,
         // Matemática básica
         t_float,t_float,t_float,t_float,t_float,t_float,
         t_float,t_float,t_float,t_float,t_float,t_float,t_float,
@@ -101,6 +129,8 @@ int main(int argc, char** argv) {
         // Teoria dos números
         t_int,t_int,t_int,t_int,
         t_int,t_int,
+        t_int,create_type_spec(TYPE_ARRAY, t_int, NULL),
+        t_int,t_int,t_int,t_int,create_type_spec(TYPE_ARRAY, t_int, NULL),
         // Estatísticas de arrays
         t_float,t_float,t_float,t_float,t_float,
         t_void,t_void,t_void,t_int,t_void,
@@ -140,6 +170,12 @@ int main(int argc, char** argv) {
 
             printf("\n============================================================================\n");
 
+            // Inferência de tipos das expressões (reticulado numérico)
+            infer_types(ast_root);
+
+            // Otimizações sobre a AST (representação de conjuntos, inlining de funções pequenas)
+            optimize_program(ast_root, &opt_options);
+
             // Gera código C no diretório de saída especificado
             char nome_base[256];
             char nome_arquivo_saida[1024];
@@ -147,7 +183,7 @@ int main(int argc, char** argv) {
             char comando_mkdir[512];
 
             // Extrai apenas o nome do arquivo sem o caminho
-            const char* caminho_entrada = argv[1];
+            const char* caminho_entrada = input_path;
             const char* ultima_barra = strrchr(caminho_entrada, '/');
             const char* nome_arquivo = ultima_barra ? ultima_barra + 1 : caminho_entrada;
 
@@ -171,16 +207,26 @@ int main(int argc, char** argv) {
                 printf("\nGerando código C em: %s\n", nome_arquivo_saida);
 
                 CodeGenContext* contexto_codegen = codegen_create(arquivo_saida);
+                contexto_codegen->emit_structured = emit_structured;
                 codegen_program(contexto_codegen, ast_root);
+                int erros_codegen = contexto_codegen->error_count;
                 codegen_free(contexto_codegen);
 
                 fclose(arquivo_saida);
+                if (erros_codegen > 0) {
+                    fprintf(stderr, "\n✗ Geração de código falhou com %d erro(s)\n", erros_codegen);
+                    remove(nome_executavel);
+                    free_ast_tree(&ast_root);
+                    if (input_file) fclose(input_file);
+                    return 1;
+                }
                 printf("✓ Código C gerado com sucesso!\n");
 
                 // Compila o código C gerado
                 char comando_compilacao[4096];
                 snprintf(comando_compilacao, sizeof(comando_compilacao),
-                        "gcc -o %s %s -lm 2>&1", nome_executavel, nome_arquivo_saida);
+                        "gcc %s-pthread -o %s %s -lm 2>&1", gcc_optimize ? "-O3 " : "",
+                        nome_executavel, nome_arquivo_saida);
 
                 printf("\nCompilando código C...\n");
                 int resultado_compilacao = system(comando_compilacao);
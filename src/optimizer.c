@@ -0,0 +1,677 @@
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================================== */
+/* INLINING DE FUNÇÕES PEQUENAS */
+/* ========================================================================== */
+/*
+ * Expande chamadas a funções do usuário em posição de comando:
+ *
+ *     x = f(a, b)      ->   T _inl0_p = a;
+ *                           T _inl0_q = b;
+ *                           <corpo de f com locais renomeados para _inl0_*>
+ *                           x = <expressão do return de f>;
+ *
+ * Só são expandidas funções não recursivas cujo corpo é uma sequência
+ * linear de declarações/atribuições/expressões terminada (opcionalmente)
+ * por um único return. O limite de tamanho é ignorado para funções
+ * anotadas com `def fun inline`.
+ */
+
+#define INLINE_MAX_NAMES 64
+
+typedef struct InlineContext {
+    ASTNode* program;
+    OptimizerOptions* opts;
+    const char* caller;
+    int counter;
+} InlineContext;
+
+typedef struct RenameMap {
+    const char* from[INLINE_MAX_NAMES];
+    char* to[INLINE_MAX_NAMES];
+    int count;
+} RenameMap;
+
+static ASTNode* find_function(ASTNode* program, const char* name) {
+    NodeList* defs = program->program.definitions;
+    while (defs) {
+        ASTNode* d = defs->node;
+        if (d && d->type == NODE_FUNCTION_DEF && d->function_def.name &&
+            strcmp(d->function_def.name, name) == 0) {
+            return d;
+        }
+        defs = defs->next;
+    }
+    return NULL;
+}
+
+static const char* call_target(ASTNode* node) {
+    if (node && node->type == NODE_CALL && node->call.function &&
+        node->call.function->type == NODE_IDENTIFIER) {
+        return node->call.function->identifier.name;
+    }
+    return NULL;
+}
+
+/* Recursão direta ou mútua: procura `target` no fecho do grafo de chamadas */
+typedef struct ReachData {
+    ASTNode* program;
+    const char* target;
+    ASTNode* visited[256];
+    int nvisited;
+    int found;
+} ReachData;
+
+static int visit_reach(ASTNode* node, void* data);
+
+static void reach_function(ReachData* rd, ASTNode* func) {
+    for (int i = 0; i < rd->nvisited; i++) {
+        if (rd->visited[i] == func) return;
+    }
+    if (rd->nvisited < 256) rd->visited[rd->nvisited++] = func;
+    ast_walk_list(func->function_def.body, visit_reach, rd);
+}
+
+static int visit_reach(ASTNode* node, void* data) {
+    ReachData* rd = (ReachData*)data;
+    if (rd->found) return 1;
+    const char* name = call_target(node);
+    if (name) {
+        if (strcmp(name, rd->target) == 0) {
+            rd->found = 1;
+            return 1;
+        }
+        ASTNode* callee = find_function(rd->program, name);
+        if (callee) reach_function(rd, callee);
+    }
+    return 0;
+}
+
+static int is_recursive(ASTNode* program, ASTNode* func) {
+    ReachData rd;
+    rd.program = program;
+    rd.target = func->function_def.name;
+    rd.nvisited = 0;
+    rd.found = 0;
+    reach_function(&rd, func);
+    return rd.found;
+}
+
+static int is_collection(TypeSpec* t) {
+    return t && (t->base_type == TYPE_ARRAY || t->base_type == TYPE_SET ||
+                 t->base_type == TYPE_MATRIX || t->base_type == TYPE_GRAPH);
+}
+
+/* Declarações que geram malloc + free no fim da função chamadora */
+static int declares_allocation(ASTNode* stmt) {
+    if (stmt->type != NODE_DECLARATION || !stmt->declaration.var_type) return 0;
+    TypeSpec* t = stmt->declaration.var_type;
+    if (t->base_type == TYPE_CUSTOM) return stmt->declaration.initializer == NULL;
+    return is_collection(t);
+}
+
+static int returns_value(ASTNode* func) {
+    NodeList* s = func->function_def.body;
+    while (s) {
+        if (s->node && s->node->type == NODE_RETURN_STMT) return s->node->return_stmt.value != NULL;
+        s = s->next;
+    }
+    return 0;
+}
+
+static int is_scalar(TypeSpec* t) {
+    return t && (t->base_type == TYPE_INT || t->base_type == TYPE_FLOAT || t->base_type == TYPE_BOOL ||
+                 t->base_type == TYPE_CHAR || t->base_type == TYPE_COMPLEX);
+}
+
+/* O valor do return tem outro tipo que o declarado na função (ex.: float em função int) */
+static int return_needs_conversion(ASTNode* callee) {
+    TypeSpec* rt = callee->function_def.return_type;
+    for (NodeList* s = callee->function_def.body; s; s = s->next) {
+        if (s->node && s->node->type == NODE_RETURN_STMT && s->node->return_stmt.value) {
+            TypeSpec* vt = s->node->return_stmt.value->inferred_type;
+            return rt && vt && vt->base_type != rt->base_type;
+        }
+    }
+    return 0;
+}
+
+/* Retorna NULL se a chamada pode ser expandida, ou o motivo da recusa */
+static const char* inline_rejection(InlineContext* ic, ASTNode* stmt, ASTNode* call,
+                                    ASTNode* callee, int in_loop) {
+    static char motivo[128];
+
+    if (strcmp(callee->function_def.name, "main") == 0) return "função main";
+    if (!callee->function_def.body) return "corpo vazio";
+    if (is_collection(callee->function_def.return_type)) return "retorna coleção";
+
+    int names = 0;
+    int nparams = 0;
+    ParamList* p = callee->function_def.parameters;
+    while (p) {
+        if (is_collection(p->type)) return "parâmetro do tipo coleção";
+        nparams++;
+        p = p->next;
+    }
+    names += nparams;
+
+    int nargs = 0;
+    NodeList* a = call->call.arguments;
+    while (a) { nargs++; a = a->next; }
+    if (nargs != nparams) return "número de argumentos incompatível";
+
+    NodeList* s = callee->function_def.body;
+    while (s) {
+        ASTNode* st = s->node;
+        if (st) {
+            switch (st->type) {
+                case NODE_DECLARATION:
+                    names++;
+                    if (in_loop && declares_allocation(st)) return "aloca memória dentro de laço";
+                    break;
+                case NODE_ASSIGNMENT:
+                case NODE_EXPR_STMT:
+                    break;
+                case NODE_RETURN_STMT:
+                    if (s->next) return "return antes do fim do corpo";
+                    break;
+                default:
+                    return "fluxo de controle no corpo";
+            }
+        }
+        s = s->next;
+    }
+    if (names > INLINE_MAX_NAMES) return "muitas variáveis locais";
+
+    if (stmt->type != NODE_EXPR_STMT && !returns_value(callee)) return "sem valor de retorno";
+    if (return_needs_conversion(callee) && !is_scalar(callee->function_def.return_type))
+        return "return com tipo diferente do declarado";
+
+    int size = count_ast_nodes(callee);
+    if (!callee->function_def.is_inline && size > ic->opts->inline_max_nodes) {
+        snprintf(motivo, sizeof(motivo), "corpo grande (%d nós)", size);
+        return motivo;
+    }
+
+    if (is_recursive(ic->program, callee)) return "recursiva";
+    return NULL;
+}
+
+static void rename_add(RenameMap* map, const char* from, const char* to) {
+    map->from[map->count] = from;
+    map->to[map->count] = strdup(to);
+    map->count++;
+}
+
+static void rename_free(RenameMap* map) {
+    for (int i = 0; i < map->count; i++) free(map->to[i]);
+    map->count = 0;
+}
+
+static const char* rename_lookup(RenameMap* map, const char* name) {
+    for (int i = map->count - 1; i >= 0; i--) {
+        if (strcmp(map->from[i], name) == 0) return map->to[i];
+    }
+    return NULL;
+}
+
+static int visit_rename(ASTNode* node, void* data) {
+    RenameMap* map = (RenameMap*)data;
+    const char* to = NULL;
+    if (node->type == NODE_IDENTIFIER) {
+        to = rename_lookup(map, node->identifier.name);
+        if (to) {
+            free(node->identifier.name);
+            node->identifier.name = strdup(to);
+        }
+    } else if (node->type == NODE_DECLARATION) {
+        to = rename_lookup(map, node->declaration.name);
+        if (to) {
+            free(node->declaration.name);
+            node->declaration.name = strdup(to);
+        }
+    }
+    return 0;
+}
+
+static ASTNode** inline_slot(ASTNode* stmt) {
+    switch (stmt->type) {
+        case NODE_EXPR_STMT: return &stmt->expr_stmt.expression;
+        case NODE_DECLARATION: return &stmt->declaration.initializer;
+        case NODE_ASSIGNMENT: return &stmt->assignment.value;
+        case NODE_RETURN_STMT: return &stmt->return_stmt.value;
+        default: return NULL;
+    }
+}
+
+/* Gera a lista de comandos que substitui `stmt`; `stmt` é reaproveitado ou liberado */
+static NodeList* expand_call(InlineContext* ic, ASTNode* stmt, ASTNode** slot, ASTNode* callee) {
+    ASTNode* call = *slot;
+    int id = ic->counter++;
+    char buffer[256];
+    RenameMap map;
+    map.count = 0;
+
+    NodeList* head = NULL;
+    NodeList** tail = &head;
+
+    // Parâmetros viram declarações inicializadas com os argumentos (avaliados uma única vez)
+    ParamList* p = callee->function_def.parameters;
+    NodeList* a = call->call.arguments;
+    while (p && a) {
+        snprintf(buffer, sizeof(buffer), "_inl%d_%s", id, p->name);
+        rename_add(&map, p->name, buffer);
+        ASTNode* decl = create_declaration(copy_type_spec(p->type), buffer, copy_ast(a->node), call->line);
+        decl->inferred_type = NULL;
+        *tail = create_node_list(decl, NULL);
+        tail = &(*tail)->next;
+        p = p->next;
+        a = a->next;
+    }
+
+    NodeList* s = callee->function_def.body;
+    while (s) {
+        if (s->node && s->node->type == NODE_DECLARATION) {
+            snprintf(buffer, sizeof(buffer), "_inl%d_%s", id, s->node->declaration.name);
+            rename_add(&map, s->node->declaration.name, buffer);
+        }
+        s = s->next;
+    }
+
+    ASTNode* result = NULL;
+    s = callee->function_def.body;
+    while (s) {
+        if (s->node) {
+            if (s->node->type == NODE_RETURN_STMT) {
+                result = copy_ast(s->node->return_stmt.value);
+                ast_walk(result, visit_rename, &map);
+                break;
+            }
+            ASTNode* c = copy_ast(s->node);
+            ast_walk(c, visit_rename, &map);
+            *tail = create_node_list(c, NULL);
+            tail = &(*tail)->next;
+        }
+        s = s->next;
+    }
+    rename_free(&map);
+
+    // Como na chamada fora de linha, o valor passa pelo tipo de retorno: T _inl0_ret = <expressão>
+    if (result && stmt->type != NODE_EXPR_STMT && return_needs_conversion(callee)) {
+        TypeSpec* rt = callee->function_def.return_type;
+        snprintf(buffer, sizeof(buffer), "_inl%d_ret", id);
+        *tail = create_node_list(create_declaration(copy_type_spec(rt), buffer, result, call->line), NULL);
+        tail = &(*tail)->next;
+        result = calloc(1, sizeof(ASTNode));
+        if (!result) {
+            fprintf(stderr, "ERRO FATAL: Falha ao alocar memória para nó IDENTIFIER\n");
+            exit(EXIT_FAILURE);
+        }
+        result->type = NODE_IDENTIFIER;
+        result->line = call->line;
+        result->identifier.name = strdup(buffer);
+        result->inferred_type = rt;
+    }
+
+    if (stmt->type == NODE_EXPR_STMT && result == NULL) {
+        free_ast(stmt);
+    } else {
+        free_ast(call);
+        *slot = result;
+        *tail = create_node_list(stmt, NULL);
+    }
+    return head;
+}
+
+static void inline_block(InlineContext* ic, NodeList** list, int in_loop, int depth);
+
+static void inline_nested(InlineContext* ic, ASTNode* stmt, int in_loop, int depth) {
+    switch (stmt->type) {
+        case NODE_IF_STMT:
+            inline_block(ic, &stmt->if_stmt.then_block, in_loop, depth);
+            inline_block(ic, &stmt->if_stmt.elif_parts, in_loop, depth);
+            inline_block(ic, &stmt->if_stmt.else_block, in_loop, depth);
+            break;
+        case NODE_WHILE_STMT:
+            inline_block(ic, &stmt->while_stmt.body, 1, depth);
+            break;
+        case NODE_FOR_STMT:
+            inline_block(ic, &stmt->for_stmt.body, 1, depth);
+            break;
+        case NODE_TRY_STMT:
+            inline_block(ic, &stmt->try_stmt.try_block, in_loop, depth);
+            inline_block(ic, &stmt->try_stmt.catch_clauses, in_loop, depth);
+            inline_block(ic, &stmt->try_stmt.finally_block, in_loop, depth);
+            break;
+        case NODE_CATCH_CLAUSE:
+            inline_block(ic, &stmt->catch_clause.body, in_loop, depth);
+            break;
+        default:
+            break;
+    }
+}
+
+static void inline_block(InlineContext* ic, NodeList** list, int in_loop, int depth) {
+    NodeList** link = list;
+    while (*link) {
+        NodeList* cur = *link;
+        ASTNode* stmt = cur->node;
+        if (!stmt) {
+            link = &cur->next;
+            continue;
+        }
+
+        inline_nested(ic, stmt, in_loop, depth);
+
+        ASTNode** slot = inline_slot(stmt);
+        const char* name = slot ? call_target(*slot) : NULL;
+        ASTNode* callee = name ? find_function(ic->program, name) : NULL;
+        if (!callee) {
+            link = &cur->next;
+            continue;
+        }
+
+        const char* motivo = depth >= INLINE_MAX_DEPTH ? "profundidade máxima de expansão"
+                                                       : inline_rejection(ic, stmt, *slot, callee, in_loop);
+        if (motivo) {
+            if (ic->opts->verbose) {
+                printf("[inline] %s -> %s (linha %d): não expandida, %s\n",
+                       name, ic->caller, stmt->line, motivo);
+            }
+            link = &cur->next;
+            continue;
+        }
+
+        if (ic->opts->verbose) {
+            printf("[inline] %s -> %s (linha %d): expandida\n", name, ic->caller, stmt->line);
+        }
+
+        NodeList* expansion = expand_call(ic, stmt, slot, callee);
+        // Chamadas expostas pela expansão (ex.: return g(x) no corpo) são tratadas no nível seguinte
+        inline_block(ic, &expansion, in_loop, depth + 1);
+
+        NodeList* next = cur->next;
+        free(cur);
+        if (!expansion) {
+            *link = next;
+            continue;
+        }
+        *link = expansion;
+        while (expansion->next) expansion = expansion->next;
+        expansion->next = next;
+        link = &expansion->next;
+    }
+}
+
+void inline_functions(ASTNode* program, OptimizerOptions* opts) {
+    if (!program || program->type != NODE_PROGRAM) return;
+
+    InlineContext ic;
+    ic.program = program;
+    ic.opts = opts;
+    ic.caller = NULL;
+    ic.counter = 0;
+
+    NodeList* defs = program->program.definitions;
+    while (defs) {
+        ASTNode* d = defs->node;
+        if (d && d->type == NODE_FUNCTION_DEF) {
+            ic.caller = d->function_def.name;
+            inline_block(&ic, &d->function_def.body, 0, 0);
+        }
+        defs = defs->next;
+    }
+}
+
+/* ========================================================================== */
+/* REPRESENTAÇÃO DE CONJUNTOS */
+/* ========================================================================== */
+/*
+ * Um set[int] local vira set[int; 0..N] (bitset) quando o domínio é limitado
+ * em tempo de compilação: tudo o que entra nele são constantes inteiras em
+ * 0..BITSET_AUTO_MAX (literais e s.add(k)) ou resultados de operações com
+ * outros candidatos, e ele não escapa da função (não é argumento de função
+ * do usuário, não é retornado e não se mistura com um set[int] comum).
+ * Os candidatos de uma função compartilham o domínio, arredondado para uma
+ * palavra de 64 bits. Os usos enxergam a escolha porque o TypeSpec da
+ * declaração é o mesmo apontado pelos identificadores.
+ */
+
+#define BITSET_MAX_CANDIDATES 64
+
+typedef struct BitsetScan {
+    ASTNode* decls[BITSET_MAX_CANDIDATES];
+    int rejected[BITSET_MAX_CANDIDATES];
+    int count;
+    int max_value;  // maior constante que entra em algum candidato
+    int changed;
+} BitsetScan;
+
+/* Folhas de uma expressão de conjunto */
+typedef struct SetLeaves {
+    int cands[BITSET_MAX_CANDIDATES];
+    int ncands;
+    int other;      // algum operando não pode ser bitset
+    int max_value;  // maior constante dos literais da expressão
+} SetLeaves;
+
+static const char* bitset_set_builtins[] = {
+    "union", "difference", "intersection", "symmetric_diff", "is_subset", "is_superset", NULL
+};
+static const char* bitset_reader_builtins[] = { "print", "println", "len", "cardinality", NULL };
+
+static int in_name_list(const char** list, const char* name) {
+    for (int i = 0; name && list[i]; i++) {
+        if (strcmp(list[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+static int is_plain_int_set(TypeSpec* t) {
+    return t && t->base_type == TYPE_SET && t->domain_max < 0 &&
+           t->element_type && t->element_type->base_type == TYPE_INT;
+}
+
+static int bitset_index(BitsetScan* bs, ASTNode* e) {
+    if (!e || e->type != NODE_IDENTIFIER) return -1;
+    for (int i = 0; i < bs->count; i++) {
+        if (e->inferred_type == bs->decls[i]->declaration.var_type) return i;
+    }
+    return -1;
+}
+
+static void bitset_reject(BitsetScan* bs, int i) {
+    if (i >= 0 && !bs->rejected[i]) {
+        bs->rejected[i] = 1;
+        bs->changed = 1;
+    }
+}
+
+static int bitset_constant(ASTNode* e, int* max_value) {
+    if (!e || e->type != NODE_INT_LITERAL || e->int_literal.value < 0 || e->int_literal.value > BITSET_AUTO_MAX) return 0;
+    if (e->int_literal.value > *max_value) *max_value = e->int_literal.value;
+    return 1;
+}
+
+static int is_set_expression(ASTNode* e) {
+    return e && (e->type == NODE_SET_LITERAL || (e->inferred_type && e->inferred_type->base_type == TYPE_SET));
+}
+
+static void bitset_leaves(BitsetScan* bs, ASTNode* e, SetLeaves* lv) {
+    if (!e) return;
+    if (e->type == NODE_IDENTIFIER) {
+        int i = bitset_index(bs, e);
+        if (i >= 0 && !bs->rejected[i] && lv->ncands < BITSET_MAX_CANDIDATES) lv->cands[lv->ncands++] = i;
+        else lv->other = 1;
+        return;
+    }
+    if (e->type == NODE_SET_LITERAL) {
+        for (NodeList* el = e->set_literal.elements; el; el = el->next) {
+            if (!bitset_constant(el->node, &lv->max_value)) lv->other = 1;
+        }
+        return;
+    }
+    if (e->type == NODE_BINARY_OP && (e->binary_op.op == OP_ADD || e->binary_op.op == OP_SUB) &&
+        (is_set_expression(e->binary_op.left) || is_set_expression(e->binary_op.right))) {
+        bitset_leaves(bs, e->binary_op.left, lv);
+        bitset_leaves(bs, e->binary_op.right, lv);
+        return;
+    }
+    const char* name = call_target(e);
+    if (name && in_name_list(bitset_set_builtins, name)) {
+        for (NodeList* a = e->call.arguments; a; a = a->next) bitset_leaves(bs, a->node, lv);
+        return;
+    }
+    lv->other = 1;
+}
+
+/* Operandos de uma mesma expressão precisam ter a mesma representação */
+static void bitset_group(BitsetScan* bs, SetLeaves* lv) {
+    if (lv->other) {
+        for (int i = 0; i < lv->ncands; i++) bitset_reject(bs, lv->cands[i]);
+    } else if (lv->ncands > 0 && lv->max_value > bs->max_value) {
+        bs->max_value = lv->max_value;
+    }
+}
+
+static void bitset_expression(BitsetScan* bs, ASTNode* e, int target) {
+    SetLeaves lv;
+    lv.ncands = 0;
+    lv.other = 0;
+    lv.max_value = 0;
+    if (target >= 0 && bs->rejected[target]) lv.other = 1;
+    else if (target >= 0) lv.cands[lv.ncands++] = target;
+    bitset_leaves(bs, e, &lv);
+    bitset_group(bs, &lv);
+}
+
+static int visit_bitset(ASTNode* node, void* data) {
+    BitsetScan* bs = (BitsetScan*)data;
+    switch (node->type) {
+        case NODE_DECLARATION: {
+            int i = -1;
+            for (int k = 0; k < bs->count; k++) {
+                if (bs->decls[k] == node) i = k;
+            }
+            if (i < 0) return 0;
+            if (node->declaration.initializer) bitset_expression(bs, node->declaration.initializer, i);
+            return 1;
+        }
+        case NODE_ASSIGNMENT: {
+            int i = bitset_index(bs, node->assignment.target);
+            if (i < 0) return 0;
+            if (node->assignment.op != OP_ASSIGN) bitset_reject(bs, i);
+            bitset_expression(bs, node->assignment.value, i);
+            return 1;
+        }
+        case NODE_MEMBER_ACCESS: {
+            int i = bitset_index(bs, node->member_access.object);
+            if (i < 0) return 0;
+            const char* m = node->member_access.member;
+            if (strcmp(m, "add") == 0) {
+                NodeList* a = node->member_access.args;
+                if (!a || a->next || !bitset_constant(a->node, &bs->max_value)) bitset_reject(bs, i);
+            } else if (strcmp(m, "contains") == 0) {
+                ast_walk_list(node->member_access.args, visit_bitset, bs);
+            } else {
+                bitset_reject(bs, i);
+            }
+            return 1;
+        }
+        case NODE_BINARY_OP: {
+            ASTNode* l = node->binary_op.left;
+            ASTNode* r = node->binary_op.right;
+            if (node->binary_op.op == OP_IN && !is_set_expression(l) && is_set_expression(r)) {
+                // x in s: pertinência não mistura representações
+                ast_walk(l, visit_bitset, bs);
+                if (bitset_index(bs, r) < 0) bitset_expression(bs, r, -1);
+                return 1;
+            }
+            int set_op = node->binary_op.op == OP_ADD || node->binary_op.op == OP_SUB ||
+                         node->binary_op.op == OP_EQ || node->binary_op.op == OP_NEQ || node->binary_op.op == OP_IN;
+            if (!set_op || !(is_set_expression(l) || is_set_expression(r))) return 0;
+            bitset_expression(bs, node, -1);
+            return 1;
+        }
+        case NODE_CALL: {
+            const char* name = call_target(node);
+            if (name && in_name_list(bitset_set_builtins, name)) {
+                bitset_expression(bs, node, -1);
+                return 1;
+            }
+            if (!name || !in_name_list(bitset_reader_builtins, name)) return 0;
+            for (NodeList* a = node->call.arguments; a; a = a->next) {
+                if (is_set_expression(a->node)) bitset_expression(bs, a->node, -1);
+                else ast_walk(a->node, visit_bitset, bs);
+            }
+            return 1;
+        }
+        case NODE_FOR_STMT:
+            if (bitset_index(bs, node->for_stmt.iterable) < 0) return 0;
+            ast_walk_list(node->for_stmt.body, visit_bitset, bs);
+            return 1;
+        case NODE_IDENTIFIER:
+            // Qualquer outro uso (argumento de função, return, ...) deixa o conjunto escapar
+            bitset_reject(bs, bitset_index(bs, node));
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static int visit_collect_sets(ASTNode* node, void* data) {
+    BitsetScan* bs = (BitsetScan*)data;
+    if (node->type == NODE_DECLARATION && is_plain_int_set(node->declaration.var_type) &&
+        bs->count < BITSET_MAX_CANDIDATES) {
+        bs->decls[bs->count] = node;
+        bs->rejected[bs->count] = 0;
+        bs->count++;
+    }
+    return 0;
+}
+
+static void choose_function_sets(ASTNode* func, OptimizerOptions* opts) {
+    BitsetScan bs;
+    bs.count = 0;
+    ast_walk_list(func->function_def.body, visit_collect_sets, &bs);
+    if (bs.count == 0) return;
+
+    // Rejeitar um candidato pode contaminar os que se misturam com ele: repete até estabilizar.
+    // O domínio vale o da última passada, que só vê os grupos aceitos
+    do {
+        bs.changed = 0;
+        bs.max_value = 0;
+        ast_walk_list(func->function_def.body, visit_bitset, &bs);
+    } while (bs.changed);
+
+    int domain_max = bs.max_value | 63;
+    for (int i = 0; i < bs.count; i++) {
+        if (bs.rejected[i]) continue;
+        bs.decls[i]->declaration.var_type->domain_max = domain_max;
+        if (opts->verbose) {
+            printf("[bitset] %s (linha %d): set[int; 0..%d]\n",
+                   bs.decls[i]->declaration.name, bs.decls[i]->line, domain_max);
+        }
+    }
+}
+
+void choose_set_representations(ASTNode* program, OptimizerOptions* opts) {
+    if (!program || program->type != NODE_PROGRAM) return;
+    for (NodeList* defs = program->program.definitions; defs; defs = defs->next) {
+        if (defs->node && defs->node->type == NODE_FUNCTION_DEF) choose_function_sets(defs->node, opts);
+    }
+    if (program->program.main_function) choose_function_sets(program->program.main_function, opts);
+}
+
+/* ========================================================================== */
+/* PIPELINE DE OTIMIZAÇÃO */
+/* ========================================================================== */
+
+void optimize_program(ASTNode* program, OptimizerOptions* opts) {
+    if (!program || !opts) return;
+    // Antes do inlining: as cópias das declarações herdam o domínio escolhido
+    choose_set_representations(program, opts);
+    inline_functions(program, opts);
+}
@@ -0,0 +1,22 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "ast.h"
+
+/* Limite padrão (em nós da AST) para expandir funções sem a anotação inline */
+#define INLINE_MAX_NODES 40
+/* Profundidade máxima de expansões aninhadas (inline dentro de inline) */
+#define INLINE_MAX_DEPTH 4
+/* Maior valor constante aceito ao escolher um bitset para set[int] automaticamente */
+#define BITSET_AUTO_MAX 4095
+
+typedef struct OptimizerOptions {
+    int verbose;
+    int inline_max_nodes;
+} OptimizerOptions;
+
+void optimize_program(ASTNode* program, OptimizerOptions* opts);
+void inline_functions(ASTNode* program, OptimizerOptions* opts);
+void choose_set_representations(ASTNode* program, OptimizerOptions* opts);
+
+#endif // OPTIMIZER_H
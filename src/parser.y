@@ -37,6 +37,7 @@ ASTNode* ast_root = NULL;
 
 static NodeList* reverse_node_list(NodeList* list);
 static ParamList* reverse_param_list(ParamList* list);
+static TypeSpec* iter_element_type(ASTNode* iterable);
 
 static char* for_iter_name = NULL;
 static char* for_val_name = NULL;
@@ -105,13 +106,13 @@ static void print_syntax_error(const char* msg) {
 
 %token <ival> INT_LITERAL
 %token <fval> FLOAT_LITERAL
-%token <sval> STRING_LITERAL COMPLEX_LITERAL IDENTIFIER
+%token <sval> STRING_LITERAL COMPLEX_LITERAL BIGINT_LITERAL IDENTIFIER
 %token <cval> CHAR_LITERAL
 %token <bval> TRUE FALSE
 
-%token DEF END FUN IF ELIF ELSE WHILE FOR IN RETURN BREAK CONTINUE
+%token DEF END FUN INLINE IF ELIF ELSE WHILE FOR IN RETURN BREAK CONTINUE
 %token TRY CATCH FINALLY IMPORT CONST THIS NEW PRINT RANGE CLASS
-%token INT_TYPE FLOAT_TYPE BOOL_TYPE COMPLEX_TYPE CHAR_TYPE STRING_TYPE
+%token INT_TYPE FLOAT_TYPE BOOL_TYPE COMPLEX_TYPE CHAR_TYPE STRING_TYPE BIGINT_TYPE MOD_TYPE
 %token VOID_TYPE UNDEFINED_TYPE MATRIX_TYPE SET_TYPE GRAPH_TYPE
 %token PLUS MINUS STAR SLASH FLOOR_DIV MOD POWER MATMUL
 %token ASSIGN PLUS_ASSIGN MINUS_ASSIGN STAR_ASSIGN SLASH_ASSIGN MOD_ASSIGN
@@ -119,7 +120,7 @@ static void print_syntax_error(const char* msg) {
 %token EQUAL NOT_EQUAL LESS GREATER LESS_EQUAL GREATER_EQUAL
 %token AND OR NOT
 %token LPAREN RPAREN LBRACKET RBRACKET LBRACE RBRACE
-%token COMMA COLON DOT
+%token COMMA COLON DOT DOTDOT SEMICOLON
 %token NEWLINE INDENT DEDENT
 
 %type <node> program statement declaration assignment if_stmt while_stmt for_stmt
@@ -141,6 +142,7 @@ static void print_syntax_error(const char* msg) {
 %type <type_spec> type primitive_type array_type matrix_type set_type graph_type
 
 %type <op> assign_op rel_op
+%type <ival> opt_inline
 
 %define parse.error verbose
 
@@ -211,11 +213,11 @@ definition
     ;
 
 function_def
-    : DEF FUN type IDENTIFIER LPAREN params RPAREN NEWLINE 
+    : DEF FUN opt_inline type IDENTIFIER LPAREN params RPAREN NEWLINE 
         {
-            current_func_params = $6 ? reverse_param_list($6) : NULL;
-            if (!symbol_table_insert(symbol_table, $4, $3, SYM_FUNC, yylineno, current_func_params)) {
-                already_declared_variable_error($4, yylineno);
+            current_func_params = $7 ? reverse_param_list($7) : NULL;
+            if (!symbol_table_insert(symbol_table, $5, $4, SYM_FUNC, yylineno, current_func_params)) {
+                already_declared_variable_error($5, yylineno);
             }
             symbol_table_enter_scope(symbol_table);
             ParamList* p = current_func_params;
@@ -227,14 +229,20 @@ function_def
             }
         }
     func_body_block END DEF {
-        $$ = create_function_def($3, $4, current_func_params, for_body, yylineno);
-        free($4);
+        $$ = create_function_def($4, $5, current_func_params, for_body, yylineno);
+        $$->function_def.is_inline = $3;
+        free($5);
         symbol_table_leave_scope(symbol_table);
         for_body = NULL;
         current_func_params = NULL;
     }
     ;
 
+opt_inline
+    : %empty { $$ = 0; }
+    | INLINE { $$ = 1; }
+    ;
+
 func_body_block
     : indented_block DEDENT {
         for_body = $1 ? reverse_node_list($1) : NULL;
@@ -306,6 +314,16 @@ primitive_type
     | FLOAT_TYPE { $$ = create_type_spec(TYPE_FLOAT, NULL, NULL); }
     | BOOL_TYPE { $$ = create_type_spec(TYPE_BOOL, NULL, NULL); }
     | COMPLEX_TYPE { $$ = create_type_spec(TYPE_COMPLEX, NULL, NULL); }
+    | BIGINT_TYPE { $$ = create_type_spec(TYPE_BIGINT, NULL, NULL); }
+    | MOD_TYPE LBRACKET INT_LITERAL RBRACKET {
+        /* mod[p]: inteiros módulo p, com p constante (2 <= p < 2^31) */
+        if ($3 < 2) {
+            fprintf(stderr, "Erro: mod[%d] requer um módulo entre 2 e 2147483647 (linha %d)\n", $3, yylineno);
+            exit(1);
+        }
+        $$ = create_type_spec(TYPE_MOD, NULL, NULL);
+        $$->modulus = $3;
+    }
     | CHAR_TYPE { $$ = create_type_spec(TYPE_CHAR, NULL, NULL); }
     | STRING_TYPE { $$ = create_type_spec(TYPE_STRING, NULL, NULL); }
     | VOID_TYPE { $$ = create_type_spec(TYPE_VOID, NULL, NULL); }
@@ -323,6 +341,15 @@ matrix_type
 
 set_type
     : SET_TYPE LBRACKET primitive_type RBRACKET { $$ = create_type_spec(TYPE_SET, $3, NULL); }
+    | SET_TYPE LBRACKET primitive_type SEMICOLON INT_LITERAL DOTDOT INT_LITERAL RBRACKET {
+        /* set[int; 0..N]: domínio limitado, representado como bitset */
+        if ($3->base_type != TYPE_INT || $5 != 0 || $7 < 0) {
+            fprintf(stderr, "Erro: domínio de conjunto deve ser set[int; 0..N] com N >= 0 (linha %d)\n", yylineno);
+            exit(1);
+        }
+        $$ = create_type_spec(TYPE_SET, $3, NULL);
+        $$->domain_max = $7;
+    }
     ;
 
 graph_type
@@ -458,11 +485,12 @@ for_single
         for_iter_name = $3;
         for_iter_expr = $5;
         symbol_table_enter_scope(symbol_table);
-        TypeSpec* iter_type = create_type_spec(TYPE_INT, NULL, NULL);
+        TypeSpec* iter_type = iter_element_type($5);
         symbol_table_insert(symbol_table, for_iter_name, iter_type, SYM_VAR, yylineno, NULL);
     } for_body_block {
-        $$ = create_for_stmt(for_iter_name, NULL, for_iter_expr, for_body, yylineno);
-        free(for_iter_name);
+        // Usa $3/$5 (e não as globais) para suportar laços for aninhados
+        $$ = create_for_stmt($3, NULL, $5, for_body, yylineno);
+        free($3);
         symbol_table_leave_scope(symbol_table);
         for_iter_name = NULL;
         for_iter_expr = NULL;
@@ -476,14 +504,14 @@ for_double
         for_idx_name = $5;
         for_iter_expr = $7;
         symbol_table_enter_scope(symbol_table);
-        TypeSpec* value_type = create_type_spec(TYPE_INT, NULL, NULL);
+        TypeSpec* value_type = iter_element_type($7);
         TypeSpec* index_type = create_type_spec(TYPE_INT, NULL, NULL);
         symbol_table_insert(symbol_table, for_val_name, value_type, SYM_VAR, yylineno, NULL);
         symbol_table_insert(symbol_table, for_idx_name, index_type, SYM_VAR, yylineno, NULL);
     } for_body_block {
-        $$ = create_for_stmt(for_val_name, for_idx_name, for_iter_expr, for_body, yylineno);
-        free(for_val_name);
-        free(for_idx_name);
+        $$ = create_for_stmt($3, $5, $7, for_body, yylineno);
+        free($3);
+        free($5);
         symbol_table_leave_scope(symbol_table);
         for_val_name = NULL;
         for_idx_name = NULL;
@@ -673,6 +701,7 @@ literal
     | TRUE { $$ = create_bool_literal(1, yylineno); }
     | FALSE { $$ = create_bool_literal(0, yylineno); }
     | COMPLEX_LITERAL { $$ = create_complex_literal($1, yylineno); free($1); }
+    | BIGINT_LITERAL { $$ = create_bigint_literal($1, yylineno); free($1); }
     | STRING_LITERAL { $$ = create_string_literal($1, yylineno); free($1); }
     | CHAR_LITERAL { $$ = create_char_literal($1, yylineno); }
     ;
@@ -703,6 +732,41 @@ void yyerror(const char* s) {
     print_syntax_error(s ? s : "erro de sintaxe");
 }
 
+/* Tipo do iterador de um for: elemento do array/conjunto percorrido (int para range) */
+static TypeSpec* iter_element_type(ASTNode* iterable) {
+    TypeSpec* t = NULL;
+    if (iterable && iterable->type == NODE_ARRAY_LITERAL) {
+        int strings = 1;
+        for (NodeList* el = iterable->array_literal.elements; el; el = el->next) {
+            TypeSpec* et = el->node ? el->node->inferred_type : NULL;
+            if (!et || et->base_type != TYPE_STRING) strings = 0;
+        }
+        if (strings && iterable->array_literal.elements) return create_type_spec(TYPE_STRING, NULL, NULL);
+        for (NodeList* el = iterable->array_literal.elements; el; el = el->next) {
+            TypeSpec* et = el->node ? el->node->inferred_type : NULL;
+            t = t ? type_join(t, et) : et;
+            if (!t) break;
+        }
+    } else if (iterable && iterable->type == NODE_IDENTIFIER && iterable->inferred_type &&
+               (iterable->inferred_type->base_type == TYPE_ARRAY || iterable->inferred_type->base_type == TYPE_SET)) {
+        t = iterable->inferred_type->element_type;
+        // Linhas de T[][] são arrays T[]
+        if (t && t->base_type == TYPE_ARRAY) return t;
+    } else if (iterable && iterable->type == NODE_IDENTIFIER && iterable->inferred_type &&
+               iterable->inferred_type->base_type == TYPE_MATRIX) {
+        return create_type_spec(TYPE_ARRAY, iterable->inferred_type->element_type, NULL);
+    }
+    if (!t) return create_type_spec(TYPE_INT, NULL, NULL);
+    switch (t->base_type) {
+        case TYPE_FLOAT: case TYPE_CHAR: case TYPE_BOOL: case TYPE_COMPLEX: case TYPE_STRING: case TYPE_BIGINT:
+            return create_type_spec(t->base_type, NULL, NULL);
+        case TYPE_MOD:
+            return copy_type_spec(t);
+        default:
+            return create_type_spec(TYPE_INT, NULL, NULL);
+    }
+}
+
 static NodeList* reverse_node_list(NodeList* list) {
     NodeList* prev = NULL;
     NodeList* cur = list;
@@ -809,6 +873,8 @@ const char *datatype_to_string(DataType t) {
         case TYPE_COMPLEX: return "complex";
         case TYPE_CHAR: return "char";
         case TYPE_STRING: return "string";
+        case TYPE_BIGINT: return "bigint";
+        case TYPE_MOD: return "mod";
         case TYPE_VOID: return "void";
         case TYPE_ARRAY: return "array";
         case TYPE_MATRIX: return "matrix";
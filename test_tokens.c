@@ -38,6 +38,8 @@ static const char* token_name(int token) {
         case FLOAT_TYPE: return "FLOAT_TYPE";
         case BOOL_TYPE: return "BOOL_TYPE";
         case COMPLEX_TYPE: return "COMPLEX_TYPE";
+        case BIGINT_TYPE: return "BIGINT_TYPE";
+        case MOD_TYPE: return "MOD_TYPE";
         case CHAR_TYPE: return "CHAR_TYPE";
         case STRING_TYPE: return "STRING_TYPE";
         case VOID_TYPE: return "VOID_TYPE";
@@ -80,6 +82,8 @@ static const char* token_name(int token) {
         case COMMA: return "COMMA";
         case COLON: return "COLON";
         case DOT: return "DOT";
+        case DOTDOT: return "DOTDOT";
+        case SEMICOLON: return "SEMICOLON";
         case NEWLINE: return "NEWLINE";
         case INDENT: return "INDENT";
         case DEDENT: return "DEDENT";
@@ -89,6 +93,7 @@ static const char* token_name(int token) {
         case STRING_LITERAL: return "STRING_LITERAL";
         case CHAR_LITERAL: return "CHAR_LITERAL";
         case COMPLEX_LITERAL: return "COMPLEX_LITERAL";
+        case BIGINT_LITERAL: return "BIGINT_LITERAL";
         default: return "UNKNOWN";
     }
 }